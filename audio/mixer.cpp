@@ -23,6 +23,7 @@
 
 #include "common/util.h"
 #include "common/textconsole.h"
+#include "common/trace.h"
 
 #include "audio/mixer_intern.h"
 #include "audio/rate.h"
@@ -301,6 +302,7 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
+	TRACE_ZONE("Mixer::mixCallback");
 	Common::StackLock lock(_mutex);
 
 	int16 *buf = (int16 *)samples;
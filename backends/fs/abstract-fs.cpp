@@ -36,6 +36,22 @@ const char *AbstractFSNode::lastPathComponent(const Common::String &str, const c
 	return cur + 1;
 }
 
+AbstractFSNode *AbstractFSNode::getChildWithKnownType(const Common::String &name, bool isDirectory, int64 fileSize) const {
+	return getChild(name);
+}
+
+bool AbstractFSNode::getDirectorySignature(uint32 &signature) const {
+	return false;
+}
+
+int64 AbstractFSNode::getFileSize() const {
+	return -1;
+}
+
 Common::SeekableReadStream *AbstractFSNode::createReadStreamForAltStream(Common::AltStreamType altStreamType) {
 	return nullptr;
 }
+
+Common::SeekableReadStream *AbstractFSNode::createReadStreamMapped() {
+	return createReadStream();
+}
@@ -118,6 +118,32 @@ public:
 	 */
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const = 0;
 
+	/**
+	 * Returns the node of a child of this directory which is known to exist,
+	 * to be a directory or not and to have the given size, like one listed by
+	 * getChildren() before. Backends can create it without checking the file
+	 * system again.
+	 *
+	 * @param fileSize The size of the file, or -1 if it is not known.
+	 *
+	 * @note By default, this method returns getChild(name).
+	 */
+	virtual AbstractFSNode *getChildWithKnownType(const Common::String &name, bool isDirectory, int64 fileSize) const;
+
+	/**
+	 * Returns a cheap signature of the children of this directory, built
+	 * from what the file system tells about the directory itself, like its
+	 * modification time and size, without reading its children.
+	 * Used to tell whether an earlier listing of the directory is still up
+	 * to date.
+	 *
+	 * A signature of 0 is returned for a directory which may still change
+	 * without changing its signature, like one modified a moment ago.
+	 *
+	 * @return false if no signature is available, which is the default.
+	 */
+	virtual bool getDirectorySignature(uint32 &signature) const;
+
 	/**
 	 * Returns a human readable path string.
 	 *
@@ -146,6 +172,15 @@ public:
 	 */
 	virtual bool isDirectory() const = 0;
 
+	/**
+	 * Returns the size of the file this node refers to, as known when the
+	 * node was created or listed if the backend keeps it.
+	 *
+	 * @return -1 if the node is a directory or the size is not available,
+	 *         which is the default.
+	 */
+	virtual int64 getFileSize() const;
+
 	/**
 	 * Indicates whether the object referred by this path can be read from or not.
 	 *
@@ -192,6 +227,15 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStreamForAltStream(Common::AltStreamType altStreamType);
 
+	/**
+	 * Creates a SeekableReadStream instance corresponding to the file
+	 * referred by this node, with the file mapped in memory. Nodes which
+	 * cannot map files return createReadStream() instead.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createReadStreamMapped();
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
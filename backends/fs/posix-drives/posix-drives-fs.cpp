@@ -82,6 +82,7 @@ Common::SeekableReadStream *DrivePOSIXFilesystemNode::createReadStream() {
 }
 
 Common::SeekableWriteStream *DrivePOSIXFilesystemNode::createWriteStream(bool atomic) {
+	_fileSize = -1;
 	StdioStream *writeStream = PosixIoStream::makeFromPath(getPath(), atomic ?
 			StdioStream::WriteMode_WriteAtomic : StdioStream::WriteMode_Write);
 
@@ -95,7 +96,7 @@ Common::SeekableWriteStream *DrivePOSIXFilesystemNode::createWriteStream(bool at
 	return writeStream;
 }
 
-DrivePOSIXFilesystemNode *DrivePOSIXFilesystemNode::getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const {
+DrivePOSIXFilesystemNode *DrivePOSIXFilesystemNode::getChildWithKnownType(const Common::String &n, bool isDirectoryFlag, int64 fileSize) const {
 	assert(_isDirectory);
 
 	// Make sure the string contains no slashes
@@ -111,13 +112,22 @@ DrivePOSIXFilesystemNode *DrivePOSIXFilesystemNode::getChildWithKnownType(const
 	child->_isValid = true;
 	child->_isPseudoRoot = false;
 	child->_isDirectory = isDirectoryFlag;
+	child->_fileSize = isDirectoryFlag ? -1 : fileSize;
 	child->_displayName = n;
 
 	return child;
 }
 
+bool DrivePOSIXFilesystemNode::getDirectorySignature(uint32 &signature) const {
+	// The list of drives has no signature
+	if (_isPseudoRoot)
+		return false;
+
+	return POSIXFilesystemNode::getDirectorySignature(signature);
+}
+
 AbstractFSNode *DrivePOSIXFilesystemNode::getChild(const Common::String &n) const {
-	DrivePOSIXFilesystemNode *child = getChildWithKnownType(n, false);
+	DrivePOSIXFilesystemNode *child = getChildWithKnownType(n, false, -1);
 	child->setFlags();
 
 	return child;
@@ -150,7 +160,7 @@ bool DrivePOSIXFilesystemNode::getChildren(AbstractFSList &list, AbstractFSNode:
 
 #if !defined(SYSTEM_NOT_SUPPORTING_D_TYPE)
 			if (dp->d_type == DT_DIR || dp->d_type == DT_REG) {
-				child = getChildWithKnownType(dp->d_name, dp->d_type == DT_DIR);
+				child = getChildWithKnownType(dp->d_name, dp->d_type == DT_DIR, -1);
 			} else
 #endif
 			{
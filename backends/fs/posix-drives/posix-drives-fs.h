@@ -69,6 +69,8 @@ public:
 	Common::SeekableWriteStream *createWriteStream(bool atomic) override;
 	AbstractFSNode *getChild(const Common::String &n) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
+	DrivePOSIXFilesystemNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag, int64 fileSize) const override;
+	bool getDirectorySignature(uint32 &signature) const override;
 	AbstractFSNode *getParent() const override;
 
 protected:
@@ -76,8 +78,6 @@ protected:
 
 private:
 	bool _isPseudoRoot;
-
-	DrivePOSIXFilesystemNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const;
 	bool isDrive(const Common::String &path) const;
 	void configureStream(StdioStream *stream);
 };
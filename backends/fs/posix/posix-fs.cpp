@@ -48,6 +48,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 
 #ifdef __OS2__
@@ -72,6 +73,17 @@ void POSIXFilesystemNode::setFlags() {
 
 	_isValid = (0 == stat(_path.c_str(), &st));
 	_isDirectory = _isValid ? S_ISDIR(st.st_mode) : false;
+	_fileSize = _isValid && !_isDirectory ? (int64)st.st_size : -1;
+}
+
+int64 POSIXFilesystemNode::getFileSize() const {
+	if (_fileSize >= 0 || _isDirectory)
+		return _fileSize;
+
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+		return -1;
+	return st.st_size;
 }
 
 POSIXFilesystemNode::POSIXFilesystemNode(const Common::String &p) {
@@ -236,6 +248,44 @@ bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, boo
 	return true;
 }
 
+AbstractFSNode *POSIXFilesystemNode::getChildWithKnownType(const Common::String &n, bool isDirectoryFlag, int64 fileSize) const {
+	assert(_isDirectory);
+
+	// Make sure the string contains no slashes
+	assert(!n.contains('/'));
+
+	// Like getChildren(), start with a clone of this node
+	POSIXFilesystemNode *child = new POSIXFilesystemNode(*this);
+	child->_displayName = n;
+	if (_path.lastChar() != '/')
+		child->_path += '/';
+	child->_path += n;
+	child->_isValid = true;
+	child->_isDirectory = isDirectoryFlag;
+	child->_fileSize = isDirectoryFlag ? -1 : fileSize;
+
+	return child;
+}
+
+bool POSIXFilesystemNode::getDirectorySignature(uint32 &signature) const {
+	struct stat st;
+	if (!_isDirectory || stat(_path.c_str(), &st) != 0)
+		return false;
+
+	// The modification time only has a resolution of seconds, so a directory
+	// modified within the last seconds may change again with the same time
+	const time_t now = time(nullptr);
+	if (now >= st.st_mtime && now - st.st_mtime < 2) {
+		signature = 0;
+		return true;
+	}
+
+	signature = (uint32)st.st_mtime ^ ((uint32)st.st_size * 2654435761U) ^ (uint32)st.st_ino;
+	if (signature == 0)
+		signature = 1;
+	return true;
+}
+
 AbstractFSNode *POSIXFilesystemNode::getParent() const {
 	if (_path == "/")
 		return 0;	// The filesystem root has no parent
@@ -280,7 +330,16 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStreamForAltStream(Co
 	return nullptr;
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createReadStreamMapped() {
+	// Files which cannot be mapped are read like the others
+	Common::SeekableReadStream *stream = PosixMappedStream::makeFromPath(getPath());
+	if (!stream)
+		stream = createReadStream();
+	return stream;
+}
+
 Common::SeekableWriteStream *POSIXFilesystemNode::createWriteStream(bool atomic) {
+	_fileSize = -1;
 	return PosixIoStream::makeFromPath(getPath(), atomic ?
 			StdioStream::WriteMode_WriteAtomic : StdioStream::WriteMode_Write);
 }
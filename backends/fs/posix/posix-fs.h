@@ -35,6 +35,8 @@ protected:
 	Common::String _path;
 	bool _isDirectory;
 	bool _isValid;
+	/** Size of the file, or -1 if it is a directory or not known yet. */
+	int64 _fileSize;
 
 	virtual AbstractFSNode *makeNode(const Common::String &path) const {
 		return new POSIXFilesystemNode(path);
@@ -43,7 +45,7 @@ protected:
 	/**
 	 * Plain constructor, for internal use only (hence protected).
 	 */
-	POSIXFilesystemNode() : _isDirectory(false), _isValid(false) {}
+	POSIXFilesystemNode() : _isDirectory(false), _isValid(false), _fileSize(-1) {}
 
 public:
 	/**
@@ -58,21 +60,25 @@ public:
 	Common::String getName() const override { return _displayName; }
 	Common::String getPath() const override { return _path; }
 	bool isDirectory() const override { return _isDirectory; }
+	int64 getFileSize() const override;
 	bool isReadable() const override;
 	bool isWritable() const override;
 
 	AbstractFSNode *getChild(const Common::String &n) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
+	AbstractFSNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag, int64 fileSize) const override;
+	bool getDirectorySignature(uint32 &signature) const override;
 	AbstractFSNode *getParent() const override;
 
 	Common::SeekableReadStream *createReadStream() override;
 	Common::SeekableReadStream *createReadStreamForAltStream(Common::AltStreamType altStreamType) override;
+	Common::SeekableReadStream *createReadStreamMapped() override;
 	Common::SeekableWriteStream *createWriteStream(bool atomic) override;
 	bool createDirectory() override;
 
 protected:
 	/**
-	 * Tests and sets the _isValid and _isDirectory flags, using the stat() function.
+	 * Tests and sets the _isValid and _isDirectory flags and the file size, using the stat() function.
 	 */
 	virtual void setFlags();
 };
@@ -25,6 +25,11 @@
 
 #include <sys/stat.h>
 #include <stdio.h>
+#ifdef HAS_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 PosixIoStream::PosixIoStream(void *handle) :
 		StdioStream(handle) {
@@ -54,3 +59,37 @@ int64 PosixIoStream::size() const {
 	return st.st_size;
 #endif
 }
+
+PosixMappedStream::PosixMappedStream(void *data, uint32 size) :
+		Common::MemoryReadStream((const byte *)data, size), _data(data), _mappedSize(size) {
+}
+
+PosixMappedStream::~PosixMappedStream() {
+#ifdef HAS_MMAP
+	munmap(_data, _mappedSize);
+#endif
+}
+
+PosixMappedStream *PosixMappedStream::makeFromPath(const Common::String &path) {
+#ifdef HAS_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64)st.st_size > 0xFFFFFFFF) {
+		::close(fd);
+		return nullptr;
+	}
+
+	// The mapping keeps its own reference to the file
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	return new PosixMappedStream(data, st.st_size);
+#else
+	return nullptr;
+#endif
+}
@@ -23,6 +23,7 @@
 #define BACKENDS_FS_POSIX_POSIXIOSTREAM_H
 
 #include "backends/fs/stdiostream.h"
+#include "common/memstream.h"
 
 /**
  * A file input / output stream using POSIX interfaces
@@ -39,4 +40,25 @@ public:
 	int64 size() const override;
 };
 
+/**
+ * A file input stream reading a file mapped in memory with mmap
+ */
+class PosixMappedStream final : public Common::MemoryReadStream {
+public:
+	/**
+	 * Map the file at @p path. Return nullptr if the platform does not
+	 * support mmap, or if the file cannot be mapped, like empty files and
+	 * files larger than a MemoryReadStream can hold.
+	 */
+	static PosixMappedStream *makeFromPath(const Common::String &path);
+
+	~PosixMappedStream() override;
+
+private:
+	PosixMappedStream(void *data, uint32 size);
+
+	void *_data;
+	uint32 _mappedSize;
+};
+
 #endif
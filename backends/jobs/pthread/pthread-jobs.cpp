@@ -0,0 +1,142 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "backends/jobs/pthread/pthread-jobs.h"
+
+#include "common/textconsole.h"
+#include "common/util.h"
+
+/**
+ * pthreads job system implementation
+ */
+class PthreadJobSystem final : public Common::JobSystem {
+public:
+	PthreadJobSystem(uint workerCount, bool pinWorkers);
+	~PthreadJobSystem() override;
+
+protected:
+	void waitForWork() override;
+	void signalWork(uint count) override;
+	void yieldThread() override;
+
+private:
+	struct Worker {
+		PthreadJobSystem *system;
+		uint index;
+		pthread_t thread;
+	};
+
+	static void *workerProc(void *arg);
+
+	Worker _workers[kMaxWorkers];
+	uint _started;
+
+	// A counting semaphore, so that a signal is not lost when a worker has
+	// not started waiting yet. Signals beyond one per worker would only
+	// wake up workers for nothing, so they are dropped.
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _signals;
+};
+
+PthreadJobSystem::PthreadJobSystem(uint workerCount, bool pinWorkers) : _started(0), _signals(0) {
+	pthread_mutex_init(&_mutex, nullptr);
+	pthread_cond_init(&_cond, nullptr);
+
+	initWorkers(workerCount);
+	for (uint i = 0; i < workerCount; ++i) {
+		Worker &worker = _workers[i];
+		worker.system = this;
+		worker.index = i;
+		if (pthread_create(&worker.thread, nullptr, workerProc, &worker) != 0) {
+			// Only its worker pushes jobs to the queue of a worker, so the
+			// queues of those which did not start stay empty
+			warning("PthreadJobSystem: pthread_create() failed for worker %u", i);
+			break;
+		}
+		_started++;
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+		if (pinWorkers) {
+			const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET((i + 1) % MAX<long>(cores, 1), &set);
+			if (pthread_setaffinity_np(worker.thread, sizeof(set), &set) != 0)
+				warning("PthreadJobSystem: Could not pin worker %u", i);
+		}
+#endif
+	}
+}
+
+PthreadJobSystem::~PthreadJobSystem() {
+	stopWorkers();
+	for (uint i = 0; i < _started; ++i)
+		pthread_join(_workers[i].thread, nullptr);
+
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void *PthreadJobSystem::workerProc(void *arg) {
+	Worker *worker = (Worker *)arg;
+	worker->system->runWorker(worker->index);
+	return nullptr;
+}
+
+void PthreadJobSystem::waitForWork() {
+	pthread_mutex_lock(&_mutex);
+	while (!_signals)
+		pthread_cond_wait(&_cond, &_mutex);
+	_signals--;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void PthreadJobSystem::signalWork(uint count) {
+	pthread_mutex_lock(&_mutex);
+	_signals = MIN(_signals + count, _started);
+	if (count == 1)
+		pthread_cond_signal(&_cond);
+	else
+		pthread_cond_broadcast(&_cond);
+	pthread_mutex_unlock(&_mutex);
+}
+
+void PthreadJobSystem::yieldThread() {
+	sched_yield();
+}
+
+Common::JobSystem *createPthreadJobSystem(int threadCount, bool pinThreads) {
+	if (threadCount <= 0) {
+		const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threadCount = cores > 0 ? cores : 1;
+	}
+
+	const uint workerCount = MIN<uint>((uint)threadCount - 1, Common::JobSystem::kMaxWorkers);
+	if (!workerCount)
+		return new Common::JobSystem();
+
+	return new PthreadJobSystem(workerCount, pinThreads);
+}
@@ -0,0 +1,37 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BACKENDS_JOBS_PTHREAD_H
+#define BACKENDS_JOBS_PTHREAD_H
+
+#include "common/jobs.h"
+
+/**
+ * Create a job system which runs its workers on POSIX threads.
+ *
+ * @param threadCount Number of threads running jobs, including the thread of
+ *                    the engine, or 0 or less for one per CPU core.
+ * @param pinThreads  Pin each worker to its own CPU core, leaving the first
+ *                    one to the thread of the engine. Only supported on Linux.
+ */
+Common::JobSystem *createPthreadJobSystem(int threadCount, bool pinThreads);
+
+#endif
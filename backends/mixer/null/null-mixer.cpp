@@ -22,6 +22,8 @@
 #include "backends/mixer/null/null-mixer.h"
 #include "common/savefile.h"
 
+NullMixerManager::CallbackObserver *NullMixerManager::_callbackObserver = nullptr;
+
 NullMixerManager::NullMixerManager() : MixerManager() {
 	_outputRate = 22050;
 	_callsCounter = 0;
@@ -64,6 +66,10 @@ void NullMixerManager::update(uint8 callbackPeriod) {
 	_callsCounter++;
 	if ((_callsCounter % callbackPeriod) == 0) {
 		assert(_mixer);
+		if (_callbackObserver)
+			_callbackObserver->beginMixerCallback();
 		_mixer->mixCallback(_samplesBuf, _samples);
+		if (_callbackObserver)
+			_callbackObserver->endMixerCallback();
 	}
 }
@@ -35,6 +35,15 @@
 
 class NullMixerManager : public MixerManager {
 public:
+	/** Notified around the mixer callbacks of all null mixers, to profile them. */
+	class CallbackObserver {
+	public:
+		virtual ~CallbackObserver() {}
+
+		virtual void beginMixerCallback() = 0;
+		virtual void endMixerCallback() = 0;
+	};
+
 	NullMixerManager();
 	virtual ~NullMixerManager();
 
@@ -46,7 +55,11 @@ public:
 
 	bool isNullDevice() const override;
 
+	static void setCallbackObserver(CallbackObserver *observer) { _callbackObserver = observer; }
+
 private:
+	static CallbackObserver *_callbackObserver;
+
 	uint32 _outputRate;
 	uint32 _callsCounter;
 	uint32 _samples;
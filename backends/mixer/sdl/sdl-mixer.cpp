@@ -28,6 +28,7 @@
 #include "common/system.h"
 #include "common/config-manager.h"
 #include "common/textconsole.h"
+#include "common/trace.h"
 
 #if defined(PLAYSTATION3) || defined(PSP2) || defined(NINTENDO_SWITCH)
 #define SAMPLES_PER_SEC 48000
@@ -207,6 +208,7 @@ void SdlMixerManager::sdlCallback(void *this_, byte *samples, int len) {
 	SdlMixerManager *manager = (SdlMixerManager *)this_;
 	assert(manager);
 
+	TRACE_THREAD_NAME("Audio");
 	manager->callbackHandler(samples, len);
 }
 
@@ -27,6 +27,7 @@
 #include "gui/EventRecorder.h"
 
 #include "common/timer.h"
+#include "common/trace.h"
 #include "graphics/pixelformat.h"
 
 ModularGraphicsBackend::ModularGraphicsBackend()
@@ -190,6 +191,10 @@ void ModularGraphicsBackend::fillScreen(const Common::Rect &r, uint32 col) {
 }
 
 void ModularGraphicsBackend::updateScreen() {
+	// Engines update the screen once per frame
+	TRACE_FRAME("Frame");
+	TRACE_ZONE("updateScreen");
+
 #ifdef ENABLE_EVENTRECORDER
 	g_system->getMillis();		// force event recorder to update the tick count
 	g_eventRec.processScreenUpdate();
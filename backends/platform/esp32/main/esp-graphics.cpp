@@ -25,6 +25,7 @@
 #include "common/config-manager.h"
 #include "common/str.h"
 #include "common/textconsole.h"	// for warning() & error()
+#include "common/trace.h"
 #include "common/translation.h"
 #include "engines/engine.h"
 #include "graphics/blit.h"
@@ -82,12 +83,13 @@ void EspGraphicsManager::gfxTask() {
 	int rgbfb_w=0;
 	int rgbfb_h=0;
 
-
+	TRACE_THREAD_NAME("Gfx");
 
 
 	while(1) {
 		int fbno=0;
 		if (xQueueReceive(_fb_num_q, (void*)(&fbno), portMAX_DELAY)) {
+			TRACE_ZONE("EspGraphicsManager::gfxTask");
 			uint16_t *lcdbuf;
 			ESP_ERROR_CHECK(esp_lcd_dpi_panel_get_frame_buffer(_panel_handle, 1, (void**)&lcdbuf));
 			if (fbno==-1) {
@@ -229,6 +231,7 @@ void EspGraphicsManager::updateScreen() {
 	if ((esp_timer_get_time()-_last_time_updated)<(1000000/30)) return;
 	_last_time_updated=esp_timer_get_time();
 
+	TRACE_ZONE("EspGraphicsManager::updateScreen");
 	uint64_t t=esp_timer_get_time();
 
 	int fbno;
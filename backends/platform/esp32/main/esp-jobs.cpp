@@ -0,0 +1,120 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/scummsys.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+#include "esp-jobs.h"
+
+// Below the graphics task, which shares the second core with the workers
+#define JOB_WORKER_PRIORITY 2
+#define JOB_WORKER_STACK_SIZE 8192
+
+class EspJobSystem final : public Common::JobSystem {
+public:
+	EspJobSystem(uint workerCount);
+	~EspJobSystem() override;
+
+protected:
+	void waitForWork() override;
+	void signalWork(uint count) override;
+	void yieldThread() override;
+
+private:
+	struct Worker {
+		EspJobSystem *system;
+		uint index;
+	};
+
+	static void workerTask(void *arg);
+
+	Worker _workers[kMaxWorkers];
+	uint _started;
+	SemaphoreHandle_t _work;
+	SemaphoreHandle_t _stopped;
+};
+
+EspJobSystem::EspJobSystem(uint workerCount) : _started(0) {
+	_work = xSemaphoreCreateCounting(MAX<uint>(workerCount, 1), 0);
+	_stopped = xSemaphoreCreateCounting(kMaxWorkers, 0);
+
+	initWorkers(workerCount);
+	for (uint i = 0; i < workerCount; ++i) {
+		Worker &worker = _workers[i];
+		worker.system = this;
+		worker.index = i;
+		if (xTaskCreatePinnedToCore(workerTask, "jobs", JOB_WORKER_STACK_SIZE, &worker, JOB_WORKER_PRIORITY, NULL, (i + 1) % portNUM_PROCESSORS) != pdPASS) {
+			warning("EspJobSystem: Could not create the task of worker %u", i);
+			break;
+		}
+		_started++;
+	}
+}
+
+EspJobSystem::~EspJobSystem() {
+	stopWorkers();
+	// FreeRTOS tasks cannot be joined, so each worker signals its end
+	for (uint i = 0; i < _started; ++i)
+		xSemaphoreTake(_stopped, portMAX_DELAY);
+
+	vSemaphoreDelete(_stopped);
+	vSemaphoreDelete(_work);
+}
+
+void EspJobSystem::workerTask(void *arg) {
+	Worker *worker = (Worker *)arg;
+	worker->system->runWorker(worker->index);
+	xSemaphoreGive(worker->system->_stopped);
+	vTaskDelete(NULL);
+}
+
+void EspJobSystem::waitForWork() {
+	xSemaphoreTake(_work, portMAX_DELAY);
+}
+
+void EspJobSystem::signalWork(uint count) {
+	// The semaphore saturates at one signal per worker
+	while (count--)
+		xSemaphoreGive(_work);
+}
+
+void EspJobSystem::yieldThread() {
+	taskYIELD();
+}
+
+Common::JobSystem *createEspJobSystem(int threadCount) {
+	if (threadCount <= 0)
+		threadCount = portNUM_PROCESSORS;
+
+	const uint workerCount = MIN<uint>((uint)threadCount - 1, Common::JobSystem::kMaxWorkers);
+	if (!workerCount)
+		return new Common::JobSystem();
+
+	return new EspJobSystem(workerCount);
+}
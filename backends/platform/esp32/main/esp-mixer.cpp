@@ -25,6 +25,7 @@
 
 #include "esp-mixer.h"
 #include "common/system.h"
+#include "common/trace.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
@@ -41,6 +42,7 @@ void EspMixerManager::audioTaskStub(void *param) {
 void EspMixerManager::audioTask() {
 	byte *buf=(byte*)heap_caps_calloc(_bufSize, 1, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 	int64_t frame_time_us=((int64_t)(_bufSize/4)*1000000ULL)/(int64_t)_freq;
+	TRACE_THREAD_NAME("Audio");
 	while(1) {
 		int skip=0;
 		if (!_audioSuspended) {
@@ -49,6 +51,7 @@ void EspMixerManager::audioTask() {
 			t=esp_timer_get_time()-t;
 			if (t > frame_time_us) {
 				ESP_LOGW(TAG, "Audio frame calc overrun: took %d us to calc %d us worth of audio", (int)t, (int)frame_time_us);
+				TRACE_COUNTER("Audio overrun us", t-frame_time_us);
 				skip=1;
 			}
 		} else {
@@ -37,11 +37,13 @@
 
 #include "backends/modular-backend.h"
 #include "esp-mutex.h"
+#include "esp-jobs.h"
 #include "base/main.h"
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "common/config-manager.h"
+#include "common/fsindex.h"
 #include "esp-graphics.h"
 #include "esp-mixer.h"
 #include "gui/debugger.h"
@@ -63,6 +65,7 @@ public:
 	virtual bool pollEvent(Common::Event &event);
 
 	virtual Common::MutexInternal *createMutex();
+	virtual Common::JobSystem *getJobSystem();
 	virtual uint32 getMillis(bool skipRecord = false);
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
@@ -84,15 +87,19 @@ private:
 	bool _mousedown_queued;
 	Common::Point _last_mouse_pos;
 	int64_t _last_ts_time_us;
+	Common::FSIndex *_fsIndex;
 };
 
 OSystem_esp32::OSystem_esp32(bool silenceLogs) :
 	_silenceLogs(silenceLogs) {
 	_fsFactory = new POSIXESPFilesystemFactory();
 	_last_ts_time_us = 0;
+	_fsIndex = nullptr;
 }
 
 OSystem_esp32::~OSystem_esp32() {
+	Common::FSDirectory::setIndex(nullptr);
+	delete _fsIndex;
 }
 
 
@@ -113,6 +120,16 @@ void OSystem_esp32::initBackend() {
 	ConfMan.registerDefault("pluginspath", Common::Path("/sdcard/scummvm/plugins/"));
 	ConfMan.registerDefault("savepath", Common::Path("/sdcard/scummvm/saves/"));
 	ConfMan.registerDefault("themepath", Common::Path("/sdcard/scummvm/themes/"));
+	// Parsing the theme takes seconds, so it is compiled once
+	ConfMan.registerDefault("gui_theme_cache", true);
+
+	// Reading directories is slow on the SD card, so their listings can be
+	// kept from one start to the next. FAT does not update the times of
+	// directories, so the listings are trusted until a lookup fails in them.
+	if (ConfMan.getBool("fs_index")) {
+		_fsIndex = new Common::FSIndex(Common::FSNode(Common::Path("/sdcard/scummvm/fsindex.dat")), false);
+		Common::FSDirectory::setIndex(_fsIndex);
+	}
 
 	BaseBackend::initBackend();
 }
@@ -264,6 +281,12 @@ Common::MutexInternal *OSystem_esp32::createMutex() {
 	return createEspMutexInternal();
 }
 
+Common::JobSystem *OSystem_esp32::getJobSystem() {
+	if (!_jobSystem)
+		_jobSystem = createEspJobSystem(ConfMan.getInt("job_threads"));
+	return _jobSystem;
+}
+
 uint32 OSystem_esp32::getMillis(bool skipRecord) {
 	uint64_t t_us=esp_timer_get_time();
 	return (uint32)(t_us/1000ULL);
@@ -306,8 +329,9 @@ void OSystem_esp32::logMessage(LogMessageType::Type type, const char *message) {
 }
 
 void OSystem_esp32::addSysArchivesToSearchSet(Common::SearchSet &s, int priority) {
+	// Engine data and themes both live in the same tree, which only needs to
+	// be scanned once
 	s.add("engine-data", new Common::FSDirectory("/sdcard/scummvm/", 4), priority);
-	s.add("gui/themes", new Common::FSDirectory("/sdcard/scummvm/", 4), priority);
 }
 
 Common::Path OSystem_esp32::getDefaultConfigFileName() {
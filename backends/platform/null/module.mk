@@ -3,6 +3,11 @@ MODULE := backends/platform/null
 MODULE_OBJS := \
 	null.o
 
+ifdef ENABLE_EVENTRECORDER
+MODULE_OBJS += \
+	null-benchmark.o
+endif
+
 # We don't use rules.mk but rather manually update OBJS and MODULE_DIRS.
 MODULE_OBJS := $(addprefix $(MODULE)/, $(MODULE_OBJS))
 OBJS := $(MODULE_OBJS) $(OBJS)
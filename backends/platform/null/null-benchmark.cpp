@@ -0,0 +1,240 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef POSIX
+#include <sys/time.h>
+#elif defined(WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "backends/platform/null/null-benchmark.h"
+
+#ifdef POSIX
+#include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-iostream.h"
+#endif
+
+#include "common/algorithm.h"
+#include "common/file.h"
+#include "common/formats/json.h"
+#include "common/system.h"
+
+NullBenchmark::NullBenchmark(const Common::String &target, const Common::String &recording) :
+	_target(target), _recording(recording) {
+	memset(&_frame, 0, sizeof(_frame));
+	_startMicros = _frameStartMicros = getMicros();
+	_mixerStartMicros = 0;
+	NullMixerManager::setCallbackObserver(this);
+}
+
+NullBenchmark::~NullBenchmark() {
+	NullMixerManager::setCallbackObserver(nullptr);
+}
+
+uint64 NullBenchmark::getMicros() {
+#ifdef POSIX
+	timeval curTime;
+	gettimeofday(&curTime, 0);
+	return (uint64)curTime.tv_sec * 1000000 + curTime.tv_usec;
+#elif defined(WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (uint64)counter.QuadPart * 1000000 / frequency.QuadPart;
+#else
+	return (uint64)g_system->getMillis(true) * 1000;
+#endif
+}
+
+void NullBenchmark::addScreenCopy(uint32 bytes) {
+	_frame.copyRectBytes += bytes;
+	_frame.copyRects++;
+}
+
+void NullBenchmark::addScreenUpdate(uint32 replayedMillis) {
+	const uint64 now = getMicros();
+	_frame.replayedMillis = replayedMillis;
+	_frame.tickMicros = now - _frameStartMicros;
+	_frames.push_back(_frame);
+
+	memset(&_frame, 0, sizeof(_frame));
+	_frameStartMicros = now;
+}
+
+void NullBenchmark::addFileLoad(uint32 bytes) {
+	_frame.fileLoads++;
+	_frame.fileLoadBytes += bytes;
+}
+
+void NullBenchmark::beginMixerCallback() {
+	_mixerStartMicros = getMicros();
+}
+
+void NullBenchmark::endMixerCallback() {
+	_frame.mixerCallbacks++;
+	_frame.mixerMicros += getMicros() - _mixerStartMicros;
+}
+
+bool NullBenchmark::writeReport(const Common::Path &fileName) const {
+	// The frames are written as one array per statistic, which keeps large
+	// reports compact and is what plotting tools expect
+	static const char *const names[] = {
+		"replayedMillis", "tickMicros", "copyRectBytes", "copyRects",
+		"mixerCallbacks", "mixerMicros", "fileLoads", "fileLoadBytes"
+	};
+	Common::JSONArray columns[ARRAYSIZE(names)];
+	uint64 totals[ARRAYSIZE(names)] = {};
+	Common::Array<uint32> ticks;
+	ticks.reserve(_frames.size());
+
+	for (uint i = 0; i < _frames.size(); ++i) {
+		const Frame &frame = _frames[i];
+		const uint32 values[ARRAYSIZE(names)] = {
+			frame.replayedMillis, frame.tickMicros, frame.copyRectBytes, frame.copyRects,
+			frame.mixerCallbacks, frame.mixerMicros, frame.fileLoads, frame.fileLoadBytes
+		};
+		for (int j = 0; j < ARRAYSIZE(names); ++j) {
+			columns[j].push_back(new Common::JSONValue((long long int)values[j]));
+			totals[j] += values[j];
+		}
+		ticks.push_back(frame.tickMicros);
+	}
+	Common::sort(ticks.begin(), ticks.end());
+
+	Common::JSONObject frames;
+	Common::JSONObject summary;
+	for (int j = 0; j < ARRAYSIZE(names); ++j) {
+		frames.setVal(names[j], new Common::JSONValue(columns[j]));
+		// The replayed time is not a cost, its total is the time of the last frame
+		if (j != 0)
+			summary.setVal(names[j], new Common::JSONValue((long long int)totals[j]));
+	}
+	summary.setVal("updateScreens", new Common::JSONValue((long long int)_frames.size()));
+	summary.setVal("replayedMillis", new Common::JSONValue((long long int)(_frames.empty() ? 0 : _frames.back().replayedMillis)));
+	summary.setVal("hostMicros", new Common::JSONValue((long long int)(getMicros() - _startMicros)));
+	summary.setVal("tickMicrosMedian", new Common::JSONValue((long long int)(ticks.empty() ? 0 : ticks[ticks.size() / 2])));
+	summary.setVal("tickMicros95th", new Common::JSONValue((long long int)(ticks.empty() ? 0 : ticks[ticks.size() * 95 / 100])));
+	summary.setVal("tickMicrosMax", new Common::JSONValue((long long int)(ticks.empty() ? 0 : ticks.back())));
+
+	Common::JSONObject report;
+	report.setVal("target", new Common::JSONValue(_target));
+	report.setVal("recording", new Common::JSONValue(_recording));
+	report.setVal("summary", new Common::JSONValue(summary));
+	report.setVal("frames", new Common::JSONValue(frames));
+
+	const Common::String json = Common::JSONValue(report).stringify(true);
+	Common::DumpFile file;
+	if (!file.open(fileName) || file.write(json.c_str(), json.size()) != json.size())
+		return false;
+	file.finalize();
+	return !file.err();
+}
+
+void BenchmarkGraphicsManager::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
+#ifdef USE_RGB_COLOR
+	_benchmark->addScreenCopy(w * h * getScreenFormat().bytesPerPixel);
+#else
+	_benchmark->addScreenCopy(w * h);
+#endif
+}
+
+void BenchmarkGraphicsManager::updateScreen() {
+	_benchmark->addScreenUpdate(g_system->getMillis(true));
+}
+
+#ifdef POSIX
+/**
+ * POSIX node which reports the files opened for reading to the factory. The
+ * children listed by the POSIX node are plain POSIX nodes, so they are
+ * wrapped as well.
+ */
+class BenchmarkFilesystemNode : public POSIXFilesystemNode {
+public:
+	BenchmarkFilesystemNode(const Common::String &path, const BenchmarkFilesystemFactory *factory) : POSIXFilesystemNode(path), _factory(factory) {}
+	BenchmarkFilesystemNode(const POSIXFilesystemNode &node, const BenchmarkFilesystemFactory *factory) : POSIXFilesystemNode(node), _factory(factory) {}
+
+	static AbstractFSNode *wrap(AbstractFSNode *node, const BenchmarkFilesystemFactory *factory) {
+		if (!node)
+			return nullptr;
+		AbstractFSNode *wrapped = new BenchmarkFilesystemNode(*static_cast<POSIXFilesystemNode *>(node), factory);
+		delete node;
+		return wrapped;
+	}
+
+	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override {
+		const uint first = list.size();
+		if (!POSIXFilesystemNode::getChildren(list, mode, hidden))
+			return false;
+		for (uint i = first; i < list.size(); ++i)
+			list[i] = wrap(list[i], _factory);
+		return true;
+	}
+
+	AbstractFSNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag, int64 fileSize) const override {
+		return wrap(POSIXFilesystemNode::getChildWithKnownType(n, isDirectoryFlag, fileSize), _factory);
+	}
+
+	Common::SeekableReadStream *createReadStream() override {
+		Common::SeekableReadStream *stream = POSIXFilesystemNode::createReadStream();
+		if (stream)
+			_factory->addFileLoad(stream->size());
+		return stream;
+	}
+
+	// Files which cannot be mapped are read through createReadStream(),
+	// which reports them already
+	Common::SeekableReadStream *createReadStreamMapped() override {
+		Common::SeekableReadStream *stream = PosixMappedStream::makeFromPath(getPath());
+		if (!stream)
+			return createReadStream();
+		_factory->addFileLoad(stream->size());
+		return stream;
+	}
+
+protected:
+	AbstractFSNode *makeNode(const Common::String &path) const override {
+		return new BenchmarkFilesystemNode(path, _factory);
+	}
+
+private:
+	const BenchmarkFilesystemFactory *_factory;
+};
+
+void BenchmarkFilesystemFactory::addFileLoad(uint32 bytes) const {
+	if (_benchmark)
+		_benchmark->addFileLoad(bytes);
+}
+
+AbstractFSNode *BenchmarkFilesystemFactory::makeRootFileNode() const {
+	return BenchmarkFilesystemNode::wrap(POSIXFilesystemFactory::makeRootFileNode(), this);
+}
+
+AbstractFSNode *BenchmarkFilesystemFactory::makeCurrentDirectoryFileNode() const {
+	return BenchmarkFilesystemNode::wrap(POSIXFilesystemFactory::makeCurrentDirectoryFileNode(), this);
+}
+
+AbstractFSNode *BenchmarkFilesystemFactory::makeFileNodePath(const Common::String &path) const {
+	return BenchmarkFilesystemNode::wrap(POSIXFilesystemFactory::makeFileNodePath(path), this);
+}
+#endif
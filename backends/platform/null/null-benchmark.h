@@ -0,0 +1,115 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BACKENDS_PLATFORM_NULL_BENCHMARK_H
+#define BACKENDS_PLATFORM_NULL_BENCHMARK_H
+
+#include "backends/graphics/null/null-graphics.h"
+#include "backends/mixer/null/null-mixer.h"
+#include "common/array.h"
+#include "common/path.h"
+#include "common/str.h"
+
+#ifdef POSIX
+#include "backends/fs/posix/posix-fs-factory.h"
+#endif
+
+/**
+ * Per-frame statistics of a recording played back by the event recorder in
+ * benchmark mode, written as JSON when the playback ends.
+ *
+ * Each call to updateScreen() ends a frame. The time a frame took is measured
+ * on the host clock, while the recorder replays the time of the recording as
+ * fast as possible.
+ */
+class NullBenchmark : public NullMixerManager::CallbackObserver {
+public:
+	NullBenchmark(const Common::String &target, const Common::String &recording);
+	~NullBenchmark() override;
+
+	void addScreenCopy(uint32 bytes);
+	void addScreenUpdate(uint32 replayedMillis);
+	void addFileLoad(uint32 bytes);
+
+	void beginMixerCallback() override;
+	void endMixerCallback() override;
+
+	/** Writes the statistics of the frames played back so far. */
+	bool writeReport(const Common::Path &fileName) const;
+
+private:
+	struct Frame {
+		uint32 replayedMillis;
+		uint32 tickMicros;
+		uint32 copyRectBytes;
+		uint32 copyRects;
+		uint32 mixerCallbacks;
+		uint32 mixerMicros;
+		uint32 fileLoads;
+		uint32 fileLoadBytes;
+	};
+
+	static uint64 getMicros();
+
+	Common::String _target;
+	Common::String _recording;
+	Common::Array<Frame> _frames;
+	Frame _frame;
+	uint64 _startMicros;
+	uint64 _frameStartMicros;
+	uint64 _mixerStartMicros;
+};
+
+/** Graphics manager which reports the screen copies and updates to a benchmark. */
+class BenchmarkGraphicsManager : public NullGraphicsManager {
+public:
+	explicit BenchmarkGraphicsManager(NullBenchmark *benchmark) : _benchmark(benchmark) {}
+
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) override;
+	void updateScreen() override;
+
+private:
+	NullBenchmark *_benchmark;
+};
+
+#ifdef POSIX
+/**
+ * Filesystem factory whose nodes report the files opened for reading to a
+ * benchmark, once it is set.
+ */
+class BenchmarkFilesystemFactory : public POSIXFilesystemFactory {
+public:
+	BenchmarkFilesystemFactory() : _benchmark(nullptr) {}
+
+	void setBenchmark(NullBenchmark *benchmark) { _benchmark = benchmark; }
+	void addFileLoad(uint32 bytes) const;
+
+protected:
+	AbstractFSNode *makeRootFileNode() const override;
+	AbstractFSNode *makeCurrentDirectoryFileNode() const override;
+	AbstractFSNode *makeFileNodePath(const Common::String &path) const override;
+
+private:
+	NullBenchmark *_benchmark;
+};
+#endif
+
+#endif
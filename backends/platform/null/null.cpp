@@ -49,15 +49,26 @@ typedef void (*sighandler_t)(int);
 #if defined(USE_NULL_DRIVER)
 #include "backends/modular-backend.h"
 #include "backends/mutex/null/null-mutex.h"
+#ifdef POSIX
+#include "backends/jobs/pthread/pthread-jobs.h"
+#include "common/config-manager.h"
+#endif
 #include "base/main.h"
 
-#ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/saves/default/default-saves.h"
+#include "backends/graphics/null/null-graphics.h"
+
+#ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
-#include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
+
+#ifdef ENABLE_EVENTRECORDER
+#include "backends/platform/null/null-benchmark.h"
+#include "common/config-manager.h"
+#include "gui/EventRecorder.h"
+#endif
 #endif
 
 /*
@@ -85,6 +96,9 @@ public:
 	virtual bool pollEvent(Common::Event &event);
 
 	virtual Common::MutexInternal *createMutex();
+#ifdef POSIX
+	virtual Common::JobSystem *getJobSystem();
+#endif
 	virtual uint32 getMillis(bool skipRecord = false);
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
@@ -95,7 +109,20 @@ public:
 
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority);
 
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	virtual MixerManager *getMixerManager();
+	virtual Common::TimerManager *getTimerManager();
+	virtual Common::SaveFileManager *getSavefileManager();
+#endif
+
 private:
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	void writeBenchmarkReport();
+
+	NullBenchmark *_benchmark;
+	Common::Path _benchmarkFile;
+#endif
+
 #ifdef POSIX
 	timeval _startTime;
 #elif defined(WIN32)
@@ -106,6 +133,10 @@ private:
 
 OSystem_NULL::OSystem_NULL(bool silenceLogs) :
 	_silenceLogs(silenceLogs) {
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	_benchmark = nullptr;
+#endif
+
 	#if defined(__amigaos4__)
 		_fsFactory = new AmigaOSFilesystemFactory();
 	#elif defined(__MORPHOS__)
@@ -119,9 +150,23 @@ OSystem_NULL::OSystem_NULL(bool silenceLogs) :
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	// The tests do not initialize the backend, but load themes and saves
+	_graphicsManager = new NullGraphicsManager();
+	_savefileManager = new DefaultSaveFileManager();
+#endif
 }
 
 OSystem_NULL::~OSystem_NULL() {
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	// The playback was interrupted before the end of the recording
+	writeBenchmarkReport();
+
+	// HACK HACK HACK
+	// This is nasty.
+	delete g_eventRec.getTimerManager();
+#endif
 }
 
 #if defined(POSIX) && !defined(NULL_DRIVER_USE_FOR_TEST)
@@ -147,13 +192,38 @@ void OSystem_NULL::initBackend() {
 	last_handler = signal(SIGINT, intHandler);
 #endif
 
-	_timerManager = new DefaultTimerManager();
 	_eventManager = new DefaultEventManager(this);
 	_savefileManager = new DefaultSaveFileManager();
-	_graphicsManager = new NullGraphicsManager();
 	_mixerManager = new NullMixerManager();
 	// Setup and start mixer
 	_mixerManager->init();
+
+#ifdef ENABLE_EVENTRECORDER
+	g_eventRec.registerMixerManager(_mixerManager);
+
+	g_eventRec.registerTimerManager(new DefaultTimerManager());
+
+	// Benchmarks play back a recording as fast as possible, and report the
+	// statistics of each frame when it ends
+	if (ConfMan.get("record_mode") == "benchmark") {
+		_benchmark = new NullBenchmark(ConfMan.getActiveDomainName(), ConfMan.get("record_file_name"));
+		_benchmarkFile = ConfMan.getPath("benchmark_file");
+#ifdef POSIX
+		// The nodes created until now, while reading the command line and
+		// the configuration, do not refer to the factory
+		BenchmarkFilesystemFactory *fsFactory = new BenchmarkFilesystemFactory();
+		fsFactory->setBenchmark(_benchmark);
+		delete _fsFactory;
+		_fsFactory = fsFactory;
+#endif
+		_graphicsManager = new BenchmarkGraphicsManager(_benchmark);
+	}
+#else
+	_timerManager = new DefaultTimerManager();
+#endif
+
+	if (_graphicsManager == nullptr)
+		_graphicsManager = new NullGraphicsManager();
 #endif
 
 	BaseBackend::initBackend();
@@ -161,7 +231,11 @@ void OSystem_NULL::initBackend() {
 
 bool OSystem_NULL::pollEvent(Common::Event &event) {
 #ifndef NULL_DRIVER_USE_FOR_TEST
-	((DefaultTimerManager *)getTimerManager())->checkTimers();
+#ifdef ENABLE_EVENTRECORDER
+	// The event recorder runs the timers on the time of the recording
+	if (g_eventRec.getRecordMode() == GUI::EventRecorder::kPassthrough)
+#endif
+		((DefaultTimerManager *)getTimerManager())->checkTimers();
 	((NullMixerManager *)_mixerManager)->update(1);
 
 #ifdef POSIX
@@ -190,22 +264,46 @@ Common::MutexInternal *OSystem_NULL::createMutex() {
 	return new NullMutexInternal();
 }
 
+#ifdef POSIX
+Common::JobSystem *OSystem_NULL::getJobSystem() {
+	// The workers are started by the first use of the job system, so that
+	// the tests which never use it do not start threads
+	if (!_jobSystem) {
+		// The defaults are not registered in the tests
+		const bool pinThreads = ConfMan.hasKey("job_pin_threads") && ConfMan.getBool("job_pin_threads");
+		_jobSystem = createPthreadJobSystem(ConfMan.getInt("job_threads"), pinThreads);
+	}
+	return _jobSystem;
+}
+#endif
+
 uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #ifdef POSIX
 	timeval curTime;
 
 	gettimeofday(&curTime, 0);
 
-	return (uint32)(((curTime.tv_sec - _startTime.tv_sec) * 1000) +
+	uint32 millis = (uint32)(((curTime.tv_sec - _startTime.tv_sec) * 1000) +
 			((curTime.tv_usec - _startTime.tv_usec) / 1000));
 #elif defined(WIN32)
-	return GetTickCount() - _startTime;
+	uint32 millis = GetTickCount() - _startTime;
 #else
-	return 0;
+	uint32 millis = 0;
 #endif
+
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	g_eventRec.processMillis(millis, skipRecord);
+#endif
+
+	return millis;
 }
 
 void OSystem_NULL::delayMillis(uint msecs) {
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	if (g_eventRec.processDelayMillis())
+		return;
+#endif
+
 #ifdef POSIX
 	usleep(msecs * 1000);
 #elif defined(WIN32)
@@ -223,10 +321,50 @@ void OSystem_NULL::getTimeAndDate(TimeDate &td, bool skipRecord) const {
 	td.tm_mon = t.tm_mon;
 	td.tm_year = t.tm_year;
 	td.tm_wday = t.tm_wday;
+
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+	g_eventRec.processTimeAndDate(td, skipRecord);
+#endif
 }
 
+#if defined(ENABLE_EVENTRECORDER) && !defined(NULL_DRIVER_USE_FOR_TEST)
+MixerManager *OSystem_NULL::getMixerManager() {
+	assert(_mixerManager);
+	return g_eventRec.getMixerManager();
+}
+
+Common::TimerManager *OSystem_NULL::getTimerManager() {
+	return g_eventRec.getTimerManager();
+}
+
+Common::SaveFileManager *OSystem_NULL::getSavefileManager() {
+	return g_eventRec.getSaveManager(_savefileManager);
+}
+
+void OSystem_NULL::writeBenchmarkReport() {
+	if (!_benchmark)
+		return;
+
+	if (_benchmark->writeReport(_benchmarkFile))
+		logMessage(LogMessageType::kInfo, Common::String::format("Benchmark report written to %s\n", _benchmarkFile.toString(Common::Path::kNativeSeparator).c_str()).c_str());
+	else
+		logMessage(LogMessageType::kError, Common::String::format("Could not write the benchmark report to %s\n", _benchmarkFile.toString(Common::Path::kNativeSeparator).c_str()).c_str());
+
+#ifdef POSIX
+	// The factory is only installed for benchmarks
+	((BenchmarkFilesystemFactory *)_fsFactory)->setBenchmark(nullptr);
+#endif
+	delete _benchmark;
+	_benchmark = nullptr;
+}
+#endif
+
 #ifndef NULL_DRIVER_USE_FOR_TEST
 void OSystem_NULL::quit() {
+#ifdef ENABLE_EVENTRECORDER
+	// The event recorder quits at the end of the recording
+	writeBenchmarkReport();
+#endif
 	exit(0);
 }
 #endif
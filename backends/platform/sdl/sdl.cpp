@@ -45,6 +45,9 @@
 #include "backends/events/default/default-events.h"
 #include "backends/keymapper/hardware-input.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
+#ifdef POSIX
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #ifdef USE_OPENGL
@@ -800,6 +803,15 @@ Common::TimerManager *OSystem_SDL::getTimerManager() {
 #endif
 }
 
+#ifdef POSIX
+Common::JobSystem *OSystem_SDL::getJobSystem() {
+	// The workers are started by the first use of the job system
+	if (!_jobSystem)
+		_jobSystem = createPthreadJobSystem(ConfMan.getInt("job_threads"), ConfMan.getBool("job_pin_threads"));
+	return _jobSystem;
+}
+#endif
+
 AudioCDManager *OSystem_SDL::createAudioCDManager() {
 	// Audio CD support was removed with SDL 2.0
 #if SDL_VERSION_ATLEAST(2, 0, 0)
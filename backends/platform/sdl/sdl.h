@@ -94,6 +94,9 @@ public:
 	void getTimeAndDate(TimeDate &td, bool skipRecord = false) const override;
 	MixerManager *getMixerManager() override;
 	Common::TimerManager *getTimerManager() override;
+#ifdef POSIX
+	Common::JobSystem *getJobSystem() override;
+#endif
 	Common::SaveFileManager *getSavefileManager() override;
 	uint32 getDoubleClickTime() const override;
 
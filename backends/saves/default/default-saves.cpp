@@ -19,6 +19,10 @@
  *
  */
 
+// Re-enable some forbidden symbols to avoid clashes with stat.h.
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h	//On IRIX, sys/stat.h includes sys/time.h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+
 #include "common/scummsys.h"
 
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
@@ -37,13 +41,23 @@
 #include "common/archive.h"
 #include "common/config-manager.h"
 #include "common/compression/deflate.h"
+#include "common/ptr.h"
 
 #include <errno.h>	// for removeSavefile()
+#ifdef POSIX
+#include <sys/stat.h>	// for getFileSignature()
+#endif
 
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
 const char *const DefaultSaveFileManager::TIMESTAMPS_FILENAME = "timestamps";
 #endif
 
+const char *const DefaultSaveFileManager::METAINDEX_DIRNAME = "metaindex";
+
+/** Tag and version of the header in front of every metadata index entry. */
+static const uint32 METAINDEX_TAG = MKTAG('S', 'M', 'I', 'X');
+static const byte METAINDEX_VERSION = 1;
+
 DefaultSaveFileManager::DefaultSaveFileManager() {
 }
 
@@ -170,6 +184,9 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 	// Add file to cache now that it exists.
 	_saveFileCache[filename] = Common::FSNode(fileNode.getPath());
 
+	// Any metadata gathered from the previous contents is stale now.
+	removeMetaInfoCache(filename);
+
 	return result;
 }
 
@@ -199,6 +216,8 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 		_saveFileCache.erase(file);
 		file = _saveFileCache.end();
 
+		removeMetaInfoCache(filename);
+
 		Common::ErrorCode result = removeFile(fileNode);
 		if (result == Common::kNoError)
 			return true;
@@ -219,6 +238,101 @@ Common::ErrorCode DefaultSaveFileManager::removeFile(const Common::FSNode &fileN
 	return Common::kUnknownError;
 }
 
+bool DefaultSaveFileManager::getFileSignature(const Common::FSNode &fileNode, uint32 &size, uint32 &mtime) {
+#ifdef POSIX
+	struct stat st;
+	if (stat(fileNode.getPath().toString(Common::Path::kNativeSeparator).c_str(), &st) != 0)
+		return false;
+
+	size = (uint32)st.st_size;
+	mtime = (uint32)st.st_mtime;
+	return true;
+#else
+	Common::ScopedPtr<Common::SeekableReadStream> stream(fileNode.createReadStream());
+	if (!stream)
+		return false;
+
+	size = (uint32)stream->size();
+	mtime = 0;
+	return true;
+#endif
+}
+
+Common::InSaveFile *DefaultSaveFileManager::openMetaInfoCache(const Common::String &filename) {
+	// Assure the savefile name cache is up-to-date.
+	const Common::Path savePathName = getSavePath();
+	assureCached(savePathName);
+	if (getError().getCode() != Common::kNoError)
+		return nullptr;
+
+	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
+	if (file == _saveFileCache.end())
+		return nullptr;
+
+	uint32 size, mtime;
+	if (!getFileSignature(file->_value, size, mtime))
+		return nullptr;
+
+	const Common::FSNode entryNode(savePathName.join(METAINDEX_DIRNAME).join(filename));
+	if (!entryNode.exists())
+		return nullptr;
+
+	Common::SeekableReadStream *entry = entryNode.createReadStream();
+	if (!entry)
+		return nullptr;
+
+	// Only hand out entries matching the current state of the save file.
+	if (entry->readUint32BE() != METAINDEX_TAG || entry->readByte() != METAINDEX_VERSION
+	        || entry->readUint32BE() != size || entry->readUint32BE() != mtime || entry->err() || entry->eos()) {
+		delete entry;
+		return nullptr;
+	}
+
+	return entry;
+}
+
+Common::OutSaveFile *DefaultSaveFileManager::openMetaInfoCacheForSaving(const Common::String &filename) {
+	// Assure the savefile name cache is up-to-date.
+	const Common::Path savePathName = getSavePath();
+	assureCached(savePathName);
+	if (getError().getCode() != Common::kNoError)
+		return nullptr;
+
+	for (Common::StringArray::const_iterator i = _lockedFiles.begin(), end = _lockedFiles.end(); i != end; ++i) {
+		if (filename == *i)
+			return nullptr; //file is locked, its contents are about to change
+	}
+
+	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
+	if (file == _saveFileCache.end())
+		return nullptr;
+
+	uint32 size, mtime;
+	if (!getFileSignature(file->_value, size, mtime))
+		return nullptr;
+
+	// The index lives in a subdirectory, which keeps it out of listSavefiles().
+	const Common::FSNode indexDir(savePathName.join(METAINDEX_DIRNAME));
+	if (!indexDir.exists() && !indexDir.createDirectory())
+		return nullptr;
+
+	Common::SeekableWriteStream *const entry = indexDir.getChild(filename).createWriteStream();
+	if (!entry)
+		return nullptr;
+
+	entry->writeUint32BE(METAINDEX_TAG);
+	entry->writeByte(METAINDEX_VERSION);
+	entry->writeUint32BE(size);
+	entry->writeUint32BE(mtime);
+	return new Common::OutSaveFile(entry);
+}
+
+void DefaultSaveFileManager::removeMetaInfoCache(const Common::String &filename) {
+	const Common::FSNode entryNode(getSavePath().join(METAINDEX_DIRNAME).join(filename));
+	if (entryNode.exists())
+		removeFile(entryNode);
+}
+
 bool DefaultSaveFileManager::exists(const Common::String &filename) {
 	// Assure the savefile name cache is up-to-date.
 	assureCached(getSavePath());
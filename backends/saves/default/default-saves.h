@@ -43,6 +43,8 @@ public:
 	Common::OutSaveFile *openForSaving(const Common::String &filename, bool compress = true) override;
 	bool removeSavefile(const Common::String &filename) override;
 	bool exists(const Common::String &filename) override;
+	Common::InSaveFile *openMetaInfoCache(const Common::String &filename) override;
+	Common::OutSaveFile *openMetaInfoCacheForSaving(const Common::String &filename) override;
 
 #ifdef USE_LIBCURL
 
@@ -55,6 +57,9 @@ public:
 
 	static Common::Path concatWithSavesPath(Common::String name);
 
+	/** Name of the save path subdirectory holding the metadata index. */
+	static const char *const METAINDEX_DIRNAME;
+
 protected:
 	/**
 	 * Get the path to the savegame directory.
@@ -75,6 +80,20 @@ protected:
 	 */
 	virtual Common::ErrorCode removeFile(const Common::FSNode &fileNode);
 
+	/**
+	 * Obtain a cheap signature of the given file, used to detect whether
+	 * a save file changed since its metadata index entry was written.
+	 * The default implementation uses stat() where available and falls
+	 * back to the file size alone otherwise.
+	 */
+	virtual bool getFileSignature(const Common::FSNode &fileNode, uint32 &size, uint32 &mtime);
+
+	/**
+	 * Drop the metadata index entry of the given save file, if any.
+	 * This is called whenever a save file is written or removed.
+	 */
+	void removeMetaInfoCache(const Common::String &filename);
+
 	/**
 	 * Assure that the given save path is cached.
 	 *
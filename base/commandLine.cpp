@@ -194,8 +194,10 @@ static const char HELP_STRING4[] =
 	"                           atari, macintosh, macintoshbw, vgaGray)\n"
 #ifdef ENABLE_EVENTRECORDER
 	"  --record-mode=MODE       Specify record mode for event recorder (record, playback,\n"
-	"                           info, update, passthrough [default])\n"
+	"                           info, update, benchmark, passthrough [default])\n"
 	"  --record-file-name=FILE  Specify record file name\n"
+	"  --benchmark-file=FILE    When benchmarking, write the statistics of each frame\n"
+	"                           to FILE as JSON (default: benchmark.json)\n"
 	"  --disable-display        Disable any gfx output. Used for headless events\n"
 	"                           playback by Event Recorder\n"
 	"  --screenshot-period=NUM  When recording, trigger a screenshot every NUM milliseconds\n"
@@ -373,9 +375,17 @@ void registerDefaults() {
 	ConfMan.registerDefault("disable_display", false);
 	ConfMan.registerDefault("record_mode", "none");
 	ConfMan.registerDefault("record_file_name", "record.bin");
+	ConfMan.registerDefault("benchmark_file", "benchmark.json");
+
+	ConfMan.registerDefault("fs_index", false);
+
+	ConfMan.registerDefault("job_threads", 0);
+	ConfMan.registerDefault("job_pin_threads", false);
 
 	ConfMan.registerDefault("gui_saveload_chooser", "grid");
 	ConfMan.registerDefault("gui_saveload_last_pos", "0");
+	ConfMan.registerDefault("gui_saveload_metaindex", true);
+	ConfMan.registerDefault("gui_theme_cache", false);
 
 	ConfMan.registerDefault("gui_browser_show_hidden", false);
 	ConfMan.registerDefault("gui_browser_native", true);
@@ -787,6 +797,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("record-file-name")
 			END_OPTION
 
+			DO_LONG_OPTION("benchmark-file")
+			END_OPTION
+
 			DO_LONG_COMMAND("list-records")
 			END_COMMAND
 
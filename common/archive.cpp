@@ -27,6 +27,7 @@
 #include "common/memstream.h"
 #include "common/punycode.h"
 #include "common/debug.h"
+#include "common/trace.h"
 
 namespace Common {
 
@@ -122,6 +123,10 @@ SeekableReadStream *Archive::createReadStreamForMemberAltStream(const Path &path
 	return nullptr;
 }
 
+SeekableReadStream *Archive::createReadStreamForMemberMapped(const Path &path) const {
+	return createReadStreamForMember(path);
+}
+
 Common::Error Archive::dumpArchive(const Path &destPath) {
 	Common::ArchiveMemberList files;
 
@@ -510,6 +515,7 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const Path &path) const
 	if (path.empty())
 		return nullptr;
 
+	TRACE_ZONE("SearchSet::createReadStreamForMember");
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(path);
@@ -534,6 +540,20 @@ SeekableReadStream *SearchSet::createReadStreamForMemberAltStream(const Path &pa
 	return nullptr;
 }
 
+SeekableReadStream *SearchSet::createReadStreamForMemberMapped(const Path &path) const {
+	if (path.empty())
+		return nullptr;
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it) {
+		SeekableReadStream *stream = it->_arc->createReadStreamForMemberMapped(path);
+		if (stream)
+			return stream;
+	}
+
+	return nullptr;
+}
+
 SeekableReadStream *SearchSet::createReadStreamForMemberNext(const Path &path, const Archive *starting) const {
 	if (path.empty())
 		return nullptr;
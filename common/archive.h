@@ -194,6 +194,17 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, AltStreamType altStreamType) const;
 
+	/**
+	 * Create a stream bound to a member with the specified name in the
+	 * archive, which maps the member in memory when the archive and the
+	 * platform support it, so that SeekableReadStream::getPointer() gives
+	 * access to its data. Otherwise, this is the same as
+	 * createReadStreamForMember().
+	 *
+	 * @return The newly created input stream.
+	 */
+	virtual SeekableReadStream *createReadStreamForMemberMapped(const Path &path) const;
+
 	/**
 	 * For most archives: same as previous. For SearchSet see SearchSet
 	 * documentation.
@@ -445,6 +456,12 @@ public:
 	 */
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, AltStreamType altStreamType) const override;
 
+	/**
+	 * Implement createReadStreamForMemberMapped from the Archive base class. The current policy is
+	 * opening the first file encountered that matches the name.
+	 */
+	SeekableReadStream *createReadStreamForMemberMapped(const Path &path) const override;
+
 	/**
 	 * Similar to above but exclude matches from archives before starting and starting itself.
 	 */
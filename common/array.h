@@ -47,9 +47,11 @@ namespace Common {
  *
  * The container class closest to this in the C++ standard library is
  * std::vector. However, there are some differences.
+ *
+ * The storage is obtained from @p Alloc, see Common::Allocator.
  */
-template<class T>
-class Array {
+template<class T, class Alloc = Allocator<T> >
+class Array : private Alloc {
 public:
 	typedef T *iterator; /*!< Array iterator. */
 	typedef const T *const_iterator; /*!< Const-qualified array iterator. */
@@ -58,6 +60,8 @@ public:
 
 	typedef uint size_type; /*!< Size type of the array. */
 
+	typedef Alloc allocator_type; /*!< Allocator of the array storage. */
+
 protected:
 	size_type _capacity; /*!< Maximum number of elements the array can hold. */
 	size_type _size; /*!< How many elements the array holds. */
@@ -66,6 +70,11 @@ protected:
 public:
 	constexpr Array() : _capacity(0), _size(0), _storage(nullptr) {}
 
+	/**
+	 * Construct an empty array whose storage is obtained from @p allocator.
+	 */
+	explicit Array(const Alloc &allocator) : Alloc(allocator), _capacity(0), _size(0), _storage(nullptr) {}
+
 	/**
 	 * Construct an array with @p count default-inserted instances of @p T. No
 	 * copies are made.
@@ -90,7 +99,7 @@ public:
 	/**
 	 * Construct an array as a copy of the given @p array.
 	 */
-	Array(const Array<T> &array) : _capacity(array._size), _size(array._size), _storage(nullptr) {
+	Array(const Array &array) : Alloc(array.get_allocator()), _capacity(array._size), _size(array._size), _storage(nullptr) {
 		if (array._storage) {
 			allocCapacity(_size);
 			uninitialized_copy(array._storage, array._storage + _size, _storage);
@@ -100,7 +109,7 @@ public:
 	/**
 	 * Construct an array as a copy of the given array using the C++11 move semantic.
 	 */
-	Array(Array<T> &&old) : _capacity(old._capacity), _size(old._size), _storage(old._storage) {
+	Array(Array &&old) : Alloc(old.get_allocator()), _capacity(old._capacity), _size(old._size), _storage(old._storage) {
 		old._storage = nullptr;
 		old._capacity = 0;
 		old._size = 0;
@@ -133,7 +142,7 @@ public:
 	}
 
 	~Array() {
-		freeStorage(_storage, _size);
+		freeStorage(_storage, _size, _capacity);
 		_storage = nullptr;
 		_capacity = _size = 0;
 	}
@@ -153,6 +162,7 @@ public:
 			// In the added-in-the-middle case, the copy is required because the parameters
 			// may contain a const ref to the original storage.
 			T *oldStorage = _storage;
+			const size_type oldCapacity = _capacity;
 
 			allocCapacity(roundUpCapacity(_size + 1));
 
@@ -164,7 +174,7 @@ public:
 			uninitialized_move(oldStorage, oldStorage + index, _storage);
 			uninitialized_move(oldStorage + index, oldStorage + _size, _storage + index + 1);
 
-			freeStorage(oldStorage, _size);
+			freeStorage(oldStorage, _size, oldCapacity);
 		}
 
 		_size++;
@@ -187,7 +197,7 @@ public:
 	}
 
 	/** Append an element to the end of the array. */
-	void push_back(const Array<T> &array) {
+	void push_back(const Array &array) {
 		if (_size + array.size() <= _capacity) {
 			uninitialized_copy(array.begin(), array.end(), end());
 			_size += array.size();
@@ -244,7 +254,7 @@ public:
 	}
 
 	/** Insert copies of all the elements from the given array into this array at the given position. */
-	void insert_at(size_type idx, const Array<T> &array) {
+	void insert_at(size_type idx, const Array &array) {
 		assert(idx <= _size);
 		insert_aux(_storage + idx, array.begin(), array.end());
 	}
@@ -282,11 +292,11 @@ public:
 	}
 
 	/** Assign the given @p array to this array. */
-	Array<T> &operator=(const Array<T> &array) {
+	Array &operator=(const Array &array) {
 		if (this == &array)
 			return *this;
 
-		freeStorage(_storage, _size);
+		freeStorage(_storage, _size, _capacity);
 		_size = array._size;
 		allocCapacity(_size);
 		uninitialized_copy(array._storage, array._storage + _size, _storage);
@@ -295,11 +305,21 @@ public:
 	}
 
 	/** Assign the given array to this array using the C++11 move semantic. */
-	Array &operator=(Array<T> &&old) {
+	Array &operator=(Array &&old) {
 		if (this == &old)
 			return *this;
 
-		freeStorage(_storage, _size);
+		if (get_allocator() != old.get_allocator()) {
+			// The storage of the other array cannot be freed by this allocator
+			freeStorage(_storage, _size, _capacity);
+			_size = old._size;
+			allocCapacity(_size);
+			uninitialized_move(old._storage, old._storage + _size, _storage);
+			old.clear();
+			return *this;
+		}
+
+		freeStorage(_storage, _size, _capacity);
 		_capacity = old._capacity;
 		_size = old._size;
 		_storage = old._storage;
@@ -318,7 +338,7 @@ public:
 
 	/** Clear the array of all its elements. */
 	void clear() {
-		freeStorage(_storage, _size);
+		freeStorage(_storage, _size, _capacity);
 		_storage = nullptr;
 		_size = 0;
 		_capacity = 0;
@@ -353,7 +373,7 @@ public:
 	}
 
 	/** Check whether two arrays are identical. */
-	bool operator==(const Array<T> &other) const {
+	bool operator==(const Array &other) const {
 		if (this == &other)
 			return true;
 		if (_size != other._size)
@@ -366,7 +386,7 @@ public:
 	}
 
 	/** Check if two arrays are different. */
-	bool operator!=(const Array<T> &other) const {
+	bool operator!=(const Array &other) const {
 		return !(*this == other);
 	}
 
@@ -398,12 +418,13 @@ public:
 			return;
 
 		T *oldStorage = _storage;
+		const size_type oldCapacity = _capacity;
 		allocCapacity(newCapacity);
 
 		if (oldStorage) {
 			// Move old data
 			uninitialized_move(oldStorage, oldStorage + _size, _storage);
-			freeStorage(oldStorage, _size);
+			freeStorage(oldStorage, _size, oldCapacity);
 		}
 	}
 
@@ -446,7 +467,13 @@ public:
 			*dst++ = *first++;
 	}
 
+	/** Return a copy of the allocator of the array storage. */
+	Alloc get_allocator() const {
+		return *this;
+	}
+
 	void swap(Array &arr) {
+		SWAP(static_cast<Alloc &>(*this), static_cast<Alloc &>(arr));
 		SWAP(this->_capacity, arr._capacity);
 		SWAP(this->_size, arr._size);
 		SWAP(this->_storage, arr._storage);
@@ -467,7 +494,7 @@ protected:
 	void allocCapacity(size_type capacity) {
 		_capacity = capacity;
 		if (capacity) {
-			_storage = (T *)malloc(sizeof(T) * capacity);
+			_storage = Alloc::allocate(capacity);
 			if (!_storage)
 				::error("Common::Array: failure to allocate %u bytes", capacity * (size_type)sizeof(T));
 		} else {
@@ -476,10 +503,11 @@ protected:
 	}
 
 	/** Free the storage used by the array. */
-	void freeStorage(T *storage, const size_type elements) {
+	void freeStorage(T *storage, const size_type elements, const size_type capacity) {
 		for (size_type i = 0; i < elements; ++i)
 			storage[i].~T();
-		free(storage);
+		if (storage)
+			Alloc::deallocate(storage, capacity);
 	}
 
 	/**
@@ -503,6 +531,7 @@ protected:
 			const size_type idx = pos - _storage;
 			if (_size + n > _capacity || (_storage <= first && first <= _storage + _size)) {
 				T *const oldStorage = _storage;
+				const size_type oldCapacity = _capacity;
 
 				// If there is not enough space, allocate more.
 				// Likewise, if this is a self-insert, we allocate new
@@ -518,7 +547,7 @@ protected:
 				// insert.
 				uninitialized_move(oldStorage + idx, oldStorage + _size, _storage + idx + n);
 
-				freeStorage(oldStorage, _size);
+				freeStorage(oldStorage, _size, oldCapacity);
 			} else if (idx + n <= _size) {
 				// Make room for the new elements by shifting back
 				// existing ones.
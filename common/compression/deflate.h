@@ -151,6 +151,20 @@ SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped,
 		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES, uint64 knownSize = 0,
 		const byte *dict = nullptr, uint dictLen = 0);
 
+/**
+ * Like wrapDeflateReadStream(), but the returned stream records a restart
+ * point every checkpointInterval bytes of uncompressed data, at the cost of
+ * 32 KB of memory each. Seeking backwards then resumes the decompression
+ * from the closest restart point instead of the start of the data.
+ * Without ZLIB support, this is the same as wrapDeflateReadStream().
+ *
+ * @param toBeWrapped	the stream to be wrapped
+ * @param knownSize	a supplied length of the uncompressed data
+ * @param checkpointInterval	the uncompressed bytes between restart points
+ */
+SeekableReadStream *wrapCheckpointedDeflateReadStream(SeekableReadStream *toBeWrapped,
+		DisposeAfterUse::Flag disposeParent, uint64 knownSize, uint32 checkpointInterval);
+
 /**
  * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
  * provides transparent on-the-fly decompression. Assumes the data it
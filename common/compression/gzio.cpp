@@ -1383,6 +1383,11 @@ SeekableReadStream* wrapDeflateReadStream(Common::SeekableReadStream *parent, Di
 	return gzio;
 }
 
+SeekableReadStream *wrapCheckpointedDeflateReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize, uint32 checkpointInterval) {
+	// Restart points need inflatePrime() from zlib
+	return wrapDeflateReadStream(parent, disposeParent, knownSize);
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 	// Not supported, return stream itself to write uncompressed data
 	return toBeWrapped;
@@ -95,8 +95,10 @@ typedef Byte Bytef;
 #include "common/compression/deflate.h"
 #include "common/compression/unzip.h"
 #include "common/memstream.h"
+#include "common/substream.h"
+#include "common/trace.h"
 
-#include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "common/hash-str.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
@@ -237,6 +239,13 @@ Common::SharedArchiveContents unzOpenCurrentFile(unzFile file
   If there is no error, the return value is UNZ_OK.
 */
 
+Common::SeekableReadStream *unzOpenCurrentFileStream(unzFile file);
+/*
+  Open the current file in the zipfile as a stream reading it from the
+  zipfile as needed, instead of reading all of it into memory.
+  Returns nullptr if there is an error.
+*/
+
 int unzCloseCurrentFile(unzFile file);
 /*
   Close the file in zip opened with unzOpenCurrentFile
@@ -318,13 +327,14 @@ typedef struct {
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
 } cached_file_in_zip;
 
-typedef Common::HashMap<Common::Path, cached_file_in_zip, Common::Path::IgnoreCase_Hash,
+typedef Common::FlatHashMap<Common::Path, cached_file_in_zip, Common::Path::IgnoreCase_Hash,
 	Common::Path::IgnoreCase_EqualTo> ZipHash;
 
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _sharedStream;	/* owner of _stream, shared with the streamed members */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -459,6 +469,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 	int err = UNZ_OK;
 
 	us->_stream = stream;
+	us->_sharedStream.reset(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos == 0)
@@ -510,7 +521,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 		err = UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -600,7 +610,7 @@ int unzClose(unzFile file) {
 		return UNZ_PARAMERROR;
 	s = (unz_s *)file;
 
-	delete s->_stream;
+	// Streamed members keep the stream of the archive alive
 	delete s;
 	return UNZ_OK;
 }
@@ -1018,11 +1028,59 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	return Common::SharedArchiveContents(uncompressedBuffer, s->cur_file_info.uncompressed_size);
 }
 
+/* Uncompressed bytes between the restart points of streamed deflated files */
+#define UNZ_INFLATE_CHECKPOINT_INTERVAL (512 * 1024)
+
+/*
+  Open the current file in the zipfile as a stream.
+  Stored files are read straight from the zipfile, deflated files are
+  inflated while reading. Neither is checked against its CRC32. The streams
+  share the ownership of the zipfile stream, so they can outlive the zipfile.
+*/
+Common::SeekableReadStream *unzOpenCurrentFileStream(unzFile file) {
+	uInt iSizeVar;
+	unz_s *s;
+	uLong offset_local_extrafield;  /* offset of the local extra field */
+	uInt  size_local_extrafield;    /* size of the local extra field */
+
+	if (file == nullptr)
+		return nullptr;
+	s = (unz_s *)file;
+	if (!s->current_file_ok)
+		return nullptr;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
+				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+		return nullptr;
+
+	const uint32 start = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+	Common::SeekableReadStream *member = new Common::SafeSeekableSubReadStream(s->_sharedStream,
+			start, start + s->cur_file_info.compressed_size);
+
+	switch (s->cur_file_info.compression_method) {
+	case 0: // Store
+		return member;
+	case Z_DEFLATED:
+		return Common::wrapCheckpointedDeflateReadStream(member, DisposeAfterUse::YES,
+				s->cur_file_info.uncompressed_size, UNZ_INFLATE_CHECKPOINT_INTERVAL);
+	default:
+		warning("Unknown compression algoritthm %d", (int)s->cur_file_info.compression_method);
+		delete member;
+		return nullptr;
+	}
+}
+
 
 namespace Common {
 
 
 class ZipArchive : public MemcachingCaseInsensitiveArchive {
+	/**
+	 * Larger files are streamed from the archive instead of being read into
+	 * memory and cached.
+	 */
+	static const uint32 kMaxMemcachedSize = 64 * 1024;
+
 	unzFile _zipFile;
 #ifndef USE_ZLIB
 	Common::CRC32 _crc;
@@ -1107,8 +1165,18 @@ const ArchiveMemberPtr ZipArchive::getMember(const Path &path) const {
 }
 
 Common::SharedArchiveContents ZipArchive::readContentsForPath(const Common::Path &path) const {
+	TRACE_ZONE("ZipArchive::readContentsForPath");
 	if (unzLocateFile(_zipFile, path, 2) != UNZ_OK)
 		return Common::SharedArchiveContents();
+
+	unz_file_info fi;
+	if (unzGetCurrentFileInfo(_zipFile, &fi, nullptr, 0, nullptr, 0, nullptr, 0) == UNZ_OK && fi.uncompressed_size > kMaxMemcachedSize) {
+		SeekableReadStream *stream = unzOpenCurrentFileStream(_zipFile);
+		if (!stream)
+			return Common::SharedArchiveContents();
+		return Common::SharedArchiveContents::bypass(stream);
+	}
+
 #ifndef USE_ZLIB
 	return unzOpenCurrentFile(_zipFile, _crc);
 #else
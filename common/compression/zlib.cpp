@@ -33,6 +33,7 @@
 
 #include "common/compression/deflate.h"
 
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -273,6 +274,236 @@ public:
 	}
 };
 
+/**
+ * A wrapper class which provides on-the-fly decompression of headerless
+ * deflate data, like GZipReadStream, and records restart points while
+ * decompressing, so that seeking backwards does not have to restart the
+ * decompression from the start of the data.
+ *
+ * A restart point is recorded at the first block boundary after every
+ * checkpoint interval of output. It holds the position of that boundary in
+ * the compressed data and a copy of the last 32 KB of output, which is the
+ * dictionary later blocks can refer to. The output goes through a window of
+ * the same size, so short seeks backwards need no restart at all.
+ */
+class CheckpointedInflateReadStream : public SeekableReadStream {
+protected:
+	enum {
+		BUFSIZE = 16384,
+		WINSIZE = 32768		// 1 << MAX_WBITS
+	};
+
+	struct Checkpoint {
+		uint32 outPos;		///< Position in the output
+		uint32 inPos;		///< Position of the first full byte in the compressed data
+		int bits;			///< Bits of the byte before inPos which are part of the next block
+		byte *window;		///< The WINSIZE bytes of output before outPos
+	};
+
+	byte _buf[BUFSIZE];
+	byte _window[WINSIZE];
+
+	DisposablePtr<SeekableReadStream> _wrapped;
+	z_stream _stream;
+	int _zlibErr;
+	uint64 _parentPos;
+	uint32 _inPos;		///< Compressed bytes read from the wrapped stream
+	uint32 _outPos;		///< Bytes decompressed so far
+	uint32 _validPos;	///< First position still held by the window
+	uint32 _pos;
+	uint32 _origSize;
+	uint32 _interval;
+	bool _eos;
+
+	Array<Checkpoint> _checkpoints;
+
+	bool inflateMore() {
+		if (_zlibErr != Z_OK)
+			return false;
+
+		if (_stream.avail_in == 0 && !_wrapped->eos()) {
+			_stream.next_in = _buf;
+			_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
+			_inPos += _stream.avail_in;
+		}
+
+		const uint32 offset = _outPos % WINSIZE;
+		_stream.next_out = _window + offset;
+		_stream.avail_out = WINSIZE - offset;
+		// Z_BLOCK stops at the end of every block, where restart points
+		// can be recorded
+		_zlibErr = inflate(&_stream, Z_BLOCK);
+		_outPos += WINSIZE - offset - _stream.avail_out;
+		if (_outPos - _validPos > WINSIZE)
+			_validPos = _outPos - WINSIZE;
+
+		if (_zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64))
+			addCheckpoint();
+
+		return _zlibErr == Z_OK || _zlibErr == Z_STREAM_END;
+	}
+
+	void addCheckpoint() {
+		const uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back().outPos;
+		if (_outPos < last + _interval)
+			return;
+
+		Checkpoint checkpoint;
+		checkpoint.outPos = _outPos;
+		checkpoint.inPos = _inPos - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.window = new byte[WINSIZE];
+		// The interval is at least WINSIZE, so the whole window is valid
+		const uint32 offset = _outPos % WINSIZE;
+		memcpy(checkpoint.window, _window + offset, WINSIZE - offset);
+		memcpy(checkpoint.window + WINSIZE - offset, _window, offset);
+		_checkpoints.push_back(checkpoint);
+	}
+
+	/** Restarts the decompression from the given restart point, or from the start. */
+	bool restart(const Checkpoint *checkpoint) {
+		_zlibErr = inflateReset(&_stream);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+
+		if (!checkpoint) {
+			_wrapped->seek(_parentPos, SEEK_SET);
+			_inPos = _outPos = _validPos = _pos = 0;
+			return true;
+		}
+
+		_wrapped->seek(_parentPos + checkpoint->inPos - (checkpoint->bits ? 1 : 0), SEEK_SET);
+		if (checkpoint->bits) {
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint->bits, partial >> (8 - checkpoint->bits));
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint->window, WINSIZE);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		const uint32 offset = checkpoint->outPos % WINSIZE;
+		memcpy(_window + offset, checkpoint->window, WINSIZE - offset);
+		memcpy(_window, checkpoint->window + WINSIZE - offset, offset);
+
+		_inPos = checkpoint->inPos;
+		_outPos = _pos = checkpoint->outPos;
+		_validPos = _outPos - WINSIZE;
+		return true;
+	}
+
+public:
+	CheckpointedInflateReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize, uint32 interval) :
+			_wrapped(w, disposeParent), _stream(), _origSize(knownSize), _interval(MAX<uint32>(interval, WINSIZE)) {
+		assert(w != nullptr);
+
+		_parentPos = w->pos();
+		_inPos = _outPos = _validPos = _pos = 0;
+		_eos = false;
+
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+	}
+
+	~CheckpointedInflateReadStream() {
+		inflateEnd(&_stream);
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			delete[] _checkpoints[i].window;
+	}
+
+	bool err() const override { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
+	void clearErr() override {
+		// only reset _eos; I/O errors are not recoverable
+		_eos = false;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		byte *out = (byte *)dataPtr;
+		uint32 left = dataSize;
+
+		while (left > 0) {
+			if (_pos < _outPos) {
+				const uint32 offset = _pos % WINSIZE;
+				const uint32 count = MIN<uint32>(MIN<uint32>(left, _outPos - _pos), WINSIZE - offset);
+				memcpy(out, _window + offset, count);
+				out += count;
+				left -= count;
+				_pos += count;
+			} else if (!inflateMore() || (_zlibErr == Z_STREAM_END && _pos == _outPos)) {
+				break;
+			}
+		}
+
+		if (left > 0 && _zlibErr == Z_STREAM_END)
+			_eos = true;
+
+		return dataSize - left;
+	}
+
+	bool eos() const override {
+		return _eos;
+	}
+	int64 pos() const override {
+		return _pos;
+	}
+	int64 size() const override {
+		return _origSize;
+	}
+	bool seek(int64 offset, int whence = SEEK_SET) override {
+		int64 newPos = 0;
+		switch (whence) {
+		default:
+			// fallthrough intended
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+			break;
+		case SEEK_END:
+			newPos = size() + offset;
+			break;
+		}
+
+		if (newPos < 0)
+			return false;
+
+		_eos = false;
+
+		// Still in the window
+		if (newPos >= _validPos && newPos <= _outPos) {
+			_pos = newPos;
+			return true;
+		}
+
+		// Restart from the closest restart point before the new position,
+		// unless decompressing from the current position gets there sooner
+		const Checkpoint *checkpoint = nullptr;
+		for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].outPos <= newPos; ++i)
+			checkpoint = &_checkpoints[i];
+
+		if (newPos < _validPos || (checkpoint && checkpoint->outPos > _outPos)) {
+			if (!restart(checkpoint))
+				return false;
+		}
+
+		while (_outPos < newPos && inflateMore() && _zlibErr != Z_STREAM_END)
+			;
+
+		_pos = MIN<int64>(newPos, _outPos);
+		return !err();
+	}
+};
+
 /**
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other WriteStream and will then provide on-the-fly compression support.
@@ -420,6 +651,20 @@ SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, Dispo
 	return new GZipReadStream(toBeWrapped, disposeParent, knownSize, dict, dictLen);
 }
 
+SeekableReadStream *wrapCheckpointedDeflateReadStream(SeekableReadStream *toBeWrapped, DisposeAfterUse::Flag disposeParent, uint64 knownSize, uint32 checkpointInterval) {
+	if (!toBeWrapped) {
+		return nullptr;
+	}
+
+	if (toBeWrapped->eos() || toBeWrapped->err()) {
+		if (disposeParent == DisposeAfterUse::YES) {
+			delete toBeWrapped;
+		}
+		return nullptr;
+	}
+	return new CheckpointedInflateReadStream(toBeWrapped, disposeParent, knownSize, checkpointInterval);
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 	if (!toBeWrapped)
 		return nullptr;
@@ -58,6 +58,22 @@ bool File::open(const Path &filename, Archive &archive) {
 	return open(stream, filename.toString());
 }
 
+bool File::openMapped(const Path &filename) {
+	assert(!filename.empty());
+	assert(!_handle);
+
+	SeekableReadStream *stream = nullptr;
+
+	if ((stream = SearchMan.createReadStreamForMemberMapped(filename))) {
+		debug(8, "Opening mapped: %s", filename.toString().c_str());
+	} else if ((stream = SearchMan.createReadStreamForMemberMapped(filename.append(".")))) {
+		// WORKAROUND: Bug #2548, see open()
+		debug(8, "Opening mapped: %s.", filename.toString().c_str());
+	}
+
+	return open(stream, filename.toString());
+}
+
 bool File::open(const FSNode &node) {
 	assert(!_handle);
 
@@ -142,6 +158,11 @@ uint32 File::read(void *ptr, uint32 len) {
 	return _handle->read(ptr, len);
 }
 
+const byte *File::getPointer(uint32 size) const {
+	assert(_handle);
+	return _handle->getPointer(size);
+}
+
 
 DumpFile::DumpFile() : _handle(nullptr) {
 }
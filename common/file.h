@@ -106,6 +106,18 @@ public:
 	 */
 	virtual bool open(SeekableReadStream *stream, const String &name);
 
+	/**
+	 * Try to open the file with the given file name, by searching SearchMan,
+	 * with the file mapped in memory where the platform supports it. The data
+	 * of a mapped file can then be used in place through getPointer(), and
+	 * reads are copies from memory. Otherwise, this is the same as open().
+	 * @note Must not be called if this file is already open (i.e. if isOpen returns true).
+	 *
+	 * @param	filename	Name of the file to open.
+	 * @return	True if the file was opened successfully, false otherwise.
+	 */
+	bool openMapped(const Path &filename);
+
 	/**
 	 * Close the file, if open.
 	 */
@@ -133,6 +145,7 @@ public:
 	int64 size() const override; /*!< Implement abstract SeekableReadStream method. */
 	bool seek(int64 offs, int whence = SEEK_SET) override;	/*!< Implement abstract SeekableReadStream method. */
 	uint32 read(void *dataPtr, uint32 dataSize) override;	/*!< Implement abstract SeekableReadStream method. */
+	const byte *getPointer(uint32 size) const override;	/*!< Override SeekableReadStream method. */
 };
 
 
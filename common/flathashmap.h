@@ -0,0 +1,598 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/hashmap.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_flathashmap Flat hash table (FlatHashMap)
+ * @ingroup common
+ *
+ * @brief Hash table storing its entries inline.
+ *
+ * @{
+ */
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val>, with
+ * the same hash and equality functors and the same interface for lookups,
+ * iteration and erasing.
+ *
+ * Instead of pointers to nodes allocated one by one, the table holds the
+ * entries themselves, next to an array with one metadata byte per entry.
+ * A metadata byte tells whether the entry is empty, erased, or in use, and
+ * then holds 7 bits of the hash of its key. Lookups probe the entries
+ * linearly, and only compare the keys of the entries whose hash bits
+ * match, so a lookup mostly touches the cache lines of the metadata and of
+ * the entry it finds.
+ *
+ * The entries move when the table grows, so pointers and references to them
+ * are invalidated by any insertion, as are iterators with HashMap. Erasing
+ * does not move the other entries.
+ *
+ * Prefer it for maps which are looked up often, and whose values are small
+ * or cheap to move.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		Val _value;
+		const Key _key;
+		explicit Node(const Key &key) : _value(), _key(key) {}
+		Node(const Key &key, Val &&value) : _value(Common::move(value)), _key(key) {}
+	};
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The table grows when the entries in use and the erased ones
+		// fill this part of it
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4,
+
+		// Metadata of the entries which are not in use. Those in use have
+		// their top bit cleared.
+		FLATHASHMAP_EMPTY = 0x80,
+		FLATHASHMAP_ERASED = 0xFE
+	};
+
+	static const size_type NOT_FOUND = (size_type)-1;
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	Node *_slots;          ///< Entries, of which those with metadata in use are constructed
+	byte *_metadata;       ///< One metadata byte per entry, after the entries in the same buffer
+	size_type _capacity;   ///< Number of entries, a power of two or zero before the first insertion
+	size_type _shift;      ///< Shift giving the home entry of a hash, from its top bits
+	size_type _size;
+	size_type _erased;     ///< Number of entries marked as erased
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	uint32 mixHash(const Key &key) const {
+		// Fibonacci hashing, so that both the top bits used for the home
+		// entry and the low bits kept in the metadata depend on all the bits
+		// of the hash
+		return (uint32)_hash(key) * 0x9E3779B1U;
+	}
+
+	size_type homeIndex(uint32 hash) const {
+		return hash >> _shift;
+	}
+
+	static byte metadataOf(uint32 hash) {
+		return hash & 0x7F;
+	}
+
+	static bool isInUse(byte metadata) {
+		return !(metadata & 0x80);
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	void rehash(size_type newCapacity);
+	size_type lookup(const Key &key) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void eraseAt(size_type idx);
+
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx < _hashmap->_capacity);
+			assert(isInUse(_hashmap->_metadata[_idx]));
+			return &_hashmap->_slots[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx < _hashmap->_capacity && !isInUse(_hashmap->_metadata[_idx]));
+			if (_idx >= _hashmap->_capacity)
+				_idx = NOT_FOUND;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	FlatHashMap(FHM_t &&map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		clear(true);
+		assign(map);
+		return *this;
+	}
+
+	FHM_t &operator=(FHM_t &&map);
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getOrCreateVal(const Key &key);
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getValOrDefault(const Key &key) const;
+	const Val &getValOrDefault(const Key &key, const Val &defaultVal) const;
+	bool tryGetVal(const Key &key, Val &out) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	/** Make room for @p count entries without growing the table again. */
+	void reserve(size_type count);
+
+	size_type size() const { return _size; }
+
+	iterator begin() {
+		for (size_type ctr = 0; ctr < _capacity; ++ctr) {
+			if (isInUse(_metadata[ctr]))
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator end() {
+		return iterator(NOT_FOUND, this);
+	}
+
+	const_iterator begin() const {
+		for (size_type ctr = 0; ctr < _capacity; ++ctr) {
+			if (isInUse(_metadata[ctr]))
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator end() const {
+		return const_iterator(NOT_FOUND, this);
+	}
+
+	iterator find(const Key &key) {
+		return iterator(lookup(key), this);
+	}
+
+	const_iterator find(const Key &key) const {
+		return const_iterator(lookup(key), this);
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap. The table is allocated by the
+ * first insertion.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() :
+	_defaultVal(), _slots(nullptr), _metadata(nullptr), _capacity(0), _shift(0), _size(0), _erased(0) {
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) :
+	_defaultVal(), _slots(nullptr), _metadata(nullptr), _capacity(0), _shift(0), _size(0), _erased(0) {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(FHM_t &&map) :
+	_defaultVal(), _slots(map._slots), _metadata(map._metadata), _capacity(map._capacity), _shift(map._shift),
+	_size(map._size), _erased(map._erased) {
+	map._slots = nullptr;
+	map._metadata = nullptr;
+	map._capacity = 0;
+	map._size = 0;
+	map._erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	clear(true);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc> &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator=(FHM_t &&map) {
+	if (this == &map)
+		return *this;
+
+	clear(true);
+	_slots = map._slots;
+	_metadata = map._metadata;
+	_capacity = map._capacity;
+	_shift = map._shift;
+	_size = map._size;
+	_erased = map._erased;
+
+	map._slots = nullptr;
+	map._metadata = nullptr;
+	map._capacity = 0;
+	map._size = 0;
+	map._erased = 0;
+	return *this;
+}
+
+/**
+ * Internal method allocating an empty table. The previous one must have been
+ * freed or moved away.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && !(capacity & (capacity - 1)));
+
+	const size_t bytes = capacity * (sizeof(Node) + 1);
+	byte *storage = (byte *)malloc(bytes);
+	if (!storage)
+		::error("Common::FlatHashMap: failure to allocate %u bytes", (uint)bytes);
+
+	_slots = (Node *)storage;
+	_metadata = storage + capacity * sizeof(Node);
+	memset(_metadata, FLATHASHMAP_EMPTY, capacity);
+
+	_capacity = capacity;
+	_shift = 32;
+	while (capacity > 1) {
+		capacity >>= 1;
+		_shift--;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	free(_slots);
+	_slots = nullptr;
+	_metadata = nullptr;
+	_capacity = 0;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap to this
+ * empty one.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	assert(!_capacity);
+	if (!map._capacity)
+		return;
+
+	// The entries keep their place, along with the erased markers
+	allocStorage(map._capacity);
+	memcpy(_metadata, map._metadata, _capacity);
+	for (size_type ctr = 0; ctr < _capacity; ++ctr) {
+		if (isInUse(_metadata[ctr]))
+			new ((void *)&_slots[ctr]) Node(map._slots[ctr]);
+	}
+	_size = map._size;
+	_erased = map._erased;
+}
+
+/**
+ * Clear all values in the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	for (size_type ctr = 0; ctr < _capacity; ++ctr) {
+		if (isInUse(_metadata[ctr]))
+			_slots[ctr].~Node();
+	}
+
+	if (shrinkArray)
+		freeStorage();
+	else if (_capacity)
+		memset(_metadata, FLATHASHMAP_EMPTY, _capacity);
+
+	_size = 0;
+	_erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(size_type newCapacity) {
+	Node *oldSlots = _slots;
+	byte *oldMetadata = _metadata;
+	const size_type oldCapacity = _capacity;
+
+	allocStorage(newCapacity);
+	for (size_type ctr = 0; ctr < oldCapacity; ++ctr) {
+		if (!isInUse(oldMetadata[ctr]))
+			continue;
+
+		// No key exists twice in the old table, so the entry goes to the
+		// first free one without comparing keys
+		Node &node = oldSlots[ctr];
+		const uint32 hash = mixHash(node._key);
+		size_type idx = homeIndex(hash);
+		while (_metadata[idx] != FLATHASHMAP_EMPTY)
+			idx = (idx + 1) & (_capacity - 1);
+
+		new ((void *)&_slots[idx]) Node(node._key, Common::move(node._value));
+		_metadata[idx] = metadataOf(hash);
+		node.~Node();
+	}
+	_erased = 0;
+
+	free(oldSlots);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = MAX<size_type>(_capacity, FLATHASHMAP_MIN_CAPACITY);
+	while (count * FLATHASHMAP_LOADFACTOR_DENOMINATOR >= capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		capacity *= 2;
+	if (capacity != _capacity)
+		rehash(capacity);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	if (!_size)
+		return NOT_FOUND;
+
+	const uint32 hash = mixHash(key);
+	const byte metadata = metadataOf(hash);
+	for (size_type idx = homeIndex(hash); ; idx = (idx + 1) & (_capacity - 1)) {
+		if (_metadata[idx] == metadata && _equal(_slots[idx]._key, key))
+			return idx;
+		if (_metadata[idx] == FLATHASHMAP_EMPTY)
+			return NOT_FOUND;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	if (!_capacity)
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+
+	const uint32 hash = mixHash(key);
+	const byte metadata = metadataOf(hash);
+	size_type firstErased = NOT_FOUND;
+	size_type idx = homeIndex(hash);
+	for (; ; idx = (idx + 1) & (_capacity - 1)) {
+		if (_metadata[idx] == metadata && _equal(_slots[idx]._key, key))
+			return idx;
+		if (_metadata[idx] == FLATHASHMAP_EMPTY)
+			break;
+		if (_metadata[idx] == FLATHASHMAP_ERASED && firstErased == NOT_FOUND)
+			firstErased = idx;
+	}
+
+	if (firstErased != NOT_FOUND) {
+		idx = firstErased;
+		_erased--;
+	} else if ((_size + _erased + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > _capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		// Keep the load factor below a certain threshold. When the erased
+		// entries make up much of it, dropping them is enough.
+		if ((_size + 1) * 2 * FLATHASHMAP_LOADFACTOR_DENOMINATOR > _capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+			rehash(_capacity * 2);
+		else
+			rehash(_capacity);
+		return lookupAndCreateIfMissing(key);
+	}
+
+	new ((void *)&_slots[idx]) Node(key);
+	_metadata[idx] = metadata;
+	_size++;
+	return idx;
+}
+
+/**
+ * Check whether the hashmap contains the given key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key) != NOT_FOUND;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getOrCreateVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getOrCreateVal(const Key &key) {
+	// The lookup may move the entries, so it must come before reading _slots
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._value;
+}
+
+/**
+ * Get a value from the hashmap. A missing key is an error, except in release
+ * builds, see HashMap::getVal().
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	const size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		return _slots[ctr]._value;
+	else
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	const size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		return _slots[ctr]._value;
+	else
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key) const {
+	return getValOrDefault(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key, const Val &defaultVal) const {
+	const size_type ctr = lookup(key);
+	return ctr != NOT_FOUND ? _slots[ctr]._value : defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::tryGetVal(const Key &key, Val &out) const {
+	const size_type ctr = lookup(key);
+	if (ctr == NOT_FOUND)
+		return false;
+
+	out = _slots[ctr]._value;
+	return true;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseAt(size_type idx) {
+	_slots[idx].~Node();
+	_size--;
+
+	// Probing goes on past an entry in use or erased, but stops at an empty
+	// one. So when the next entry is empty, no lookup needs to go past this
+	// one either.
+	if (_metadata[(idx + 1) & (_capacity - 1)] == FLATHASHMAP_EMPTY) {
+		_metadata[idx] = FLATHASHMAP_EMPTY;
+	} else {
+		_metadata[idx] = FLATHASHMAP_ERASED;
+		_erased++;
+	}
+}
+
+/**
+ * Erase an element referred to by an iterator. The other iterators stay
+ * valid.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	assert(entry._hashmap == this);
+	assert(entry._idx < _capacity);
+	assert(isInUse(_metadata[entry._idx]));
+	eraseAt(entry._idx);
+}
+
+/**
+ * Erase an element specified by a key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	const size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		eraseAt(ctr);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/framearena.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+FrameArena::FrameArena(size_t chunkSize) : _chunkSize(chunkSize), _chunk(0), _offset(0), _previousBytes(0) {
+	_stats.allocations = 0;
+	_stats.heapAllocations = 0;
+	_stats.peakBytes = 0;
+}
+
+FrameArena::~FrameArena() {
+	for (uint i = 0; i < _chunks.size(); ++i)
+		free(_chunks[i].data);
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+	assert(alignment && !(alignment & (alignment - 1)));
+
+	size_t offset = 0;
+	if (_chunk < _chunks.size())
+		offset = (((size_t)_chunks[_chunk].data + _offset + alignment - 1) & ~(alignment - 1)) - (size_t)_chunks[_chunk].data;
+	if (_chunk >= _chunks.size() || offset + size > _chunks[_chunk].size) {
+		if (!nextChunk(size, alignment))
+			return nullptr;
+		offset = (((size_t)_chunks[_chunk].data + alignment - 1) & ~(alignment - 1)) - (size_t)_chunks[_chunk].data;
+	}
+
+	_offset = offset + size;
+	++_stats.allocations;
+	const size_t used = getUsedBytes();
+	if (used > _stats.peakBytes)
+		_stats.peakBytes = used;
+	return _chunks[_chunk].data + offset;
+}
+
+bool FrameArena::nextChunk(size_t size, size_t alignment) {
+	uint next = _chunks.empty() ? 0 : _chunk + 1;
+
+	// The memory of the following chunks is not in use, so one of them which
+	// is large enough can be used instead of a new one.
+	if (next < _chunks.size() && _chunks[next].size < size + alignment) {
+		for (uint i = next + 1; i < _chunks.size(); ++i) {
+			if (_chunks[i].size >= size + alignment) {
+				SWAP(_chunks[next], _chunks[i]);
+				break;
+			}
+		}
+	}
+
+	if (next >= _chunks.size() || _chunks[next].size < size + alignment) {
+		Chunk chunk;
+		chunk.size = MAX(_chunkSize, size + alignment);
+		chunk.data = (byte *)malloc(chunk.size);
+		if (!chunk.data) {
+			warning("FrameArena: Could not allocate %u bytes", (uint)chunk.size);
+			return false;
+		}
+		++_stats.heapAllocations;
+		_chunks.insert_at(next, chunk);
+	}
+
+	if (next != _chunk)
+		_previousBytes += _chunks[_chunk].size;
+	_chunk = next;
+	_offset = 0;
+	return true;
+}
+
+void FrameArena::deallocate(void *ptr, size_t size) {
+	if (!ptr || _chunk >= _chunks.size())
+		return;
+
+	byte *data = _chunks[_chunk].data;
+	if ((byte *)ptr >= data && (byte *)ptr + size == data + _offset)
+		_offset = (byte *)ptr - data;
+}
+
+FrameArena::Mark FrameArena::getMark() const {
+	Mark mark;
+	mark.chunk = _chunk;
+	mark.offset = _offset;
+	return mark;
+}
+
+void FrameArena::release(const Mark &mark) {
+	assert(mark.chunk <= _chunk);
+	assert(mark.chunk < _chunk || mark.offset <= _offset);
+
+	for (uint i = mark.chunk; i < _chunk; ++i)
+		_previousBytes -= _chunks[i].size;
+	_chunk = mark.chunk;
+	_offset = mark.offset;
+}
+
+void FrameArena::reset() {
+	_chunk = 0;
+	_offset = 0;
+	_previousBytes = 0;
+}
+
+void FrameArena::freeUnusedChunks() {
+	const uint used = MIN<uint>(_chunk + 1, _chunks.size());
+	for (uint i = used; i < _chunks.size(); ++i)
+		free(_chunks[i].data);
+	_chunks.resize(used);
+}
+
+size_t FrameArena::getUsedBytes() const {
+	return _previousBytes + _offset;
+}
+
+} // End of namespace Common
@@ -0,0 +1,203 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_FRAMEARENA_H
+#define COMMON_FRAMEARENA_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_frame_arena Frame arena
+ * @ingroup common_memory
+ *
+ * @brief Bump allocator for short-lived allocations.
+ * @{
+ */
+
+/**
+ * This class hands out memory from large chunks by advancing an offset,
+ * which makes an allocation much cheaper than one from the heap. The memory
+ * is not freed one allocation at a time, but all at once back to a reset
+ * point, typically at the end of a frame or of a room. The chunks are kept
+ * for the allocations which follow.
+ *
+ * The destructors of the objects in the arena are not called when it is
+ * reset, so the objects must be destroyed before that, e.g. by the
+ * containers which hold them.
+ */
+class FrameArena : NonCopyable {
+public:
+	/** A reset point of the arena, see getMark() and release(). */
+	struct Mark {
+		uint chunk;
+		size_t offset;
+	};
+
+	/** Statistics of the use of the arena since it was created. */
+	struct Stats {
+		uint32 allocations;     ///< Number of allocations served by the arena
+		uint32 heapAllocations; ///< Number of chunks allocated from the heap
+		size_t peakBytes;       ///< Largest amount of memory in use at once
+	};
+
+	/**
+	 * Alignment of the memory returned by allocate() when none is given,
+	 * sufficient for any of the types of the engines.
+	 */
+	static const size_t kDefaultAlignment = 8;
+
+	/**
+	 * Construct an arena, which allocates chunks of @p chunkSize bytes, or
+	 * larger ones for larger allocations.
+	 */
+	explicit FrameArena(size_t chunkSize = 64 * 1024);
+	~FrameArena();
+
+	/**
+	 * Allocate @p size bytes aligned on @p alignment, which must be a power
+	 * of two.
+	 */
+	void *allocate(size_t size, size_t alignment = kDefaultAlignment);
+
+	/**
+	 * Give back memory obtained from allocate(). It is only reused before the
+	 * next reset point when it was the latest allocation, as it is when an
+	 * array grows.
+	 */
+	void deallocate(void *ptr, size_t size);
+
+	/** Return a reset point at the current state of the arena. */
+	Mark getMark() const;
+
+	/**
+	 * Free all the memory allocated after the given reset point. The marks
+	 * obtained after it become invalid.
+	 */
+	void release(const Mark &mark);
+
+	/** Free all the memory allocated from the arena. */
+	void reset();
+
+	/** Free the chunks of the heap which are not in use. */
+	void freeUnusedChunks();
+
+	/** Return the amount of memory in use, including the alignment padding. */
+	size_t getUsedBytes() const;
+
+	const Stats &getStats() const { return _stats; }
+
+	/**
+	 * Releases the arena back to its state at the construction of the scope
+	 * when the scope ends.
+	 */
+	class Scope : NonCopyable {
+	public:
+		explicit Scope(FrameArena &arena) : _arena(arena), _mark(arena.getMark()) {}
+		~Scope() { _arena.release(_mark); }
+
+	private:
+		FrameArena &_arena;
+		Mark _mark;
+	};
+
+private:
+	struct Chunk {
+		byte *data;
+		size_t size;
+	};
+
+	bool nextChunk(size_t size, size_t alignment);
+
+	const size_t _chunkSize;
+	Array<Chunk> _chunks;
+	uint _chunk;            ///< Index of the chunk memory is allocated from
+	size_t _offset;         ///< Offset of the free memory in that chunk
+	size_t _previousBytes;  ///< Total size of the chunks before it
+	Stats _stats;
+};
+
+/**
+ * Allocator for the containers which obtains memory from a FrameArena, see
+ * Common::Allocator. Freeing memory is mostly left to the reset points of
+ * the arena.
+ *
+ * An allocator without an arena uses the heap instead, so that the same
+ * container type can be used for both short-lived and long-lived data.
+ */
+template<class T>
+class FrameArenaAllocator {
+public:
+	typedef T value_type;
+
+	template<class U>
+	struct rebind {
+		typedef FrameArenaAllocator<U> other;
+	};
+
+	constexpr FrameArenaAllocator() : _arena(nullptr) {}
+	explicit constexpr FrameArenaAllocator(FrameArena *arena) : _arena(arena) {}
+	template<class U>
+	constexpr FrameArenaAllocator(const FrameArenaAllocator<U> &other) : _arena(other.getArena()) {}
+
+	T *allocate(size_t n) {
+		if (_arena)
+			return (T *)_arena->allocate(n * sizeof(T), alignof(T) > FrameArena::kDefaultAlignment ? alignof(T) : FrameArena::kDefaultAlignment);
+		return (T *)malloc(n * sizeof(T));
+	}
+
+	void deallocate(T *p, size_t n) {
+		if (_arena)
+			_arena->deallocate(p, n * sizeof(T));
+		else
+			free(p);
+	}
+
+	FrameArena *getArena() const { return _arena; }
+
+	bool operator==(const FrameArenaAllocator &other) const { return _arena == other._arena; }
+	bool operator!=(const FrameArenaAllocator &other) const { return _arena != other._arena; }
+
+private:
+	FrameArena *_arena;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+/**
+ * A custom placement new operator, using a FrameArena.
+ *
+ * The objects must be destroyed by calling their destructor, as delete
+ * cannot free them.
+ */
+inline void *operator new(size_t nbytes, Common::FrameArena &arena) {
+	return arena.allocate(nbytes);
+}
+
+inline void operator delete(void *p, Common::FrameArena &arena) {
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "common/system.h"
 #include "common/debug.h"
+#include "common/fsindex.h"
 #include "common/punycode.h"
 #include "common/textconsole.h"
 #include "backends/fs/abstract-fs.h"
@@ -212,6 +213,10 @@ bool FSNode::isDirectory() const {
 	return _realNode && _realNode->isDirectory();
 }
 
+int64 FSNode::getFileSize() const {
+	return _realNode ? _realNode->getFileSize() : -1;
+}
+
 void FSNode::listChildren(ArchiveMemberList &childList, const char *pattern) const {
 	Common::FSList fsList;
 	if (!getChildren(fsList, Common::FSNode::kListAll))
@@ -263,6 +268,21 @@ SeekableReadStream *FSNode::createReadStreamForAltStream(AltStreamType altStream
 	return _realNode->createReadStreamForAltStream(altStreamType);
 }
 
+SeekableReadStream *FSNode::createReadStreamMapped() const {
+	if (_realNode == nullptr)
+		return nullptr;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createReadStreamMapped: '%s' does not exist", getName().c_str());
+		return nullptr;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createReadStreamMapped: '%s' is a directory", getName().c_str());
+		return nullptr;
+	}
+
+	return _realNode->createReadStreamMapped();
+}
+
 SeekableWriteStream *FSNode::createWriteStream(bool atomic) const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -320,6 +340,12 @@ FSDirectory::FSDirectory(const Path &prefix, const Path &name, int depth, bool f
 FSDirectory::~FSDirectory() {
 }
 
+FSIndex *FSDirectory::_index = nullptr;
+
+void FSDirectory::setIndex(FSIndex *index) {
+	_index = index;
+}
+
 void FSDirectory::setPrefix(const Path &prefix) {
 	_prefix = prefix;
 }
@@ -333,13 +359,57 @@ FSNode *FSDirectory::lookupCache(NodeCache &cache, const Path &name) const {
 	if (!name.empty()) {
 		ensureCached();
 
-		if (cache.contains(name))
-			return &cache[name];
+		NodeCache::iterator it = cache.find(name);
+		if (it != cache.end())
+			return &it->_value;
+
+		// The lookup may have failed in a listing which was taken from the
+		// index without being checked, and is out of date
+		if (_index && invalidateIndex(name)) {
+			_fileCache.clear();
+			_subDirCache.clear();
+			_cached = false;
+			ensureCached();
+
+			it = cache.find(name);
+			if (it != cache.end())
+				return &it->_value;
+		}
 	}
 
 	return nullptr;
 }
 
+bool FSDirectory::invalidateIndex(const Path &name) const {
+	FSList dirs;
+	if (_flat) {
+		// Any directory of a flat tree may hold the name
+		dirs.push_back(_node);
+		for (NodeCache::const_iterator it = _subDirCache.begin(); it != _subDirCache.end(); ++it)
+			dirs.push_back(it->_value);
+	} else {
+		// The deepest directory of the path which was listed
+		Path parent = name.getParent().removeTrailingSeparators();
+		while (!parent.empty() && parent != _prefix && !_subDirCache.contains(parent))
+			parent = parent.getParent().removeTrailingSeparators();
+
+		NodeCache::const_iterator it = _subDirCache.find(parent);
+		dirs.push_back(it != _subDirCache.end() ? it->_value : _node);
+	}
+
+	// Each directory is listed again at most once, lookups of missing files
+	// are frequent
+	bool invalidated = false;
+	for (FSList::const_iterator it = dirs.begin(); it != dirs.end(); ++it) {
+		const String path = it->getPath().toString(Common::Path::kNativeSeparator);
+		if (!_invalidated.contains(path) && _index->invalidate(*it)) {
+			_invalidated[path] = true;
+			invalidated = true;
+		}
+	}
+	return invalidated;
+}
+
 bool FSDirectory::hasFile(const Path &path) const {
 	if (path.empty() || !_node.isDirectory())
 		return false;
@@ -407,6 +477,23 @@ SeekableReadStream *FSDirectory::createReadStreamForMemberAltStream(const Path &
 	return stream;
 }
 
+SeekableReadStream *FSDirectory::createReadStreamForMemberMapped(const Path &path) const {
+	if (path.empty() || !_node.isDirectory())
+		return nullptr;
+
+	FSNode *node = lookupCache(_fileCache, path);
+	if (!node)
+		return nullptr;
+
+	debug(5, "FSDirectory::createReadStreamForMemberMapped('%s') -> '%s'", path.toString(Common::Path::kNativeSeparator).c_str(), node->getPath().toString(Common::Path::kNativeSeparator).c_str());
+
+	SeekableReadStream *stream = node->createReadStreamMapped();
+	if (!stream)
+		warning("FSDirectory::createReadStreamForMemberMapped: Can't create stream for file '%s'", Common::toPrintable(path.toString(Common::Path::kNativeSeparator)).c_str());
+
+	return stream;
+}
+
 FSDirectory *FSDirectory::getSubDirectory(const Path &name, int depth, bool flat, bool ignoreClashes) {
 	return getSubDirectory(Path(), name, depth, flat, ignoreClashes);
 }
@@ -428,7 +515,10 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const Path& pr
 		return;
 
 	FSList list;
-	node.getChildren(list, FSNode::kListAll);
+	if (_index)
+		_index->getChildren(node, list);
+	else
+		node.getChildren(list, FSNode::kListAll);
 
 	FSList::iterator it = list.begin();
 	for ( ; it != list.end(); ++it) {
@@ -469,6 +559,10 @@ void FSDirectory::ensureCached() const  {
 		return;
 	cacheDirectoryRecursive(_node, _depth, _prefix);
 	_cached = true;
+
+	// Keep the listings of this tree for the next start
+	if (_index)
+		_index->flush();
 }
 
 int FSDirectory::listMatchingMembers(ArchiveMemberList &list, const Path &pattern, bool matchPathComponents) const {
@@ -24,8 +24,8 @@
 
 #include "common/array.h"
 #include "common/archive.h"
+#include "common/flathashmap.h"
 #include "common/hash-str.h"
-#include "common/hashmap.h"
 #include "common/ptr.h"
 #include "common/str.h"
 #include "common/ustr.h"
@@ -45,6 +45,7 @@ namespace Common {
 
 class FSNode;
 class FSDirectory;
+class FSIndex;
 class SeekableReadStream;
 class WriteStream;
 class SeekableWriteStream;
@@ -70,6 +71,7 @@ class FSNode : public ArchiveMember {
 private:
 	friend class ::AbstractFSNode;
 	friend class FSDirectory;
+	friend class FSIndex;
 	SharedPtr<AbstractFSNode>	_realNode;
 	/**
 	 * Construct an FSNode from a backend's AbstractFSNode implementation.
@@ -220,6 +222,16 @@ public:
 	 */
 	bool isDirectory() const override;
 
+	/**
+	 * Return the size of the file the node refers to, without opening it.
+	 * The size is the one known when the node was created or listed, so it
+	 * may be out of date if the file was changed since.
+	 *
+	 * @return The size of the file, or -1 if the node is a directory or
+	 *         the size is not available from the backend.
+	 */
+	int64 getFileSize() const;
+
 	/**
 	 * Adds the immediate children of this FSNode to a list, optionally matching a pattern.
 	 * Has no effect if this FSNode is not a directory.
@@ -271,6 +283,16 @@ public:
 	 */
 	SeekableReadStream *createReadStreamForAltStream(AltStreamType altStreamType) const override;
 
+	/**
+	 * Create a SeekableReadStream instance which maps the file referred by
+	 * this node in memory, so that SeekableReadStream::getPointer() gives
+	 * access to its data. On platforms which cannot map files, this is the
+	 * same as createReadStream().
+	 *
+	 * @return Pointer to the stream object, nullptr in case of a failure.
+	 */
+	SeekableReadStream *createReadStreamMapped() const;
+
 	/**
 	 * Create a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -350,13 +372,21 @@ class FSDirectory : public Archive {
 
 	// Caches are case insensitive, clashes are dealt with when creating
 	// Key is stored in lowercase.
-	typedef HashMap<Path, FSNode, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> NodeCache;
+	typedef FlatHashMap<Path, FSNode, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> NodeCache;
 	mutable NodeCache	_fileCache, _subDirCache;
 	mutable bool _cached;
 
+	// persistent index of directory listings, shared by all instances
+	static FSIndex *_index;
+	// directories whose listing in the index was dropped by this instance
+	mutable HashMap<String, bool> _invalidated;
+
 	// look for a match
 	FSNode *lookupCache(NodeCache &cache, const Path &name) const;
 
+	// drop the listings of the index a failed lookup may have been made in
+	bool invalidateIndex(const Path &name) const;
+
 	// cache management
 	void cacheDirectoryRecursive(FSNode node, int depth, const Path& prefix) const;
 
@@ -391,6 +421,13 @@ public:
 
 	virtual ~FSDirectory();
 
+	/**
+	 * Set the persistent index used by all FSDirectory instances to list
+	 * their directories, or disable it with nullptr. The index is not owned,
+	 * and must outlive all uses of FSDirectory.
+	 */
+	static void setIndex(FSIndex *index);
+
 	/**
 	 * Return the underlying FSNode of the FSDirectory.
 	 */
@@ -448,6 +485,12 @@ public:
 	 * for success.
 	 */
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, AltStreamType altStreamType) const override;
+
+	/**
+	 * Open the specified file mapped in memory. A full match of relative path and file name is needed
+	 * for success.
+	 */
+	SeekableReadStream *createReadStreamForMemberMapped(const Path &path) const override;
 };
 
 /** @} */
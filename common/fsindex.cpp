@@ -0,0 +1,378 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/fsindex.h"
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+#include "backends/fs/abstract-fs.h"
+
+namespace Common {
+
+/** Tags and version of the headers of the index file and of its journal. */
+static const uint32 FSINDEX_TAG = MKTAG('F', 'S', 'I', 'X');
+static const uint32 FSINDEX_JOURNAL_TAG = MKTAG('F', 'S', 'I', 'J');
+static const byte FSINDEX_VERSION = 2;
+
+/** Size below which the journal is never merged into the index file. */
+static const uint32 FSINDEX_MIN_MERGE_SIZE = 16 * 1024;
+
+static String readString(SeekableReadStream &stream) {
+	uint16 length = stream.readUint16LE();
+	String str;
+	char buffer[64];
+	while (length > 0 && !stream.eos() && !stream.err()) {
+		const uint16 count = MIN<uint16>(length, sizeof(buffer));
+		stream.read(buffer, count);
+		str += String(buffer, count);
+		length -= count;
+	}
+	return str;
+}
+
+static void writeString(WriteStream &stream, const String &str) {
+	stream.writeUint16LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+static String nativePath(const FSNode &node) {
+	return node.getPath().toString(Common::Path::kNativeSeparator);
+}
+
+FSIndex::FSIndex(const FSNode &file, bool checkSignatures) : _file(file),
+		_journalFile(file.getParent().getChild(file.getName() + ".journal")), _checkSignatures(checkSignatures),
+		_generation(0), _size(0), _journalSize(0), _opened(false), _dirty(false) {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.invalidated = 0;
+	_stats.merges = 0;
+}
+
+FSIndex::~FSIndex() {
+	flush();
+}
+
+SeekableReadStream *FSIndex::openFile(const FSNode &file, uint32 tag, uint32 &generation) const {
+	if (!file.exists())
+		return nullptr;
+
+	SeekableReadStream *stream = file.createReadStream();
+	if (!stream)
+		return nullptr;
+
+	if (stream->readUint32BE() != tag || stream->readByte() != FSINDEX_VERSION) {
+		warning("FSIndex: '%s' is not a directory index, ignoring it", nativePath(file).c_str());
+		delete stream;
+		return nullptr;
+	}
+
+	generation = stream->readUint32LE();
+	return stream;
+}
+
+void FSIndex::open() {
+	_opened = true;
+
+	_stream.reset(openFile(_file, FSINDEX_TAG, _generation));
+	if (!_stream)
+		return;
+	_size = _stream->size();
+	if (!readRecords(*_stream, _file, false)) {
+		_directories.clear();
+		_stream.reset();
+		return;
+	}
+
+	// A journal left from an index file which has been replaced since does
+	// not apply to it
+	uint32 generation;
+	_journalStream.reset(openFile(_journalFile, FSINDEX_JOURNAL_TAG, generation));
+	if (_journalStream && generation != _generation)
+		_journalStream.reset();
+	if (_journalStream)
+		readRecords(*_journalStream, _journalFile, true);
+}
+
+bool FSIndex::readRecords(SeekableReadStream &stream, const FSNode &file, bool journal) {
+	// Only the directory headers are read here, their children are skipped
+	// until they are needed. Records of the journal supersede the earlier ones.
+	while (true) {
+		const String path = readString(stream);
+		if (stream.eos())
+			return true;
+
+		Directory dir;
+		dir.signature = stream.readUint32LE();
+		dir.checked = false;
+		dir.pending = false;
+		dir.stream = &stream;
+		const uint32 size = stream.readUint32LE();
+		dir.offset = stream.pos();
+
+		if (stream.eos() || stream.err() || !stream.skip(size)) {
+			// The journal is appended to, so only its last record may be cut
+			// short, when the device lost power while writing it
+			warning("FSIndex: '%s' is truncated, ignoring %s", nativePath(file).c_str(), journal ? "its end" : "it");
+			return journal;
+		}
+
+		if (size == 0) {
+			// The directory was dropped, which has to be kept in the journal
+			// when it is rewritten
+			_directories.erase(path);
+			_removed.push_back(path);
+		} else {
+			_directories[path] = dir;
+		}
+	}
+}
+
+bool FSIndex::readEntries(Directory &dir) {
+	if (!dir.stream)
+		return true;
+
+	if (!dir.stream->seek(dir.offset))
+		return false;
+
+	SeekableReadStream &stream = *dir.stream;
+	const uint32 count = stream.readUint32LE();
+	dir.entries.resize(count);
+	for (uint32 i = 0; i < count; ++i) {
+		dir.entries[i].isDirectory = stream.readByte() != 0;
+		dir.entries[i].size = stream.readSint64LE();
+		dir.entries[i].name = readString(stream);
+	}
+
+	if (stream.eos() || stream.err()) {
+		dir.entries.clear();
+		return false;
+	}
+
+	dir.stream = nullptr;
+	return true;
+}
+
+bool FSIndex::getChildren(const FSNode &dir, FSList &list) {
+	if (!dir._realNode) {
+		++_stats.misses;
+		return dir.getChildren(list, FSNode::kListAll);
+	}
+
+	if (!_opened)
+		open();
+
+	// A signature of 0 never matches, it is returned for directories which
+	// may still be changing
+	uint32 signature = 0;
+	const bool checked = _checkSignatures && dir._realNode->getDirectorySignature(signature);
+
+	const String path = nativePath(dir);
+	DirectoryMap::iterator it = _directories.find(path);
+	if (it != _directories.end() && (!checked || (signature != 0 && it->_value.signature == signature)) && readEntries(it->_value)) {
+		++_stats.hits;
+		it->_value.checked = it->_value.checked || checked;
+
+		const Array<Entry> &entries = it->_value.entries;
+		list.reserve(list.size() + entries.size());
+		for (Array<Entry>::const_iterator entry = entries.begin(); entry != entries.end(); ++entry)
+			list.push_back(FSNode(dir._realNode->getChildWithKnownType(entry->name, entry->isDirectory, entry->size)));
+		return true;
+	}
+
+	++_stats.misses;
+	const uint first = list.size();
+	if (!dir.getChildren(list, FSNode::kListAll))
+		return false;
+
+	Directory &record = _directories[path];
+	record.signature = signature;
+	record.checked = true;
+	record.pending = true;
+	record.stream = nullptr;
+	record.entries.resize(list.size() - first);
+	for (uint i = first; i < list.size(); ++i) {
+		Entry &entry = record.entries[i - first];
+		entry.name = list[i].getRealName();
+		entry.isDirectory = list[i].isDirectory();
+		entry.size = entry.isDirectory ? -1 : list[i].getFileSize();
+	}
+	_dirty = true;
+
+	debug(5, "FSIndex: recorded %u children of '%s'", record.entries.size(), path.c_str());
+	return true;
+}
+
+bool FSIndex::invalidate(const FSNode &dir) {
+	if (!_opened)
+		return false;
+
+	const String path = nativePath(dir);
+	if (_dropped.contains(path))
+		return true;
+
+	DirectoryMap::iterator it = _directories.find(path);
+	if (it == _directories.end() || it->_value.checked)
+		return false;
+
+	++_stats.invalidated;
+	_directories.erase(it);
+	_dropped[path] = true;
+	_removed.push_back(path);
+	_dirty = true;
+
+	debug(5, "FSIndex: dropped the children of '%s'", path.c_str());
+	return true;
+}
+
+uint32 FSIndex::writeRecord(WriteStream &stream, const String &path, const Directory *dir) const {
+	uint32 size = 0;
+	if (dir) {
+		size = 4;
+		for (Array<Entry>::const_iterator entry = dir->entries.begin(); entry != dir->entries.end(); ++entry)
+			size += 11 + entry->name.size();
+	}
+
+	writeString(stream, path);
+	stream.writeUint32LE(dir ? dir->signature : 0);
+	stream.writeUint32LE(size);
+	if (dir) {
+		stream.writeUint32LE(dir->entries.size());
+		for (Array<Entry>::const_iterator entry = dir->entries.begin(); entry != dir->entries.end(); ++entry) {
+			stream.writeByte(entry->isDirectory ? 1 : 0);
+			stream.writeSint64LE(entry->size);
+			writeString(stream, entry->name);
+		}
+	}
+	return 10 + path.size() + size;
+}
+
+bool FSIndex::startJournal() {
+	_journal.reset(_journalFile.createWriteStream(false));
+	if (!_journal) {
+		warning("FSIndex: Can't write '%s'", nativePath(_journalFile).c_str());
+		return false;
+	}
+
+	_journal->writeUint32BE(FSINDEX_JOURNAL_TAG);
+	_journal->writeByte(FSINDEX_VERSION);
+	_journal->writeUint32LE(_generation);
+	_journalSize = 0;
+	return true;
+}
+
+bool FSIndex::merge() {
+	// Everything gets rewritten, so the children still in the old files have
+	// to be read first. Directories which cannot be read are dropped.
+	for (DirectoryMap::iterator it = _directories.begin(); it != _directories.end(); ) {
+		DirectoryMap::iterator dir = it++;
+		if (!readEntries(dir->_value))
+			_directories.erase(dir);
+	}
+	_stream.reset();
+	_journalStream.reset();
+	_journal.reset();
+
+	ScopedPtr<SeekableWriteStream> out(_file.createWriteStream());
+	if (!out) {
+		warning("FSIndex: Can't write '%s'", nativePath(_file).c_str());
+		return false;
+	}
+
+	// The new generation discards the journal, even if it cannot be
+	// truncated below
+	out->writeUint32BE(FSINDEX_TAG);
+	out->writeByte(FSINDEX_VERSION);
+	out->writeUint32LE(++_generation);
+	for (DirectoryMap::iterator it = _directories.begin(); it != _directories.end(); ++it) {
+		writeRecord(*out, it->_key, &it->_value);
+		it->_value.pending = false;
+	}
+	_removed.clear();
+	_size = out->pos();
+
+	out->finalize();
+	if (out->err()) {
+		warning("FSIndex: Can't write '%s'", nativePath(_file).c_str());
+		return false;
+	}
+
+	++_stats.merges;
+	debug(5, "FSIndex: merged the journal into '%s'", nativePath(_file).c_str());
+	return startJournal();
+}
+
+bool FSIndex::flush() {
+	if (!_dirty)
+		return true;
+
+	const uint32 mergeSize = MAX(_size, FSINDEX_MIN_MERGE_SIZE);
+	if (!_journal) {
+		// The journal is rewritten the first time it is written to in a run,
+		// with the records of the earlier runs which are still valid, unless
+		// it has grown large enough to be merged into the index file
+		if (_journalStream && (uint32)_journalStream->size() > mergeSize) {
+			_dirty = false;
+			return merge();
+		}
+
+		for (DirectoryMap::iterator it = _directories.begin(); it != _directories.end(); ) {
+			DirectoryMap::iterator dir = it++;
+			if (!_journalStream || dir->_value.stream != _journalStream.get())
+				continue;
+			if (readEntries(dir->_value))
+				dir->_value.pending = true;
+			else
+				_directories.erase(dir);
+		}
+		_journalStream.reset();
+
+		if (!_stream) {
+			// There is no index file yet, or it was dropped
+			_dirty = false;
+			return merge();
+		}
+		if (!startJournal())
+			return false;
+	}
+
+	for (Array<String>::const_iterator path = _removed.begin(); path != _removed.end(); ++path)
+		_journalSize += writeRecord(*_journal, *path, nullptr);
+	_removed.clear();
+	for (DirectoryMap::iterator it = _directories.begin(); it != _directories.end(); ++it) {
+		if (it->_value.pending)
+			_journalSize += writeRecord(*_journal, it->_key, &it->_value);
+		it->_value.pending = false;
+	}
+
+	_dirty = false;
+	if (!_journal->flush() || _journal->err()) {
+		warning("FSIndex: Can't write '%s'", nativePath(_journalFile).c_str());
+		_journal.reset();
+		return false;
+	}
+
+	if (_journalSize > mergeSize)
+		return merge();
+	return true;
+}
+
+} // End of namespace Common
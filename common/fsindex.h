@@ -0,0 +1,163 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_FSINDEX_H
+#define COMMON_FSINDEX_H
+
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/ptr.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_fsindex Directory index
+ * @ingroup common
+ *
+ * @brief Persistent index of directory listings.
+ *
+ * @{
+ */
+
+/**
+ * Persistent index of the children of directories, kept in a single file.
+ *
+ * FSDirectory lists its directories through the index once one has been
+ * installed with FSDirectory::setIndex(). A directory is only listed from
+ * the index while its signature, as returned by the file system backend
+ * (usually built from its modification time and size), matches the one
+ * recorded with the listing; otherwise it is listed again and the listing is
+ * recorded anew. Checking a signature is cheaper than listing a directory on
+ * slow storage like FAT on an SD card.
+ *
+ * Directories without a signature are listed from the index without being
+ * checked. When a lookup fails in such a directory, FSDirectory drops its
+ * listing with invalidate() and lists it again, in case the file was added
+ * since the listing was recorded.
+ *
+ * The index file is read lazily: opening it only reads the path and the
+ * signature of every directory, the children of a directory are read the
+ * first time that directory is listed. New listings are appended to a
+ * journal next to the index file, which is merged into the index file once
+ * it grows larger than it.
+ */
+class FSIndex {
+public:
+	struct Stats {
+		uint32 hits;        ///< Directories listed from the index
+		uint32 misses;      ///< Directories listed from the file system
+		uint32 invalidated; ///< Listings dropped after a lookup failed
+		uint32 merges;      ///< Times the journal was merged into the index file
+	};
+
+	/**
+	 * @param file             The index file, which does not need to exist yet.
+	 * @param checkSignatures  Whether listings are checked against the signature
+	 *                         of their directory. File systems which do not
+	 *                         update the times of directories when their
+	 *                         children change have no usable signature.
+	 */
+	explicit FSIndex(const FSNode &file, bool checkSignatures = true);
+	~FSIndex();
+
+	/**
+	 * Lists all children of a directory, including hidden ones, from the
+	 * index when it is up to date, or from the file system otherwise.
+	 *
+	 * @return False if the directory cannot be listed.
+	 */
+	bool getChildren(const FSNode &dir, FSList &list);
+
+	/**
+	 * Drops the listing of a directory which was taken from the index without
+	 * being checked, after a lookup in it failed, so that the directory is
+	 * listed from the file system the next time.
+	 *
+	 * @return True if the listing of the directory was dropped, now or earlier
+	 *         since the index was opened, so that the listings made from it
+	 *         may be out of date.
+	 */
+	bool invalidate(const FSNode &dir);
+
+	/**
+	 * Appends the listings recorded since the last call to the journal of the
+	 * index file.
+	 */
+	bool flush();
+
+	const Stats &getStats() const { return _stats; }
+
+private:
+	struct Entry {
+		String name;
+		bool isDirectory;
+		int64 size;     ///< Size of a file, or -1 if unknown
+	};
+
+	struct Directory {
+		uint32 signature;
+		/** Whether the signature matched, or the directory was listed from the file system. */
+		bool checked;
+		/** Whether the listing was recorded since the last flush. */
+		bool pending;
+		/** Stream the children are read from, or nullptr once read. */
+		SeekableReadStream *stream;
+		int32 offset;
+		Array<Entry> entries;
+	};
+
+	typedef HashMap<String, Directory> DirectoryMap;
+
+	void open();
+	SeekableReadStream *openFile(const FSNode &file, uint32 tag, uint32 &generation) const;
+	bool readRecords(SeekableReadStream &stream, const FSNode &file, bool journal);
+	bool readEntries(Directory &dir);
+	uint32 writeRecord(WriteStream &stream, const String &path, const Directory *dir) const;
+	bool startJournal();
+	bool merge();
+
+	FSNode _file;
+	FSNode _journalFile;
+	bool _checkSignatures;
+	ScopedPtr<SeekableReadStream> _stream;
+	ScopedPtr<SeekableReadStream> _journalStream;
+	ScopedPtr<SeekableWriteStream> _journal;
+	/** Generation of the index file, which its journal must belong to. */
+	uint32 _generation;
+	uint32 _size;
+	uint32 _journalSize;
+	DirectoryMap _directories;
+	/** Directories dropped since the last flush. */
+	Array<String> _removed;
+	/** Directories dropped since the index was opened. */
+	HashMap<String, bool> _dropped;
+	bool _opened;
+	bool _dirty;
+	Stats _stats;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
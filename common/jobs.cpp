@@ -0,0 +1,333 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// The standard headers must come before the forbidden symbols are defined
+#include <atomic>
+#include <new>
+
+#include "common/jobs.h"
+#include "common/trace.h"
+#include "common/util.h"
+
+namespace Common {
+
+namespace {
+
+typedef std::atomic<int32> PendingCounter;
+
+static_assert(sizeof(PendingCounter) <= sizeof(uint64), "The counter of a job group does not fit its storage");
+
+PendingCounter &pendingOf(uint64 &storage) {
+	return *reinterpret_cast<PendingCounter *>(&storage);
+}
+
+const PendingCounter &pendingOf(const uint64 &storage) {
+	return *reinterpret_cast<const PendingCounter *>(&storage);
+}
+
+// The job system and the index of the worker running on the calling thread
+thread_local const JobSystem *t_jobSystem = nullptr;
+thread_local uint t_workerIndex = 0;
+
+// Number of times an idle worker checks the queues before it goes to sleep,
+// as jobs often come in bursts
+const int kWorkerSpinCount = 64;
+
+} // End of anonymous namespace
+
+struct JobSystem::Job {
+	Proc proc;
+	void *data;
+	Group *group;
+};
+
+/**
+ * Queue of the jobs created by a thread. The thread pushes and pops jobs at
+ * the back, other threads steal them from the front. A spin lock guards it,
+ * as it is only held for a few instructions.
+ */
+struct JobSystem::Queue {
+	static const uint32 kSize = 128; // Must be a power of two
+
+	Job jobs[kSize];
+	uint32 front;
+	uint32 back;
+	std::atomic<uint32> size;
+	std::atomic_flag lock;
+
+	Queue() : front(0), back(0), size(0) {
+		lock.clear();
+	}
+
+	void acquire() {
+		while (lock.test_and_set(std::memory_order_acquire))
+			;
+	}
+
+	void release() {
+		lock.clear(std::memory_order_release);
+	}
+
+	bool push(const Job &job) {
+		acquire();
+		const bool full = back - front == kSize;
+		if (!full) {
+			jobs[back++ & (kSize - 1)] = job;
+			size.store(back - front);
+		}
+		release();
+		return !full;
+	}
+
+	bool pop(Job &job) {
+		if (!size.load(std::memory_order_relaxed))
+			return false;
+
+		acquire();
+		const bool empty = back == front;
+		if (!empty) {
+			job = jobs[--back & (kSize - 1)];
+			size.store(back - front);
+		}
+		release();
+		return !empty;
+	}
+
+	bool steal(Job &job) {
+		if (!size.load(std::memory_order_relaxed))
+			return false;
+
+		acquire();
+		const bool empty = back == front;
+		if (!empty) {
+			job = jobs[front++ & (kSize - 1)];
+			size.store(back - front);
+		}
+		release();
+		return !empty;
+	}
+};
+
+struct JobSystem::State {
+	// One queue per worker, then one shared by the other threads
+	Queue *queues;
+	std::atomic<uint32> sleeping;
+	std::atomic<bool> quit;
+
+	std::atomic<uint32> jobs;
+	std::atomic<uint32> stolen;
+	std::atomic<uint32> inlined;
+	std::atomic<uint32> sleeps;
+
+	State() : queues(nullptr), sleeping(0), quit(false), jobs(0), stolen(0), inlined(0), sleeps(0) {}
+};
+
+JobSystem::Group::Group() {
+	new (&_pending) PendingCounter(0);
+}
+
+JobSystem::Group::~Group() {
+	assert(isDone());
+	pendingOf(_pending).~PendingCounter();
+}
+
+bool JobSystem::Group::isDone() const {
+	return pendingOf(_pending).load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem() : _workerCount(0), _state(new State()) {
+}
+
+JobSystem::~JobSystem() {
+	delete[] _state->queues;
+	delete _state;
+}
+
+void JobSystem::initWorkers(uint count) {
+	assert(!_workerCount && count <= kMaxWorkers);
+	if (!count)
+		return;
+
+	_state->queues = new Queue[count + 1];
+	_workerCount = count;
+}
+
+uint JobSystem::getQueueIndex() const {
+	return t_jobSystem == this ? t_workerIndex : _workerCount;
+}
+
+void JobSystem::run(Group &group, Proc proc, void *data) {
+	Job job;
+	job.proc = proc;
+	job.data = data;
+	job.group = &group;
+	pendingOf(group._pending).fetch_add(1, std::memory_order_relaxed);
+
+	if (!_workerCount || !_state->queues[getQueueIndex()].push(job)) {
+		_state->inlined.fetch_add(1, std::memory_order_relaxed);
+		execute(job);
+		return;
+	}
+
+	// A worker going to sleep checks the queues after it counts itself as
+	// sleeping, so either it sees the job, or the job sees it
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (_state->sleeping.load())
+		signalWork(1);
+}
+
+void JobSystem::wait(Group &group) {
+	const PendingCounter &pending = pendingOf(group._pending);
+	const uint queue = getQueueIndex();
+
+	while (pending.load(std::memory_order_acquire) > 0) {
+		Job job;
+		if (takeJob(queue, job))
+			execute(job);
+		else
+			yieldThread();
+	}
+}
+
+void JobSystem::execute(const Job &job) {
+	job.proc(job.data);
+	_state->jobs.fetch_add(1, std::memory_order_relaxed);
+	pendingOf(job.group->_pending).fetch_sub(1, std::memory_order_release);
+}
+
+bool JobSystem::takeJob(uint queue, Job &job) {
+	if (!_workerCount)
+		return false;
+
+	if (_state->queues[queue].pop(job))
+		return true;
+
+	for (uint i = 1; i <= _workerCount; ++i) {
+		if (_state->queues[(queue + i) % (_workerCount + 1)].steal(job)) {
+			_state->stolen.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::hasJobs() const {
+	for (uint i = 0; i <= _workerCount; ++i) {
+		if (_state->queues[i].size.load())
+			return true;
+	}
+	return false;
+}
+
+void JobSystem::runWorker(uint index) {
+	assert(index < _workerCount);
+	t_jobSystem = this;
+	t_workerIndex = index;
+	TRACE_THREAD_NAME("Job worker");
+
+	while (!_state->quit.load(std::memory_order_acquire)) {
+		Job job;
+		if (takeJob(index, job)) {
+			execute(job);
+			continue;
+		}
+
+		bool found = false;
+		for (int spin = 0; spin < kWorkerSpinCount && !found; ++spin) {
+			yieldThread();
+			found = hasJobs();
+		}
+		if (found)
+			continue;
+
+		_state->sleeping.fetch_add(1);
+		if (!hasJobs() && !_state->quit.load()) {
+			_state->sleeps.fetch_add(1, std::memory_order_relaxed);
+			waitForWork();
+		}
+		_state->sleeping.fetch_sub(1);
+	}
+
+	t_jobSystem = nullptr;
+}
+
+void JobSystem::stopWorkers() {
+	_state->quit.store(true);
+	signalWork(_workerCount);
+}
+
+namespace {
+
+struct ParallelFor {
+	void (*proc)(const void *func, uint first, uint last);
+	const void *func;
+	uint end;
+	uint grain;
+	std::atomic<uint> next;
+};
+
+void runParallelFor(void *data) {
+	ParallelFor &range = *(ParallelFor *)data;
+
+	// The ranges are handed out one at a time, so that the threads which
+	// are done first take more of them
+	for (;;) {
+		const uint first = range.next.fetch_add(range.grain, std::memory_order_relaxed);
+		if (first >= range.end)
+			break;
+		range.proc(range.func, first, MIN(range.end - first, range.grain) + first);
+	}
+}
+
+} // End of anonymous namespace
+
+void JobSystem::parallelForIntern(uint begin, uint end, uint grain, RangeProc proc, const void *func) {
+	if (!grain)
+		grain = 1;
+
+	ParallelFor range;
+	range.proc = proc;
+	range.func = func;
+	range.end = end;
+	range.grain = grain;
+	range.next.store(begin, std::memory_order_relaxed);
+
+	// The calling thread takes ranges too
+	const uint ranges = (end - begin + grain - 1) / grain;
+	const uint helpers = MIN(ranges, _workerCount + 1) - 1;
+
+	Group group;
+	for (uint i = 0; i < helpers; ++i)
+		run(group, runParallelFor, &range);
+	runParallelFor(&range);
+	wait(group);
+}
+
+JobSystem::Stats JobSystem::getStats() const {
+	Stats stats;
+	stats.jobs = _state->jobs.load(std::memory_order_relaxed);
+	stats.stolen = _state->stolen.load(std::memory_order_relaxed);
+	stats.inlined = _state->inlined.load(std::memory_order_relaxed);
+	stats.sleeps = _state->sleeps.load(std::memory_order_relaxed);
+	return stats;
+}
+
+} // End of namespace Common
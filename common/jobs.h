@@ -0,0 +1,175 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_JOBS_H
+#define COMMON_JOBS_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_jobs Job system
+ * @ingroup common
+ *
+ * @brief Pool of worker threads which run short jobs in parallel.
+ * @{
+ */
+
+/**
+ * The job system runs short jobs on a fixed pool of worker threads, see
+ * OSystem::getJobSystem().
+ *
+ * Each worker has its own queue. A thread pushes the jobs it creates to its
+ * own queue and takes them back in the reverse order, while idle workers
+ * steal the oldest jobs from the queues of the others. A thread waiting for
+ * a group of jobs runs queued jobs meanwhile, so jobs may create and wait
+ * for jobs of their own.
+ *
+ * This base class has no workers: jobs run on the thread which waits for
+ * them. Backends with threads derive from it to start the workers.
+ *
+ * Jobs must not wait for events of the engine or call into OSystem, as the
+ * workers are not the thread of the engine.
+ */
+class JobSystem : NonCopyable {
+public:
+	typedef void (*Proc)(void *data);
+
+	/** Largest number of workers. */
+	static const uint kMaxWorkers = 16;
+
+	/** A set of jobs which can be waited for together. */
+	class Group : NonCopyable {
+	public:
+		Group();
+		~Group();
+
+		/** Return true once all the jobs of the group have completed. */
+		bool isDone() const;
+
+	private:
+		friend class JobSystem;
+
+		// Storage of the atomic counter of the jobs not completed yet,
+		// which is hidden from the header
+		uint64 _pending;
+	};
+
+	/** Statistics of the use of the job system since it was created. */
+	struct Stats {
+		uint32 jobs;          ///< Number of jobs run
+		uint32 stolen;        ///< Number of jobs run by another thread than the one which created them
+		uint32 inlined;       ///< Number of jobs run at once as their queue was full or there are no workers
+		uint32 sleeps;        ///< Number of times a worker went to sleep for lack of jobs
+	};
+
+	JobSystem();
+	virtual ~JobSystem();
+
+	/** Return the number of worker threads, 0 when jobs run on the waiting thread. */
+	uint getWorkerCount() const { return _workerCount; }
+
+	/**
+	 * Queue a job calling @p proc with @p data, and add it to @p group. The
+	 * data must remain valid until the group is done.
+	 */
+	void run(Group &group, Proc proc, void *data);
+
+	/** Run queued jobs until all the jobs of @p group have completed. */
+	void wait(Group &group);
+
+	/**
+	 * Call @p func(first, last) on consecutive ranges of at most @p grain
+	 * indices covering [begin, end), in parallel, and return once all the
+	 * calls have returned. Without workers, @p func is called once on the
+	 * whole range.
+	 */
+	template<class Func>
+	void parallelFor(uint begin, uint end, uint grain, const Func &func) {
+		if (end <= begin)
+			return;
+		if (!_workerCount || end - begin <= grain) {
+			func(begin, end);
+			return;
+		}
+		parallelForIntern(begin, end, grain, &callRange<Func>, &func);
+	}
+
+	Stats getStats() const;
+
+protected:
+	/**
+	 * Allocate the queues of @p count workers. Backends call this before
+	 * they start the worker threads.
+	 */
+	void initWorkers(uint count);
+
+	/**
+	 * Body of the worker thread @p index. It returns once stopWorkers() has
+	 * been called.
+	 */
+	void runWorker(uint index);
+
+	/**
+	 * Make runWorker() return in all the workers. Backends call this before
+	 * they join the worker threads.
+	 */
+	void stopWorkers();
+
+	/** Block the calling worker until signalWork() is called. */
+	virtual void waitForWork() {}
+
+	/** Wake up to @p count workers blocked in waitForWork(). */
+	virtual void signalWork(uint count) {}
+
+	/** Let other threads run, while a thread waits for jobs taken by others. */
+	virtual void yieldThread() {}
+
+private:
+	struct Job;
+	struct Queue;
+	struct State;
+
+	typedef void (*RangeProc)(const void *func, uint first, uint last);
+
+	template<class Func>
+	static void callRange(const void *func, uint first, uint last) {
+		(*(const Func *)func)(first, last);
+	}
+
+	void parallelForIntern(uint begin, uint end, uint grain, RangeProc proc, const void *func);
+
+	bool takeJob(uint queue, Job &job);
+	bool hasJobs() const;
+	void execute(const Job &job);
+	uint getQueueIndex() const;
+
+	uint _workerCount;
+	State *_state;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
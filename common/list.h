@@ -23,6 +23,7 @@
 #define COMMON_LIST_H
 
 #include "common/list_intern.h"
+#include "common/memory.h"
 
 namespace Common {
 
@@ -39,12 +40,15 @@ namespace Common {
 /**
  * Simple doubly linked list, modeled after the list template of the standard
  * C++ library.
+ *
+ * The nodes are obtained from @p Alloc, see Common::Allocator.
  */
-template<typename t_T>
-class List {
+template<typename t_T, class Alloc = Allocator<t_T> >
+class List : private Alloc {
 protected:
 	typedef ListInternal::NodeBase		NodeBase; /*!< @todo Doc required. */
 	typedef ListInternal::Node<t_T>		Node;     /*!< An element of the doubly linked list. */
+	typedef typename Alloc::template rebind<Node>::other NodeAllocator; /*!< Allocator of the nodes. */
 
 	NodeBase _anchor; /*!< Pointer to the position of the element in the list. */
 
@@ -54,13 +58,18 @@ public:
 
 	typedef t_T value_type; /*!< Value type of the list. */
 	typedef uint size_type; /*!< Size type of the list. */
+	typedef Alloc allocator_type; /*!< Allocator of the list nodes. */
 
 public:
 	/**
 	 * Construct a new empty list.
 	 */
 	constexpr List() : _anchor(&_anchor, &_anchor) {}
-	List(const List<t_T> &list) {  /*!< Construct a new list as a copy of the given @p list. */
+	/**
+	 * Construct a new empty list whose nodes are obtained from @p allocator.
+	 */
+	explicit List(const Alloc &allocator) : Alloc(allocator), _anchor(&_anchor, &_anchor) {}
+	List(const List &list) : Alloc(list.get_allocator()) {  /*!< Construct a new list as a copy of the given @p list. */
 		_anchor._prev = &_anchor;
 		_anchor._next = &_anchor;
 
@@ -174,7 +183,7 @@ public:
 	}
 
 	/** Assign a given @p list to this list. */
-	List<t_T> &operator=(const List<t_T> &list) {
+	List &operator=(const List &list) {
 		if (this != &list) {
 			iterator i;
 			const iterator e = end();
@@ -208,7 +217,7 @@ public:
 		while (pos != &_anchor) {
 			Node *node = static_cast<Node *>(pos);
 			pos = pos->_next;
-			delete node;
+			destroyNode(node);
 		}
 
 		_anchor._prev = &_anchor;
@@ -262,7 +271,31 @@ public:
 		return const_iterator(const_cast<NodeBase *>(&_anchor));
 	}
 
+	/** Return a copy of the allocator of the list nodes. */
+	Alloc get_allocator() const {
+		return *this;
+	}
+
 protected:
+	/**
+	 * Allocate and construct a node holding a copy of @p element.
+	 */
+	Node *createNode(const t_T &element) {
+		NodeAllocator allocator(get_allocator());
+		Node *node = allocator.allocate(1);
+		assert(node);
+		return new ((void *)node) Node(element);
+	}
+
+	/**
+	 * Destroy and free a node.
+	 */
+	void destroyNode(Node *node) {
+		NodeAllocator allocator(get_allocator());
+		node->~Node();
+		allocator.deallocate(node, 1);
+	}
+
 	/**
 	 * Erase an element at @p pos.
 	 */
@@ -271,7 +304,7 @@ protected:
 		Node *node = static_cast<Node *>(pos);
 		n._prev->_next = n._next;
 		n._next->_prev = n._prev;
-		delete node;
+		destroyNode(node);
 		return n;
 	}
 
@@ -279,8 +312,7 @@ protected:
 	 * Insert an @p element before @p pos.
 	 */
 	void insert(NodeBase *pos, const t_T &element) {
-		ListInternal::NodeBase *newNode = new Node(element);
-		assert(newNode);
+		ListInternal::NodeBase *newNode = createNode(element);
 
 		newNode->_next = pos;
 		newNode->_prev = pos->_prev;
@@ -96,6 +96,41 @@ void uninitialized_fill_n(Type *dst, size_t n, const Value &x) {
 		new ((void *)dst++) Type(x);
 }
 
+/**
+ * The default allocator of the containers, modeled after std::allocator.
+ * It allocates uninitialized memory from the heap.
+ *
+ * Allocators passed to the containers instead must provide the same
+ * members. They may hold state, which the containers copy along with
+ * their elements.
+ */
+template<class T>
+struct Allocator {
+	typedef T value_type;
+
+	template<class U>
+	struct rebind {
+		typedef Allocator<U> other;
+	};
+
+	constexpr Allocator() {}
+	template<class U>
+	constexpr Allocator(const Allocator<U> &) {}
+
+	/** Allocate memory for @p n objects, or return nullptr on failure. */
+	T *allocate(size_t n) {
+		return (T *)malloc(n * sizeof(T));
+	}
+
+	/** Free memory obtained from allocate() for @p n objects. */
+	void deallocate(T *p, size_t n) {
+		free(p);
+	}
+
+	bool operator==(const Allocator &) const { return true; }
+	bool operator!=(const Allocator &) const { return false; }
+};
+
 /** @} */
 
 } // End of namespace Common
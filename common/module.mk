@@ -13,9 +13,12 @@ MODULE_OBJS := \
 	error.o \
 	events.o \
 	file.o \
+	framearena.o \
 	fs.o \
+	fsindex.o \
 	gui_options.o \
 	hashmap.o \
+	jobs.o \
 	language.o \
 	localization.o \
 	macresman.o \
@@ -54,6 +57,11 @@ MODULE_OBJS += \
 	recorderfile.o
 endif
 
+ifdef ENABLE_TRACING
+MODULE_OBJS += \
+	trace.o
+endif
+
 ifdef USE_UPDATES
 MODULE_OBJS += \
 	updates.o
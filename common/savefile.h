@@ -276,6 +276,29 @@ public:
 	 * @return true if the file exists. false otherwise.
 	 */
 	virtual bool exists(const String &name) = 0;
+
+	/**
+	 * Open the cached metadata entry of the given save file for reading.
+	 *
+	 * The metadata index lets save/load dialogs show descriptions, dates
+	 * and thumbnails without decompressing every save. An entry is only
+	 * returned while the save file is unchanged since the entry was written.
+	 * The contents of the entry are opaque to the SaveFileManager.
+	 *
+	 * @param name  Name of the save file the entry belongs to.
+	 * @return Pointer to an InSaveFile, or NULL if there is no valid entry.
+	 */
+	virtual InSaveFile *openMetaInfoCache(const String &name) { return nullptr; }
+
+	/**
+	 * Open the cached metadata entry of the given save file for writing.
+	 * The entry is bound to the current state of the save file, which must
+	 * exist.
+	 *
+	 * @param name  Name of the save file the entry belongs to.
+	 * @return Pointer to an OutSaveFile, or NULL if the index is unavailable.
+	 */
+	virtual OutSaveFile *openMetaInfoCacheForSaving(const String &name) { return nullptr; }
 };
 
 /** @} */
@@ -792,6 +792,19 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Obtain a pointer to the next @p size bytes of the stream, for streams
+	 * which hold their whole data in memory, like memory mapped files.
+	 *
+	 * This lets the caller use the data where it is instead of copying it.
+	 * The position indicator is not moved, and the pointer remains valid
+	 * until the stream is destroyed.
+	 *
+	 * @return The pointer, or nullptr if the data is not in memory or fewer
+	 *         than @p size bytes are left.
+	 */
+	virtual const byte *getPointer(uint32 size) const { return nullptr; }
+
 	/**
 	 * Read at most one less than the number of characters specified
 	 * by @p bufSize from the stream and store them in the string buffer.
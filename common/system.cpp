@@ -27,6 +27,7 @@
 #include "common/file.h"
 #include "common/savefile.h"
 #include "common/str.h"
+#include "common/jobs.h"
 #include "common/taskbar.h"
 #include "common/updates.h"
 #include "common/dialogs.h"
@@ -45,6 +46,7 @@ OSystem::OSystem() {
 	_audiocdManager = nullptr;
 	_eventManager = nullptr;
 	_timerManager = nullptr;
+	_jobSystem = nullptr;
 	_savefileManager = nullptr;
 #if defined(USE_TASKBAR)
 	_taskbarManager = nullptr;
@@ -71,6 +73,9 @@ OSystem::~OSystem() {
 	delete _timerManager;
 	_timerManager = nullptr;
 
+	delete _jobSystem;
+	_jobSystem = nullptr;
+
 #if defined(USE_TASKBAR)
 	delete _taskbarManager;
 	_taskbarManager = nullptr;
@@ -259,6 +264,12 @@ Common::TimerManager *OSystem::getTimerManager() {
 	return _timerManager;
 }
 
+Common::JobSystem *OSystem::getJobSystem() {
+	if (!_jobSystem)
+		_jobSystem = new Common::JobSystem();
+	return _jobSystem;
+}
+
 Common::SaveFileManager *OSystem::getSavefileManager() {
 	return _savefileManager;
 }
@@ -69,6 +69,7 @@ class TextToSpeechManager;
 #if defined(USE_SYSDIALOGS)
 class DialogManager;
 #endif
+class JobSystem;
 class TimerManager;
 class SeekableReadStream;
 class WriteStream;
@@ -210,6 +211,15 @@ protected:
 	 */
 	Common::TimerManager *_timerManager;
 
+	/**
+	 * No default value is provided for _jobSystem by OSystem. However,
+	 * getJobSystem() creates one without workers if none has been set
+	 * before.
+	 *
+	 * @note _jobSystem is deleted by the OSystem destructor.
+	 */
+	Common::JobSystem *_jobSystem;
+
 	/**
 	 * No default value is provided for _savefileManager by OSystem.
 	 *
@@ -1549,6 +1559,17 @@ public:
 	 */
 	virtual Common::TimerManager *getTimerManager();
 
+	/**
+	 * Return the job system, which runs short jobs in parallel on a pool of
+	 * worker threads.
+	 *
+	 * Backends without threads get a job system which runs the jobs on the
+	 * thread waiting for them.
+	 *
+	 * For more information, see @ref JobSystem.
+	 */
+	virtual Common::JobSystem *getJobSystem();
+
 	/**
 	 * Return the event manager singleton.
 	 *
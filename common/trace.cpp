@@ -0,0 +1,204 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// The standard headers must come before the forbidden symbols are defined
+#include <atomic>
+#include <chrono>
+
+#include "common/trace.h"
+#include "common/array.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 8192
+#endif
+
+namespace Common {
+
+namespace {
+
+enum TraceEventType {
+	kTraceZone,
+	kTraceCounter,
+	kTraceFrame
+};
+
+struct TraceEvent {
+	const char *name;
+	uint64 time;
+	int64 value; // The duration of a zone, or the value of a counter
+	TraceEventType type;
+};
+
+/**
+ * The ring buffer of a thread. Only its thread writes events, and publishes
+ * them by incrementing the head. A reader copies the events, then checks the
+ * head again to drop those the thread overwrote meanwhile.
+ *
+ * The buffers are never freed, as a reader may access them at any time.
+ */
+struct TraceBuffer {
+	TraceEvent events[TRACE_BUFFER_SIZE];
+	std::atomic<uint32> head;
+	std::atomic<uint32> tail;
+	std::atomic<const char *> threadName;
+	uint32 threadId;
+	TraceBuffer *next;
+};
+
+std::atomic<TraceBuffer *> g_traceBuffers(nullptr);
+std::atomic<uint32> g_traceThreads(0);
+thread_local TraceBuffer *t_traceBuffer = nullptr;
+
+uint64 getTraceMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceBuffer *getTraceBuffer() {
+	TraceBuffer *buffer = t_traceBuffer;
+	if (buffer)
+		return buffer;
+
+	buffer = new TraceBuffer();
+	buffer->head.store(0, std::memory_order_relaxed);
+	buffer->tail.store(0, std::memory_order_relaxed);
+	buffer->threadName.store(nullptr, std::memory_order_relaxed);
+	buffer->threadId = ++g_traceThreads;
+	buffer->next = g_traceBuffers.load(std::memory_order_relaxed);
+	while (!g_traceBuffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+		;
+	t_traceBuffer = buffer;
+	return buffer;
+}
+
+void addTraceEvent(TraceEventType type, const char *name, uint64 time, int64 value) {
+	TraceBuffer *buffer = getTraceBuffer();
+	const uint32 head = buffer->head.load(std::memory_order_relaxed);
+	TraceEvent &event = buffer->events[head % TRACE_BUFFER_SIZE];
+	event.name = name;
+	event.time = time;
+	event.value = value;
+	event.type = type;
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * Copies the events of a buffer which are still valid, oldest first. The
+ * thread of the buffer fills the slot at its head before it moves the head,
+ * so that slot is never read.
+ */
+void readTraceBuffer(const TraceBuffer &buffer, Array<TraceEvent> &events) {
+	const uint32 head = buffer.head.load(std::memory_order_acquire);
+	uint32 first = buffer.tail.load(std::memory_order_relaxed);
+	if (head - first >= TRACE_BUFFER_SIZE)
+		first = head - TRACE_BUFFER_SIZE + 1;
+
+	events.clear();
+	events.reserve(head - first);
+	for (uint32 i = first; i != head; ++i)
+		events.push_back(buffer.events[i % TRACE_BUFFER_SIZE]);
+
+	// The events the thread wrote meanwhile may have overwritten the oldest
+	// ones, up to the slot it may be filling now
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint32 newHead = buffer.head.load(std::memory_order_relaxed);
+	const uint32 overwritten = newHead - first >= TRACE_BUFFER_SIZE ? newHead - first - TRACE_BUFFER_SIZE + 1 : 0;
+	if (overwritten)
+		events.erase(events.begin(), events.begin() + MIN<uint32>(overwritten, events.size()));
+}
+
+String escapeTraceName(const char *name) {
+	String escaped;
+	for (const char *c = name; *c; ++c) {
+		if (*c == '"' || *c == '\\')
+			escaped += '\\';
+		if ((byte)*c >= 0x20)
+			escaped += *c;
+	}
+	return escaped;
+}
+
+} // End of anonymous namespace
+
+TraceZone::TraceZone(const char *name) : _name(name), _start(getTraceMicros()) {
+}
+
+TraceZone::~TraceZone() {
+	addTraceEvent(kTraceZone, _name, _start, getTraceMicros() - _start);
+}
+
+void traceCounter(const char *name, int64 value) {
+	addTraceEvent(kTraceCounter, name, getTraceMicros(), value);
+}
+
+void traceFrame(const char *name) {
+	addTraceEvent(kTraceFrame, name, getTraceMicros(), 0);
+}
+
+void traceThreadName(const char *name) {
+	getTraceBuffer()->threadName.store(name, std::memory_order_relaxed);
+}
+
+void clearTrace() {
+	for (TraceBuffer *buffer = g_traceBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+bool writeTrace(WriteStream &stream) {
+	stream.writeString("{\"traceEvents\":[\n");
+
+	Array<TraceEvent> events;
+	bool first = true;
+	for (TraceBuffer *buffer = g_traceBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		const char *threadName = buffer->threadName.load(std::memory_order_relaxed);
+		if (threadName) {
+			stream.writeString(String::format("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			                                  first ? "" : ",\n", buffer->threadId, escapeTraceName(threadName).c_str()));
+			first = false;
+		}
+
+		readTraceBuffer(*buffer, events);
+		for (uint i = 0; i < events.size(); ++i) {
+			const TraceEvent &event = events[i];
+			String line = String::format("%s{\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%llu",
+			                             first ? "" : ",\n", escapeTraceName(event.name).c_str(), buffer->threadId, (unsigned long long)event.time);
+			switch (event.type) {
+			case kTraceZone:
+				line += String::format(",\"ph\":\"X\",\"dur\":%lld}", (long long)event.value);
+				break;
+			case kTraceCounter:
+				line += String::format(",\"ph\":\"C\",\"args\":{\"value\":%lld}}", (long long)event.value);
+				break;
+			case kTraceFrame:
+				line += ",\"ph\":\"i\",\"s\":\"g\"}";
+				break;
+			}
+			stream.writeString(line);
+			first = false;
+		}
+	}
+
+	stream.writeString("\n],\"displayTimeUnit\":\"ms\"}\n");
+	return !stream.err();
+}
+
+} // End of namespace Common
@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_TRACE_H
+#define COMMON_TRACE_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+/**
+ * @defgroup common_trace Tracing
+ * @ingroup common
+ *
+ * @brief  Instrumentation of hot paths, exported as Chrome trace JSON.
+ *
+ * Tracing is only built when ScummVM is configured with --enable-tracing.
+ * Otherwise the TRACE_* macros expand to nothing, and their arguments are
+ * not evaluated.
+ *
+ * Each thread records its events to its own ring buffer without locking.
+ * Once a buffer is full, the oldest events are overwritten. The buffers can
+ * be written at any time as JSON for chrome://tracing or Perfetto, with the
+ * "trace" command of the debugger console.
+ *
+ * The names given to the macros must be string literals, or strings which
+ * outlive the trace.
+ * @{
+ */
+
+#ifdef ENABLE_TRACING
+
+namespace Common {
+
+class WriteStream;
+
+/** Records a zone which lasts for the lifetime of the object. */
+class TraceZone : NonCopyable {
+public:
+	explicit TraceZone(const char *name);
+	~TraceZone();
+
+private:
+	const char *_name;
+	uint64 _start;
+};
+
+/** Records the value of a counter. */
+void traceCounter(const char *name, int64 value);
+
+/** Records the end of a frame. */
+void traceFrame(const char *name);
+
+/** Names the calling thread in the trace. */
+void traceThreadName(const char *name);
+
+/** Discards the events recorded so far. */
+void clearTrace();
+
+/** Writes the events recorded so far as Chrome trace JSON. */
+bool writeTrace(WriteStream &stream);
+
+} // End of namespace Common
+
+#define TRACE_CONCAT_INTERN(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INTERN(a, b)
+
+#define TRACE_ZONE(name) Common::TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_COUNTER(name, value) Common::traceCounter(name, value)
+#define TRACE_FRAME(name) Common::traceFrame(name)
+#define TRACE_THREAD_NAME(name) Common::traceThreadName(name)
+
+#else
+
+#define TRACE_ZONE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_FRAME(name) do {} while (0)
+#define TRACE_THREAD_NAME(name) do {} while (0)
+
+#endif
+
+/** @} */
+
+#endif
@@ -30,7 +30,6 @@
 
 namespace Common {
 
-template<class T> class Array;
 class SeekableReadStream;
 
 /**
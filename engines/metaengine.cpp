@@ -26,6 +26,7 @@
 #include "backends/keymapper/keymap.h"
 #include "backends/keymapper/standard-actions.h"
 
+#include "common/config-manager.h"
 #include "common/savefile.h"
 #include "common/system.h"
 #include "common/translation.h"
@@ -472,3 +473,21 @@ SaveStateDescriptor MetaEngine::querySaveMetaInfos(const char *target, int slot)
 
 	return SaveStateDescriptor();
 }
+
+SaveStateDescriptor MetaEngine::querySaveMetaInfosCached(const char *target, int slot) const {
+	if (!ConfMan.getBool("gui_saveload_metaindex"))
+		return querySaveMetaInfos(target, slot);
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	const Common::String filename = getSavegameFile(slot, target);
+
+	SaveStateDescriptor desc(this, slot, Common::U32String());
+	if (desc.loadMetaInfoCache(*saveFileMan, filename))
+		return desc;
+
+	desc = querySaveMetaInfos(target, slot);
+	if (desc.isValid())
+		desc.saveMetaInfoCache(*saveFileMan, filename);
+
+	return desc;
+}
@@ -358,6 +358,19 @@ public:
 	 */
 	virtual SaveStateDescriptor querySaveMetaInfos(const char *target, int slot) const;
 
+	/**
+	 * Return meta information from the specified save state, going through
+	 * the save metadata index of the SaveFileManager when possible.
+	 *
+	 * This is meant for save/load dialogs, which query many slots at once:
+	 * only saves without an up-to-date index entry are opened and decoded
+	 * through querySaveMetaInfos(), and their entry is written afterwards.
+	 *
+	 * @param target  Name of a config manager target.
+	 * @param slot    Slot number of the save state.
+	 */
+	SaveStateDescriptor querySaveMetaInfosCached(const char *target, int slot) const;
+
 	/**
 	 * Return the name of the save file for the given slot and optional target,
 	 * or a pattern for matching filenames against.
@@ -22,8 +22,13 @@
 #include "engines/savestate.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
+#include "graphics/scaler.h"
 #include "graphics/surface.h"
+#include "graphics/thumbnail.h"
 #include "common/config-manager.h"
+#include "common/ptr.h"
+#include "common/savefile.h"
+#include "common/stream.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 
@@ -111,3 +116,91 @@ bool SaveStateDescriptor::isValid() const
 {
 	return _slot >= 0 && !_description.empty();
 }
+
+void SaveStateDescriptor::saveMetaInfoCache(Common::WriteStream &out) const {
+	const Common::String description = _description.encode();
+	out.writeUint32BE(description.size());
+	out.writeString(description);
+	out.writeByte(_saveDate.size());
+	out.writeString(_saveDate);
+	out.writeByte(_saveTime.size());
+	out.writeString(_saveTime);
+	out.writeByte(_playTime.size());
+	out.writeString(_playTime);
+	out.writeUint32BE(_playTimeMSecs);
+	out.writeByte(_isDeletable);
+	out.writeByte(_isWriteProtected);
+	out.writeByte(_saveType);
+
+	const Graphics::Surface *thumbnail = _thumbnail.get();
+	if (!thumbnail) {
+		out.writeByte(0);
+		return;
+	}
+
+	out.writeByte(1);
+	if (thumbnail->w <= kThumbnailWidth && thumbnail->h <= kThumbnailHeight2) {
+		Graphics::saveThumbnail(out, *thumbnail);
+		return;
+	}
+
+	// Scale down to the dialog size once here instead of on every display
+	int w = kThumbnailWidth;
+	int h = thumbnail->h * kThumbnailWidth / thumbnail->w;
+	if (h > kThumbnailHeight2) {
+		h = kThumbnailHeight2;
+		w = thumbnail->w * kThumbnailHeight2 / thumbnail->h;
+	}
+	Graphics::Surface *scaled = thumbnail->scale(MAX(w, 1), MAX(h, 1), true);
+	Graphics::saveThumbnail(out, *scaled);
+	scaled->free();
+	delete scaled;
+}
+
+bool SaveStateDescriptor::loadMetaInfoCache(Common::SeekableReadStream &in) {
+	const uint32 descriptionSize = in.readUint32BE();
+	if (descriptionSize > (uint32)(in.size() - in.pos()))
+		return false;
+	_description = in.readString(0, descriptionSize).decode();
+	_saveDate = in.readString(0, in.readByte());
+	_saveTime = in.readString(0, in.readByte());
+	_playTime = in.readString(0, in.readByte());
+	_playTimeMSecs = in.readUint32BE();
+	_isDeletable = in.readByte() != 0;
+	_isWriteProtected = in.readByte() != 0;
+	_saveType = (SaveType)in.readByte();
+
+	const bool hasThumbnail = in.readByte() != 0;
+	if (in.err() || in.eos())
+		return false;
+
+	_thumbnail.reset();
+	if (hasThumbnail) {
+		Graphics::Surface *thumbnail = nullptr;
+		if (!Graphics::loadThumbnail(in, thumbnail))
+			return false;
+		setThumbnail(thumbnail);
+	}
+
+	// Thumbnails are read without checking for the end of the stream
+	return !in.err() && !in.eos();
+}
+
+bool SaveStateDescriptor::saveMetaInfoCache(Common::SaveFileManager &saveFileMan, const Common::String &filename) const {
+	Common::ScopedPtr<Common::OutSaveFile> out(saveFileMan.openMetaInfoCacheForSaving(filename));
+	if (!out)
+		return false;
+
+	saveMetaInfoCache(*out);
+	out->finalize();
+	if (out->err()) {
+		warning("SaveStateDescriptor::saveMetaInfoCache: Failed to write metadata index entry for '%s'", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool SaveStateDescriptor::loadMetaInfoCache(Common::SaveFileManager &saveFileMan, const Common::String &filename) {
+	Common::ScopedPtr<Common::InSaveFile> in(saveFileMan.openMetaInfoCache(filename));
+	return in && loadMetaInfoCache(*in);
+}
@@ -29,6 +29,12 @@
 
 class MetaEngine;
 
+namespace Common {
+class SaveFileManager;
+class SeekableReadStream;
+class WriteStream;
+}
+
 namespace Graphics {
 struct Surface;
 }
@@ -225,6 +231,38 @@ public:
 	 * Returns true if this entry is valid
 	 */
 	bool isValid() const;
+
+	/**
+	 * Serialize the descriptor into a save metadata index entry.
+	 * Thumbnails are stored pre-scaled to the save/load dialog size.
+	 *
+	 * @see Common::SaveFileManager::openMetaInfoCacheForSaving
+	 */
+	void saveMetaInfoCache(Common::WriteStream &out) const;
+
+	/**
+	 * Restore the descriptor from a save metadata index entry. The slot is
+	 * not part of the entry and is left untouched.
+	 *
+	 * @return true if the entry could be read, false otherwise.
+	 * @see Common::SaveFileManager::openMetaInfoCache
+	 */
+	bool loadMetaInfoCache(Common::SeekableReadStream &in);
+
+	/**
+	 * Write the save metadata index entry of the given save file.
+	 *
+	 * @return true if the entry was written, false otherwise.
+	 */
+	bool saveMetaInfoCache(Common::SaveFileManager &saveFileMan, const Common::String &filename) const;
+
+	/**
+	 * Restore the descriptor from the save metadata index entry of the
+	 * given save file, if it has an up-to-date one.
+	 *
+	 * @return true if the entry could be read, false otherwise.
+	 */
+	bool loadMetaInfoCache(Common::SaveFileManager &saveFileMan, const Common::String &filename);
 private:
 	/**
 	 * The saveslot id, as it would be passed to the "-x" command line switch.
@@ -44,6 +44,7 @@
 #include "sci/graphics/cursor.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/paint16.h"
+#include "sci/graphics/picture_cache.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/ports.h"
 #include "sci/graphics/view.h"
@@ -117,6 +118,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
+	registerCmd("view_cache",		WRAP_METHOD(Console, cmdViewCache));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
@@ -132,6 +135,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("show_map",			WRAP_METHOD(Console, cmdShowMap));
 	registerCmd("set_palette",		WRAP_METHOD(Console, cmdSetPalette));
 	registerCmd("draw_pic",			WRAP_METHOD(Console, cmdDrawPic));
+	registerCmd("pic_benchmark",		WRAP_METHOD(Console, cmdPicBenchmark));
+	registerCmd("frame_benchmark",	WRAP_METHOD(Console, cmdFrameBenchmark));
 	registerCmd("draw_cel",			WRAP_METHOD(Console, cmdDrawCel));
 	registerCmd("undither",           WRAP_METHOD(Console, cmdUndither));
 	registerCmd("pic_visualize",		WRAP_METHOD(Console, cmdPicVisualize));
@@ -150,6 +155,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("vpi",                WRAP_METHOD(Console, cmdVisiblePlaneItemList));	// alias
 	registerCmd("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	registerCmd("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	registerCmd("frame_arena",        WRAP_METHOD(Console, cmdFrameArena));
 	// Segments
 	registerCmd("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	registerCmd("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -163,6 +169,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -233,6 +240,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("selector_cache",	WRAP_METHOD(Console, cmdSelectorCache));
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -357,6 +365,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_types - Shows the valid resource types\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
+	debugPrintf(" resource_cache - Shows memory usage and statistics of the resource cache\n");
+	debugPrintf(" view_cache - Shows memory usage and statistics of the view and font cache\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
@@ -374,6 +384,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" show_map - Switches to visual, priority, control or display screen\n");
 	debugPrintf(" set_palette - Sets a palette resource\n");
 	debugPrintf(" draw_pic - Draws a pic resource\n");
+	debugPrintf(" pic_benchmark - Draws all pic resources and shows how long rendering and the picture cache take\n");
+	debugPrintf(" frame_benchmark - Redraws the whole current frame and shows how long it takes (SCI2+)\n");
 	debugPrintf(" draw_cel - Draws a cel from a view resource\n");
 	debugPrintf(" pic_visualize - Enables visualization of the drawing process of EGA pictures\n");
 	debugPrintf(" undither - Enable/disable undithering\n");
@@ -386,6 +398,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" visible_plane_items / vpi - Shows a list of all items for a plane in the visible draw list (SCI2+)\n");
 	debugPrintf(" saved_bits - List saved bits on the hunk\n");
 	debugPrintf(" show_saved_bits - Display saved bits\n");
+	debugPrintf(" frame_arena - Shows the allocations of the draw lists of the frames (SCI2+)\n");
 	debugPrintf("\n");
 	debugPrintf("Segments:\n");
 	debugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -398,6 +411,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows timing statistics of the garbage collector\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -447,6 +461,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" selector_cache - Shows statistics of the selector lookup cache and sends per frame\n");
 	debugPrintf(" script_objects / scro - Shows all objects inside a specified script\n");
 	debugPrintf(" script_strings / scrs - Shows all strings inside a specified script\n");
 	debugPrintf(" script_said - Shows all said - strings inside a specified script\n");
@@ -1134,6 +1149,65 @@ bool Console::cmdAllocList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows memory usage and statistics of the resource cache\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		resMan->resetLRUStats();
+		debugPrintf("Resource cache statistics reset\n");
+		return true;
+	}
+
+	const ResourceManager::LRUStats &stats = resMan->getLRUStats();
+	const uint32 lookups = stats.hits + stats.misses;
+
+	debugPrintf("Budget: %d bytes\n", resMan->getMaxMemoryLRU());
+	debugPrintf("Cached: %d bytes (%d bytes decompressed), locked: %d bytes\n",
+				resMan->getMemoryLRU(), resMan->getMemoryResidentLRU(), resMan->getMemoryLocked());
+	debugPrintf("Lookups: %u, hits: %u (%u%%), misses: %u (%u bytes loaded)\n",
+				lookups, stats.hits, lookups ? stats.hits * 100 / lookups : 0, stats.misses, stats.loadedBytes);
+	debugPrintf("Evictions: %u (%u decompressed)\n", stats.evictions, stats.residentEvictions);
+	return true;
+}
+
+bool Console::cmdViewCache(int argc, const char **argv) {
+	GfxCache *cache = _engine->_gfxCache;
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows memory usage and statistics of the view and font cache\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	if (!cache) {
+		debugPrintf("The view cache is not available\n");
+		return true;
+	}
+
+	if (argc == 2) {
+		cache->resetStats();
+		debugPrintf("View cache statistics reset\n");
+		return true;
+	}
+
+	const GfxCache::Stats &stats = cache->getStats();
+	const uint32 lookups = stats.hits + stats.misses;
+
+	debugPrintf("Budget: %u bytes\n", cache->getViewBudget());
+	debugPrintf("Cached: %d views in %u bytes (as of the last miss), %d fonts\n",
+				cache->getViewCount(), cache->getViewMemory(), cache->getFontCount());
+	debugPrintf("Lookups: %u, hits: %u (%u%%), misses: %u\n",
+				lookups, stats.hits, lookups ? stats.hits * 100 / lookups : 0, stats.misses);
+	debugPrintf("Evictions: %u views, %u fonts\n", stats.evictions, stats.fontEvictions);
+	return true;
+}
+
 bool Console::cmdDissectScript(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Examines a script\n");
@@ -1513,8 +1587,17 @@ bool Console::cmdMapInstrument(int argc, const char **argv) {
 }
 
 bool Console::cmdAudioList(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Lists currently active digital audio samples, with mixing statistics\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
 #ifdef ENABLE_SCI32
-	if (_engine->_audio32) {
+	if (_engine->_audio32 && argc == 2) {
+		_engine->_audio32->resetMixStats();
+		debugPrintf("Mixing statistics reset\n");
+	} else if (_engine->_audio32) {
 		debugPrintf("Audio list (%d active channels):\n", _engine->_audio32->getNumActiveChannels());
 		_engine->_audio32->printAudioList(this);
 	} else {
@@ -2058,6 +2141,92 @@ bool Console::cmdDrawPic(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdPicBenchmark(int argc, const char **argv) {
+	if (!_engine->_gfxPaint16) {
+		debugPrintf("Command not available / implemented for SCI32 games.\n");
+		return true;
+	}
+
+	GfxPaint16 *paint16 = _engine->_gfxPaint16;
+	GfxPictureCache *pictureCache = paint16->getPictureCache();
+	Common::List<ResourceId> pictures = _engine->getResMan()->listResources(kResourceTypePic);
+	Common::sort(pictures.begin(), pictures.end());
+
+	if (pictureCache)
+		pictureCache->resetStats();
+
+	uint32 renderMillis = 0, cachedMillis = 0, slowestMillis = 0;
+	int slowestPicture = -1;
+	for (Common::List<ResourceId>::const_iterator it = pictures.begin(); it != pictures.end(); ++it) {
+		// Render the picture from scratch first, then once more from the cache
+		if (pictureCache)
+			pictureCache->clear();
+
+		uint32 start = g_system->getMillis();
+		paint16->kernelDrawPicture(it->getNumber(), 100, false, false, false, 0);
+		const uint32 millis = g_system->getMillis() - start;
+		renderMillis += millis;
+		if (millis >= slowestMillis) {
+			slowestMillis = millis;
+			slowestPicture = it->getNumber();
+		}
+
+		start = g_system->getMillis();
+		paint16->kernelDrawPicture(it->getNumber(), 100, false, false, false, 0);
+		cachedMillis += g_system->getMillis() - start;
+	}
+	_engine->_gfxScreen->copyToScreen();
+
+	debugPrintf("Drew %d pictures: %u ms rendering, %u ms redrawing\n", pictures.size(), renderMillis, cachedMillis);
+	if (slowestPicture != -1)
+		debugPrintf("Slowest picture: %d (%u ms)\n", slowestPicture, slowestMillis);
+	if (pictureCache) {
+		const GfxPictureCache::Stats &stats = pictureCache->getStats();
+		debugPrintf("Picture cache: %u hits, %u misses, %u not cacheable, budget %u bytes\n",
+					stats.hits, stats.misses, stats.uncacheable, pictureCache->getBudget());
+	} else {
+		debugPrintf("Picture cache is disabled\n");
+	}
+	return true;
+}
+
+bool Console::cmdFrameBenchmark(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (argc > 2) {
+		debugPrintf("Redraws every plane and screen item of the current frame\n");
+		debugPrintf("Usage: %s [<frames>]\n", argv[0]);
+		return true;
+	}
+
+	GfxFrameout *frameout = _engine->_gfxFrameout;
+	if (!frameout) {
+		debugPrintf("This SCI version does not have a frame renderer\n");
+		return true;
+	}
+
+	const int frames = argc == 2 ? atoi(argv[1]) : 100;
+	if (frames <= 0) {
+		debugPrintf("Invalid number of frames\n");
+		return true;
+	}
+
+	// Erasing the whole screen makes frameOut draw everything again, like
+	// after a room change
+	const Common::Rect screenRect(frameout->getScreenWidth(), frameout->getScreenHeight());
+	const uint32 start = g_system->getMillis();
+	for (int i = 0; i < frames; ++i) {
+		frameout->frameOut(false, screenRect);
+	}
+	const uint32 millis = g_system->getMillis() - start;
+	frameout->frameOut(true, screenRect);
+
+	debugPrintf("Drew %d frames in %u ms (%u us per frame)\n", frames, millis, millis * 1000 / frames);
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 bool Console::cmdDrawCel(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Draws a cel from a view resource\n");
@@ -2174,6 +2343,20 @@ bool Console::cmdPlaneList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdFrameArena(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (_engine->_gfxFrameout) {
+		debugPrintf("Frame arena:\n");
+		_engine->_gfxFrameout->printFrameArenaStats(this);
+	} else {
+		debugPrintf("This SCI version does not have a frame arena\n");
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 bool Console::cmdVisiblePlaneList(int argc, const char **argv) {
 #ifdef ENABLE_SCI32
 	if (_engine->_gfxFrameout) {
@@ -2828,6 +3011,35 @@ bool Console::cmdGCInvoke(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows timing statistics of the garbage collector\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	IncrementalGC *gc = _engine->_gamestate->_gc;
+
+	if (argc == 2) {
+		gc->resetStats();
+		debugPrintf("Garbage collector statistics reset\n");
+		return true;
+	}
+
+	const GCStats &stats = gc->getStats();
+
+	debugPrintf("Mode: %s, every %d kernel calls\n",
+				gc->isEnabled() ? "incremental" : "full", _engine->_gamestate->scriptGCInterval);
+	if (gc->isEnabled())
+		debugPrintf("Step budget: %u ms%s\n", gc->getStepBudget(), gc->isRunning() ? ", collecting now" : "");
+	debugPrintf("Collections: %u full, %u incremental in %u steps\n",
+				stats.fullRuns, stats.incrementalRuns, stats.steps);
+	debugPrintf("Objects freed: %u\n", stats.freed);
+	debugPrintf("Time: %u ms in total, longest pause %u ms, longest pause of the last collection %u ms\n",
+				stats.totalTime, stats.maxPause, stats.lastPause);
+	return true;
+}
+
 bool Console::cmdGCObjects(int argc, const char **argv) {
 	AddrSet *use_map = findAllActiveReferences(_engine->_gamestate);
 
@@ -3436,6 +3648,93 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	SegManager *segMan = _engine->_gamestate->_segMan;
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+
+	if (argc > 3 || (argc == 3 && strcmp(argv[1], "benchmark")) ||
+		(argc == 2 && strcmp(argv[1], "reset") && strcmp(argv[1], "on") && strcmp(argv[1], "off") && strcmp(argv[1], "benchmark"))) {
+		debugPrintf("Shows statistics of the selector lookup cache and sends per frame\n");
+		debugPrintf("Usage: %s [reset | on | off | benchmark [<iterations>]]\n", argv[0]);
+		debugPrintf("benchmark looks up all selectors of all loaded objects, with and without the cache\n");
+		return true;
+	}
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		cache.resetStats();
+		debugPrintf("Selector lookup cache statistics reset\n");
+		return true;
+	}
+
+	if (argc == 2 && (!strcmp(argv[1], "on") || !strcmp(argv[1], "off"))) {
+		cache.setEnabled(!strcmp(argv[1], "on"));
+		debugPrintf("Selector lookup cache %s\n", cache.isEnabled() ? "enabled" : "disabled");
+		return true;
+	}
+
+	if (argc >= 2) {
+		const int iterations = (argc == 3) ? atoi(argv[2]) : 100;
+		if (iterations <= 0) {
+			debugPrintf("Invalid number of iterations\n");
+			return true;
+		}
+
+		// The sends of a frame, as far as they can be recreated: every
+		// property and method of every loaded object
+		Common::Array<reg_t> objects;
+		Common::Array<Selector> selectors;
+		const Common::Array<SegmentObj *> &segments = segMan->getSegments();
+		for (uint i = 0; i < segments.size(); i++) {
+			if (!segments[i] || segments[i]->getType() != SEG_TYPE_SCRIPT)
+				continue;
+			const ObjMap &objMap = ((Script *)segments[i])->getObjectMap();
+			for (ObjMap::const_iterator it = objMap.begin(); it != objMap.end(); ++it) {
+				const Object &obj = it->_value;
+				const Object *objClass = obj.getClass(segMan);
+				if (objClass && getSciVersion() != SCI_VERSION_3) {
+					for (uint v = 0; v < objClass->getVarCount(); v++) {
+						objects.push_back(obj.getPos());
+						selectors.push_back(objClass->getVarSelector(v));
+					}
+				}
+				for (uint m = 0; m < obj.getMethodCount(); m++) {
+					objects.push_back(obj.getPos());
+					selectors.push_back(obj.getFuncSelector(m));
+				}
+			}
+		}
+
+		const bool enabled = cache.isEnabled();
+		uint32 millis[2];
+		for (int pass = 0; pass < 2; pass++) {
+			cache.setEnabled(pass == 1);
+			const uint32 start = g_system->getMillis();
+			for (int n = 0; n < iterations; n++) {
+				for (uint i = 0; i < objects.size(); i++)
+					lookupSelector(segMan, objects[i], selectors[i], nullptr, nullptr);
+			}
+			millis[pass] = g_system->getMillis() - start;
+		}
+		cache.setEnabled(enabled);
+
+		debugPrintf("%d x %d lookups: %d ms without cache, %d ms with cache\n",
+					iterations, objects.size(), millis[0], millis[1]);
+		return true;
+	}
+
+	const SelectorLookupCache::Stats &stats = cache.getStats();
+	const uint32 lookups = stats.hits + stats.misses;
+
+	debugPrintf("Cache: %s, %d entries, cleared %u times\n", cache.isEnabled() ? "enabled" : "disabled",
+				cache.getEntryCount(), stats.invalidations);
+	debugPrintf("Lookups: %u, hits: %u (%u%%), misses: %u\n",
+				lookups, stats.hits, lookups ? stats.hits * 100 / lookups : 0, stats.misses);
+	debugPrintf("Sends: %u in %u frames, last frame: %u, most in a frame: %u, average: %u\n",
+				stats.sends, stats.frames, stats.lastFrameSends, stats.maxFrameSends,
+				stats.frames ? stats.sends / stats.frames : 0);
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("Shows all objects inside a specified script.\n");
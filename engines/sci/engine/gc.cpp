@@ -21,6 +21,8 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/config-manager.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -98,11 +100,9 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void pushRootSet(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -169,8 +169,13 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
 
-	processWorkList(s->_segMan, wm, heap);
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+
+	pushRootSet(s, wm);
+	processWorkList(s->_segMan, wm, s->_segMan->getSegments());
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
@@ -178,11 +183,8 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
-
-	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
+static uint32 freeUnreachable(SegManager *segMan, const AddrSet &activeRefs) {
+	uint32 freed = 0;
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -190,9 +192,6 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
-
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
@@ -210,10 +209,11 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -223,8 +223,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -232,6 +230,192 @@ void run_gc(EngineState *s) {
 		if (segcount[i])
 			debugC(kDebugLevelGC, "\t%d\t* %s", segcount[i], segnames[i]);
 #endif
+
+	return freed;
+}
+
+static void recordPause(GCStats &stats, uint32 pause) {
+	stats.totalTime += pause;
+	stats.lastPause = MAX(stats.lastPause, pause);
+	stats.maxPause = MAX(stats.maxPause, pause);
+}
+
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+
+	// Some debug stuff
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	// Whatever an incremental collection has marked so far is redone here
+	s->_gc->cancel(segMan);
+
+	// Compute the set of all segments references currently in use.
+	AddrSet *activeRefs = findAllActiveReferences(s);
+
+	GCStats &stats = s->_gc->getStats();
+	stats.freed += freeUnreachable(segMan, *activeRefs);
+
+	delete activeRefs;
+
+	stats.fullRuns++;
+	stats.lastPause = 0;
+	recordPause(stats, g_system->getMillis() - startTime);
+}
+
+/**
+ * Number of steps which may find too much to mark to finish the collection
+ * within their budget, before one finishes it whatever it takes.
+ */
+static const uint kMaxFinishAttempts = 8;
+
+IncrementalGC::IncrementalGC() : _state(kStateIdle), _stackSegment(0), _finishAttempts(0) {
+	_enabled = ConfMan.hasKey("sci_gc_incremental") && ConfMan.getBool("sci_gc_incremental");
+	_stepBudget = ConfMan.hasKey("sci_gc_step_ms") ? MAX(ConfMan.getInt("sci_gc_step_ms"), 1) : 2;
+	resetStats();
+}
+
+void IncrementalGC::resetStats() {
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+void IncrementalGC::start() {
+	if (_state == kStateIdle)
+		_state = kStatePending;
+}
+
+void IncrementalGC::cancel(SegManager *segMan) {
+	if (_state == kStateMarking)
+		segMan->setGCWriteBarrier(nullptr);
+
+	_state = kStateIdle;
+	_wm._worklist.clear();
+	_wm._map.clear();
+	_writes.clear();
+	_finishAttempts = 0;
+}
+
+void IncrementalGC::scan(const Common::Array<SegmentObj *> &heap, reg_t reg) {
+	const SegmentId seg = reg.getSegment();
+	if (seg == _stackSegment || seg >= heap.size() || !heap[seg])
+		return;
+
+	// Scripts may be unloaded and lists freed while marking, and their
+	// segments reused
+	SegmentObj *mobj = heap[seg];
+	if (!mobj->isValidOffset(reg.getOffset()))
+		return;
+
+	debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
+	_wm.pushArray(mobj->listAllOutgoingReferences(reg));
+}
+
+bool IncrementalGC::mark(const Common::Array<SegmentObj *> &heap, uint32 startTime, bool bounded) {
+	// Looking at the clock is not free, so only do it every so often
+	uint count = 0;
+	while (!_wm._worklist.empty()) {
+		if (bounded && (++count & 63) == 0 && g_system->getMillis() - startTime >= _stepBudget)
+			return false;
+
+		const reg_t reg = _wm._worklist.back();
+		_wm._worklist.pop_back();
+		scan(heap, reg);
+	}
+	return true;
+}
+
+void IncrementalGC::rescanWrites(const Common::Array<SegmentObj *> &heap) {
+	AddrSet writes;
+	SWAP(writes, _writes);
+	for (AddrSet::const_iterator it = writes.begin(); it != writes.end(); ++it)
+		scan(heap, it->_key);
+}
+
+void IncrementalGC::recordFrames(EngineState *s) {
+	// The frames write to their objects and locals, and to the globals,
+	// without looking them up again
+	for (Common::List<ExecStack>::const_iterator it = s->_executionStack.begin(); it != s->_executionStack.end(); ++it) {
+		if (it->type == EXEC_STACK_TYPE_KERNEL)
+			continue;
+
+		_writes.setVal(it->objp, true);
+		const Script *script = s->_segMan->getScriptIfLoaded(it->local_segment);
+		if (script && script->getLocalsSegment())
+			_writes.setVal(make_reg(script->getLocalsSegment(), 0), true);
+	}
+
+	if (s->variablesSegment[VAR_GLOBAL])
+		_writes.setVal(make_reg(s->variablesSegment[VAR_GLOBAL], 0), true);
+}
+
+void IncrementalGC::step(EngineState *s) {
+	if (_state == kStateIdle)
+		return;
+
+	// Kernel calls keep pointers to lists and nodes while they run scripts
+	for (Common::List<ExecStack>::const_iterator it = s->_executionStack.begin(); it != s->_executionStack.end(); ++it) {
+		if (it->type == EXEC_STACK_TYPE_KERNEL)
+			return;
+	}
+
+	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+
+	if (_state == kStatePending) {
+		debugC(kDebugLevelGC, "[GC] Starting incremental collection...");
+		_stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
+		pushRootSet(s, _wm);
+		segMan->setGCWriteBarrier(&_writes);
+		_state = kStateMarking;
+		_stats.incrementalRuns++;
+		_stats.lastPause = 0;
+	}
+
+	// Scan again what may have been written to since the previous step
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	rescanWrites(heap);
+
+	if (!mark(heap, startTime) || !finish(s, startTime))
+		recordFrames(s);
+
+	_stats.steps++;
+	recordPause(_stats, g_system->getMillis() - startTime);
+}
+
+bool IncrementalGC::finish(EngineState *s, uint32 startTime) {
+	SegManager *segMan = s->_segMan;
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+
+	// Scan again whatever may have changed since it was marked: the root
+	// set, the frames which are running and what was recorded in this step.
+	// Sweeping needs all of it marked in one go, so the collection goes on
+	// marking when there is too much of it for the budget, unless it keeps
+	// finding too much.
+	pushRootSet(s, _wm);
+	recordFrames(s);
+	rescanWrites(heap);
+	if (!mark(heap, startTime, _finishAttempts < kMaxFinishAttempts)) {
+		_finishAttempts++;
+		return false;
+	}
+
+	segMan->setGCWriteBarrier(nullptr);
+
+	if (g_sci->_gfxPorts)
+		g_sci->_gfxPorts->processEngineHunkList(_wm);
+
+	AddrSet *activeRefs = normalizeAddresses(segMan, _wm._map);
+	const uint32 freed = freeUnreachable(segMan, *activeRefs);
+	delete activeRefs;
+
+	debugC(kDebugLevelGC, "[GC] Incremental collection freed %u objects after %u attempts to finish", freed, _finishAttempts + 1);
+	_stats.freed += freed;
+
+	_state = kStateIdle;
+	_wm._map.clear();
+	_writes.clear();
+	_finishAttempts = 0;
+	return true;
 }
 
 } // End of namespace Sci
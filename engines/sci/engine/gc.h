@@ -62,6 +62,86 @@ struct WorklistManager {
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+struct GCStats {
+	uint32 fullRuns;		///< Collections done in one go
+	uint32 incrementalRuns;	///< Collections spread over several kernel calls
+	uint32 steps;			///< Pauses of incremental collections
+	uint32 freed;			///< Objects freed by all collections
+	uint32 totalTime;		///< Time spent collecting, in ms
+	uint32 lastPause;		///< Longest pause of the last collection, in ms
+	uint32 maxPause;		///< Longest pause of all collections, in ms
+};
+
+/**
+ * Garbage collector which marks a bit at a time over several kernel calls,
+ * so that large heaps do not stall the game, then sweeps like run_gc().
+ *
+ * While it is marking, the SegManager records the objects, lists, nodes and
+ * arrays it hands out and the locals of the scripts which run, as they may
+ * be written to. Each step scans again what was recorded since the previous
+ * one, along with the objects and locals of the frames on the execution
+ * stack, which scripts keep writing to without looking them up again. The
+ * last step only has to scan again what changed since the previous step
+ * before it sweeps.
+ */
+class IncrementalGC {
+public:
+	IncrementalGC();
+
+	/** Whether scheduled collections should be incremental (sci_gc_incremental) */
+	bool isEnabled() const { return _enabled; }
+	bool isRunning() const { return _state != kStateIdle; }
+
+	/** The time the collector may mark for per kernel call, in ms (sci_gc_step_ms, at least 1) */
+	uint32 getStepBudget() const { return _stepBudget; }
+
+	/**
+	 * Starts a collection. Marking begins with the next step().
+	 */
+	void start();
+
+	/**
+	 * Marks until the budget of the step is used up, and finishes the
+	 * collection once there is nothing left to mark, and what changed since
+	 * the previous step can be marked within the budget too. Does nothing
+	 * while a kernel call is running scripts, as it may still write to lists
+	 * it has looked up before.
+	 */
+	void step(EngineState *s);
+
+	/**
+	 * Drops the collection in progress, like when the heap is replaced.
+	 */
+	void cancel(SegManager *segMan);
+
+	GCStats &getStats() { return _stats; }
+	void resetStats();
+
+private:
+	enum State {
+		kStateIdle,
+		kStatePending,
+		kStateMarking
+	};
+
+	void scan(const Common::Array<SegmentObj *> &heap, reg_t reg);
+	bool mark(const Common::Array<SegmentObj *> &heap, uint32 startTime, bool bounded = true);
+	void rescanWrites(const Common::Array<SegmentObj *> &heap);
+	void recordFrames(EngineState *s);
+	bool finish(EngineState *s, uint32 startTime);
+
+	bool _enabled;
+	uint32 _stepBudget;
+	State _state;
+
+	WorklistManager _wm;
+	AddrSet _writes; ///< What may have been written to since the last step
+	SegmentId _stackSegment;
+	uint _finishAttempts; ///< Steps which found too much to mark to finish
+
+	GCStats _stats;
+};
+
 
 } // End of namespace Sci
 
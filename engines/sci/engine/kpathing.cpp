@@ -21,6 +21,7 @@
 
 #include "sci/sci.h"
 #include "sci/engine/state.h"
+#include "sci/engine/pathfinding.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/kernel.h"
 #include "sci/graphics/paint16.h"
@@ -109,31 +110,15 @@ struct Vertex {
 	Vertex *_next;	// next element
 	Vertex *_prev;	// previous element
 
-	// A* cost variables
-	uint32 costF;
-	uint32 costG;
-
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
 public:
 	Vertex(const Common::Point &p) : v(p) {
-		costG = HUGE_DISTANCE;
 		path_prev = nullptr;
 	}
 };
 
-class VertexList: public Common::List<Vertex *> {
-public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
-		}
-		return false;
-	}
-};
-
 /* Circular list definitions. */
 
 #define CLIST_FOREACH(var, head)					\
@@ -255,6 +240,14 @@ struct PathfindingState {
 	// Total number of vertices
 	int vertices;
 
+	// The polygons before the start and end points were merged into them,
+	// the points of all polygons follow each other
+	Common::Array<Common::Point> _polygonPoints;
+	Common::Array<uint> _polygonSizes;
+
+	// Set when merging the start or end point split up an edge
+	bool _splitEdge;
+
 	// Point to prepend and append to final path
 	Common::Point *_prependPoint;
 	Common::Point *_appendPoint;
@@ -269,6 +262,7 @@ struct PathfindingState {
 		_prependPoint = nullptr;
 		_appendPoint = nullptr;
 		vertices = 0;
+		_splitEdge = false;
 	}
 
 	~PathfindingState() {
@@ -503,64 +497,6 @@ static void print_input(EngineState *s, reg_t poly_list, Common::Point start, Co
 	}
 }
 
-/**
- * Computes the area of a triangle
- * Parameters: (const Common::Point &) a, b, c: The points of the triangle
- * Returns   : (int) The area multiplied by two
- */
-static int area(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
-	return (b.x - a.x) * (a.y - c.y) - (c.x - a.x) * (a.y - b.y);
-}
-
-/**
- * Determines whether or not a point is to the left of a directed line
- * Parameters: (const Common::Point &) a, b: The directed line (a, b)
- *             (const Common::Point &) c: The query point
- * Returns   : (int) true if c is to the left of (a, b), false otherwise
- */
-static bool left(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
-	return area(a, b, c) > 0;
-}
-
-/**
- * Determines whether or not three points are collinear
- * Parameters: (const Common::Point &) a, b, c: The three points
- * Returns   : (int) true if a, b, and c are collinear, false otherwise
- */
-static bool collinear(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
-	return area(a, b, c) == 0;
-}
-
-/**
- * Determines whether or not a point lies on a line segment
- * Parameters: (const Common::Point &) a, b: The line segment (a, b)
- *             (const Common::Point &) c: The query point
- * Returns   : (int) true if c lies on (a, b), false otherwise
- */
-static bool between(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
-	if (!collinear(a, b, c))
-		return false;
-
-	// Assumes a != b.
-	if (a.x != b.x)
-		return ((a.x <= c.x) && (c.x <= b.x)) || ((a.x >= c.x) && (c.x >= b.x));
-	else
-		return ((a.y <= c.y) && (c.y <= b.y)) || ((a.y >= c.y) && (c.y >= b.y));
-}
-
-/**
- * Determines whether or not two line segments properly intersect
- * Parameters: (const Common::Point &) a, b: The line segment (a, b)
- *             (const Common::Point &) c, d: The line segment (c, d)
- * Returns   : (int) true if (a, b) properly intersects (c, d), false otherwise
- */
-static bool intersect_proper(const Common::Point &a, const Common::Point &b, const Common::Point &c, const Common::Point &d) {
-	int ab = (left(a, b, c) && left(b, a, d)) || (left(a, b, d) && left(b, a, c));
-	int cd = (left(c, d, a) && left(d, c, b)) || (left(c, d, b) && left(d, c, a));
-
-	return ab && cd;
-}
-
 /**
  * Polygon containment test
  * Parameters: (const Common::Point &) p: The point
@@ -698,48 +634,6 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
-/**
- * Returns a list of all vertices that are visible from a particular vertex.
- * @param s				the pathfinding state
- * @param vertex_cur	the vertex
- * @return list of vertices that are visible from vert
- */
-static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
-	VertexList *visVerts = new VertexList();
-
-	for (int i = 0; i < s->vertices; i++) {
-		Vertex *vertex = s->vertex_index[i];
-
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
-
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
-
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
-		}
-
-		if (j == s->vertices)
-			visVerts->push_front(vertex);
-	}
-
-	return visVerts;
-}
-
 /**
  * Determines if a point lies on the screen border
  * Parameters: (const Common::Point &) p: The point
@@ -1146,6 +1040,7 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 				if (between(vertex->v, next->v, v)) {
 					// Split edge by adding vertex
 					polygon->vertices.insertAfter(vertex, v_new);
+					s->_splitEdge = true;
 					return v_new;
 				}
 			}
@@ -1326,6 +1221,17 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		}
 	}
 
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+		Vertex *vertex;
+		uint size = 0;
+
+		CLIST_FOREACH(vertex, &(*it)->vertices) {
+			pf_s->_polygonPoints.push_back(vertex->v);
+			size++;
+		}
+		pf_s->_polygonSizes.push_back(size);
+	}
+
 	// Merge start and end points into polygon set
 	pf_s->vertex_start = merge_point(pf_s, *new_start);
 	pf_s->vertex_end = merge_point(pf_s, *new_end);
@@ -1353,104 +1259,114 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 }
 
 /**
- * Computes a shortest path from vertex_start to vertex_end. The caller can
- * construct the resulting path by following the path_prev links from
- * vertex_end back to vertex_start. If no path exists vertex_end->path_prev
- * will be NULL
- * Parameters: (PathfindingState *) s: The pathfinding state
+ * Prepares the visibility graph of the polygon set. The graph of the previous
+ * call is reused if the polygons did not change, with the start and end
+ * points replaced.
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) p: The pathfinding state
+ *             (VisibilityGraph &) localGraph: Graph to use if the graph can't be cached
+ * Returns   : (VisibilityGraph *) The graph, its vertices are in the order of p->vertex_index
  */
-static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
-	// The remaining vertices
-	VertexList openSet;
-
-	openSet.push_front(s->vertex_start);
-	s->vertex_start->costG = 0;
-	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
-
-	while (!openSet.empty()) {
-		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = nullptr;
-		uint32 min = HUGE_DISTANCE;
-
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
+static VisibilityGraph *prepare_visibility_graph(EngineState *s, PathfindingState *p, VisibilityGraph &localGraph) {
+	if (p->_splitEdge) {
+		// The polygons changed by merging the start or end point, so the
+		// graph is only valid for this call
+		for (PolygonList::iterator it = p->polygons.begin(); it != p->polygons.end(); ++it) {
+			Common::Array<Common::Point> points;
+			Vertex *vertex;
+
+			CLIST_FOREACH(vertex, &(*it)->vertices) {
+				points.push_back(vertex->v);
 			}
+			localGraph.addPolygon(points.begin(), points.size());
 		}
+		return &localGraph;
+	}
 
-		assert(vertex_min != nullptr);	// the vertex cost should never be bigger than HUGE_DISTANCE
-
-		// Check if we are done
-		if (vertex_min == s->vertex_end)
-			break;
-
-		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+	if (!s->_avoidPathGraph)
+		s->_avoidPathGraph = new VisibilityGraph();
 
-		VertexList *visVerts = visible_vertices(s, vertex_min);
+	VisibilityGraph *graph = s->_avoidPathGraph;
+	if (!graph->hasPolygons(p->_polygonPoints, p->_polygonSizes)) {
+		graph->clear();
+		const Common::Point *points = p->_polygonPoints.begin();
+		for (uint i = 0; i < p->_polygonSizes.size(); i++) {
+			graph->addPolygon(points, p->_polygonSizes[i]);
+			points += p->_polygonSizes[i];
+		}
+	}
 
-		for (VertexList::iterator it = visVerts->begin(); it != visVerts->end(); ++it) {
-			uint32 new_dist;
-			Vertex *vertex = *it;
+	// Start and end points which did not match an existing vertex were
+	// added as single-vertex polygons in front of the others
+	Common::Point extra[2];
+	const uint extraCount = p->vertices - p->_polygonPoints.size();
+	assert(extraCount <= ARRAYSIZE(extra));
+	for (uint i = 0; i < extraCount; i++)
+		extra[i] = p->vertex_index[i]->v;
+	graph->setExtraVertices(extra, extraCount);
 
-			if (closedSet.contains(vertex))
-				continue;
+	return graph;
+}
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
-
-			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
-
-			// When travelling to a vertex on the screen edge, we
-			// add a penalty score to make this path less appealing.
-			// NOTE: If an obstacle has only one vertex on a screen edge,
-			// later SSCI pathfinders will treat that vertex like any
-			// other, while we apply a penalty to paths traversing it.
-			// This difference might lead to problems, but none are
-			// known at the time of writing.
-
-			// WORKAROUND: This check is needed in SCI1.1 games, such as LB2. Until our
-			// algorithm matches better what SSCI is doing, we exempt certain rooms where
-			// the check fails.
-			bool penaltyWorkaround =
-				// QFG1VGA room 81 - Hero gets stuck when walking to the SE corner (bug #6140).
-				(g_sci->getGameId() == GID_QFG1VGA && g_sci->getEngineState()->currentRoomNumber() == 81) ||
+/**
+ * Computes a shortest path from vertex_start to vertex_end. The caller can
+ * construct the resulting path by following the path_prev links from
+ * vertex_end back to vertex_start. If no path exists vertex_end->path_prev
+ * will be NULL
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) p: The pathfinding state
+ */
+static void AStar(EngineState *s, PathfindingState *p) {
+	VisibilityGraph localGraph;
+	VisibilityGraph *graph = prepare_visibility_graph(s, p, localGraph);
+	assert((int)graph->size() == p->vertices);
+
+	// When travelling to a vertex on the screen edge, we
+	// add a penalty score to make this path less appealing.
+	// NOTE: If an obstacle has only one vertex on a screen edge,
+	// later SSCI pathfinders will treat that vertex like any
+	// other, while we apply a penalty to paths traversing it.
+	// This difference might lead to problems, but none are
+	// known at the time of writing.
+
+	// WORKAROUND: This check is needed in SCI1.1 games, such as LB2. Until our
+	// algorithm matches better what SSCI is doing, we exempt certain rooms where
+	// the check fails.
+	bool penaltyWorkaround =
+		// QFG1VGA room 81 - Hero gets stuck when walking to the SE corner (bug #6140).
+		(g_sci->getGameId() == GID_QFG1VGA && s->currentRoomNumber() == 81) ||
 #ifdef ENABLE_SCI32
-				// QFG4 room 563 - Hero zig-zags into the room (bug #10858).
-				// Entering from the south (564) off-screen behind an obstacle, hero
-				// fails to turn at a point on the screen edge, passes the poly's corner,
-				// then approaches the destination from deeper in the room.
-				(g_sci->getGameId() == GID_QFG4 && g_sci->getEngineState()->currentRoomNumber() == 563) ||
-
-				// QFG4 room 580 - Hero zig-zags into the room (bug #10870).
-				// Entering from the south (581) off-screen behind an obstacle, as above.
-				(g_sci->getGameId() == GID_QFG4 && g_sci->getEngineState()->currentRoomNumber() == 580) ||
+		// QFG4 room 563 - Hero zig-zags into the room (bug #10858).
+		// Entering from the south (564) off-screen behind an obstacle, hero
+		// fails to turn at a point on the screen edge, passes the poly's corner,
+		// then approaches the destination from deeper in the room.
+		(g_sci->getGameId() == GID_QFG4 && s->currentRoomNumber() == 563) ||
+
+		// QFG4 room 580 - Hero zig-zags into the room (bug #10870).
+		// Entering from the south (581) off-screen behind an obstacle, as above.
+		(g_sci->getGameId() == GID_QFG4 && s->currentRoomNumber() == 580) ||
 #endif
-				false;
-
-			if (s->pointOnScreenBorder(vertex->v) && !penaltyWorkaround)
-				new_dist += 10000;
-
-			if (new_dist < vertex->costG) {
-				vertex->costG = new_dist;
-				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
-				vertex->path_prev = vertex_min;
-			}
-		}
-
-		delete visVerts;
-	}
-
-	if (openSet.empty())
-		debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", s->vertex_end->v.x, s->vertex_end->v.y);
+		false;
+
+	Common::Array<uint32> penalties;
+	penalties.resize(p->vertices);
+	int start = -1, end = -1;
+	for (int i = 0; i < p->vertices; i++) {
+		Vertex *vertex = p->vertex_index[i];
+		penalties[i] = (p->pointOnScreenBorder(vertex->v) && !penaltyWorkaround) ? 10000 : 0;
+		if (vertex == p->vertex_start)
+			start = i;
+		if (vertex == p->vertex_end)
+			end = i;
+	}
+	assert(start >= 0 && end >= 0);
+
+	Common::Array<int> pathPrev;
+	if (!findShortestPath(*graph, start, end, penalties, pathPrev))
+		debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", p->vertex_end->v.x, p->vertex_end->v.y);
+
+	for (int i = 0; i < p->vertices; i++)
+		p->vertex_index[i]->path_prev = (pathPrev[i] >= 0) ? p->vertex_index[pathPrev[i]] : nullptr;
 }
 
 static reg_t allocateOutputArray(SegManager *segMan, int size) {
@@ -1629,7 +1545,7 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 		}
 
 		// Apply Dijkstra
-		AStar(p);
+		AStar(s, p);
 
 		output = output_path(p, s);
 		delete p;
@@ -0,0 +1,364 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/util.h"
+
+#include "sci/engine/pathfinding.h"
+
+namespace Sci {
+
+#define HUGE_DISTANCE 0xFFFFFFFF
+
+static Common::Rect boundingBox(const Common::Point &a, const Common::Point &b) {
+	return Common::Rect(MIN(a.x, b.x), MIN(a.y, b.y), MAX(a.x, b.x), MAX(a.y, b.y));
+}
+
+// Both rects have inclusive right and bottom edges
+static bool boxesOverlap(const Common::Rect &a, const Common::Rect &b) {
+	return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+}
+
+VisibilityGraph::VisibilityGraph() : _extraCount(0) {
+}
+
+void VisibilityGraph::clear() {
+	_vertices.clear();
+	_polygons.clear();
+	_known.clear();
+	_visible.clear();
+	_extraCount = 0;
+}
+
+void VisibilityGraph::addPolygon(const Common::Point *points, uint count) {
+	if (!count)
+		return;
+
+	GraphPolygon polygon;
+	polygon.first = _vertices.size();
+	polygon.count = count;
+	polygon.box = Common::Rect(points[0].x, points[0].y, points[0].x, points[0].y);
+
+	for (uint i = 0; i < count; i++) {
+		GraphVertex vertex;
+		vertex.v = points[i];
+		vertex.prev = polygon.first + (i + count - 1) % count;
+		vertex.next = polygon.first + (i + 1) % count;
+		vertex.edgeBox = boundingBox(points[i], points[(i + 1) % count]);
+		_vertices.push_back(vertex);
+
+		polygon.box.left = MIN(polygon.box.left, points[i].x);
+		polygon.box.top = MIN(polygon.box.top, points[i].y);
+		polygon.box.right = MAX(polygon.box.right, points[i].x);
+		polygon.box.bottom = MAX(polygon.box.bottom, points[i].y);
+	}
+
+	_polygons.push_back(polygon);
+
+	// Visibility between the vertices changes with every polygon
+	_known.clear();
+	_visible.clear();
+}
+
+bool VisibilityGraph::hasPolygons(const Common::Array<Common::Point> &points, const Common::Array<uint> &counts) const {
+	if (points.size() != _vertices.size() || counts.size() != _polygons.size())
+		return false;
+
+	for (uint i = 0; i < counts.size(); i++) {
+		if (counts[i] != _polygons[i].count)
+			return false;
+	}
+
+	for (uint i = 0; i < points.size(); i++) {
+		if (points[i] != _vertices[i].v)
+			return false;
+	}
+
+	return true;
+}
+
+void VisibilityGraph::setExtraVertices(const Common::Point *points, uint count) {
+	assert(count <= kExtraVertices);
+	for (uint i = 0; i < count; i++)
+		_extra[i] = points[i];
+	_extraCount = count;
+}
+
+/**
+ * Determines whether or not a line from a point to a vertex intersects the
+ * interior of the polygon, locally at that vertex
+ */
+bool VisibilityGraph::isInside(const Common::Point &p, uint vertex) const {
+	// Extra vertices are single-vertex polygons
+	if (vertex < _extraCount)
+		return false;
+
+	const GraphVertex &cur = _vertices[vertex - _extraCount];
+
+	// Check that it's not a single-vertex polygon
+	if (cur.next == vertex - _extraCount)
+		return false;
+
+	const Common::Point &prev = _vertices[cur.prev].v;
+	const Common::Point &next = _vertices[cur.next].v;
+
+	if (left(prev, cur.v, next)) {
+		// Convex vertex, line (p, cur) intersects the inside
+		// if p is located left of both edges
+		return left(cur.v, next, p) && left(prev, cur.v, p);
+	} else {
+		// Non-convex vertex, line (p, cur) intersects the
+		// inside if p is located left of either edge
+		return left(cur.v, next, p) || left(prev, cur.v, p);
+	}
+}
+
+bool VisibilityGraph::computeVisible(uint a, uint b) const {
+	const Common::Point &pa = getPoint(a);
+	const Common::Point &pb = getPoint(b);
+
+	// Make sure we don't intersect a polygon locally at the vertices
+	if (isInside(pb, a) || isInside(pa, b))
+		return false;
+
+	// Check for intersecting edges. An edge can only touch the line if their
+	// bounding boxes overlap.
+	const Common::Rect lineBox = boundingBox(pa, pb);
+
+	for (uint i = 0; i < _polygons.size(); i++) {
+		const GraphPolygon &polygon = _polygons[i];
+		if (polygon.count < 2 || !boxesOverlap(polygon.box, lineBox))
+			continue;
+
+		for (uint j = polygon.first; j < polygon.first + polygon.count; j++) {
+			const GraphVertex &edge = _vertices[j];
+			if (!boxesOverlap(edge.edgeBox, lineBox))
+				continue;
+
+			if (between(pa, pb, edge.v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if (isInside(pa, j + _extraCount) || isInside(pb, j + _extraCount))
+					return false;
+
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(pa, pb, edge.v, _vertices[edge.next].v))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool VisibilityGraph::isVisible(uint a, uint b) {
+	if (a == b)
+		return false;
+
+	const uint count = _vertices.size();
+	if (a < _extraCount || b < _extraCount || count > kMaxCachedVertices)
+		return computeVisible(a, b);
+
+	if (_known.empty()) {
+		_known.resize((count * count + 31) / 32);
+		_visible.resize(_known.size());
+		memset(_known.begin(), 0, _known.size() * sizeof(uint32));
+		memset(_visible.begin(), 0, _visible.size() * sizeof(uint32));
+	}
+
+	const uint pa = a - _extraCount;
+	const uint pb = b - _extraCount;
+	const uint bit = pa * count + pb;
+	if (_known[bit / 32] & (1u << (bit % 32)))
+		return (_visible[bit / 32] & (1u << (bit % 32))) != 0;
+
+	// Visibility is symmetric, so both directions are stored at once
+	const bool visible = computeVisible(a, b);
+	const uint mirrorBit = pb * count + pa;
+	_known[bit / 32] |= 1u << (bit % 32);
+	_known[mirrorBit / 32] |= 1u << (mirrorBit % 32);
+	if (visible) {
+		_visible[bit / 32] |= 1u << (bit % 32);
+		_visible[mirrorBit / 32] |= 1u << (mirrorBit % 32);
+	}
+	return visible;
+}
+
+namespace {
+
+/**
+ * The open set of A*. Vertices with the same cost are picked in the reverse
+ * order of being added, like the list based open set which was used before
+ * did, so the same path is chosen among paths of equal length.
+ */
+class OpenSet {
+public:
+	OpenSet(uint size, const Common::Array<uint32> &costF) : _costF(costF), _sequence(0) {
+		_position.resize(size);
+		_order.resize(size);
+		for (uint i = 0; i < size; i++)
+			_position[i] = -1;
+	}
+
+	bool empty() const { return _heap.empty(); }
+	bool contains(uint vertex) const { return _position[vertex] >= 0; }
+
+	/** Reserves the position of the vertex among vertices of equal cost. */
+	void markAdded(uint vertex) { _order[vertex] = _sequence++; }
+
+	void push(uint vertex) {
+		_position[vertex] = _heap.size();
+		_heap.push_back(vertex);
+		siftUp(_heap.size() - 1);
+	}
+
+	/** Moves the vertex up after its cost got lowered. */
+	void update(uint vertex) {
+		siftUp(_position[vertex]);
+	}
+
+	uint pop() {
+		const uint top = _heap[0];
+		const uint last = _heap.back();
+		_heap.pop_back();
+		_position[top] = -1;
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			_position[last] = 0;
+			siftDown(0);
+		}
+		return top;
+	}
+
+private:
+	bool before(uint a, uint b) const {
+		return _costF[a] < _costF[b] || (_costF[a] == _costF[b] && _order[a] > _order[b]);
+	}
+
+	void place(uint index, uint vertex) {
+		_heap[index] = vertex;
+		_position[vertex] = index;
+	}
+
+	void siftUp(uint index) {
+		const uint vertex = _heap[index];
+		while (index > 0) {
+			const uint parent = (index - 1) / 2;
+			if (!before(vertex, _heap[parent]))
+				break;
+			place(index, _heap[parent]);
+			index = parent;
+		}
+		place(index, vertex);
+	}
+
+	void siftDown(uint index) {
+		const uint vertex = _heap[index];
+		const uint size = _heap.size();
+		for (;;) {
+			uint child = index * 2 + 1;
+			if (child >= size)
+				break;
+			if (child + 1 < size && before(_heap[child + 1], _heap[child]))
+				child++;
+			if (!before(_heap[child], vertex))
+				break;
+			place(index, _heap[child]);
+			index = child;
+		}
+		place(index, vertex);
+	}
+
+	const Common::Array<uint32> &_costF;
+	Common::Array<uint> _heap;
+	Common::Array<int> _position;
+	Common::Array<uint32> _order;
+	uint32 _sequence;
+};
+
+} // End of anonymous namespace
+
+bool findShortestPath(VisibilityGraph &graph, uint start, uint end, const Common::Array<uint32> &penalties, Common::Array<int> &pathPrev) {
+	const uint size = graph.size();
+	const Common::Point &endPoint = graph.getPoint(end);
+
+	Common::Array<uint32> costF, costG;
+	Common::Array<bool> closed;
+	costF.resize(size);
+	costG.resize(size);
+	closed.resize(size);
+	pathPrev.resize(size);
+	for (uint i = 0; i < size; i++) {
+		costF[i] = HUGE_DISTANCE;
+		costG[i] = HUGE_DISTANCE;
+		closed[i] = false;
+		pathPrev[i] = -1;
+	}
+
+	OpenSet openSet(size, costF);
+
+	costG[start] = 0;
+	costF[start] = (uint32)sqrt((float)graph.getPoint(start).sqrDist(endPoint));
+	openSet.markAdded(start);
+	openSet.push(start);
+
+	while (!openSet.empty()) {
+		const uint vertexMin = openSet.pop();
+
+		// Check if we are done
+		if (vertexMin == end)
+			return true;
+
+		closed[vertexMin] = true;
+
+		const Common::Point &pointMin = graph.getPoint(vertexMin);
+
+		// Visible vertices are visited from the last to the first one, like
+		// the pathfinder always did
+		for (int vertex = size - 1; vertex >= 0; vertex--) {
+			if (closed[vertex] || !graph.isVisible(vertexMin, vertex))
+				continue;
+
+			const bool isOpen = openSet.contains(vertex);
+			if (!isOpen)
+				openSet.markAdded(vertex);
+
+			uint32 newDist = costG[vertexMin] + (uint32)sqrt((float)pointMin.sqrDist(graph.getPoint(vertex)));
+			newDist += penalties[vertex];
+
+			if (newDist < costG[vertex]) {
+				costG[vertex] = newDist;
+				costF[vertex] = costG[vertex] + (uint32)sqrt((float)graph.getPoint(vertex).sqrDist(endPoint));
+				pathPrev[vertex] = vertexMin;
+				if (isOpen)
+					openSet.update(vertex);
+			}
+
+			if (!isOpen)
+				openSet.push(vertex);
+		}
+	}
+
+	return false;
+}
+
+} // End of namespace Sci
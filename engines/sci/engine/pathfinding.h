@@ -0,0 +1,187 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SCI_ENGINE_PATHFINDING_H
+#define SCI_ENGINE_PATHFINDING_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Sci {
+
+/**
+ * Computes the area of a triangle
+ * Parameters: (const Common::Point &) a, b, c: The points of the triangle
+ * Returns   : (int) The area multiplied by two
+ */
+inline int area(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
+	return (b.x - a.x) * (a.y - c.y) - (c.x - a.x) * (a.y - b.y);
+}
+
+/**
+ * Determines whether or not a point is to the left of a directed line
+ * Parameters: (const Common::Point &) a, b: The directed line (a, b)
+ *             (const Common::Point &) c: The query point
+ * Returns   : (int) true if c is to the left of (a, b), false otherwise
+ */
+inline bool left(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
+	return area(a, b, c) > 0;
+}
+
+/**
+ * Determines whether or not three points are collinear
+ * Parameters: (const Common::Point &) a, b, c: The three points
+ * Returns   : (int) true if a, b, and c are collinear, false otherwise
+ */
+inline bool collinear(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
+	return area(a, b, c) == 0;
+}
+
+/**
+ * Determines whether or not a point lies on a line segment
+ * Parameters: (const Common::Point &) a, b: The line segment (a, b)
+ *             (const Common::Point &) c: The query point
+ * Returns   : (int) true if c lies on (a, b), false otherwise
+ */
+inline bool between(const Common::Point &a, const Common::Point &b, const Common::Point &c) {
+	if (!collinear(a, b, c))
+		return false;
+
+	// Assumes a != b.
+	if (a.x != b.x)
+		return ((a.x <= c.x) && (c.x <= b.x)) || ((a.x >= c.x) && (c.x >= b.x));
+	else
+		return ((a.y <= c.y) && (c.y <= b.y)) || ((a.y >= c.y) && (c.y >= b.y));
+}
+
+/**
+ * Determines whether or not two line segments properly intersect
+ * Parameters: (const Common::Point &) a, b: The line segment (a, b)
+ *             (const Common::Point &) c, d: The line segment (c, d)
+ * Returns   : (int) true if (a, b) properly intersects (c, d), false otherwise
+ */
+inline bool intersect_proper(const Common::Point &a, const Common::Point &b, const Common::Point &c, const Common::Point &d) {
+	int ab = (left(a, b, c) && left(b, a, d)) || (left(a, b, d) && left(b, a, c));
+	int cd = (left(c, d, a) && left(d, c, b)) || (left(c, d, b) && left(d, c, a));
+
+	return ab && cd;
+}
+
+/**
+ * Determines which vertices of a polygon set can see each other, i.e. which
+ * can be connected by a line without crossing the inside of a polygon.
+ *
+ * The vertices of the polygons come first, followed by a few extra vertices,
+ * which are the start and end points of a path that do not lie on one of the
+ * polygons. Visibility between the polygon vertices is remembered, so the
+ * graph can be reused by pathfinding on the same polygon set, with only the
+ * extra vertices replaced.
+ */
+class VisibilityGraph {
+public:
+	VisibilityGraph();
+
+	/** Removes all polygons and extra vertices. */
+	void clear();
+
+	/**
+	 * Adds a polygon, its vertices are connected in the given order.
+	 * Polygons with a single vertex have no edges.
+	 */
+	void addPolygon(const Common::Point *points, uint count);
+
+	/**
+	 * Checks whether the graph holds the given polygons, added in the given
+	 * order. The points of all polygons follow each other in points.
+	 */
+	bool hasPolygons(const Common::Array<Common::Point> &points, const Common::Array<uint> &counts) const;
+
+	/** Replaces the extra vertices, they are added as single vertices. */
+	void setExtraVertices(const Common::Point *points, uint count);
+
+	/** Number of vertices, including the extra vertices. */
+	uint size() const { return _vertices.size() + _extraCount; }
+	uint getExtraCount() const { return _extraCount; }
+
+	/**
+	 * Returns a vertex. The extra vertices come first, then the vertices of
+	 * the polygons in the order they were added.
+	 */
+	const Common::Point &getPoint(uint index) const {
+		return index < _extraCount ? _extra[index] : _vertices[index - _extraCount].v;
+	}
+
+	/** Checks whether the line between two vertices is free of obstacles. */
+	bool isVisible(uint a, uint b);
+
+private:
+	struct GraphVertex {
+		Common::Point v;
+		uint16 prev;           ///< Previous vertex of the polygon, the vertex itself if it has no edges
+		uint16 next;           ///< Next vertex of the polygon, the vertex itself if it has no edges
+		Common::Rect edgeBox;  ///< Bounding box of the edge to the next vertex, right and bottom inclusive
+	};
+
+	struct GraphPolygon {
+		uint16 first;
+		uint16 count;
+		Common::Rect box;      ///< Bounding box, right and bottom inclusive
+	};
+
+	enum {
+		kExtraVertices = 2,
+		kMaxCachedVertices = 256
+	};
+
+	bool isInside(const Common::Point &p, uint vertex) const;
+	bool computeVisible(uint a, uint b) const;
+
+	Common::Array<GraphVertex> _vertices;
+	Common::Array<GraphPolygon> _polygons;
+
+	Common::Point _extra[kExtraVertices];
+	uint _extraCount;
+
+	// Visibility between polygon vertices, two bits per pair: known and
+	// visible
+	Common::Array<uint32> _known;
+	Common::Array<uint32> _visible;
+};
+
+/**
+ * Finds the shortest path between two vertices of a visibility graph with
+ * A*. The open set is a binary heap, which picks the vertex with the lowest
+ * estimated cost, and of those the one which was added to it last.
+ *
+ * @param graph     the visibility graph
+ * @param start     the start vertex
+ * @param end       the end vertex
+ * @param penalties costs added to paths going to each vertex
+ * @param pathPrev  receives the previous vertex on the shortest path to each
+ *                  vertex, or -1
+ * @return true if the end vertex can be reached
+ */
+bool findShortestPath(VisibilityGraph &graph, uint start, uint end, const Common::Array<uint32> &penalties, Common::Array<int> &pathPrev);
+
+} // End of namespace Sci
+
+#endif // SCI_ENGINE_PATHFINDING_H
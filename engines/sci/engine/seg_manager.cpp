@@ -23,6 +23,7 @@
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
+#include "sci/engine/gc.h"
 #ifdef ENABLE_SCI32
 #include "sci/engine/guest_additions.h"
 #endif
@@ -31,7 +32,7 @@ namespace Sci {
 
 
 SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
-	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
+	: _resMan(resMan), _scriptPatcher(scriptPatcher), _gcWrites(nullptr) {
 	_heap.push_back(0);
 
 	_clonesSegId = 0;
@@ -165,6 +166,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.invalidate();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -268,6 +270,8 @@ Object *SegManager::getObject(reg_t pos) const {
 		}
 	}
 
+	if (obj)
+		gcWriteBarrier(pos);
 	return obj;
 }
 
@@ -510,6 +514,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	gcWriteBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -526,6 +531,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	gcWriteBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -552,6 +558,7 @@ List *SegManager::lookupList(reg_t addr) {
 		return nullptr;
 	}
 
+	gcWriteBarrier(addr);
 	return &(lt[addr.getOffset()]);
 }
 
@@ -576,9 +583,14 @@ Node *SegManager::lookupNode(reg_t addr, bool stopOnDiscarded) {
 		return nullptr;
 	}
 
+	gcWriteBarrier(addr);
 	return &(nt[addr.getOffset()]);
 }
 
+void SegManager::recordGCWrite(reg_t addr) const {
+	_gcWrites->setVal(addr, true);
+}
+
 SegmentRef SegManager::dereference(reg_t pointer) {
 	SegmentRef ret;
 
@@ -589,6 +601,12 @@ SegmentRef SegManager::dereference(reg_t pointer) {
 	}
 
 	SegmentObj *mobj = _heap[pointer.getSegment()];
+	if (mobj->getType() == SEG_TYPE_LOCALS)
+		gcWriteBarrier(make_reg(pointer.getSegment(), 0));
+#ifdef ENABLE_SCI32
+	if (mobj->getType() == SEG_TYPE_ARRAY)
+		gcWriteBarrier(make_reg(pointer.getSegment(), pointer.getOffset()));
+#endif
 	return mobj->dereference(pointer);
 }
 
@@ -952,6 +970,7 @@ SciArray *SegManager::allocateArray(SciArrayType type, uint16 size, reg_t *addr)
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	gcWriteBarrier(*addr);
 
 	SciArray *array = &table->at(offset);
 	array->setType(type);
@@ -968,6 +987,7 @@ SciArray *SegManager::lookupArray(reg_t addr) {
 	if (!arrayTable.isValidEntry(addr.getOffset()))
 		error("Attempt to use non-array %04x:%04x as array", PRINT_REG(addr));
 
+	gcWriteBarrier(addr);
 	return &(arrayTable[addr.getOffset()]);
 }
 
@@ -1099,6 +1119,8 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 		scr = allocateScript(scriptNum, segmentId);
 	}
 
+	_selectorLookupCache.invalidate();
+
 	scr->load(scriptNum, _resMan, _scriptPatcher, applyScriptPatches);
 	scr->initializeLocals(this);
 	scr->initializeObjects(this, segmentId, applyScriptPatches);
@@ -1136,6 +1158,7 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (!scr->getLockers()) {
 		// The actual script deletion seems to be done by SCI scripts themselves
 		scr->markDeleted();
+		_selectorLookupCache.invalidate();
 		debugC(kDebugLevelScripts, "Unloaded script 0x%x.", script_nr);
 	}
 }
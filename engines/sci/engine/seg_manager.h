@@ -25,6 +25,7 @@
 #include "common/scummsys.h"
 #include "common/serializer.h"
 #include "sci/engine/script.h"
+#include "sci/engine/selector_lookup.h"
 #include "sci/engine/vm.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/segment.h"
@@ -44,6 +45,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+struct reg_t_Hash;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -460,7 +462,30 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
+	/**
+	 * Records the objects, lists, nodes and arrays handed out and the locals
+	 * dereferenced from now on in the given set. The incremental garbage
+	 * collector scans them again, as they may have been changed after it
+	 * marked them.
+	 * @param writes	the set to record them in, or nullptr to stop
+	 */
+	void setGCWriteBarrier(Common::HashMap<reg_t, bool, reg_t_Hash> *writes) { _gcWrites = writes; }
+
+	/**
+	 * Records an address for the incremental garbage collector while it is
+	 * marking, for anything scripts may write to without the SegManager, like
+	 * the locals of the script they run.
+	 */
+	void gcWriteBarrier(reg_t addr) const {
+		if (_gcWrites)
+			recordGCWrite(addr);
+	}
+
 private:
+	void recordGCWrite(reg_t addr) const;
+
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
@@ -469,6 +494,9 @@ private:
 	ResourceManager *_resMan;
 	ScriptPatcher *_scriptPatcher;
 
+	SelectorLookupCache _selectorLookupCache;
+	Common::HashMap<reg_t, bool, reg_t_Hash> *_gcWrites;
+
 	SegmentId _clonesSegId; ///< ID of the (a) clones segment
 	SegmentId _listsSegId; ///< ID of the (a) list segment
 	SegmentId _nodesSegId; ///< ID of the (a) node segment
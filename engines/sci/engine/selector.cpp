@@ -323,6 +323,31 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
+static void lookupSelectorUncached(SegManager *segMan, const Object *obj, Selector selectorId, SelectorLookupCache::Entry &result) {
+	result.varIndex = obj->locateVarSelector(segMan, selectorId);
+	result.function = NULL_REG;
+
+	if (result.varIndex >= 0) {
+		// Found it as a variable
+		result.type = kSelectorVariable;
+		return;
+	}
+
+	// Check if it's a method, with recursive lookup in superclasses
+	while (obj) {
+		int index = obj->funcSelectorPosition(selectorId);
+		if (index >= 0) {
+			result.function = obj->getFunction(index);
+			result.type = kSelectorMethod;
+			return;
+		} else {
+			obj = segMan->getObject(obj->getSuperClassSelector());
+		}
+	}
+
+	result.type = kSelectorNone;
+}
+
 SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
 	const Object *obj = segMan->getObject(obj_location);
 	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
@@ -336,31 +361,26 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x", PRINT_REG(obj_location));
 	}
 
-	int index = obj->locateVarSelector(segMan, selectorId);
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	const SelectorLookupCache::Entry *entry = cache.find(obj, selectorId);
+	SelectorLookupCache::Entry result;
+	if (!entry) {
+		lookupSelectorUncached(segMan, obj, selectorId, result);
+		cache.store(obj, selectorId, result);
+		entry = &result;
+	}
 
-	if (index >= 0) {
-		// Found it as a variable
+	if (entry->type == kSelectorVariable) {
 		if (varp) {
 			varp->obj = obj_location;
-			varp->varindex = index;
+			varp->varindex = entry->varIndex;
 		}
-		return kSelectorVariable;
-	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
-			}
-		}
-
-		return kSelectorNone;
+	} else if (entry->type == kSelectorMethod) {
+		if (fptr)
+			*fptr = entry->function;
 	}
+
+	return entry->type;
 }
 
 } // End of namespace Sci
@@ -0,0 +1,99 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "sci/engine/object.h"
+#include "sci/engine/selector_lookup.h"
+
+namespace Sci {
+
+// The cache is rebuilt after every script load, which keeps it small in
+// practice. This only guards against unusual games piling up entries.
+static const uint kMaxSelectorLookupEntries = 8192;
+
+SelectorLookupCache::SelectorLookupCache() : _enabled(true), _frameSends(0) {
+	resetStats();
+}
+
+const SelectorLookupCache::Entry *SelectorLookupCache::find(const Object *obj, Selector selector) {
+	if (!_enabled)
+		return nullptr;
+
+	Key key;
+	key.object = obj->getPos();
+	key.selector = selector;
+
+	EntryMap::const_iterator it = _entries.find(key);
+	if (it == _entries.end()) {
+		_stats.misses++;
+		return nullptr;
+	}
+
+	_stats.hits++;
+	return &it->_value;
+}
+
+void SelectorLookupCache::store(const Object *obj, Selector selector, const Entry &entry) {
+	if (!_enabled)
+		return;
+
+	Key key;
+	key.object = obj->getPos();
+	key.selector = selector;
+
+	if (_entries.size() >= kMaxSelectorLookupEntries)
+		invalidate();
+
+	_entries[key] = entry;
+}
+
+void SelectorLookupCache::invalidate() {
+	if (_entries.empty())
+		return;
+	_entries.clear();
+	_stats.invalidations++;
+}
+
+void SelectorLookupCache::setEnabled(bool enabled) {
+	_enabled = enabled;
+	_entries.clear();
+}
+
+void SelectorLookupCache::endFrame() {
+	_stats.frames++;
+	_stats.lastFrameSends = _frameSends;
+	if (_frameSends > _stats.maxFrameSends)
+		_stats.maxFrameSends = _frameSends;
+	_frameSends = 0;
+}
+
+void SelectorLookupCache::resetStats() {
+	_stats.sends = 0;
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.invalidations = 0;
+	_stats.frames = 0;
+	_stats.lastFrameSends = 0;
+	_stats.maxFrameSends = 0;
+	_frameSends = 0;
+}
+
+} // End of namespace Sci
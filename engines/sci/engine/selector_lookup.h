@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SCI_ENGINE_SELECTOR_LOOKUP_H
+#define SCI_ENGINE_SELECTOR_LOOKUP_H
+
+#include "common/hashmap.h"
+
+#include "sci/engine/vm.h"
+#include "sci/engine/vm_types.h"
+
+namespace Sci {
+
+class Object;
+
+/**
+ * Cache of the results of lookupSelector(). Looking up a selector scans the
+ * property table of the class, then the method tables of the object and all
+ * of its superclasses, for every send.
+ *
+ * Results are keyed by the position of the object in its script. Clones keep
+ * the position of the object they were cloned from, along with its method
+ * table and superclass chain, so they share its entries. The cache is
+ * cleared whenever a script is loaded or unloaded, as script segments get
+ * reused.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		SelectorType type;
+		int varIndex;   ///< For kSelectorVariable
+		reg_t function; ///< For kSelectorMethod
+	};
+
+	struct Stats {
+		uint32 sends;          ///< Selectors sent to objects by scripts
+		uint32 hits;
+		uint32 misses;
+		uint32 invalidations;  ///< Number of times the cache was cleared
+		uint32 frames;         ///< Number of frames counted (kAnimate or kFrameOut)
+		uint32 lastFrameSends; ///< Sends during the last frame
+		uint32 maxFrameSends;  ///< Most sends during a single frame
+	};
+
+	SelectorLookupCache();
+
+	/** Returns the cached result of the lookup, or nullptr if it is not cached. */
+	const Entry *find(const Object *obj, Selector selector);
+	void store(const Object *obj, Selector selector, const Entry &entry);
+
+	/** Drops all entries, called when scripts are loaded or unloaded. */
+	void invalidate();
+
+	void setEnabled(bool enabled);
+	bool isEnabled() const { return _enabled; }
+	uint getEntryCount() const { return _entries.size(); }
+
+	void countSend() { _stats.sends++; _frameSends++; }
+	/** Marks the end of a frame for the sends per frame statistics. */
+	void endFrame();
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	struct Key {
+		reg_t object;
+		Selector selector;
+
+		bool operator==(const Key &other) const {
+			return object == other.object && selector == other.selector;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return ((key.object.getSegment() << 3) ^ key.object.getOffset() ^ (key.object.getOffset() << 16)) * 31 + key.selector;
+		}
+	};
+
+	typedef Common::HashMap<Key, Entry, KeyHash> EntryMap;
+
+	EntryMap _entries;
+	bool _enabled;
+	Stats _stats;
+	uint32 _frameSends;
+};
+
+} // End of namespace Sci
+
+#endif // SCI_ENGINE_SELECTOR_LOOKUP_H
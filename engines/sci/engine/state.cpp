@@ -24,6 +24,7 @@
 #include "sci/debug.h"	// for g_debug_sleeptime_factor
 #include "sci/engine/features.h"
 #include "sci/engine/file.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/guest_additions.h"
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
@@ -31,6 +32,7 @@
 #include "sci/engine/vm.h"
 #include "sci/engine/script.h"
 #include "sci/engine/message.h"
+#include "sci/engine/pathfinding.h"
 
 namespace Sci {
 
@@ -68,7 +70,9 @@ static const uint16 s_halfWidthSJISMap[256] = {
 
 EngineState::EngineState(SegManager *segMan) :
 	_segMan(segMan),
+	_gc(new IncrementalGC()),
 	_msgState(nullptr),
+	_avoidPathGraph(nullptr),
 	_dirseeker() {
 
 	reset(false);
@@ -76,6 +80,8 @@ EngineState::EngineState(SegManager *segMan) :
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _avoidPathGraph;
+	delete _gc;
 }
 
 void EngineState::reset(bool isRestoring) {
@@ -104,6 +110,7 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	_gc->cancel(_segMan);
 
 	_eventCounter = 0;
 	_paletteSetIntensityCounter = 0;
@@ -46,6 +46,8 @@ class FileHandle;
 class DirSeeker;
 class EventManager;
 class MessageState;
+class VisibilityGraph;
+class IncrementalGC;
 class SoundCommandParser;
 class VirtualIndexFile;
 
@@ -188,10 +190,13 @@ struct EngineState : public Common::Serializable {
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	IncrementalGC *_gc; /**< Collector for gcs spread over several kernel calls */
 
 	MessageState *_msgState;
 	void initMessageState();
 
+	VisibilityGraph *_avoidPathGraph; /**< Visibility graph of the last polygon set given to kAvoidPath */
+
 	// MemorySegment provides access to a 256-byte block of memory that remains
 	// intact across restarts and restores
 	enum {
@@ -258,6 +258,7 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPt
 		g_sci->_guestAdditions->sendSelectorHook(send_obj, selector, argp);
 #endif
 
+		s->_segMan->getSelectorLookupCache().countSend();
 		SelectorType selectorType = lookupSelector(s->_segMan, send_obj, selector, &varp, &funcp);
 		if (selectorType == kSelectorNone)
 			error("Send to invalid selector 0x%x (%s) of object at %04x:%04x", 0xffff & selector, g_sci->getKernel()->getSelectorName(0xffff & selector).c_str(), PRINT_REG(send_obj));
@@ -593,6 +594,8 @@ void run_vm(EngineState *s) {
 			} else {
 				s->variablesSegment[VAR_LOCAL] = local_script->getLocalsSegment();
 				s->variablesBase[VAR_LOCAL] = s->variables[VAR_LOCAL] = local_script->getLocalsBegin();
+				if (local_script->getLocalsSegment())
+					s->_segMan->gcWriteBarrier(make_reg(local_script->getLocalsSegment(), 0));
 				s->variablesMax[VAR_LOCAL] = local_script->getLocalsCount();
 				s->variablesMax[VAR_TEMP] = s->xs->tempCount;
 				s->variablesMax[VAR_PARAM] = s->xs->argc + 1;
@@ -848,9 +851,14 @@ void run_vm(EngineState *s) {
 
 		case op_callk: { // 0x21 (33)
 			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
+			if (s->_gc->isRunning()) {
+				s->_gc->step(s);
+			} else if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				if (s->_gc->isEnabled())
+					s->_gc->start();
+				else
+					run_gc(s);
 			}
 
 			// Call kernel function
@@ -19,6 +19,7 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/stack.h"
 #include "graphics/primitives.h"
@@ -35,7 +36,15 @@
 namespace Sci {
 
 GfxCache::GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette)
-	: _resMan(resMan), _screen(screen), _palette(palette) {
+	: _resMan(resMan), _screen(screen), _palette(palette), _useCounter(0), _viewMemory(0) {
+	// Memory which cached views may take up, the most recently used
+	// MIN_CACHED_VIEWS views are kept regardless
+	int viewCacheKB = 768;
+	if (ConfMan.hasKey("sci_view_cache_kb"))
+		viewCacheKB = ConfMan.getInt("sci_view_cache_kb");
+	_viewBudget = MAX(viewCacheKB, 0) * 1024;
+
+	resetStats();
 }
 
 GfxCache::~GfxCache() {
@@ -43,10 +52,17 @@ GfxCache::~GfxCache() {
 	purgeViewCache();
 }
 
+void GfxCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+	_stats.fontEvictions = 0;
+}
+
 void GfxCache::purgeFontCache() {
 	for (FontCache::iterator iter = _cachedFonts.begin(); iter != _cachedFonts.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
+		delete iter->_value.font;
+		iter->_value.font = 0;
 	}
 
 	_cachedFonts.clear();
@@ -54,39 +70,97 @@ void GfxCache::purgeFontCache() {
 
 void GfxCache::purgeViewCache() {
 	for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
+		delete iter->_value.view;
+		iter->_value.view = 0;
 	}
 
 	_cachedViews.clear();
+	_viewMemory = 0;
+}
+
+void GfxCache::evictFont(GuiResourceId keepId) {
+	FontCache::iterator oldest = _cachedFonts.end();
+	for (FontCache::iterator iter = _cachedFonts.begin(); iter != _cachedFonts.end(); ++iter) {
+		if (iter->_key != keepId && (oldest == _cachedFonts.end() || iter->_value.lastUse < oldest->_value.lastUse))
+			oldest = iter;
+	}
+	if (oldest == _cachedFonts.end())
+		return;
+
+	delete oldest->_value.font;
+	_cachedFonts.erase(oldest);
+	_stats.fontEvictions++;
+}
+
+void GfxCache::evictViews(GuiResourceId keepId) {
+	// Views grow while their cels get unpacked, so their sizes are brought up
+	// to date before deciding what to drop
+	_viewMemory = 0;
+	for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
+		iter->_value.size = iter->_value.view->getMemorySize();
+		_viewMemory += iter->_value.size;
+	}
+
+	while (_viewMemory > _viewBudget && _cachedViews.size() > MIN_CACHED_VIEWS) {
+		ViewCache::iterator oldest = _cachedViews.end();
+		for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
+			if (iter->_key != keepId && (oldest == _cachedViews.end() || iter->_value.lastUse < oldest->_value.lastUse))
+				oldest = iter;
+		}
+		if (oldest == _cachedViews.end())
+			break;
+
+		debugC(kDebugLevelGraphics, "GfxCache: Dropping view %d (%d bytes)", oldest->_key, oldest->_value.size);
+		_viewMemory -= oldest->_value.size;
+		delete oldest->_value.view;
+		_cachedViews.erase(oldest);
+		_stats.evictions++;
+	}
 }
 
 GfxFont *GfxCache::getFont(GuiResourceId fontId) {
-	if (_cachedFonts.size() >= MAX_CACHED_FONTS)
-		purgeFontCache();
-
-	if (!_cachedFonts.contains(fontId)) {
-		// Create special Korean font in korean games, when font 1001 is selected
-		if ((fontId == 1001) && (g_sci->getLanguage() == Common::KO_KOR))
-			_cachedFonts[fontId] = new GfxFontKorean(_screen, fontId);
-		// Create special SJIS font in japanese games, when font 900 is selected
-		else if ((fontId == 900) && (g_sci->getLanguage() == Common::JA_JPN))
-			_cachedFonts[fontId] = new GfxFontSjis(_screen, fontId);
-		else
-			_cachedFonts[fontId] = new GfxFontFromResource(_resMan, _screen, fontId);
+	FontCache::iterator iter = _cachedFonts.find(fontId);
+	if (iter != _cachedFonts.end()) {
+		iter->_value.lastUse = ++_useCounter;
+		return iter->_value.font;
 	}
 
-	return _cachedFonts[fontId];
+	CachedFont &entry = _cachedFonts[fontId];
+	// Create special Korean font in korean games, when font 1001 is selected
+	if ((fontId == 1001) && (g_sci->getLanguage() == Common::KO_KOR))
+		entry.font = new GfxFontKorean(_screen, fontId);
+	// Create special SJIS font in japanese games, when font 900 is selected
+	else if ((fontId == 900) && (g_sci->getLanguage() == Common::JA_JPN))
+		entry.font = new GfxFontSjis(_screen, fontId);
+	else
+		entry.font = new GfxFontFromResource(_resMan, _screen, fontId);
+	entry.lastUse = ++_useCounter;
+	GfxFont *font = entry.font;
+
+	if (_cachedFonts.size() > MAX_CACHED_FONTS)
+		evictFont(fontId);
+
+	return font;
 }
 
 GfxView *GfxCache::getView(GuiResourceId viewId) {
-	if (_cachedViews.size() >= MAX_CACHED_VIEWS)
-		purgeViewCache();
+	ViewCache::iterator iter = _cachedViews.find(viewId);
+	if (iter != _cachedViews.end()) {
+		_stats.hits++;
+		iter->_value.lastUse = ++_useCounter;
+		return iter->_value.view;
+	}
+
+	_stats.misses++;
+	GfxView *view = new GfxView(_resMan, _screen, _palette, viewId);
+	CachedView &entry = _cachedViews[viewId];
+	entry.view = view;
+	entry.lastUse = ++_useCounter;
+	entry.size = 0;
 
-	if (!_cachedViews.contains(viewId))
-		_cachedViews[viewId] = new GfxView(_resMan, _screen, _palette, viewId);
+	evictViews(viewId);
 
-	return _cachedViews[viewId];
+	return view;
 }
 
 int16 GfxCache::kernelViewGetCelWidth(GuiResourceId viewId, int16 loopNo, int16 celNo) {
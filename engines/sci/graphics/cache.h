@@ -22,27 +22,55 @@
 #ifndef SCI_GRAPHICS_CACHE_H
 #define SCI_GRAPHICS_CACHE_H
 
-#include "common/hashmap.h"
+#include "common/flathashmap.h"
 
 namespace Sci {
 
 class GfxFont;
 class GfxView;
 
-typedef Common::HashMap<int, GfxFont *> FontCache;
-typedef Common::HashMap<int, GfxView *> ViewCache;
+struct CachedFont {
+	GfxFont *font;
+	uint32 lastUse;
+};
+
+struct CachedView {
+	GfxView *view;
+	uint32 lastUse;
+	uint32 size;	///< Memory used by the view when it was last accounted
+};
+
+typedef Common::FlatHashMap<int, CachedFont> FontCache;
+typedef Common::FlatHashMap<int, CachedView> ViewCache;
 
 /**
  * Cache class, handles caching of views/fonts
+ *
+ * Views are kept within a memory budget and fonts within a fixed count. When
+ * either is exceeded, the least recently used entries are dropped.
  */
 class GfxCache {
 public:
+	struct Stats {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+		uint32 fontEvictions;
+	};
+
 	GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette);
 	~GfxCache();
 
 	GfxFont *getFont(GuiResourceId fontId);
 	GfxView *getView(GuiResourceId viewId);
 
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+	uint32 getViewBudget() const { return _viewBudget; }
+	uint32 getViewMemory() const { return _viewMemory; }
+	uint getViewCount() const { return _cachedViews.size(); }
+	uint getFontCount() const { return _cachedFonts.size(); }
+
 	int16 kernelViewGetCelWidth(GuiResourceId viewId, int16 loopNo, int16 celNo);
 	int16 kernelViewGetCelHeight(GuiResourceId viewId, int16 loopNo, int16 celNo);
 	int16 kernelViewGetLoopCount(GuiResourceId viewId);
@@ -51,6 +79,8 @@ public:
 private:
 	void purgeFontCache();
 	void purgeViewCache();
+	void evictFont(GuiResourceId keepId);
+	void evictViews(GuiResourceId keepId);
 
 	ResourceManager *_resMan;
 	GfxScreen *_screen;
@@ -58,6 +88,11 @@ private:
 
 	FontCache _cachedFonts;
 	ViewCache _cachedViews;
+
+	uint32 _useCounter;
+	uint32 _viewBudget;
+	uint32 _viewMemory;
+	Stats _stats;
 };
 
 } // End of namespace Sci
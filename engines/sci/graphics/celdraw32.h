@@ -0,0 +1,70 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCI_GRAPHICS_CELDRAW32_H
+#define SCI_GRAPHICS_CELDRAW32_H
+
+#include "common/scummsys.h"
+
+namespace Sci {
+
+/**
+ * Draws a row of cel pixels which need no remapping. Unless SKIP is false,
+ * pixels with the skip color are left alone.
+ *
+ * @param source    the first pixel to draw; when FLIP is set the row is read
+ *                  from there towards its start
+ */
+template<bool FLIP, bool SKIP>
+inline void drawCelSpan(byte *target, const byte *source, const int16 width, const uint8 skipColor) {
+	if (!FLIP && !SKIP) {
+		memcpy(target, source, width);
+		return;
+	}
+
+	for (int16 x = 0; x < width; ++x) {
+		const byte pixel = FLIP ? *source-- : *source++;
+		if (!SKIP || pixel != skipColor) {
+			target[x] = pixel;
+		}
+	}
+}
+
+/**
+ * Scales a row of cel pixels into `target` through a table of source
+ * indexes. Runs of equal indexes, like every pair of pixels when scaling up
+ * 2x, read their source pixel only once.
+ */
+inline void scaleCelSpan(byte *target, const byte *row, const int16 *valuesX, const int16 width) {
+	int16 x = 0;
+	while (x < width) {
+		const int16 index = valuesX[x];
+		const byte pixel = row[index];
+		target[x++] = pixel;
+		while (x < width && valuesX[x] == index) {
+			target[x++] = pixel;
+		}
+	}
+}
+
+} // End of namespace Sci
+
+#endif // SCI_GRAPHICS_CELDRAW32_H
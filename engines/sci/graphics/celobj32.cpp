@@ -24,6 +24,7 @@
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/graphics/celobj32.h"
+#include "sci/graphics/celdraw32.h"
 #include "sci/graphics/frameout.h"
 #include "sci/graphics/palette32.h"
 #include "sci/graphics/remap32.h"
@@ -84,13 +85,16 @@ const CelScalerTable &CelScaler::getScalerTable(const Ratio &scaleX, const Ratio
 #pragma mark -
 #pragma mark CelObj
 bool CelObj::_drawBlackLines = false;
+bool CelObj::_useGlobalScaling = false;
 
-void CelObj::init() {
+void CelObj::init(const bool useGlobalScaling) {
 	CelObj::deinit();
 	_drawBlackLines = false;
+	_useGlobalScaling = useGlobalScaling;
 	_nextCacheId = 1;
 	_scaler = new CelScaler();
 	_cache = new CelCache(100);
+	_cacheIndex = new CelCacheIndex();
 }
 
 void CelObj::deinit() {
@@ -98,6 +102,8 @@ void CelObj::deinit() {
 	_scaler = nullptr;
 	delete _cache;
 	_cache = nullptr;
+	delete _cacheIndex;
+	_cacheIndex = nullptr;
 }
 
 #pragma mark -
@@ -261,8 +267,7 @@ struct SCALER_Scale {
 				_valuesY[y] = CLIP<int16>(unsafeValue, 0, scaledImageRect.height() - 1);
 			}
 		} else {
-			const bool useGlobalScaling = g_sci->_gfxFrameout->getScriptWidth() == kLowResX;
-			if (useGlobalScaling) {
+			if (CelObj::_useGlobalScaling) {
 				const int16 unscaledX = (scaledPosition.x / scaleX).toInt();
 				if (FLIP) {
 					const int lastIndex = celObj._width - 1;
@@ -525,10 +530,11 @@ struct MAPPER_NoMap {
 };
 
 void CelObj::draw(Buffer &target, const ScreenItem &screenItem, const Common::Rect &targetRect) const {
-	const Common::Point &scaledPosition = screenItem._scaledPosition;
-	const Ratio &scaleX = screenItem._ratioX;
-	const Ratio &scaleY = screenItem._ratioY;
-	_drawBlackLines = screenItem._drawBlackLines;
+	drawScaled(target, targetRect, screenItem._scaledPosition, screenItem._ratioX, screenItem._ratioY, screenItem._drawBlackLines);
+}
+
+void CelObj::drawScaled(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY, const bool drawBlackLines) const {
+	_drawBlackLines = drawBlackLines;
 
 	if (_remap) {
 		// In SSCI, this check was `g_Remap_numActiveRemaps && _remap`, but
@@ -700,32 +706,33 @@ void CelObj::submitPalette() const {
 
 int CelObj::_nextCacheId = 1;
 CelCache *CelObj::_cache = nullptr;
+CelCacheIndex *CelObj::_cacheIndex = nullptr;
 
 int CelObj::searchCache(const CelInfo32 &celInfo, int *const nextInsertIndex) const {
 	*nextInsertIndex = -1;
+
+	CelCacheIndex::const_iterator cached = _cacheIndex->find(celInfo);
+	if (cached != _cacheIndex->end()) {
+		(*_cache)[cached->_value].id = ++_nextCacheId;
+		return cached->_value;
+	}
+
 	int oldestId = _nextCacheId + 1;
 	int oldestIndex = 0;
 
 	for (int i = 0, len = _cache->size(); i < len; ++i) {
-		CelCacheEntry &entry = (*_cache)[i];
+		const CelCacheEntry &entry = (*_cache)[i];
 
 		if (entry.celObj == nullptr) {
-			if (*nextInsertIndex == -1) {
-				*nextInsertIndex = i;
-			}
-		} else if (entry.celObj->_info == celInfo) {
-			entry.id = ++_nextCacheId;
-			return i;
+			*nextInsertIndex = i;
+			return -1;
 		} else if (oldestId > entry.id) {
 			oldestId = entry.id;
 			oldestIndex = i;
 		}
 	}
 
-	if (*nextInsertIndex == -1) {
-		*nextInsertIndex = oldestIndex;
-	}
-
+	*nextInsertIndex = oldestIndex;
 	return -1;
 }
 
@@ -735,8 +742,12 @@ void CelObj::putCopyInCache(const int cacheIndex) const {
 	}
 
 	CelCacheEntry &entry = (*_cache)[cacheIndex];
+	if (entry.celObj) {
+		_cacheIndex->erase(entry.celObj->_info);
+	}
 	entry.celObj.reset(duplicate());
 	entry.id = ++_nextCacheId;
+	_cacheIndex->setVal(entry.celObj->_info, cacheIndex);
 }
 
 #pragma mark -
@@ -779,6 +790,45 @@ struct RENDERER {
 	}
 };
 
+/**
+ * Line buffer for rows of scaled pixels drawn by CelObj::renderScaledSpans.
+ */
+static byte s_scaledLine[kCelScalerTableSize];
+
+template<bool FLIP, bool SKIP, typename READER>
+void CelObj::renderSpans(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	SCALER_NoScale<FLIP, READER> scaler(*this, targetRect.left - scaledPosition.x + targetRect.width(), scaledPosition);
+
+	byte *targetPixel = (byte *)target.getPixels() + target.w * targetRect.top + targetRect.left;
+	const int16 targetWidth = targetRect.width();
+	for (int16 y = targetRect.top; y < targetRect.bottom; ++y) {
+		scaler.setTarget(targetRect.left, y);
+		drawCelSpan<FLIP, SKIP>(targetPixel, scaler._row, targetWidth, _skipColor);
+		targetPixel += target.w;
+	}
+}
+
+template<bool FLIP, typename READER>
+void CelObj::renderScaledSpans(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY) const {
+	typedef SCALER_Scale<FLIP, READER> SCALER;
+	SCALER scaler(*this, targetRect, scaledPosition, scaleX, scaleY);
+
+	byte *targetPixel = (byte *)target.getPixels() + target.w * targetRect.top + targetRect.left;
+	const int16 targetWidth = targetRect.width();
+	int16 lastSourceY = -1;
+	for (int16 y = targetRect.top; y < targetRect.bottom; ++y) {
+		// When scaling up, consecutive rows come from the same source row,
+		// which only needs to be scaled once
+		if (SCALER::_valuesY[y] != lastSourceY) {
+			lastSourceY = SCALER::_valuesY[y];
+			scaler.setTarget(targetRect.left, y);
+			scaleCelSpan(s_scaledLine, scaler._row, SCALER::_valuesX + targetRect.left, targetWidth);
+		}
+		drawCelSpan<false, true>(targetPixel, s_scaledLine, targetWidth, _skipColor);
+		targetPixel += target.w;
+	}
+}
+
 template<typename MAPPER, typename SCALER>
 void CelObj::render(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
 
@@ -867,26 +917,56 @@ void CelObj::scaleDrawUncompMap(Buffer &target, const Ratio &scaleX, const Ratio
 }
 
 void CelObj::drawNoFlipNoMD(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (!_isMacSource) {
+		renderSpans<false, true, READER_Compressed>(target, targetRect, scaledPosition);
+		return;
+	}
+
 	render<MAPPER_NoMD, SCALER_NoScale<false, READER_Compressed> >(target, targetRect, scaledPosition);
 }
 
 void CelObj::drawHzFlipNoMD(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (!_isMacSource) {
+		renderSpans<true, true, READER_Compressed>(target, targetRect, scaledPosition);
+		return;
+	}
+
 	render<MAPPER_NoMD, SCALER_NoScale<true, READER_Compressed> >(target, targetRect, scaledPosition);
 }
 
 void CelObj::drawUncompNoFlipNoMD(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (!_isMacSource) {
+		renderSpans<false, true, READER_Uncompressed>(target, targetRect, scaledPosition);
+		return;
+	}
+
 	render<MAPPER_NoMD, SCALER_NoScale<false, READER_Uncompressed> >(target, targetRect, scaledPosition);
 }
 
 void CelObj::drawUncompNoFlipNoMDNoSkip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (!_isMacSource) {
+		renderSpans<false, false, READER_Uncompressed>(target, targetRect, scaledPosition);
+		return;
+	}
+
 	render<MAPPER_NoMDNoSkip, SCALER_NoScale<false, READER_Uncompressed> >(target, targetRect, scaledPosition);
 }
 
 void CelObj::drawUncompHzFlipNoMD(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (!_isMacSource) {
+		renderSpans<true, true, READER_Uncompressed>(target, targetRect, scaledPosition);
+		return;
+	}
+
 	render<MAPPER_NoMD, SCALER_NoScale<true, READER_Uncompressed> >(target, targetRect, scaledPosition);
 }
 
 void CelObj::drawUncompHzFlipNoMDNoSkip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+	if (!_isMacSource) {
+		renderSpans<true, false, READER_Uncompressed>(target, targetRect, scaledPosition);
+		return;
+	}
+
 	render<MAPPER_NoMDNoSkip, SCALER_NoScale<true, READER_Uncompressed> >(target, targetRect, scaledPosition);
 }
 
@@ -898,6 +978,14 @@ void CelObj::scaleDrawNoMD(Buffer &target, const Ratio &scaleX, const Ratio &sca
 		return;
 	}
 
+	if (!_isMacSource && !_drawBlackLines) {
+		if (_drawMirrored)
+			renderScaledSpans<true, READER_Compressed>(target, targetRect, scaledPosition, scaleX, scaleY);
+		else
+			renderScaledSpans<false, READER_Compressed>(target, targetRect, scaledPosition, scaleX, scaleY);
+		return;
+	}
+
 	if (_drawMirrored)
 		render<MAPPER_NoMD, SCALER_Scale<true, READER_Compressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	else
@@ -912,6 +1000,15 @@ void CelObj::scaleDrawUncompNoMD(Buffer &target, const Ratio &scaleX, const Rati
 		return;
 	}
 
+	if (!_isMacSource && !_drawBlackLines) {
+		if (_drawMirrored) {
+			renderScaledSpans<true, READER_Uncompressed>(target, targetRect, scaledPosition, scaleX, scaleY);
+		} else {
+			renderScaledSpans<false, READER_Uncompressed>(target, targetRect, scaledPosition, scaleX, scaleY);
+		}
+		return;
+	}
+
 	if (_drawMirrored) {
 		render<MAPPER_NoMD, SCALER_Scale<true, READER_Uncompressed> >(target, targetRect, scaledPosition, scaleX, scaleY);
 	} else {
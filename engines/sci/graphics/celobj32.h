@@ -22,6 +22,7 @@
 #ifndef SCI_GRAPHICS_CELOBJ32_H
 #define SCI_GRAPHICS_CELOBJ32_H
 
+#include "common/hashmap.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "sci/resource/resource.h"
@@ -105,7 +106,7 @@ struct CelInfo32 {
 
 	// This is the equivalence criteria used by CelObj::searchCache in at least
 	// SSCI SQ6. Notably, it does not check the color field.
-	inline bool operator==(const CelInfo32 &other) {
+	inline bool operator==(const CelInfo32 &other) const {
 		return (
 			type == other.type &&
 			resourceId == other.resourceId &&
@@ -115,7 +116,7 @@ struct CelInfo32 {
 		);
 	}
 
-	inline bool operator!=(const CelInfo32 &other) {
+	inline bool operator!=(const CelInfo32 &other) const {
 		return !(*this == other);
 	}
 
@@ -148,6 +149,23 @@ struct CelCacheEntry {
 
 typedef Common::Array<CelCacheEntry> CelCache;
 
+struct CelInfo32Hash {
+	uint operator()(const CelInfo32 &info) const {
+		uint hash = info.type;
+		hash = hash * 31 + info.resourceId;
+		hash = hash * 31 + (uint16)info.loopNo;
+		hash = hash * 31 + (uint16)info.celNo;
+		hash = hash * 31 + info.bitmap.getSegment();
+		hash = hash * 31 + info.bitmap.getOffset();
+		return hash;
+	}
+};
+
+/**
+ * Maps the CelInfo32 of every cached cel to its slot in the CelCache.
+ */
+typedef Common::HashMap<CelInfo32, int, CelInfo32Hash> CelCacheIndex;
+
 #pragma mark -
 #pragma mark CelScaler
 
@@ -262,6 +280,13 @@ protected:
 public:
 	static CelScaler *_scaler;
 
+	/**
+	 * When true, scaled cels follow the global scaling pattern, as if they
+	 * were always drawn from an even multiple of the scaling ratio. This is
+	 * the case for games with low resolution script coordinates.
+	 */
+	static bool _useGlobalScaling;
+
 	/**
 	 * The basic identifying information for this cel. This information
 	 * effectively acts as a composite key for a cel object, and any cel object
@@ -340,8 +365,11 @@ public:
 
 	/**
 	 * Initialises static CelObj members.
+	 *
+	 * @param useGlobalScaling  whether scaled cels follow the global scaling
+	 *                          pattern, see _useGlobalScaling
 	 */
-	static void init();
+	static void init(const bool useGlobalScaling);
 
 	/**
 	 * Frees static CelObj members.
@@ -357,6 +385,13 @@ public:
 	 */
 	void draw(Buffer &target, const ScreenItem &screenItem, const Common::Rect &targetRect) const;
 
+	/**
+	 * Draws the cel to the target buffer the same way as a screen item with
+	 * the given position, scaling and black lines flag. The mirroring of the
+	 * cel will be unchanged from any previous call to draw.
+	 */
+	void drawScaled(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY, const bool drawBlackLines) const;
+
 	/**
 	 * Draws the cel to the target buffer using the priority and positioning
 	 * information from the given screen item and the given mirror flag.
@@ -420,6 +455,16 @@ private:
 	template<typename MAPPER, typename SCALER>
 	void render(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY) const;
 
+	/**
+	 * Draws a cel which needs no remapping or Mac palette translation a row
+	 * at a time, instead of passing every pixel through a mapper.
+	 */
+	template<bool FLIP, bool SKIP, typename READER>
+	void renderSpans(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
+
+	template<bool FLIP, typename READER>
+	void renderScaledSpans(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition, const Ratio &scaleX, const Ratio &scaleY) const;
+
 	void drawHzFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
 	void drawNoFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
 	void drawUncompNoFlip(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
@@ -462,6 +507,12 @@ protected:
 	 */
 	static CelCache *_cache;
 
+	/**
+	 * The slots of the cel objects in the cache, so that finding a cached cel
+	 * does not need to go through the whole cache.
+	 */
+	static CelCacheIndex *_cacheIndex;
+
 	/**
 	 * Searches the cel cache for a CelObj matching the provided CelInfo32. If
 	 * not found, -1 is returned. `nextInsertIndex` will receive the index of
@@ -0,0 +1,164 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/array.h"
+
+#include "sci/graphics/floodfill.h"
+#include "sci/graphics/screen.h"
+
+namespace Sci {
+
+namespace {
+
+struct FloodFillSeed {
+	int16 x, y;
+};
+
+/**
+ * Checks pixels of one row against the search values of the fill. The plane
+ * to check is picked once, instead of for every pixel.
+ */
+class RowMatcher {
+public:
+	RowMatcher(const FloodFillPlanes &planes, const FloodFillParams &params) : _isEGAVisual(false) {
+		if (params.matchMask & GFX_SCREEN_MASK_VISUAL) {
+			_plane = planes.visual;
+			_search = params.searchColor;
+			_isEGAVisual = params.isEGA;
+		} else if (params.matchMask & GFX_SCREEN_MASK_PRIORITY) {
+			_plane = planes.priority;
+			_search = params.searchPriority;
+		} else {
+			_plane = planes.control;
+			_search = params.searchControl;
+		}
+		_width = planes.width;
+	}
+
+	void setRow(int16 y) {
+		_row = _plane + y * _width;
+		_y = y;
+	}
+
+	bool matches(int16 x) const {
+		byte value = _row[x];
+		if (_isEGAVisual) {
+			// In EGA games a pixel in the framebuffer is only 4 bits. We store
+			// a full byte per pixel to allow undithering, but when comparing
+			// pixels for flood-fill purposes, we should only compare the
+			// visible color of a pixel.
+			if ((x ^ _y) & 1)
+				value = (value ^ (value >> 4)) & 0x0F;
+			else
+				value = value & 0x0F;
+		}
+		return value == _search;
+	}
+
+private:
+	const byte *_plane;
+	const byte *_row;
+	uint16 _width;
+	int16 _y;
+	byte _search;
+	bool _isEGAVisual;
+};
+
+void fillRun(const FloodFillPlanes &planes, const FloodFillParams &params, int16 left, int16 right, int16 y) {
+	const int offset = y * planes.width + left;
+	const int count = right - left + 1;
+
+	if (params.drawMask & GFX_SCREEN_MASK_VISUAL) {
+		memset(planes.visual + offset, params.color, count);
+		if (planes.paletteMap)
+			memset(planes.paletteMap + offset, planes.paletteMapValue, count);
+
+		if (planes.displayUpscaled) {
+			byte *display = planes.display + (y * 2) * planes.displayWidth + left * 2;
+			memset(display, params.color, count * 2);
+			memset(display + planes.displayWidth, params.color, count * 2);
+		} else {
+			memset(planes.display + offset, params.color, count);
+		}
+	}
+	if (params.drawMask & GFX_SCREEN_MASK_PRIORITY)
+		memset(planes.priority + offset, params.priority, count);
+	if (params.drawMask & GFX_SCREEN_MASK_CONTROL)
+		memset(planes.control + offset, params.control, count);
+}
+
+// Remembers the start of every run of matching pixels between left and right
+void pushRuns(Common::Array<FloodFillSeed> &stack, RowMatcher &matcher, int16 left, int16 right, int16 y) {
+	matcher.setRow(y);
+	bool inRun = false;
+	for (int16 x = left; x <= right; x++) {
+		if (matcher.matches(x)) {
+			if (!inRun) {
+				FloodFillSeed seed;
+				seed.x = x;
+				seed.y = y;
+				stack.push_back(seed);
+				inRun = true;
+			}
+		} else {
+			inRun = false;
+		}
+	}
+}
+
+} // End of anonymous namespace
+
+void floodFill(const FloodFillPlanes &planes, const FloodFillParams &params, int16 x, int16 y, const Common::Rect &border) {
+	RowMatcher matcher(planes, params);
+	Common::Array<FloodFillSeed> stack;
+	stack.reserve(64);
+
+	FloodFillSeed seed;
+	seed.x = x;
+	seed.y = y;
+	stack.push_back(seed);
+
+	while (!stack.empty()) {
+		seed = stack.back();
+		stack.pop_back();
+
+		matcher.setRow(seed.y);
+		if (!matcher.matches(seed.x)) // already filled
+			continue;
+
+		int16 left = seed.x;
+		int16 right = seed.x;
+		while (left > border.left && matcher.matches(left - 1))
+			left--;
+		while (right < border.right - 1 && matcher.matches(right + 1))
+			right++;
+
+		fillRun(planes, params, left, right, seed.y);
+
+		// checking lines above and below for possible flood targets
+		if (seed.y > border.top)
+			pushRuns(stack, matcher, left, right, seed.y - 1);
+		if (seed.y < border.bottom - 1)
+			pushRuns(stack, matcher, left, right, seed.y + 1);
+	}
+}
+
+} // End of namespace Sci
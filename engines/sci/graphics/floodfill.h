@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCI_GRAPHICS_FLOODFILL_H
+#define SCI_GRAPHICS_FLOODFILL_H
+
+#include "common/rect.h"
+
+namespace Sci {
+
+/**
+ * The screen planes a flood fill works on. The visual, priority and control
+ * planes share the same layout.
+ */
+struct FloodFillPlanes {
+	byte *visual;
+	byte *priority;
+	byte *control;
+	uint16 width;
+
+	byte *display;          ///< Same layout as the visual plane, unless displayUpscaled is set
+	uint16 displayWidth;
+	bool displayUpscaled;   ///< Display is upscaled 2x (640x400 mode)
+
+	byte *paletteMap;       ///< Same layout as the visual plane, may be nullptr
+	byte paletteMapValue;
+};
+
+/**
+ * What a flood fill looks for and what it puts into the filled area.
+ */
+struct FloodFillParams {
+	byte matchMask;         ///< The plane checked for matching pixels (GFX_SCREEN_MASK_*)
+	byte searchColor;
+	byte searchPriority;
+	byte searchControl;
+	bool isEGA;             ///< Compare the visible EGA color of visual pixels
+
+	byte drawMask;          ///< The planes which get filled (GFX_SCREEN_MASK_*)
+	byte color;
+	byte priority;
+	byte control;
+};
+
+/**
+ * Scanline flood fill of the area connected to the given point. Whole runs
+ * of matching pixels get filled at once, and only the start of every run of
+ * matching pixels above and below a filled run is remembered, instead of
+ * going through the screen pixel by pixel.
+ *
+ * @param border    the area which may be filled, right and bottom are exclusive
+ */
+void floodFill(const FloodFillPlanes &planes, const FloodFillParams &params, int16 x, int16 y, const Common::Rect &border);
+
+} // End of namespace Sci
+
+#endif // SCI_GRAPHICS_FLOODFILL_H
@@ -27,6 +27,7 @@
 #include "common/str.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/trace.h"
 #include "engines/engine.h"
 #include "engines/util.h"
 #include "graphics/paletteman.h"
@@ -120,7 +121,7 @@ GfxFrameout::~GfxFrameout() {
 }
 
 void GfxFrameout::run() {
-	CelObj::init();
+	CelObj::init(_scriptWidth == kLowResX);
 	Plane::init();
 	ScreenItem::init();
 	GfxText32::init();
@@ -137,7 +138,7 @@ void GfxFrameout::clear() {
 	_planes.clear();
 	_visiblePlanes.clear();
 	_showList.clear();
-	_screenItemLists.clear();
+	_frameArena.freeUnusedChunks();
 }
 
 bool GfxFrameout::detectHiRes() const {
@@ -478,6 +479,7 @@ void GfxFrameout::kernelAddPicAt(const reg_t planeObject, const GuiResourceId pi
 #pragma mark Rendering
 
 void GfxFrameout::frameOut(const bool shouldShowBits, const Common::Rect &eraseRect) {
+	TRACE_ZONE("GfxFrameout::frameOut");
 	updateMousePositionForRendering();
 
 	RobotDecoder &robotPlayer = g_sci->_video32->getRobotPlayer();
@@ -489,23 +491,25 @@ void GfxFrameout::frameOut(const bool shouldShowBits, const Common::Rect &eraseR
 
 	// SSCI allocated these as static arrays of 100 pointers to
 	// ScreenItemList / RectList
-	_screenItemLists.resize(_planes.size());
-	for (DrawList::size_type i = 0; i < _screenItemLists.size(); ++i) {
-		_screenItemLists[i].clear();
-	}
-	EraseListList eraseLists(_planes.size());
+	Common::FrameArena::Scope frameScope(_frameArena);
+	const Common::FrameArenaAllocator<DrawList> allocator(&_frameArena);
+	ScreenItemListList screenItemLists(allocator);
+	EraseListList eraseLists(allocator);
+
+	screenItemLists.resize(_planes.size(), DrawList(&_frameArena));
+	eraseLists.resize(_planes.size(), RectList(&_frameArena));
 
 	if (g_sci->_gfxRemap32->getRemapCount() > 0 && _remapOccurred) {
 		remapMarkRedraw();
 	}
 
-	calcLists(_screenItemLists, eraseLists, eraseRect);
+	calcLists(screenItemLists, eraseLists, eraseRect);
 
-	for (ScreenItemListList::iterator list = _screenItemLists.begin(); list != _screenItemLists.end(); ++list) {
+	for (ScreenItemListList::iterator list = screenItemLists.begin(); list != screenItemLists.end(); ++list) {
 		list->sort();
 	}
 
-	for (ScreenItemListList::iterator list = _screenItemLists.begin(); list != _screenItemLists.end(); ++list) {
+	for (ScreenItemListList::iterator list = screenItemLists.begin(); list != screenItemLists.end(); ++list) {
 		for (DrawList::iterator drawItem = list->begin(); drawItem != list->end(); ++drawItem) {
 			(*drawItem)->screenItem->getCelObj().submitPalette();
 		}
@@ -515,7 +519,7 @@ void GfxFrameout::frameOut(const bool shouldShowBits, const Common::Rect &eraseR
 
 	for (PlaneList::size_type i = 0; i < _planes.size(); ++i) {
 		drawEraseList(eraseLists[i], *_planes[i]);
-		drawScreenItemList(_screenItemLists[i]);
+		drawScreenItemList(screenItemLists[i]);
 	}
 
 	if (robotIsActive) {
@@ -547,11 +551,13 @@ void GfxFrameout::palMorphFrameOut(const int8 *styleRanges, PlaneShowStyle *show
 
 	// SSCI allocated these as static arrays of 100 pointers to
 	// ScreenItemList / RectList
-	ScreenItemListList screenItemLists;
-	EraseListList eraseLists;
+	Common::FrameArena::Scope frameScope(_frameArena);
+	const Common::FrameArenaAllocator<DrawList> allocator(&_frameArena);
+	ScreenItemListList screenItemLists(allocator);
+	EraseListList eraseLists(allocator);
 
-	screenItemLists.resize(_planes.size());
-	eraseLists.resize(_planes.size());
+	screenItemLists.resize(_planes.size(), DrawList(&_frameArena));
+	eraseLists.resize(_planes.size(), RectList(&_frameArena));
 
 	if (g_sci->_gfxRemap32->getRemapCount() > 0 && _remapOccurred) {
 		remapMarkRedraw();
@@ -754,7 +760,7 @@ int splitRectsForRender(Common::Rect &middleRect, const Common::Rect &showRect,
 
 // The third rectangle parameter is only ever passed by VMD code
 void GfxFrameout::calcLists(ScreenItemListList &drawLists, EraseListList &eraseLists, const Common::Rect &eraseRect) {
-	RectList eraseList;
+	RectList eraseList(&_frameArena);
 	Common::Rect outRects[4];
 	int deletedPlaneCount = 0;
 	bool addedToEraseList = false;
@@ -1018,7 +1024,8 @@ void GfxFrameout::drawScreenItemList(const DrawList &screenItemList) {
 }
 
 void GfxFrameout::mergeToShowList(const Common::Rect &drawRect, RectList &showList, const int overdrawThreshold) {
-	RectList mergeList;
+	Common::FrameArena::Scope mergeScope(_frameArena);
+	RectList mergeList(&_frameArena);
 	Common::Rect merged;
 	mergeList.add(drawRect);
 
@@ -1465,6 +1472,13 @@ void GfxFrameout::printVisiblePlaneList(Console *con) const {
 	printPlaneListInternal(con, _visiblePlanes);
 }
 
+void GfxFrameout::printFrameArenaStats(Console *con) const {
+	const Common::FrameArena::Stats &stats = _frameArena.getStats();
+	con->debugPrintf("Allocations: %u\n", stats.allocations);
+	con->debugPrintf("Heap allocations: %u\n", stats.heapAllocations);
+	con->debugPrintf("Peak bytes: %u\n", (uint)stats.peakBytes);
+}
+
 void GfxFrameout::printPlaneItemListInternal(Console *con, const ScreenItemList &screenItemList) const {
 	ScreenItemList::size_type i = 0;
 	for (ScreenItemList::const_iterator sit = screenItemList.begin(); sit != screenItemList.end(); sit++) {
@@ -28,8 +28,8 @@
 #include "sci/graphics/screen_item32.h"
 
 namespace Sci {
-typedef Common::Array<DrawList> ScreenItemListList;
-typedef Common::Array<RectList> EraseListList;
+typedef Common::Array<DrawList, Common::FrameArenaAllocator<DrawList> > ScreenItemListList;
+typedef Common::Array<RectList, Common::FrameArenaAllocator<RectList> > EraseListList;
 
 class GfxCursor32;
 class GfxTransitions32;
@@ -329,10 +329,10 @@ private:
 	RectList _showList;
 
 	/**
-	 * A list of DrawLists used by frameOut(). This is a field to avoid
-	 * constructing and destroying DrawLists on every frame.
+	 * The arena of the draw and erase lists built while rendering a frame,
+	 * which is released at the end of the frame.
 	 */
-	ScreenItemListList _screenItemLists;
+	Common::FrameArena _frameArena;
 
 	/**
 	 * The amount of extra overdraw that is acceptable when merging two show
@@ -442,6 +442,7 @@ public:
 	void printPlaneItemList(Console *con, const reg_t planeObject) const;
 	void printVisiblePlaneItemList(Console *con, const reg_t planeObject) const;
 	void printPlaneItemListInternal(Console *con, const ScreenItemList &screenItemList) const;
+	void printFrameArenaStats(Console *con) const;
 };
 
 } // End of namespace Sci
@@ -39,7 +39,7 @@ namespace Sci {
 // Cache limits
 #define MAX_CACHED_CURSORS 10
 #define MAX_CACHED_FONTS 20
-#define MAX_CACHED_VIEWS 50
+#define MIN_CACHED_VIEWS 8
 
 enum ShakeDirection {
 	kShakeVertical   = 1,
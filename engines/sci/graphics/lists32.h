@@ -23,9 +23,40 @@
 #define SCI_GRAPHICS_LISTS32_H
 
 #include "common/array.h"
+#include "common/memory.h"
 
 namespace Sci {
 
+/**
+ * The default allocator of the items of the lists below. It allocates them
+ * like new does, so that a list can take ownership of items created by its
+ * users.
+ */
+template<class T>
+struct NewItemAllocator {
+	typedef T value_type;
+
+	template<class U>
+	struct rebind {
+		typedef NewItemAllocator<U> other;
+	};
+
+	NewItemAllocator() {}
+	template<class U>
+	NewItemAllocator(const NewItemAllocator<U> &) {}
+
+	T *allocate(size_t n) {
+		return (T *)::operator new(n * sizeof(T));
+	}
+
+	void deallocate(T *p, size_t n) {
+		::operator delete(p);
+	}
+
+	bool operator==(const NewItemAllocator &) const { return true; }
+	bool operator!=(const NewItemAllocator &) const { return false; }
+};
+
 /**
  * StablePointerArray holds pointers in a fixed-size array that maintains
  * position of erased items until `pack` is called. It is used by RectList
@@ -38,12 +69,30 @@ namespace Sci {
  * StablePointerDynamicArray was created below to handle DrawList, while
  * StablePointerArray keeps the performance advantages of fixed arrays on
  * the stack when rendering frames.
+ *
+ * The items which the array creates itself, as copies, are allocated with
+ * the given allocator, which must also be the one of any pointer passed to
+ * it.
  */
-template<class T, uint N>
-class StablePointerArray {
+template<class T, uint N, class Alloc = NewItemAllocator<T> >
+class StablePointerArray : private Alloc {
 	uint _size;
 	T *_items[N];
 
+protected:
+	T *create(const T &item) {
+		T *p = Alloc::allocate(1);
+		assert(p);
+		return new ((void *)p) T(item);
+	}
+
+	void destroy(T *item) {
+		if (item) {
+			item->~T();
+			Alloc::deallocate(item, 1);
+		}
+	}
+
 public:
 	typedef T **iterator;
 	typedef T *const *const_iterator;
@@ -51,16 +100,17 @@ public:
 	typedef uint size_type;
 
 	StablePointerArray() : _size(0), _items() {}
-	StablePointerArray(const StablePointerArray &other) : _size(other._size) {
+	explicit StablePointerArray(const Alloc &allocator) : Alloc(allocator), _size(0), _items() {}
+	StablePointerArray(const StablePointerArray &other) : Alloc(other.get_allocator()), _size(other._size) {
 		for (size_type i = 0; i < _size; ++i) {
 			if (other._items[i] == nullptr) {
 				_items[i] = nullptr;
 			} else {
-				_items[i] = new T(*other._items[i]);
+				_items[i] = create(*other._items[i]);
 			}
 		}
 	}
-	StablePointerArray(StablePointerArray &&other) : _size(other._size) {
+	StablePointerArray(StablePointerArray &&other) : Alloc(other.get_allocator()), _size(other._size) {
 		other._size = 0;
 		for (size_type i = 0; i < _size; ++i) {
 			_items[i] = other._items[i];
@@ -69,7 +119,7 @@ public:
 	}
 	~StablePointerArray() {
 		for (size_type i = 0; i < _size; ++i) {
-			delete _items[i];
+			destroy(_items[i]);
 		}
 	}
 
@@ -80,12 +130,19 @@ public:
 			if (other._items[i] == nullptr) {
 				_items[i] = nullptr;
 			} else {
-				_items[i] = new T(*other._items[i]);
+				_items[i] = create(*other._items[i]);
 			}
 		}
 	}
 
 	void operator=(StablePointerArray &&other) {
+		if (get_allocator() != other.get_allocator()) {
+			// The items of the other array cannot be freed by this one
+			*this = other;
+			other.clear();
+			return;
+		}
+
 		clear();
 		_size = other._size;
 		other._size = 0;
@@ -95,6 +152,10 @@ public:
 		}
 	}
 
+	Alloc get_allocator() const {
+		return *this;
+	}
+
 	T *const &operator[](size_type index) const {
 		assert(index < _size);
 		return _items[index];
@@ -123,7 +184,7 @@ public:
 
 	void clear() {
 		for (size_type i = 0; i < _size; ++i) {
-			delete _items[i];
+			destroy(_items[i]);
 			_items[i] = nullptr;
 		}
 
@@ -144,7 +205,7 @@ public:
 	void erase(T *item) {
 		for (iterator it = begin(); it != end(); ++it) {
 			if (*it == item) {
-				delete *it;
+				destroy(*it);
 				*it = nullptr;
 				break;
 			}
@@ -156,7 +217,7 @@ public:
 	 */
 	void erase(iterator &it) {
 		assert(it >= _items && it < _items + _size);
-		delete *it;
+		destroy(*it);
 		*it = nullptr;
 	}
 
@@ -166,7 +227,7 @@ public:
 	void erase_at(size_type index) {
 		assert(index < _size);
 
-		delete _items[index];
+		destroy(_items[index]);
 		_items[index] = nullptr;
 	}
 
@@ -211,9 +272,25 @@ public:
  * It is only used by DrawList, and was created upon discovering that LSL7
  * room 301 can overflow DrawList when displaying a large menu. Bug #14632
  */
-template<class T, uint N>
-class StablePointerDynamicArray {
-	Common::Array<T *> _items;
+template<class T, uint N, class Alloc = NewItemAllocator<T> >
+class StablePointerDynamicArray : private Alloc {
+	typedef typename Alloc::template rebind<T *>::other PointerAllocator;
+
+	Common::Array<T *, PointerAllocator> _items;
+
+protected:
+	T *create(const T &item) {
+		T *p = Alloc::allocate(1);
+		assert(p);
+		return new ((void *)p) T(item);
+	}
+
+	void destroy(T *item) {
+		if (item) {
+			item->~T();
+			Alloc::deallocate(item, 1);
+		}
+	}
 
 public:
 	typedef T **iterator;
@@ -224,40 +301,53 @@ public:
 	StablePointerDynamicArray() {
 		_items.reserve(N);
 	}
-	StablePointerDynamicArray(const StablePointerDynamicArray &other) {
+	explicit StablePointerDynamicArray(const Alloc &allocator) : Alloc(allocator), _items(PointerAllocator(allocator)) {
+		_items.reserve(N);
+	}
+	StablePointerDynamicArray(const StablePointerDynamicArray &other) : Alloc(other.get_allocator()), _items(PointerAllocator(other.get_allocator())) {
 		_items.reserve(MAX(N, other.size()));
 		for (size_type i = 0; i < other.size(); ++i) {
 			if (other._items[i] == nullptr) {
 				_items.push_back(nullptr);
 			} else {
-				_items.push_back(new T(*other._items[i]));
+				_items.push_back(create(*other._items[i]));
 			}
 		}
 	}
-	StablePointerDynamicArray(StablePointerDynamicArray &&other) {
-		_items = Common::move(other._items);
+	StablePointerDynamicArray(StablePointerDynamicArray &&other) : Alloc(other.get_allocator()), _items(Common::move(other._items)) {
 	}
 	~StablePointerDynamicArray() {
 		for (size_type i = 0; i < _items.size(); ++i) {
-			delete _items[i];
+			destroy(_items[i]);
 		}
 	}
 
-	void operator=(StablePointerDynamicArray &other) {
+	void operator=(const StablePointerDynamicArray &other) {
 		clear();
 		for (size_type i = 0; i < other.size(); ++i) {
 			if (other._items[i] == nullptr) {
 				_items.push_back(nullptr);
 			} else {
-				_items.push_back(new T(*other._items[i]));
+				_items.push_back(create(*other._items[i]));
 			}
 		}
 	}
 	void operator=(StablePointerDynamicArray &&other) {
+		if (get_allocator() != other.get_allocator()) {
+			// The items of the other array cannot be freed by this one
+			*this = other;
+			other.clear();
+			return;
+		}
+
 		clear();
 		_items = Common::move(other._items);
 	}
 
+	Alloc get_allocator() const {
+		return *this;
+	}
+
 	T *const &operator[](size_type index) const {
 		return _items[index];
 	}
@@ -283,7 +373,7 @@ public:
 
 	void clear() {
 		for (size_type i = 0; i < _items.size(); ++i) {
-			delete _items[i];
+			destroy(_items[i]);
 		}
 		_items.resize(0);
 	}
@@ -302,7 +392,7 @@ public:
 	void erase(T *item) {
 		for (iterator it = begin(); it != end(); ++it) {
 			if (*it == item) {
-				delete *it;
+				destroy(*it);
 				*it = nullptr;
 				break;
 			}
@@ -314,7 +404,7 @@ public:
 	 */
 	void erase(iterator &it) {
 		assert(it >= begin() && it < end());
-		delete *it;
+		destroy(*it);
 		*it = nullptr;
 	}
 
@@ -322,7 +412,7 @@ public:
 	 * Erases the object pointed to at the given index.
 	 */
 	void erase_at(size_type index) {
-		delete _items[index];
+		destroy(_items[index]);
 		_items[index] = nullptr;
 	}
 
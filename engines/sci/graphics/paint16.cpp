@@ -19,6 +19,8 @@
  *
  */
 
+#include "common/config-manager.h"
+
 #include "sci/sci.h"
 #include "sci/engine/features.h"
 #include "sci/engine/state.h"
@@ -31,6 +33,7 @@
 #include "sci/graphics/animate.h"
 #include "sci/graphics/scifont.h"
 #include "sci/graphics/picture.h"
+#include "sci/graphics/picture_cache.h"
 #include "sci/graphics/view.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/gfxdrivers.h"
@@ -51,9 +54,16 @@ GfxPaint16::GfxPaint16(ResourceManager *resMan, SegManager *segMan, GfxCache *ca
 	// _animate and _text16 will be initialized later on
 	_animate = nullptr;
 	_text16 = nullptr;
+
+	// Rendered pictures are cached unless the budget is set to 0
+	int pictureCacheKB = 1024;
+	if (ConfMan.hasKey("sci_picture_cache_kb"))
+		pictureCacheKB = ConfMan.getInt("sci_picture_cache_kb");
+	_pictureCache = pictureCacheKB > 0 ? new GfxPictureCache(screen, ports, palette, pictureCacheKB * 1024) : nullptr;
 }
 
 GfxPaint16::~GfxPaint16() {
+	delete _pictureCache;
 }
 
 void GfxPaint16::init(GfxAnimate *animate, GfxText16 *text16) {
@@ -66,17 +76,25 @@ void GfxPaint16::debugSetEGAdrawingVisualize(bool state) {
 }
 
 void GfxPaint16::drawPicture(GuiResourceId pictureId, bool mirroredFlag, bool addToFlag, GuiResourceId paletteId) {
-	GfxPicture *picture = new GfxPicture(_resMan, _coordAdjuster, _ports, _screen, _palette, pictureId, _EGAdrawingVisualize);
-
 	// Set up custom per-picture palette mod
 	doCustomPicPalette(_screen, pictureId);
 
-	// do we add to a picture? if not -> clear screen with white
-	if (!addToFlag)
-		clearScreen(_screen->getColorWhite());
+	GfxPictureCache *pictureCache = _EGAdrawingVisualize ? nullptr : _pictureCache;
+	if (!pictureCache || !pictureCache->restore(pictureId, mirroredFlag, addToFlag, paletteId)) {
+		GfxPicture *picture = new GfxPicture(_resMan, _coordAdjuster, _ports, _screen, _palette, pictureId, _EGAdrawingVisualize);
+		if (pictureCache)
+			picture->setEffectLog(pictureCache->beginRecording());
 
-	picture->draw(mirroredFlag, addToFlag, paletteId);
-	delete picture;
+		// do we add to a picture? if not -> clear screen with white
+		if (!addToFlag)
+			clearScreen(_screen->getColorWhite());
+
+		picture->draw(mirroredFlag, addToFlag, paletteId);
+		delete picture;
+
+		if (pictureCache)
+			pictureCache->endRecording();
+	}
 
 	// We make a call to SciPalette here, for increasing sys timestamp and also loading targetpalette, if palvary active
 	//  (SCI1.1 only)
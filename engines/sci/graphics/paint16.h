@@ -29,6 +29,7 @@ class GfxScreen;
 class GfxPalette;
 class Font;
 class GfxView;
+class GfxPictureCache;
 
 /**
  * Paint16 class, handles painting/drawing for SCI16 (SCI0-SCI1.1) games
@@ -41,6 +42,7 @@ public:
 	void init(GfxAnimate *animate, GfxText16 *text16);
 
 	void debugSetEGAdrawingVisualize(bool state);
+	GfxPictureCache *getPictureCache() const { return _pictureCache; }
 
 	void drawPicture(GuiResourceId pictureId, bool mirroredFlag, bool addToFlag, GuiResourceId paletteId);
 	void drawCelAndShow(GuiResourceId viewId, int16 loopNo, int16 celNo, uint16 leftPos, uint16 topPos, byte priority, uint16 paletteNo, uint16 scaleX = 128, uint16 scaleY = 128, uint16 scaleSignal = 0);
@@ -93,6 +95,7 @@ private:
 	GfxPalette *_palette;
 	GfxText16 *_text16;
 	GfxTransitions *_transitions;
+	GfxPictureCache *_pictureCache;
 
 	// true means make EGA picture drawing visible
 	bool _EGAdrawingVisualize;
@@ -20,7 +20,6 @@
  */
 
 #include "common/span.h"
-#include "common/stack.h"
 #include "common/system.h"
 
 #include "sci/sci.h"
@@ -28,6 +27,7 @@
 #include "sci/graphics/screen.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/coordadjuster.h"
+#include "sci/graphics/floodfill.h"
 #include "sci/graphics/ports.h"
 #include "sci/graphics/picture.h"
 
@@ -46,7 +46,8 @@ GfxPicture::GfxPicture(ResourceManager *resMan, GfxCoordAdjuster16 *coordAdjuste
 	_addToFlag(false),
 	_EGApaletteNo(0),
 	_priority(0),
-	_EGAdrawingVisualize(EGAdrawingVisualize) {
+	_EGAdrawingVisualize(EGAdrawingVisualize),
+	_effects(nullptr) {
 	
 	assert(resourceId != -1);
 	initData(resourceId);
@@ -138,7 +139,7 @@ void GfxPicture::drawSci11Vga() {
 	if (has_cel) {
 		// Create palette and set it
 		_palette->createFromData(inbuffer.subspan(palette_data_ptr), &palette);
-		_palette->set(&palette, true);
+		setPalette(&palette);
 
 		drawCelData(inbuffer, cel_headerPos, cel_RlePos, cel_LiteralPos, 0, 0, 0, 0, false);
 	}
@@ -147,7 +148,7 @@ void GfxPicture::drawSci11Vga() {
 	drawVectorData(inbuffer.subspan(vector_dataPos, vector_size));
 
 	// Set priority band information
-	_ports->priorityBandsInitSci11(inbuffer.subspan(40));
+	priorityBandsInitSci11(inbuffer.subspan(40));
 }
 
 extern void unpackCelData(const SciSpan<const byte> &inBuffer, SciSpan<byte> &celBitmap, byte clearColor, int rlePos, int literalPos, ViewType viewType, uint16 width, bool isMacSci11ViewData);
@@ -653,7 +654,7 @@ void GfxPicture::drawVectorData(const SciSpan<const byte> &data) {
 					curPos += size;
 					break;
 				case PIC_OPX_EGA_SET_PRIORITY_TABLE:
-					_ports->priorityBandsInit(data.subspan(curPos, 14));
+					priorityBandsInit(data.subspan(curPos, 14));
 					curPos += 14;
 					break;
 				default:
@@ -676,7 +677,7 @@ void GfxPicture::drawVectorData(const SciSpan<const byte> &data) {
 							curPos += 256 + 4 + 1024;
 						} else {
 							// Setting half of the Amiga palette
-							_palette->modifyAmigaPalette(data.subspan(curPos));
+							modifyAmigaPalette(data.subspan(curPos));
 							curPos += 32;
 						}
 					} else {
@@ -685,7 +686,7 @@ void GfxPicture::drawVectorData(const SciSpan<const byte> &data) {
 							palette.colors[i].used = data[curPos++];
 							palette.colors[i].r = data[curPos++]; palette.colors[i].g = data[curPos++]; palette.colors[i].b = data[curPos++];
 						}
-						_palette->set(&palette, true);
+						setPalette(&palette);
 					}
 					break;
 				case PIC_OPX_VGA_EMBEDDED_VIEW: // draw cel
@@ -702,11 +703,11 @@ void GfxPicture::drawVectorData(const SciSpan<const byte> &data) {
 					curPos += size;
 					break;
 				case PIC_OPX_VGA_PRIORITY_TABLE_EQDIST:
-					_ports->priorityBandsInit(-1, data.getUint16LEAt(curPos), data.getUint16LEAt(curPos + 2));
+					priorityBandsInit(data.getUint16LEAt(curPos), data.getUint16LEAt(curPos + 2));
 					curPos += 4;
 					break;
 				case PIC_OPX_VGA_PRIORITY_TABLE_EXPLICIT:
-					_ports->priorityBandsInit(data.subspan(curPos, 14));
+					priorityBandsInit(data.subspan(curPos, 14));
 					curPos += 14;
 					break;
 				default:
@@ -746,6 +747,50 @@ void GfxPicture::drawVectorData(const SciSpan<const byte> &data) {
 	error("picture vector data without terminator");
 }
 
+void GfxPicture::setPalette(Palette *palette) {
+	_palette->set(palette, true);
+	if (_effects)
+		logEffect(PictureEffect::kSetPalette, SciSpan<const byte>((const byte *)palette, sizeof(Palette)), sizeof(Palette));
+}
+
+void GfxPicture::modifyAmigaPalette(const SciSpan<const byte> &data) {
+	_palette->modifyAmigaPalette(data);
+	if (_effects)
+		logEffect(PictureEffect::kModifyAmigaPalette, data, 32);
+}
+
+void GfxPicture::priorityBandsInit(const SciSpan<const byte> &data) {
+	_ports->priorityBandsInit(data);
+	if (_effects)
+		logEffect(PictureEffect::kPriorityBands, data, 14);
+}
+
+void GfxPicture::priorityBandsInitSci11(const SciSpan<const byte> &data) {
+	_ports->priorityBandsInitSci11(data);
+	if (_effects)
+		logEffect(PictureEffect::kPriorityBandsSci11, data, 14 * 2);
+}
+
+void GfxPicture::priorityBandsInit(int16 top, int16 bottom) {
+	_ports->priorityBandsInit(-1, top, bottom);
+	if (_effects) {
+		PictureEffect effect;
+		effect.type = PictureEffect::kPriorityBandsEqualDistance;
+		effect.top = top;
+		effect.bottom = bottom;
+		_effects->push_back(effect);
+	}
+}
+
+void GfxPicture::logEffect(PictureEffect::Type type, const SciSpan<const byte> &data, uint size) {
+	PictureEffect effect;
+	effect.type = type;
+	effect.top = effect.bottom = 0;
+	effect.data.resize(size);
+	data.subspan(0, size).unsafeCopyDataTo(effect.data.begin());
+	_effects->push_back(effect);
+}
+
 bool GfxPicture::vectorIsNonOpcode(byte pixel) {
 	if (pixel >= PIC_OP_FIRST)
 		return false;
@@ -804,10 +849,9 @@ void GfxPicture::vectorGetPatternTexture(const SciSpan<const byte> &data, uint &
 // code. This algo really needs to behave exactly as the one from sierra.
 void GfxPicture::vectorFloodFill(int16 x, int16 y, byte color, byte priority, byte control) {
 	Port *curPort = _ports->getPort();
-	Common::Stack<Common::Point> stack;
-	Common::Point p, p1;
+	Common::Point p;
 	byte screenMask = _screen->getDrawingMask(color, priority, control);
-	byte matchedMask, matchMask;
+	byte matchMask;
 
 	bool isEGA = (_resMan->getViewType() == kViewEga);
 
@@ -864,63 +908,28 @@ void GfxPicture::vectorFloodFill(int16 x, int16 y, byte color, byte priority, by
 		matchMask = GFX_SCREEN_MASK_CONTROL;
 	}
 
+	FloodFillParams params;
+	params.matchMask = matchMask;
+	params.searchColor = searchColor;
+	params.searchPriority = searchPriority;
+	params.searchControl = searchControl;
+	params.isEGA = isEGA;
+	params.drawMask = screenMask;
+	params.color = color;
+	params.priority = priority;
+	params.control = control;
+
 	// hard borders for filling
 	int16 borderLeft = curPort->rect.left + curPort->left;
 	int16 borderTop = curPort->rect.top + curPort->top;
 	int16 borderRight = curPort->rect.right + curPort->left - 1;
 	int16 borderBottom = curPort->rect.bottom + curPort->top - 1;
-	int16 curToLeft, curToRight, a_set, b_set;
 
 	// Translate coordinates, if required (needed for Macintosh 480x300)
 	_screen->vectorAdjustCoordinate(&borderLeft, &borderTop);
 	_screen->vectorAdjustCoordinate(&borderRight, &borderBottom);
-	//return;
-
-	stack.push(p);
-
-	while (stack.size()) {
-		p = stack.pop();
-		if ((matchedMask = _screen->vectorIsFillMatch(p.x, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)) == 0) // already filled
-			continue;
-		_screen->vectorPutPixel(p.x, p.y, screenMask, color, priority, control);
-		curToLeft = p.x;
-		curToRight = p.x;
-		// moving west and east pointers as long as there is a matching color to fill
-		while (curToLeft > borderLeft && (matchedMask = _screen->vectorIsFillMatch(curToLeft - 1, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)))
-			_screen->vectorPutPixel(--curToLeft, p.y, screenMask, color, priority, control);
-		while (curToRight < borderRight && (matchedMask = _screen->vectorIsFillMatch(curToRight + 1, p.y, matchMask, searchColor, searchPriority, searchControl, isEGA)))
-			_screen->vectorPutPixel(++curToRight, p.y, screenMask, color, priority, control);
-#if 0
-		// debug code for floodfill
-		_screen->copyToScreen();
-		g_system->updateScreen();
-		g_system->delayMillis(100);
-#endif
-		// checking lines above and below for possible flood targets
-		a_set = b_set = 0;
-		while (curToLeft <= curToRight) {
-			if (p.y > borderTop && (matchedMask = _screen->vectorIsFillMatch(curToLeft, p.y - 1, matchMask, searchColor, searchPriority, searchControl, isEGA))) { // one line above
-				if (a_set == 0) {
-					p1.x = curToLeft;
-					p1.y = p.y - 1;
-					stack.push(p1);
-					a_set = 1;
-				}
-			} else
-				a_set = 0;
-
-			if (p.y < borderBottom && (matchedMask = _screen->vectorIsFillMatch(curToLeft, p.y + 1, matchMask, searchColor, searchPriority, searchControl, isEGA))) { // one line below
-				if (b_set == 0) {
-					p1.x = curToLeft;
-					p1.y = p.y + 1;
-					stack.push(p1);
-					b_set = 1;
-				}
-			} else
-				b_set = 0;
-			curToLeft++;
-		}
-	}
+
+	_screen->vectorFloodFill(p.x, p.y, Common::Rect(borderLeft, borderTop, borderRight + 1, borderBottom + 1), params);
 }
 
 // Bitmap for drawing sierra circles
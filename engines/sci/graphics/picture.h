@@ -22,6 +22,8 @@
 #ifndef SCI_GRAPHICS_PICTURE_H
 #define SCI_GRAPHICS_PICTURE_H
 
+#include "common/array.h"
+
 #include "sci/util.h"
 
 namespace Sci {
@@ -42,6 +44,28 @@ class GfxPalette;
 class GfxCoordAdjuster16;
 class ResourceManager;
 class Resource;
+struct Palette;
+
+/**
+ * A change to global state a picture makes besides drawing into the screen
+ * planes, recorded so that it can be applied again when a cached rendering
+ * of the picture is used.
+ */
+struct PictureEffect {
+	enum Type {
+		kSetPalette,
+		kModifyAmigaPalette,
+		kPriorityBands,
+		kPriorityBandsSci11,
+		kPriorityBandsEqualDistance
+	};
+
+	Type type;
+	int16 top, bottom;        ///< Only for kPriorityBandsEqualDistance
+	Common::Array<byte> data; ///< Palette or priority table
+};
+
+typedef Common::Array<PictureEffect> PictureEffectList;
 
 /**
  * Picture class, handles loading and displaying of picture resources
@@ -55,6 +79,12 @@ public:
 	GuiResourceId getResourceId();
 	void draw(bool mirroredFlag, bool addToFlag, int16 EGApaletteNo);
 
+	/**
+	 * Records the palette and priority band changes done while drawing
+	 * into the given list.
+	 */
+	void setEffectLog(PictureEffectList *effects) { _effects = effects; }
+
 private:
 	void initData(GuiResourceId resourceId);
 #if 0
@@ -76,6 +106,13 @@ private:
 	void vectorPatternCircle(Common::Rect box, Common::Rect clipBox, byte size, byte color, byte prio, byte control);
 	void vectorPatternTexturedCircle(Common::Rect box, Common::Rect clipBox, byte size, byte color, byte prio, byte control, byte texture);
 
+	void setPalette(Palette *palette);
+	void modifyAmigaPalette(const SciSpan<const byte> &data);
+	void priorityBandsInit(const SciSpan<const byte> &data);
+	void priorityBandsInitSci11(const SciSpan<const byte> &data);
+	void priorityBandsInit(int16 top, int16 bottom);
+	void logEffect(PictureEffect::Type type, const SciSpan<const byte> &data, uint size);
+
 	ResourceManager *_resMan;
 	GfxCoordAdjuster16 *_coordAdjuster;
 	GfxPorts *_ports;
@@ -93,6 +130,8 @@ private:
 
 	// If true, we will show the whole EGA drawing process...
 	bool _EGAdrawingVisualize;
+
+	PictureEffectList *_effects;
 };
 
 } // End of namespace Sci
@@ -0,0 +1,281 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/debug.h"
+
+#include "sci/sci.h"
+#include "sci/graphics/palette.h"
+#include "sci/graphics/picture_cache.h"
+#include "sci/graphics/ports.h"
+
+namespace Sci {
+
+// Splits the screen outside of the given rect into up to 4 rects
+static int getOutsideRects(const Common::Rect &rect, int16 screenWidth, int16 screenHeight, Common::Rect *outside) {
+	int count = 0;
+	if (rect.top > 0)
+		outside[count++] = Common::Rect(0, 0, screenWidth, rect.top);
+	if (rect.bottom < screenHeight)
+		outside[count++] = Common::Rect(0, rect.bottom, screenWidth, screenHeight);
+	if (rect.left > 0)
+		outside[count++] = Common::Rect(0, rect.top, rect.left, rect.bottom);
+	if (rect.right < screenWidth)
+		outside[count++] = Common::Rect(rect.right, rect.top, screenWidth, rect.bottom);
+	return count;
+}
+
+GfxPictureCache::GfxPictureCache(GfxScreen *screen, GfxPorts *ports, GfxPalette *palette, uint32 budget)
+	: _screen(screen), _ports(ports), _palette(palette), _budget(budget), _size(0), _pendingCacheable(false) {
+	resetStats();
+}
+
+GfxPictureCache::~GfxPictureCache() {
+	clear();
+}
+
+void GfxPictureCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+	_stats.uncacheable = 0;
+}
+
+void GfxPictureCache::clear() {
+	while (!_entries.empty())
+		evict(_entries.begin());
+	_chain.clear();
+}
+
+bool GfxPictureCache::chainsEqual(const Chain &a, const Chain &b) {
+	if (a.size() != b.size())
+		return false;
+	for (uint i = 0; i < a.size(); i++) {
+		if (!(a[i] == b[i]))
+			return false;
+	}
+	return true;
+}
+
+GfxPictureCache::Entry *GfxPictureCache::find(const Chain &chain, const Common::Rect &rect, bool undithering) {
+	for (EntryList::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		Entry *entry = *it;
+		if (entry->rect == rect && entry->undithering == undithering && chainsEqual(entry->chain, chain)) {
+			// Move to the front of the LRU list
+			_entries.erase(it);
+			_entries.push_front(entry);
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool GfxPictureCache::isOnScreen(const Entry *entry) {
+	if (!_screen->bitsEqual(entry->bits))
+		return false;
+	const int16 *ditheredColors = _screen->unditherGetDitheredBgColors();
+	return !ditheredColors || !memcmp(ditheredColors, entry->ditheredColors, sizeof(entry->ditheredColors));
+}
+
+bool GfxPictureCache::restore(GuiResourceId pictureId, bool mirroredFlag, bool addToFlag, int16 EGApaletteNo) {
+	_pendingCacheable = false;
+	_pendingEffects.clear();
+
+	// All planes are upscaled in this mode, which bitsSave() does not support
+	if (_screen->getUpscaledHires() == GFX_SCREEN_UPSCALED_480x300) {
+		_chain.clear();
+		return false;
+	}
+
+	Common::Rect rect = _ports->getPort()->rect;
+	_ports->offsetRect(rect);
+	rect.clip(Common::Rect(_screen->getScriptWidth(), _screen->getScriptHeight()));
+	if (rect.isEmpty()) {
+		_chain.clear();
+		return false;
+	}
+
+	const bool undithering = _screen->unditherGetDitheredBgColors() != nullptr;
+
+	Chain chain;
+	if (addToFlag) {
+		// The picture gets drawn over the current screen, which is only known
+		// if it still holds the rendering of the pictures drawn before
+		Entry *prefix = _chain.empty() ? nullptr : find(_chain, rect, undithering);
+		if (!prefix || !isOnScreen(prefix)) {
+			_chain.clear();
+			return false;
+		}
+		chain = _chain;
+	}
+
+	Link link;
+	link.pictureId = pictureId;
+	link.mirroredFlag = mirroredFlag;
+	link.EGApaletteNo = EGApaletteNo;
+	chain.push_back(link);
+
+	Entry *entry = find(chain, rect, undithering);
+	if (!entry) {
+		_pendingCacheable = true;
+		_pendingChain = chain;
+		_pendingRect = rect;
+		return false;
+	}
+
+	_stats.hits++;
+
+	_screen->bitsRestore(entry->bits);
+	int16 *ditheredColors = _screen->unditherGetDitheredBgColors();
+	if (ditheredColors)
+		memcpy(ditheredColors, entry->ditheredColors, sizeof(entry->ditheredColors));
+	applyEffects(entry->effects);
+
+	_chain = chain;
+	return true;
+}
+
+PictureEffectList *GfxPictureCache::beginRecording() {
+	_stats.misses++;
+	if (!_pendingCacheable) {
+		_chain.clear();
+		return nullptr;
+	}
+
+	Common::Rect outside[4];
+	const int outsideCount = getOutsideRects(_pendingRect, _screen->getScriptWidth(), _screen->getScriptHeight(), outside);
+
+	uint32 outsideSize = 0;
+	for (int i = 0; i < outsideCount; i++)
+		outsideSize += _screen->bitsGetDataSize(outside[i], GFX_SCREEN_MASK_ALL);
+
+	_outsideBits.resize(outsideSize);
+	byte *outsidePtr = _outsideBits.begin();
+	for (int i = 0; i < outsideCount; i++) {
+		_screen->bitsSave(outside[i], GFX_SCREEN_MASK_ALL, outsidePtr);
+		outsidePtr += _screen->bitsGetDataSize(outside[i], GFX_SCREEN_MASK_ALL);
+	}
+
+	return &_pendingEffects;
+}
+
+void GfxPictureCache::endRecording() {
+	if (!_pendingCacheable)
+		return;
+	_pendingCacheable = false;
+
+	// Only the port is stored, so pictures which drew outside of it are not
+	// cached
+	Common::Rect outside[4];
+	const int outsideCount = getOutsideRects(_pendingRect, _screen->getScriptWidth(), _screen->getScriptHeight(), outside);
+	const byte *outsidePtr = _outsideBits.begin();
+	for (int i = 0; i < outsideCount; i++) {
+		if (!_screen->bitsEqual(outsidePtr)) {
+			debugC(kDebugLevelGraphics, "GfxPictureCache: Picture %d drew outside of the port", _pendingChain.back().pictureId);
+			_stats.uncacheable++;
+			_chain.clear();
+			return;
+		}
+		outsidePtr += _screen->bitsGetDataSize(outside[i], GFX_SCREEN_MASK_ALL);
+	}
+
+	_chain = _pendingChain;
+
+	const uint32 bitsSize = _screen->bitsGetDataSize(_pendingRect, GFX_SCREEN_MASK_ALL);
+	uint32 size = sizeof(Entry) + bitsSize + _pendingChain.size() * sizeof(Link);
+	for (uint i = 0; i < _pendingEffects.size(); i++)
+		size += sizeof(PictureEffect) + _pendingEffects[i].data.size();
+
+	if (size > _budget) {
+		_stats.uncacheable++;
+		return;
+	}
+
+	while (!_entries.empty() && _size + size > _budget) {
+		evict(--_entries.end());
+		_stats.evictions++;
+	}
+
+	byte *bits = (byte *)malloc(bitsSize);
+	if (!bits) {
+		_stats.uncacheable++;
+		return;
+	}
+
+	Entry *entry = new Entry();
+	entry->chain = _pendingChain;
+	entry->rect = _pendingRect;
+	entry->bits = bits;
+	entry->effects = _pendingEffects;
+	entry->size = size;
+	_screen->bitsSave(_pendingRect, GFX_SCREEN_MASK_ALL, bits);
+
+	const int16 *ditheredColors = _screen->unditherGetDitheredBgColors();
+	entry->undithering = ditheredColors != nullptr;
+	if (ditheredColors)
+		memcpy(entry->ditheredColors, ditheredColors, sizeof(entry->ditheredColors));
+	else
+		memset(entry->ditheredColors, 0, sizeof(entry->ditheredColors));
+
+	_entries.push_front(entry);
+	_size += size;
+
+	debugC(kDebugLevelGraphics, "GfxPictureCache: Stored picture %d (chain of %d), %d pictures in %d bytes", _pendingChain.back().pictureId, _pendingChain.size(), _entries.size(), _size);
+}
+
+void GfxPictureCache::applyEffects(const PictureEffectList &effects) {
+	for (uint i = 0; i < effects.size(); i++) {
+		const PictureEffect &effect = effects[i];
+		const SciSpan<const byte> data(effect.data.begin(), effect.data.size());
+
+		switch (effect.type) {
+		case PictureEffect::kSetPalette: {
+			Palette palette;
+			memcpy((void *)&palette, effect.data.begin(), sizeof(Palette));
+			_palette->set(&palette, true);
+			break;
+		}
+		case PictureEffect::kModifyAmigaPalette:
+			_palette->modifyAmigaPalette(data);
+			break;
+		case PictureEffect::kPriorityBands:
+			_ports->priorityBandsInit(data);
+			break;
+		case PictureEffect::kPriorityBandsSci11:
+			_ports->priorityBandsInitSci11(data);
+			break;
+		case PictureEffect::kPriorityBandsEqualDistance:
+			_ports->priorityBandsInit(-1, effect.top, effect.bottom);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void GfxPictureCache::evict(EntryList::iterator it) {
+	Entry *entry = *it;
+	_entries.erase(it);
+	_size -= entry->size;
+	free(entry->bits);
+	delete entry;
+}
+
+} // End of namespace Sci
@@ -0,0 +1,137 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCI_GRAPHICS_PICTURE_CACHE_H
+#define SCI_GRAPHICS_PICTURE_CACHE_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/rect.h"
+
+#include "sci/graphics/helpers.h"
+#include "sci/graphics/picture.h"
+#include "sci/graphics/screen.h"
+
+namespace Sci {
+
+class GfxPorts;
+class GfxPalette;
+
+/**
+ * Cache of rendered SCI16 pictures. Drawing a vector picture means running
+ * its whole drawing program including flood fills again, so the visual,
+ * priority and control planes resulting from a drawPicture() call are kept
+ * and restored when the same picture is drawn again.
+ *
+ * Pictures drawn with the addTo flag are drawn on top of whatever is on the
+ * screen, so they are keyed by the whole chain of pictures drawn since the
+ * screen was last cleared. Such a chain is only used once the screen has
+ * been verified to still hold the rendering of the chain so far.
+ */
+class GfxPictureCache {
+public:
+	struct Stats {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+		uint32 uncacheable; ///< Renderings which could not be stored
+	};
+
+	GfxPictureCache(GfxScreen *screen, GfxPorts *ports, GfxPalette *palette, uint32 budget);
+	~GfxPictureCache();
+
+	/**
+	 * Restores the rendering of the given picture into the current port.
+	 * Returns false if it is not cached, the picture then has to be drawn
+	 * between beginRecording() and endRecording().
+	 */
+	bool restore(GuiResourceId pictureId, bool mirroredFlag, bool addToFlag, int16 EGApaletteNo);
+
+	/**
+	 * Starts recording the rendering of the picture of the last failed
+	 * restore(). Returns the list the picture has to log its effects into,
+	 * or nullptr if the rendering can not be cached.
+	 */
+	PictureEffectList *beginRecording();
+	void endRecording();
+
+	void clear();
+
+	uint32 getBudget() const { return _budget; }
+	uint32 getSize() const { return _size; }
+	uint getEntryCount() const { return _entries.size(); }
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	struct Link {
+		GuiResourceId pictureId;
+		bool mirroredFlag;
+		int16 EGApaletteNo;
+
+		bool operator==(const Link &other) const {
+			return pictureId == other.pictureId && mirroredFlag == other.mirroredFlag && EGApaletteNo == other.EGApaletteNo;
+		}
+	};
+
+	typedef Common::Array<Link> Chain;
+
+	struct Entry {
+		Chain chain;
+		Common::Rect rect;
+		bool undithering;
+		byte *bits;
+		int16 ditheredColors[DITHERED_BG_COLORS_SIZE];
+		PictureEffectList effects;
+		uint32 size;
+	};
+
+	typedef Common::List<Entry *> EntryList;
+
+	Entry *find(const Chain &chain, const Common::Rect &rect, bool undithering);
+	bool isOnScreen(const Entry *entry);
+	void applyEffects(const PictureEffectList &effects);
+	void evict(EntryList::iterator it);
+	static bool chainsEqual(const Chain &a, const Chain &b);
+
+	GfxScreen *_screen;
+	GfxPorts *_ports;
+	GfxPalette *_palette;
+
+	uint32 _budget;
+	uint32 _size;
+	EntryList _entries; ///< Most recently used first
+	Stats _stats;
+
+	/** Pictures drawn since the screen was cleared, empty if unknown */
+	Chain _chain;
+
+	// Rendering which is currently being recorded
+	bool _pendingCacheable;
+	Chain _pendingChain;
+	Common::Rect _pendingRect;
+	PictureEffectList _pendingEffects;
+	Common::Array<byte> _outsideBits; ///< Screen outside of the port before drawing
+};
+
+} // End of namespace Sci
+
+#endif // SCI_GRAPHICS_PICTURE_CACHE_H
@@ -35,10 +35,10 @@
 namespace Sci {
 #pragma mark DrawList
 void DrawList::add(ScreenItem *screenItem, const Common::Rect &rect) {
-	DrawItem *drawItem = new DrawItem;
-	drawItem->screenItem = screenItem;
-	drawItem->rect = rect;
-	DrawListBase::add(drawItem);
+	DrawItem drawItem;
+	drawItem.screenItem = screenItem;
+	drawItem.rect = rect;
+	DrawListBase::add(create(drawItem));
 }
 
 #pragma mark -
@@ -646,7 +646,7 @@ void Plane::filterUpEraseRects(DrawList &drawList, const RectList &lowerEraseLis
 }
 
 void Plane::mergeToDrawList(const ScreenItemList::size_type index, const Common::Rect &rect, DrawList &drawList) const {
-	RectList mergeList;
+	RectList mergeList(drawList.getArena());
 	ScreenItem &item = *_screenItemList[index];
 	Common::Rect r = item._screenRect;
 	r.clip(rect);
@@ -688,7 +688,7 @@ void Plane::mergeToDrawList(const ScreenItemList::size_type index, const Common:
 }
 
 void Plane::mergeToRectList(const Common::Rect &rect, RectList &eraseList) const {
-	RectList mergeList;
+	RectList mergeList(eraseList.getArena());
 	Common::Rect r;
 	mergeList.add(rect);
 
@@ -23,6 +23,7 @@
 #define SCI_GRAPHICS_PLANE32_H
 
 #include "common/array.h"
+#include "common/framearena.h"
 #include "common/rect.h"
 #include "sci/engine/features.h"
 #include "sci/engine/vm_types.h"
@@ -51,11 +52,24 @@ enum PlanePictureCodes {
 #pragma mark -
 #pragma mark RectList
 
-typedef StablePointerArray<Common::Rect, 200> RectListBase;
+typedef StablePointerArray<Common::Rect, 200, Common::FrameArenaAllocator<Common::Rect> > RectListBase;
 class RectList : public RectListBase {
 public:
+	RectList() {}
+
+	/**
+	 * Constructs a list which allocates its rects from the given arena, or
+	 * from the heap if it is null.
+	 */
+	explicit RectList(Common::FrameArena *arena) :
+		RectListBase(Common::FrameArenaAllocator<Common::Rect>(arena)) {}
+
 	void add(const Common::Rect &rect) {
-		RectListBase::add(new Common::Rect(rect));
+		RectListBase::add(create(rect));
+	}
+
+	Common::FrameArena *getArena() const {
+		return get_allocator().getArena();
 	}
 };
 
@@ -78,14 +92,28 @@ struct DrawItem {
 	}
 };
 
-typedef StablePointerDynamicArray<DrawItem, 250> DrawListBase;
+typedef StablePointerDynamicArray<DrawItem, 250, Common::FrameArenaAllocator<DrawItem> > DrawListBase;
 class DrawList : public DrawListBase {
 private:
 	inline static bool sortHelper(const DrawItem *a, const DrawItem *b) {
 		return *a < *b;
 	}
 public:
+	DrawList() {}
+
+	/**
+	 * Constructs a list which allocates its items from the given arena, or
+	 * from the heap if it is null.
+	 */
+	explicit DrawList(Common::FrameArena *arena) :
+		DrawListBase(Common::FrameArenaAllocator<DrawItem>(arena)) {}
+
 	void add(ScreenItem *screenItem, const Common::Rect &rect);
+
+	Common::FrameArena *getArena() const {
+		return get_allocator().getArena();
+	}
+
 	inline void sort() {
 		pack();
 		Common::sort(begin(), end(), sortHelper);
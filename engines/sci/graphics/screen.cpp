@@ -30,6 +30,7 @@
 
 #include "sci/sci.h"
 #include "sci/engine/state.h"
+#include "sci/graphics/floodfill.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/view.h"
 #include "sci/graphics/palette.h"
@@ -441,34 +442,20 @@ void GfxScreen::vectorPutLinePixel480x300(int16 x, int16 y, byte drawMask, byte
 	}
 }
 
-byte GfxScreen::vectorIsFillMatch(int16 x, int16 y, byte screenMask, byte checkForColor, byte checkForPriority, byte checkForControl, bool isEGA) {
-	int offset = y * _width + x;
-	byte match = 0;
-
-	if (screenMask & GFX_SCREEN_MASK_VISUAL) {
-		if (!isEGA) {
-			if (*(_visualScreen + offset) == checkForColor)
-				match |= GFX_SCREEN_MASK_VISUAL;
-		} else {
-			// In EGA games a pixel in the framebuffer is only 4 bits. We store
-			// a full byte per pixel to allow undithering, but when comparing
-			// pixels for flood-fill purposes, we should only compare the
-			// visible color of a pixel.
-
-			byte EGAcolor = *(_visualScreen + offset);
-			if ((x ^ y) & 1)
-				EGAcolor = (EGAcolor ^ (EGAcolor >> 4)) & 0x0F;
-			else
-				EGAcolor = EGAcolor & 0x0F;
-			if (EGAcolor == checkForColor)
-				match |= GFX_SCREEN_MASK_VISUAL;
-		}
-	}
-	if ((screenMask & GFX_SCREEN_MASK_PRIORITY) && *(_priorityScreen + offset) == checkForPriority)
-		match |= GFX_SCREEN_MASK_PRIORITY;
-	if ((screenMask & GFX_SCREEN_MASK_CONTROL) && *(_controlScreen + offset) == checkForControl)
-		match |= GFX_SCREEN_MASK_CONTROL;
-	return match;
+void GfxScreen::vectorFloodFill(int16 x, int16 y, const Common::Rect &border, const FloodFillParams &params) {
+	FloodFillPlanes planes;
+	planes.visual = _visualScreen;
+	planes.priority = _priorityScreen;
+	planes.control = _controlScreen;
+	planes.width = _width;
+	// Same as vectorPutPixel(), only the 640x400 mode upscales the display
+	planes.display = _displayScreen;
+	planes.displayWidth = _displayWidth;
+	planes.displayUpscaled = (_upscaledHires == GFX_SCREEN_UPSCALED_640x400);
+	planes.paletteMap = _paletteMapScreen;
+	planes.paletteMapValue = _curPaletteMapValue;
+
+	floodFill(planes, params, x, y, border);
 }
 
 /**
@@ -728,6 +715,71 @@ void GfxScreen::bitsRestoreDisplayScreen(Common::Rect rect, const byte *&memoryP
 	}
 }
 
+// Checks whether the screen still holds what bitsSave() stored
+bool GfxScreen::bitsEqual(const byte *memoryPtr) {
+	Common::Rect rect;
+	byte mask;
+
+	memcpy((void *)&rect, memoryPtr, sizeof(rect)); memoryPtr += sizeof(rect);
+	memcpy((void *)&mask, memoryPtr, sizeof(mask)); memoryPtr += sizeof(mask);
+
+	if (mask & GFX_SCREEN_MASK_VISUAL) {
+		if (!bitsEqualScreen(rect, memoryPtr, _visualScreen, _width))
+			return false;
+		if (!bitsEqualDisplayScreen(rect, memoryPtr, _displayScreen))
+			return false;
+		if (_paletteMapScreen && !bitsEqualDisplayScreen(rect, memoryPtr, _paletteMapScreen))
+			return false;
+	}
+	if (mask & GFX_SCREEN_MASK_PRIORITY) {
+		if (!bitsEqualScreen(rect, memoryPtr, _priorityScreen, _width))
+			return false;
+	}
+	if (mask & GFX_SCREEN_MASK_CONTROL) {
+		if (!bitsEqualScreen(rect, memoryPtr, _controlScreen, _width))
+			return false;
+	}
+	return true;
+}
+
+bool GfxScreen::bitsEqualScreen(Common::Rect rect, const byte *&memoryPtr, const byte *screen, uint16 screenWidth) {
+	int width = rect.width();
+	int y;
+
+	screen += (rect.top * screenWidth) + rect.left;
+
+	for (y = rect.top; y < rect.bottom; y++) {
+		if (memcmp(screen, memoryPtr, width))
+			return false;
+		memoryPtr += width;
+		screen += screenWidth;
+	}
+	return true;
+}
+
+bool GfxScreen::bitsEqualDisplayScreen(Common::Rect rect, const byte *&memoryPtr, const byte *screen) {
+	int width;
+	int y;
+
+	if (!_upscaledHires) {
+		screen += (rect.top * _displayWidth) + rect.left;
+		width = rect.width();
+	} else {
+		screen += (_upscaledHeightMapping[rect.top] * _displayWidth) + _upscaledWidthMapping[rect.left];
+		width = _upscaledWidthMapping[rect.right] - _upscaledWidthMapping[rect.left];
+		rect.top = _upscaledHeightMapping[rect.top];
+		rect.bottom = _upscaledHeightMapping[rect.bottom];
+	}
+
+	for (y = rect.top; y < rect.bottom; y++) {
+		if (memcmp(screen, memoryPtr, width))
+			return false;
+		memoryPtr += width;
+		screen += _displayWidth;
+	}
+	return true;
+}
+
 void GfxScreen::setShakePos(uint16 shakeXOffset, uint16 shakeYOffset) {
 	if (!_upscaledHires)
 		_gfxDrv->setShakePos(shakeXOffset, shakeYOffset);
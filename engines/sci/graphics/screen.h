@@ -58,6 +58,7 @@ enum {
 };
 
 class GfxDriver;
+struct FloodFillParams;
 
 /**
  * Screen class, actually creates 3 (4) screens internally:
@@ -103,7 +104,7 @@ private:
 
 public:
 	void vectorAdjustLineCoordinates(int16 *left, int16 *top, int16 *right, int16 *bottom, byte drawMask, byte color, byte priority, byte control);
-	byte vectorIsFillMatch(int16 x, int16 y, byte screenMask, byte checkForColor, byte checkForPriority, byte checkForControl, bool isEGA);
+	void vectorFloodFill(int16 x, int16 y, const Common::Rect &border, const FloodFillParams &params);
 
 	byte getDrawingMask(byte color, byte prio, byte control);
 	void drawLine(Common::Point startPoint, Common::Point endPoint, byte color, byte prio, byte control);
@@ -128,6 +129,7 @@ public:
 	void bitsSave(Common::Rect rect, byte mask, byte *memoryPtr);
 	void bitsGetRect(const byte *memoryPtr, Common::Rect *destRect);
 	void bitsRestore(const byte *memoryPtr);
+	bool bitsEqual(const byte *memoryPtr);
 
 	void scale2x(const SciSpan<const byte> &src, SciSpan<byte> &dst, int16 srcWidth, int16 srcHeight, byte bytesPerPixel = 1);
 
@@ -178,6 +180,8 @@ private:
 	void bitsRestoreDisplayScreen(Common::Rect rect, const byte *&memoryPtr, byte *screen);
 	void bitsSaveScreen(Common::Rect rect, const byte *screen, uint16 screenWidth, byte *&memoryPtr);
 	void bitsSaveDisplayScreen(Common::Rect rect, const byte *screen, byte *&memoryPtr);
+	bool bitsEqualScreen(Common::Rect rect, const byte *&memoryPtr, const byte *screen, uint16 screenWidth);
+	bool bitsEqualDisplayScreen(Common::Rect rect, const byte *&memoryPtr, const byte *screen);
 
 	void setShakePos(uint16 shakeXOffset, uint16 shakeYOffset);
 
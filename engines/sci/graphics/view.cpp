@@ -105,6 +105,7 @@ void GfxView::initData() {
 	}
 
 	_loop.resize(0);
+	_bitmapSize = 0;
 	_embeddedPal = false;
 	_EGAmapping.clear();
 	_isScaleable = true;
@@ -415,6 +416,13 @@ bool GfxView::isScaleable() {
 	return _isScaleable;
 }
 
+uint32 GfxView::getMemorySize() const {
+	uint32 size = sizeof(GfxView) + _resource->size() + _bitmapSize;
+	for (uint i = 0; i < _loop.size(); i++)
+		size += sizeof(LoopInfo) + _loop[i].cel.size() * sizeof(CelInfo);
+	return size;
+}
+
 void GfxView::getCelRect(int16 loopNo, int16 celNo, int16 x, int16 y, int16 z, Common::Rect &outRect) const {
 	const CelInfo *celInfo = getCelInfo(loopNo, celNo);
 	outRect.left = x + celInfo->displaceX - (celInfo->width >> 1);
@@ -662,6 +670,7 @@ const SciSpan<const byte> &GfxView::getBitmap(int16 loopNo, int16 celNo) {
 	const Common::String sourceName = Common::String::format("%s loop %d cel %d", _resource->name().c_str(), loopNo, celNo);
 
 	SciSpan<byte> outBitmap = cel.rawBitmap->allocate(pixelCount, sourceName);
+	_bitmapSize += pixelCount;
 
 	// unpack the actual cel bitmap data
 	unpackCel(loopNo, celNo, outBitmap);
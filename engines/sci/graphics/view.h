@@ -77,6 +77,12 @@ public:
 
 	bool isScaleable();
 
+	/**
+	 * Memory held by this view: its resource, loop and cel tables and all
+	 * cel bitmaps which have been unpacked so far.
+	 */
+	uint32 getMemorySize() const;
+
 	void adjustToUpscaledCoordinates(int16 &y, int16 &x);
 	void adjustBackUpscaledCoordinates(int16 &y, int16 &x);
 
@@ -97,6 +103,7 @@ private:
 	Resource *_resource;
 
 	Common::Array<LoopInfo> _loop;
+	uint32 _bitmapSize;	///< Bytes of unpacked cel bitmaps
 	bool _embeddedPal;
 	Palette _viewPalette;
 
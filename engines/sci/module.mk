@@ -29,11 +29,13 @@ MODULE_OBJS := \
 	engine/kvideo.o \
 	engine/message.o \
 	engine/object.o \
+	engine/pathfinding.o \
 	engine/savegame.o \
 	engine/script.o \
 	engine/scriptdebug.o \
 	engine/script_patches.o \
 	engine/selector.o \
+	engine/selector_lookup.o \
 	engine/seg_manager.o \
 	engine/segment.o \
 	engine/state.o \
@@ -48,6 +50,7 @@ MODULE_OBJS := \
 	graphics/controls16.o \
 	graphics/coordadjuster.o \
 	graphics/cursor.o \
+	graphics/floodfill.o \
 	graphics/fontkorean.o \
 	graphics/fontsjis.o \
 	graphics/gfxdrivers.o \
@@ -57,6 +60,7 @@ MODULE_OBJS := \
 	graphics/paint16.o \
 	graphics/palette.o \
 	graphics/picture.o \
+	graphics/picture_cache.o \
 	graphics/portrait.o \
 	graphics/ports.o \
 	graphics/remap.o \
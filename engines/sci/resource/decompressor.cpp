@@ -49,23 +49,59 @@ void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_szPacked = nPacked;
 	_szUnpacked = nUnpacked;
 	_nBits = 0;
+	_bitsUsed = 0;
 	_dwRead = _dwWrote = 0;
 	_dwBits = 0;
+	_inputPos = _inputSize = 0;
+	_inputLeft = nPacked;
+}
+
+void Decompressor::fillInput() {
+	_inputPos = 0;
+	if (_inputLeft) {
+		_inputSize = _src->read(_input, MIN<uint32>(_inputLeft, kInputSize));
+		_inputLeft = _inputSize ? _inputLeft - _inputSize : 0;
+		if (_inputSize)
+			return;
+	}
+
+	// Broken resources may need more than the packed data
+	_input[0] = _src->readByte();
+	_inputSize = 1;
+}
+
+inline byte Decompressor::getInputByte() {
+	if (_inputPos == _inputSize)
+		fillInput();
+	return _input[_inputPos++];
+}
+
+inline void Decompressor::countBits(int n) {
+	// The bits buffer used to be refilled with single bytes to more than 24
+	// bits whenever fewer than n bits were left
+	if (_dwRead * 8 - _bitsUsed < (uint32)n)
+		_dwRead = (_bitsUsed + 32) / 8;
+	_bitsUsed += n;
 }
 
 void Decompressor::fetchBitsMSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
+	if (_nBits <= 32 && _inputSize - _inputPos >= 4) {
+		_dwBits |= (uint64)READ_BE_UINT32(_input + _inputPos) << (32 - _nBits);
+		_inputPos += 4;
+		_nBits += 32;
+	}
+	while (_nBits <= 56) {
+		_dwBits |= (uint64)getInputByte() << (56 - _nBits);
 		_nBits += 8;
-		_dwRead++;
 	}
 }
 
 uint32 Decompressor::getBitsMSB(int n) {
+	countBits(n);
 	// fetching more data to buffer if needed
 	if (_nBits < n)
 		fetchBitsMSB();
-	uint32 ret = _dwBits >> (32 - n);
+	uint32 ret = (uint32)(_dwBits >> (64 - n));
 	_dwBits <<= n;
 	_nBits -= n;
 	return ret;
@@ -75,19 +111,41 @@ byte Decompressor::getByteMSB() {
 	return getBitsMSB(8);
 }
 
+byte Decompressor::peekByteMSB() {
+	if (_nBits < 8)
+		fetchBitsMSB();
+	return (byte)(_dwBits >> 56);
+}
+
+void Decompressor::skipBitsMSB(int n) {
+	// Same as countBits() for n single bits. The buffer would have been
+	// refilled at most once, with four bytes.
+	if (_dwRead * 8 - _bitsUsed < (uint32)n)
+		_dwRead += 4;
+	_bitsUsed += n;
+
+	_dwBits <<= n;
+	_nBits -= n;
+}
+
 void Decompressor::fetchBitsLSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
+	if (_nBits <= 32 && _inputSize - _inputPos >= 4) {
+		_dwBits |= (uint64)READ_LE_UINT32(_input + _inputPos) << _nBits;
+		_inputPos += 4;
+		_nBits += 32;
+	}
+	while (_nBits <= 56) {
+		_dwBits |= (uint64)getInputByte() << _nBits;
 		_nBits += 8;
-		_dwRead++;
 	}
 }
 
 uint32 Decompressor::getBitsLSB(int n) {
+	countBits(n);
 	// fetching more data to buffer if needed
 	if (_nBits < n)
 		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~(0xFFFFFFFFU << n));
+	uint32 ret = (uint32)_dwBits & ~(0xFFFFFFFFU << n);
 	_dwBits >>= n;
 	_nBits -= n;
 	return ret;
@@ -97,9 +155,6 @@ byte Decompressor::getByteLSB() {
 	return getBitsLSB(8);
 }
 
-void Decompressor::putByte(byte b) {
-	_dest[_dwWrote++] = b;
-}
 //-------------------------------
 //  Huffman decompressor
 //-------------------------------
@@ -114,16 +169,73 @@ int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPac
 	terminator = _src->readByte() | 0x100;
 	_nodes = new byte [numnodes << 1];
 	_src->read(_nodes, numnodes << 1);
+	buildLookup(numnodes);
 
-	while ((c = getc2()) != terminator && (c >= 0) && !isFinished())
+	// Once past the end of dest, the result can only be an error
+	while ((c = getc2()) != terminator && (c >= 0) && !isFinished() && _dwWrote <= _szUnpacked)
 		putByte(c);
 
 	delete[] _nodes;
 	return _dwWrote == _szUnpacked ? 0 : 1;
 }
 
+void DecompressorHuffman::buildLookup(byte numnodes) {
+	for (int bits = 0; bits < 256; bits++) {
+		LookupEntry &entry = _lookup[bits];
+		uint16 index = 0;
+		for (int i = 0; ; i++) {
+			if (index >= numnodes) {
+				entry.type = kLookupInvalid;
+				break;
+			}
+
+			const byte *node = _nodes + (index << 1);
+			if (!node[1]) {
+				entry.type = kLookupLeaf;
+				entry.value = node[0];
+				entry.bits = i;
+				break;
+			}
+			if (i == 8) {
+				entry.type = kLookupNode;
+				entry.value = index;
+				entry.bits = 8;
+				break;
+			}
+
+			if (bits & (0x80 >> i)) {
+				const byte next = node[1] & 0x0F;
+				if (next == 0) {
+					entry.type = kLookupLiteral;
+					entry.bits = i + 1;
+					break;
+				}
+				index += next;
+			} else {
+				index += node[1] >> 4;
+			}
+		}
+	}
+}
+
 int16 DecompressorHuffman::getc2() {
-	byte *node = _nodes;
+	const LookupEntry &entry = _lookup[peekByteMSB()];
+	switch (entry.type) {
+	case kLookupLeaf:
+		skipBitsMSB(entry.bits);
+		return entry.value;
+	case kLookupLiteral:
+		skipBitsMSB(entry.bits);
+		return getByteMSB() | 0x100;
+	case kLookupNode:
+		skipBitsMSB(8);
+		return walkTree(_nodes + (entry.value << 1));
+	default:
+		return walkTree(_nodes);
+	}
+}
+
+int16 DecompressorHuffman::walkTree(const byte *node) {
 	int16 next;
 	while (node[1]) {
 		if (getBitsMSB(1)) {
@@ -221,11 +333,9 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 					// For me this seems a normal situation, It's necessary to handle it
 					warning("unpackLZW: Trying to write beyond the end of array(len=%d, destctr=%d, tok_len=%d)",
 					        _szUnpacked, _dwWrote, tokenlastlength);
-					for (int i = 0; _dwWrote < _szUnpacked; i++)
-						putByte(dest[tokenlist[token] + i]);
+					copyOutput(tokenlist[token], _szUnpacked - _dwWrote);
 				} else
-					for (int i = 0; i < tokenlastlength; i++)
-						putByte(dest[tokenlist[token] + i]);
+					copyOutput(tokenlist[token], tokenlastlength);
 			} else {
 				tokenlastlength = 1;
 				if (_dwWrote >= _szUnpacked)
@@ -252,6 +362,21 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
+void DecompressorLZW::copyOutput(uint32 offset, uint32 length) {
+	if (offset + length <= _szUnpacked && _dwWrote + length <= _szUnpacked) {
+		// The string may run into the bytes it writes, so this has to go
+		// forward one byte at a time
+		const byte *in = _dest + offset;
+		byte *out = _dest + _dwWrote;
+		for (uint32 i = 0; i < length; i++)
+			out[i] = in[i];
+		_dwWrote += length;
+	} else {
+		for (uint32 i = 0; i < length; i++, offset++)
+			putByte(offset < _szUnpacked ? _dest[offset] : 0);
+	}
+}
+
 int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
@@ -259,9 +384,15 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 	byte *stak = (byte *)malloc(0x1014);
 	uint32 tokensSize = 0x1004 * sizeof(Tokenlist);
 	Tokenlist *tokens = (Tokenlist *)malloc(tokensSize);
-	if (!stak || !tokens) {
+	// Where the string of every token was written to dest before, so that it
+	// can be copied from there instead of following the links of the token
+	uint32 *tokenOffsets = (uint32 *)malloc(0x1004 * sizeof(uint32));
+	uint16 *tokenLengths = (uint16 *)malloc(0x1004 * sizeof(uint16));
+	if (!stak || !tokens || !tokenOffsets || !tokenLengths) {
 		free(stak);
 		free(tokens);
+		free(tokenOffsets);
+		free(tokenLengths);
 
 		error("[DecompressorLZW::unpackLZW1] Cannot allocate decompression buffers");
 	}
@@ -270,13 +401,19 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 
 	byte lastchar = 0;
 	uint16 stakptr = 0, lastbits = 0;
+	uint32 laststart = 0, lastlength = 0;
 
 	byte decryptstart = 0;
 	uint16 bitstring;
 	uint16 token;
 	bool bExit = false;
+	// Cleared once a token refers to a token which does not exist yet, after
+	// which only following the links gives the same result as before
+	bool useOffsets = true;
+	int result = 0;
 
-	while (!isFinished() && !bExit) {
+	// Once past the end of dest, the result can only be an error
+	while (!isFinished() && !bExit && _dwWrote <= _szUnpacked) {
 		switch (decryptstart) {
 		case 0:
 			bitstring = getBitsMSB(_numbits);
@@ -284,13 +421,15 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 				bExit = true;
 				continue;
 			}
+			laststart = _dwWrote;
+			lastlength = 1;
 			putByte(bitstring);
 			lastbits = bitstring;
 			lastchar = (bitstring & 0xff);
 			decryptstart = 1;
 			break;
 
-		case 1:
+		case 1: {
 			bitstring = getBitsMSB(_numbits);
 			if (bitstring == 0x101) { // found end-of-data signal
 				bExit = true;
@@ -301,31 +440,59 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 				_curtoken = 0x102;
 				_endtoken = 0x1ff;
 				decryptstart = 0;
+				useOffsets = true;
 				continue;
 			}
 
+			if (bitstring > _curtoken)
+				useOffsets = false;
+
+			const uint32 start = _dwWrote;
 			token = bitstring;
-			if (token >= _curtoken) { // index past current point
-				token = lastbits;
-				stak[stakptr++] = lastchar;
-			}
-			while ((token > 0xff) && (token < 0x1004)) { // follow links back in data
-				stak[stakptr++] = tokens[token].data;
-				token = tokens[token].next;
-			}
-			lastchar = stak[stakptr++] = token & 0xff;
-			// put stack in buffer
-			while (stakptr > 0) {
-				putByte(stak[--stakptr]);
-				if (_dwWrote == _szUnpacked) {
-					bExit = true;
-					continue;
+			if (useOffsets) {
+				if (token >= _curtoken) { // the token which gets added next
+					copyOutput(laststart, lastlength);
+					putByte(lastchar);
+				} else if (token > 0xff) {
+					copyOutput(tokenOffsets[token], tokenLengths[token]);
+				} else {
+					putByte(token);
 				}
+				if (token > 0xff && start < _szUnpacked)
+					lastchar = _dest[start];
+				else if (token <= 0xff)
+					lastchar = token;
+			} else {
+				if (token >= _curtoken) { // index past current point
+					token = lastbits;
+					stak[stakptr++] = lastchar;
+				}
+				while ((token > 0xff) && (token < 0x1004)) { // follow links back in data
+					if (stakptr == 0x1013) {
+						warning("unpackLZW1: Token links form a loop");
+						result = SCI_ERROR_DECOMPRESSION_ERROR;
+						bExit = true;
+						break;
+					}
+					stak[stakptr++] = tokens[token].data;
+					token = tokens[token].next;
+				}
+				if (bExit)
+					continue;
+				lastchar = stak[stakptr++] = token & 0xff;
+				// put stack in buffer
+				while (stakptr > 0)
+					putByte(stak[--stakptr]);
 			}
+			if (start < _szUnpacked && _dwWrote >= _szUnpacked)
+				bExit = true;
+
 			// put token into record
 			if (_curtoken <= _endtoken) {
 				tokens[_curtoken].data = lastchar;
 				tokens[_curtoken].next = lastbits;
+				tokenOffsets[_curtoken] = laststart;
+				tokenLengths[_curtoken] = lastlength + 1;
 				_curtoken++;
 				if (_curtoken == _endtoken && _numbits < 12) {
 					_numbits++;
@@ -333,7 +500,10 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 				}
 			}
 			lastbits = bitstring;
+			laststart = start;
+			lastlength = _dwWrote - start;
 			break;
+		}
 
 		default:
 			break;
@@ -342,7 +512,11 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 
 	free(stak);
 	free(tokens);
+	free(tokenOffsets);
+	free(tokenLengths);
 
+	if (result)
+		return result;
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
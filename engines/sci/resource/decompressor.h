@@ -53,12 +53,16 @@ public:
 	Decompressor() :
 		_dwBits(0),
 		_nBits(0),
+		_bitsUsed(0),
 		_szPacked(0),
 		_szUnpacked(0),
 		_dwRead(0),
 		_dwWrote(0),
 		_src(nullptr),
-		_dest(nullptr)
+		_dest(nullptr),
+		_inputPos(0),
+		_inputSize(0),
+		_inputLeft(0)
 	{}
 
 	virtual ~Decompressor() {}
@@ -93,6 +97,18 @@ protected:
 	 */
 	uint32 getBitsLSB(int n);
 
+	/**
+	 * Get the next 8 bits from _src stream like getBitsMSB(8), without
+	 * taking them.
+	 */
+	byte peekByteMSB();
+
+	/**
+	 * Take n bits like n calls of getBitsMSB(1) would.
+	 * @param n		number of bits to skip, at most 8
+	 */
+	void skipBitsMSB(int n);
+
 	/**
 	 * Get one byte from _src stream.
 	 * @return byte
@@ -104,11 +120,29 @@ protected:
 	void fetchBitsLSB();
 
 	/**
-	 * Write one byte into _dest stream
-	 * @param b byte to put
+	 * Accounts for n bits taken from the bits buffer in _dwRead, which counts
+	 * the bytes that refilling the buffer to 32 bits at a time would have read.
+	 * isFinished() relies on that count.
 	 */
+	void countBits(int n);
 
-	virtual void putByte(byte b);
+	/**
+	 * Get the next byte of the packed data. The packed data is read from _src
+	 * in blocks, anything after it one byte at a time.
+	 */
+	byte getInputByte();
+	void fillInput();
+
+	/**
+	 * Write one byte into _dest stream. Bytes past the end of _dest are
+	 * counted, but not written.
+	 * @param b byte to put
+	 */
+	void putByte(byte b) {
+		if (_dwWrote < _szUnpacked)
+			_dest[_dwWrote] = b;
+		_dwWrote++;
+	}
 
 	/**
 	 * Returns true if all expected data has been unpacked to _dest
@@ -118,14 +152,24 @@ protected:
 		return (_dwWrote == _szUnpacked) && (_dwRead >= _szPacked);
 	}
 
-	uint32 _dwBits;		///< bits buffer
+	enum {
+		kInputSize = 256
+	};
+
+	uint64 _dwBits;		///< bits buffer
 	byte _nBits;		///< number of unread bits in _dwBits
+	uint32 _bitsUsed;	///< number of bits taken from _dwBits
 	uint32 _szPacked;	///< size of the compressed data
 	uint32 _szUnpacked;	///< size of the decompressed data
-	uint32 _dwRead;		///< number of bytes read from _src
+	uint32 _dwRead;		///< number of bytes read from _src, see countBits()
 	uint32 _dwWrote;	///< number of bytes written to _dest
 	Common::ReadStream *_src;
 	byte *_dest;
+
+	byte _input[kInputSize];	///< block of packed data read from _src
+	uint16 _inputPos;
+	uint16 _inputSize;
+	uint32 _inputLeft;	///< packed bytes which have not been read from _src yet
 };
 
 /**
@@ -137,8 +181,28 @@ public:
 
 protected:
 	int16 getc2();
+	int16 walkTree(const byte *node);
+	void buildLookup(byte numnodes);
+
+	enum LookupType {
+		kLookupLeaf,		///< value is the decoded symbol
+		kLookupLiteral,		///< a literal byte follows the code
+		kLookupNode,		///< value is the node reached after 8 bits
+		kLookupInvalid		///< the code leaves the tree
+	};
+
+	/**
+	 * Where the tree leads for the next 8 bits of input, so that most codes
+	 * are decoded with a single lookup instead of one bit at a time.
+	 */
+	struct LookupEntry {
+		uint16 value;
+		byte bits;	///< number of bits of the code
+		byte type;	///< LookupType
+	};
 
 	byte *_nodes;
+	LookupEntry _lookup[256];
 };
 
 /**
@@ -164,6 +228,11 @@ protected:
 	int unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 	int unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
+	/**
+	 * Appends a string which was already written to _dest.
+	 */
+	void copyOutput(uint32 offset, uint32 length);
+
 	// functions to post-process view and pic resources
 	void reorderPic(byte *src, byte *dest, int dsize);
 	void reorderView(byte *src, byte *dest);
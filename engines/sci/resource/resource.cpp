@@ -26,6 +26,7 @@
 #include "common/fs.h"
 #include "common/macresman.h"
 #include "common/textconsole.h"
+#include "common/trace.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
 #include "common/compression/installshield_cab.h"
@@ -210,6 +211,10 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
+	_compressed = false;
+	_lruPrev = nullptr;
+	_lruNext = nullptr;
+	_lruResident = false;
 }
 
 Resource::~Resource() {
@@ -388,7 +393,9 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 	}
 	// adding a new file
 	file = new Common::File;
-	if (file->open(source->getLocationName())) {
+	// Resources are read from all over the volumes, so mapping them saves
+	// the copies through the buffers of the C library
+	if (file->openMapped(source->getLocationName())) {
 		if (_volumeFiles.size() == MAX_OPENED_VOLUMES) {
 			it = --_volumeFiles.end();
 			delete *it;
@@ -421,6 +428,7 @@ void ResourceManager::disposeVolumeFileStream(Common::SeekableReadStream *fileSt
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	TRACE_ZONE("ResourceManager::loadResource");
 	res->_source->loadResource(this, res);
 	if (_patcher) {
 		_patcher->applyPatch(*res);
@@ -1007,7 +1015,11 @@ void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_LRU.head = _LRU.tail = nullptr;
+	_LRU.memory = 0;
+	_residentLRU.head = _residentLRU.tail = nullptr;
+	_residentLRU.memory = 0;
+	resetLRUStats();
 	_resMap.clear();
 	_audioMapSCI1 = nullptr;
 #ifdef ENABLE_SCI32
@@ -1081,6 +1093,8 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
 
+	initLRUBudget();
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1122,12 +1136,44 @@ ResourceManager::~ResourceManager() {
 	}
 }
 
+void ResourceManager::initLRUBudget() {
+	// Targets on memory constrained devices can shrink the budget, and
+	// targets with plenty of memory can grow it to avoid decompressing
+	// resources again and again
+	if (_detectionMode || !ConfMan.hasKey("sci_resource_cache_kb"))
+		return;
+
+	const int budget = ConfMan.getInt("sci_resource_cache_kb");
+	if (budget > 0) {
+		_maxMemoryLRU = budget * 1024;
+		debugC(1, kDebugLevelResMan, "resMan: Resource cache budget set to %d KiB", budget);
+	}
+}
+
+void ResourceManager::resetLRUStats() {
+	_lruStats.hits = 0;
+	_lruStats.misses = 0;
+	_lruStats.evictions = 0;
+	_lruStats.residentEvictions = 0;
+	_lruStats.loadedBytes = 0;
+}
+
 void ResourceManager::removeFromLRU(Resource *res) {
 	if (res->_status != kResStatusEnqueued) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	LRUList &list = res->_lruResident ? _residentLRU : _LRU;
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		list.head = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		list.tail = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = nullptr;
+	list.memory -= res->size();
 	_memoryLRU -= res->size();
 	res->_status = kResStatusAllocated;
 }
@@ -1137,8 +1183,20 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	// Resources which had to be decompressed are expensive to load again,
+	// so they go to a separate list which is only evicted from last
+	res->_lruResident = res->_compressed;
+	LRUList &list = res->_lruResident ? _residentLRU : _LRU;
+	res->_lruPrev = nullptr;
+	res->_lruNext = list.head;
+	if (list.head)
+		list.head->_lruPrev = res;
+	else
+		list.tail = res;
+	list.head = res;
+	list.memory += res->size();
 	_memoryLRU += res->size();
+	TRACE_COUNTER("SCI resource memory", _memoryLRU);
 #ifdef SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
 	      res->_id.toString().c_str(), res->size,
@@ -1149,8 +1207,15 @@ void ResourceManager::addToLRU(Resource *res) {
 
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
+		Resource *goner;
+		if (!_LRU.tail || _residentLRU.memory > _maxMemoryLRU / 2) {
+			assert(_residentLRU.tail);
+			goner = _residentLRU.tail;
+			_lruStats.residentEvictions++;
+		} else {
+			goner = _LRU.tail;
+		}
+		_lruStats.evictions++;
 		removeFromLRU(goner);
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
@@ -1195,9 +1260,15 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return nullptr;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+		_lruStats.misses++;
+		_lruStats.loadedBytes += retval->size();
+	} else {
+		_lruStats.hits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -2239,6 +2310,11 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 		if (res == nullptr) {
 			res = new Resource(this, resId);
 			_resMap.setVal(resId, res);
+		} else if (res->_status == kResStatusEnqueued) {
+			// Keep the LRU lists consistent when a cached resource is
+			// replaced by another source
+			removeFromLRU(res);
+			res->unalloc();
 		}
 
 		res->_status = kResStatusNoMalloc;
@@ -2407,6 +2483,7 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 	if (errorNum) {
 		unalloc();
 	} else {
+		_compressed = (compression != kCompNone);
 		// At least Lighthouse puts sound effects in RESSCI.00n/RESSCI.PAT
 		// instead of using a RESOURCE.SFX
 		if (getType() == kResourceTypeAudio) {
@@ -24,7 +24,7 @@
 
 #include "common/str.h"
 #include "common/list.h"
-#include "common/hashmap.h"
+#include "common/flathashmap.h"
 
 #include "sci/graphics/helpers.h"		// for ViewType
 #include "sci/resource/decompressor.h"
@@ -304,6 +304,12 @@ public:
 
 	uint16 getNumLockers() const { return _lockers; }
 
+	/**
+	 * Whether the resource data had to be decompressed when it was loaded.
+	 * Such resources are kept in memory longer by the LRU policy.
+	 */
+	bool isCompressed() const { return _compressed; }
+
 protected:
 	ResourceId _id;	// TODO: _id could almost be made const, only readResourceInfo() modifies it...
 	int32 _fileOffset; /**< Offset in file */
@@ -311,6 +317,12 @@ protected:
 	uint16 _lockers; /**< Number of places where this resource was locked */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
+	bool _compressed;
+
+	// Links in the LRU list the resource is enqueued in, if any
+	Resource *_lruPrev; /**< More recently used resource */
+	Resource *_lruNext; /**< Less recently used resource */
+	bool _lruResident;  /**< Enqueued in the resident LRU list */
 
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
@@ -321,7 +333,7 @@ protected:
 	int readResourceInfo(ResVersion volVersion, Common::SeekableReadStream *file, uint32 &szPacked, ResourceCompression &compression);
 };
 
-typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
+typedef Common::FlatHashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
 class IntMapResourceSource;
 class ResourceManager {
@@ -427,6 +439,21 @@ public:
 	void addNewGMPatch(SciGameId gameId);
 	void addNewD110Patch(SciGameId gameId);
 
+	struct LRUStats {
+		uint32 hits;       ///< Lookups of resources which were in memory already
+		uint32 misses;     ///< Lookups which needed to load the resource
+		uint32 evictions;  ///< Resources freed to stay within the budget
+		uint32 residentEvictions; ///< Evictions of resources which had been decompressed
+		uint32 loadedBytes; ///< Bytes loaded on misses
+	};
+
+	const LRUStats &getLRUStats() const { return _lruStats; }
+	void resetLRUStats();
+	int getMaxMemoryLRU() const { return _maxMemoryLRU; }
+	int getMemoryLRU() const { return _memoryLRU; }
+	int getMemoryResidentLRU() const { return _residentLRU.memory; }
+	int getMemoryLocked() const { return _memoryLocked; }
+
 #ifdef ENABLE_SCI32
 	/**
 	 * Parses all resources from a SCI2.1 chunk resource and adds them to the
@@ -500,7 +527,25 @@ protected:
 	SourcesList _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+
+	/**
+	 * Intrusive list of resources, linked through Resource::_lruPrev and
+	 * Resource::_lruNext, with the most recently used one at the head.
+	 */
+	struct LRUList {
+		Resource *head;
+		Resource *tail;
+		int memory;
+	};
+
+	LRUList _LRU; ///< Last Resource Used list
+	/**
+	 * Resources which had to be decompressed. They are only freed once the
+	 * regular LRU list is empty, or once they take more than half of the
+	 * budget.
+	 */
+	LRUList _residentLRU;
+	LRUStats _lruStats;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -645,6 +690,7 @@ protected:
 
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
+	void initLRUBudget();
 
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
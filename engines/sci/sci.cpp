@@ -33,6 +33,7 @@
 #include "sci/event.h"
 
 #include "sci/engine/features.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/guest_additions.h"
 #include "sci/engine/message.h"
 #include "sci/engine/object.h"
@@ -571,6 +572,7 @@ bool SciEngine::initGame() {
 
 	_gamestate->initMessageState();
 	_gamestate->gcCountDown = GC_INTERVAL - 1;
+	_gamestate->_gc->cancel(_gamestate->_segMan);
 
 	// Script 0 should always be at segment 1
 	if (script0Segment != 1) {
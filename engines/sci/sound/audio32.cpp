@@ -181,6 +181,216 @@ private:
 	bool _loop;
 };
 
+#pragma mark -
+#pragma mark CachedPCMStream
+
+/**
+ * A SOL resource decoded to 16-bit PCM.
+ */
+struct DecodedAudio {
+	Common::Array<int16> samples;
+	int rate;
+	bool stereo;
+
+	/**
+	 * The length reported by the SOL stream, which scripts get to see.
+	 */
+	Audio::Timestamp length;
+};
+
+/**
+ * Plays decoded audio from the PCM cache.
+ */
+class CachedPCMStream : public Audio::SeekableAudioStream {
+public:
+	CachedPCMStream(const Common::SharedPtr<DecodedAudio> &audio) :
+		_audio(audio),
+		_position(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const int samplesRead = MIN<int>(numSamples, _audio->samples.size() - _position);
+		memcpy(buffer, _audio->samples.data() + _position, samplesRead * sizeof(int16));
+		_position += samplesRead;
+		return samplesRead;
+	}
+
+	bool isStereo() const override { return _audio->stereo; }
+	int getRate() const override { return _audio->rate; }
+	bool endOfData() const override { return _position == _audio->samples.size(); }
+
+	bool seek(const Audio::Timestamp &where) override {
+		const uint32 position = where.convertToFramerate(_audio->rate).totalNumberOfFrames() * (_audio->stereo ? 2 : 1);
+		if (position > _audio->samples.size()) {
+			return false;
+		}
+
+		_position = position;
+		return true;
+	}
+
+	Audio::Timestamp getLength() const override { return _audio->length; }
+
+private:
+	Common::SharedPtr<DecodedAudio> _audio;
+	uint32 _position;
+};
+
+#pragma mark -
+#pragma mark ReadAheadAudioStream
+
+/**
+ * Decodes a stream ahead of the mixer callback, from the read-ahead timer of
+ * Audio32. The mixer callback only decodes by itself when the timer has not
+ * kept up.
+ */
+class ReadAheadAudioStream : public Audio::SeekableAudioStream {
+public:
+	enum {
+		/**
+		 * Samples decoded at once. Even, since 8-bit SOL audio packs two
+		 * samples into a byte.
+		 */
+		kChunkSize = 2048,
+
+		/**
+		 * Chunks decoded per call of the read-ahead timer, which is more than
+		 * gets played in between calls.
+		 */
+		kChunksPerFill = 2
+	};
+
+	ReadAheadAudioStream(Audio32 &audio32, Audio::SeekableAudioStream *stream) :
+		_audio32(audio32),
+		_stream(stream),
+		// Half a second of audio
+		_buffer((stream->getRate() * (stream->isStereo() ? 2 : 1) / 2 + kChunkSize) & ~1),
+		_start(0),
+		_size(0),
+		_endOfStream(false) {
+		_audio32.addReadAheadStream(this);
+	}
+
+	~ReadAheadAudioStream() override {
+		_audio32.removeReadAheadStream(this);
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		int samplesRead = 0;
+		for (;;) {
+			{
+				Common::StackLock lock(_bufferMutex);
+				samplesRead += take(buffer + samplesRead, numSamples - samplesRead);
+				if (samplesRead == numSamples || _endOfStream) {
+					break;
+				}
+			}
+
+			// The timer has not kept up
+			Common::StackLock lock(_streamMutex);
+			decodeChunk();
+		}
+
+		return samplesRead;
+	}
+
+	bool isStereo() const override { return _stream->isStereo(); }
+	int getRate() const override { return _stream->getRate(); }
+
+	bool endOfData() const override {
+		Common::StackLock lock(_bufferMutex);
+		return _endOfStream && _size == 0;
+	}
+
+	bool seek(const Audio::Timestamp &where) override {
+		Common::StackLock streamLock(_streamMutex);
+		Common::StackLock bufferLock(_bufferMutex);
+		_start = _size = 0;
+		_endOfStream = false;
+		return _stream->seek(where);
+	}
+
+	Audio::Timestamp getLength() const override { return _stream->getLength(); }
+
+	/**
+	 * Decodes a few chunks, unless the buffer is full. Called by the
+	 * read-ahead timer. The stream is only held for a chunk at a time, and
+	 * only a few chunks are decoded per call, so that the mixer callback never
+	 * waits long for the stream or for the timer to let go of it.
+	 */
+	void fill() {
+		for (int i = 0; i < kChunksPerFill; ++i) {
+			Common::StackLock lock(_streamMutex);
+			if (!decodeChunk()) {
+				return;
+			}
+		}
+	}
+
+private:
+	/**
+	 * Decodes a chunk into the buffer, if it has room for one. The caller must
+	 * hold `_streamMutex`, so only consumers change the buffer meanwhile,
+	 * which only makes more room.
+	 *
+	 * @returns false if the stream has ended or the buffer is full.
+	 */
+	bool decodeChunk() {
+		{
+			Common::StackLock lock(_bufferMutex);
+			if (_endOfStream || _buffer.size() - _size < kChunkSize) {
+				return false;
+			}
+		}
+
+		int16 chunk[kChunkSize];
+		const int samplesRead = _stream->readBuffer(chunk, kChunkSize);
+
+		Common::StackLock lock(_bufferMutex);
+		for (int i = 0; i < samplesRead; ++i) {
+			_buffer[(_start + _size + i) % _buffer.size()] = chunk[i];
+		}
+		_size += samplesRead;
+
+		if (samplesRead < kChunkSize || _stream->endOfData()) {
+			_endOfStream = true;
+		}
+		return true;
+	}
+
+	/**
+	 * Takes decoded samples out of the buffer. The caller must hold
+	 * `_bufferMutex`.
+	 */
+	int take(int16 *buffer, const int numSamples) {
+		int samplesTaken = 0;
+		while (samplesTaken < numSamples && _size) {
+			const uint run = MIN<uint>(MIN<uint>(numSamples - samplesTaken, _size), _buffer.size() - _start);
+			memcpy(buffer + samplesTaken, _buffer.data() + _start, run * sizeof(int16));
+			samplesTaken += run;
+			_start = (_start + run) % _buffer.size();
+			_size -= run;
+		}
+		return samplesTaken;
+	}
+
+	Audio32 &_audio32;
+
+	/**
+	 * The decoded stream, used by whoever holds `_streamMutex`.
+	 */
+	Common::ScopedPtr<Audio::SeekableAudioStream> _stream;
+	Common::Mutex _streamMutex;
+
+	/**
+	 * Ring buffer of decoded samples, guarded by `_bufferMutex`.
+	 */
+	Common::Array<int16> _buffer;
+	uint _start;
+	uint _size;
+	bool _endOfStream;
+	mutable Common::Mutex _bufferMutex;
+};
+
 #pragma mark -
 
 Audio32::Audio32(ResourceManager *resMan) :
@@ -210,7 +420,23 @@ Audio32::Audio32(ResourceManager *resMan) :
 	_useModifiedAttenuation(g_sci->_features->usesModifiedAudioAttenuation()),
 
 	_monitoredChannelIndex(-1),
-	_numMonitoredSamples(0) {
+	_numMonitoredSamples(0),
+
+	_pcmCacheSize(0),
+	_pcmCacheUses(0),
+
+	_mixTime(0),
+	_mixCount(0) {
+	memset(&_pcmCacheStats, 0, sizeof(_pcmCacheStats));
+
+	// The PCM cache gets a quarter of the budget of the resource cache by
+	// default, which it adds to, as the resources stay locked while they play
+	if (ConfMan.hasKey("sci_audio_cache_kb")) {
+		_pcmCacheBudget = MAX(0, ConfMan.getInt("sci_audio_cache_kb")) * 1024;
+	} else {
+		_pcmCacheBudget = resMan->getMaxMemoryLRU() / 4;
+	}
+
 	// In games where scripts premultiply master audio volumes into the volumes
 	// of the individual audio channels sent to the mixer, Audio32 needs to use
 	// the kPlainSoundType so that the master SFX volume is not applied twice.
@@ -222,9 +448,11 @@ Audio32::Audio32(ResourceManager *resMan) :
 	const Audio::Mixer::SoundType soundType = g_sci->_features->gameScriptsControlMasterVolume() ? Audio::Mixer::kPlainSoundType : Audio::Mixer::kSFXSoundType;
 
 	_mixer->playStream(soundType, &_handle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
+	g_sci->getTimerManager()->installTimerProc(&readAheadCallback, 20000, this, "sciAudio32ReadAhead");
 }
 
 Audio32::~Audio32() {
+	g_sci->getTimerManager()->removeTimerProc(&readAheadCallback);
 	stop(kAllChannels);
 	_mixer->stopHandle(_handle);
 }
@@ -296,6 +524,8 @@ int Audio32::readBuffer(Audio::st_sample_t *const buffer, const int numSamples)
 		return 0;
 	}
 
+	const uint32 mixStartTime = g_system->getMillis();
+
 	// ResourceManager is not thread-safe so we need to avoid calling into it
 	// from the audio thread, but at the same time we need to be able to clear
 	// out any finished channels on a regular basis
@@ -409,6 +639,7 @@ int Audio32::readBuffer(Audio::st_sample_t *const buffer, const int numSamples)
 			}
 		}
 
+		int channelSamplesWritten = 0;
 		if (channelIndex == _monitoredChannelIndex) {
 			if (numSamples > (int)_monitoredBuffer.size()) {
 				_monitoredBuffer.resize(numSamples);
@@ -423,6 +654,7 @@ int Audio32::readBuffer(Audio::st_sample_t *const buffer, const int numSamples)
 				Audio::clampedAdd(*targetBuffer++, *sourceBuffer++);
 			}
 
+			channelSamplesWritten = _numMonitoredSamples;
 			if (_numMonitoredSamples > maxSamplesWritten) {
 				maxSamplesWritten = _numMonitoredSamples;
 			}
@@ -437,15 +669,22 @@ int Audio32::readBuffer(Audio::st_sample_t *const buffer, const int numSamples)
 				leftVolume = rightVolume = 0;
 			}
 
-			const int channelSamplesWritten = writeAudioInternal(*channel.stream, *channel.converter, buffer, numSamples, leftVolume, rightVolume);
+			channelSamplesWritten = writeAudioInternal(*channel.stream, *channel.converter, buffer, numSamples, leftVolume, rightVolume);
 			if (channelSamplesWritten > maxSamplesWritten) {
 				maxSamplesWritten = channelSamplesWritten;
 			}
 		}
+
+		AudioChannel &mixedChannel = getChannel(channelIndex);
+		mixedChannel.mixSamples += channelSamplesWritten;
+		++mixedChannel.mixCount;
 	}
 
 	_inAudioThread = false;
 
+	_mixTime += g_system->getMillis() - mixStartTime;
+	++_mixCount;
+
 	return maxSamplesWritten;
 }
 
@@ -589,6 +828,11 @@ void Audio32::freeChannel(const int16 channelIndex) {
 		// ResourceManager is not thread-safe; instead, we just record that the
 		// resource needs unlocking and unlock it whenever we are on the main
 		// thread again
+		//
+		// The stream goes first, since the read-ahead timer may still be
+		// decoding from the resource until it is destroyed
+		channel.stream.reset();
+
 		if (_inAudioThread) {
 			_resourcesToUnlock.push_back(channel.resource);
 		} else {
@@ -596,7 +840,6 @@ void Audio32::freeChannel(const int16 channelIndex) {
 		}
 
 		channel.resource = nullptr;
-		channel.stream.reset();
 	}
 
 	channel.converter.reset();
@@ -694,6 +937,9 @@ bool Audio32::playRobotAudio(const RobotAudioStream::RobotAudioPacket &packet) {
 		channel.soundNode = NULL_REG;
 		channel.volume = kMaxVolume;
 		channel.pan = -1;
+		channel.decoding = kDecodeWhileMixing;
+		channel.mixSamples = 0;
+		channel.mixCount = 0;
 		// TODO: Avoid unnecessary channel conversion
 		channel.converter.reset(Audio::makeRateConverter(RobotAudioStream::kRobotSampleRate, getRate(), false, true, false));
 		// The RobotAudioStream buffer size is
@@ -828,6 +1074,9 @@ uint16 Audio32::play(int16 channelIndex, const ResourceId resourceId, const bool
 	channel.soundNode = soundNode;
 	channel.volume = volume < 0 || volume > kMaxVolume ? (int)kMaxVolume : volume;
 	channel.pan = -1;
+	channel.decoding = kDecodeWhileMixing;
+	channel.mixSamples = 0;
+	channel.mixCount = 0;
 
 	if (monitor) {
 		_monitoredChannelIndex = channelIndex;
@@ -837,8 +1086,16 @@ uint16 Audio32::play(int16 channelIndex, const ResourceId resourceId, const bool
 
 	Audio::RewindableAudioStream *audioStream;
 
-	if (detectSolAudio(*dataStream)) {
-		audioStream = makeSOLStream(dataStream, DisposeAfterUse::YES);
+	PCMCache::iterator cached = _pcmCache.find(resourceId);
+	if (cached != _pcmCache.end()) {
+		delete dataStream;
+		cached->_value.lastUse = ++_pcmCacheUses;
+		++_pcmCacheStats.hits;
+		audioStream = new CachedPCMStream(cached->_value.audio);
+		channel.decoding = kDecodeCached;
+	} else if (detectSolAudio(*dataStream)) {
+		Audio::SeekableAudioStream *solStream = makeSOLStream(dataStream, DisposeAfterUse::YES);
+		audioStream = solStream ? makeDecodedStream(resourceId, solStream, channel.decoding) : nullptr;
 	} else if (detectWaveAudio(*dataStream)) {
 		audioStream = Audio::makeWAVStream(dataStream, DisposeAfterUse::YES);
 	} else if (detectAIFFAudio(*dataStream)) {
@@ -1411,6 +1668,85 @@ void Audio32::kernelPanOff(EngineState *s, const int argc, const reg_t *const ar
 	}
 }
 
+#pragma mark -
+#pragma mark Decoding
+
+Audio::SeekableAudioStream *Audio32::makeDecodedStream(const ResourceId resourceId, Audio::SeekableAudioStream *stream, AudioChannelDecoding &decoding) {
+	const uint32 numChannels = stream->isStereo() ? 2 : 1;
+	const uint32 decodedSize = stream->getLength().convertToFramerate(stream->getRate()).totalNumberOfFrames() * numChannels * sizeof(int16);
+
+	if (decodedSize > _pcmCacheBudget / 4) {
+		decoding = kDecodeAhead;
+		return new ReadAheadAudioStream(*this, stream);
+	}
+
+	Common::SharedPtr<DecodedAudio> audio(new DecodedAudio());
+	audio->rate = stream->getRate();
+	audio->stereo = stream->isStereo();
+	audio->length = stream->getLength();
+
+	// The length of SOL audio is worked out from its size, so this is only
+	// about right
+	audio->samples.reserve(decodedSize / sizeof(int16) + ReadAheadAudioStream::kChunkSize);
+	while (!stream->endOfData()) {
+		const uint position = audio->samples.size();
+		audio->samples.resize(position + ReadAheadAudioStream::kChunkSize);
+		const int samplesRead = stream->readBuffer(audio->samples.data() + position, ReadAheadAudioStream::kChunkSize);
+		audio->samples.resize(position + samplesRead);
+		if (samplesRead < ReadAheadAudioStream::kChunkSize) {
+			break;
+		}
+	}
+	delete stream;
+
+	const uint32 size = audio->samples.size() * sizeof(int16);
+	evictPCM(size);
+
+	PCMCacheEntry &entry = _pcmCache[resourceId];
+	entry.audio = audio;
+	entry.lastUse = ++_pcmCacheUses;
+	_pcmCacheSize += size;
+	++_pcmCacheStats.misses;
+
+	decoding = kDecodeCached;
+	return new CachedPCMStream(audio);
+}
+
+void Audio32::evictPCM(const uint32 size) {
+	while (!_pcmCache.empty() && _pcmCacheSize + size > _pcmCacheBudget) {
+		PCMCache::iterator oldest = _pcmCache.begin();
+		for (PCMCache::iterator it = _pcmCache.begin(); it != _pcmCache.end(); ++it) {
+			if (it->_value.lastUse < oldest->_value.lastUse) {
+				oldest = it;
+			}
+		}
+
+		_pcmCacheSize -= oldest->_value.audio->samples.size() * sizeof(int16);
+		_pcmCache.erase(oldest);
+		++_pcmCacheStats.evictions;
+	}
+}
+
+void Audio32::addReadAheadStream(ReadAheadAudioStream *stream) {
+	Common::StackLock lock(_readAheadMutex);
+	_readAheadStreams.push_back(stream);
+}
+
+void Audio32::removeReadAheadStream(ReadAheadAudioStream *stream) {
+	Common::StackLock lock(_readAheadMutex);
+	ReadAheadList::iterator it = Common::find(_readAheadStreams.begin(), _readAheadStreams.end(), stream);
+	assert(it != _readAheadStreams.end());
+	_readAheadStreams.erase(it);
+}
+
+void Audio32::readAheadCallback(void *refCon) {
+	Audio32 *audio32 = static_cast<Audio32 *>(refCon);
+	Common::StackLock lock(audio32->_readAheadMutex);
+	for (ReadAheadList::const_iterator it = audio32->_readAheadStreams.begin(); it != audio32->_readAheadStreams.end(); ++it) {
+		(*it)->fill();
+	}
+}
+
 #pragma mark -
 #pragma mark Debugging
 
@@ -1430,6 +1766,10 @@ void Audio32::printAudioList(Console *con) const {
 						 channel.pan,
 						 stream && stream->loop() ? ", looping" : "",
 						 channel.pausedAtTick ? ", paused" : "");
+		con->debugPrintf("                %s, mixed %u times, %u samples\n",
+						 channel.decoding == kDecodeCached ? "cached" : channel.decoding == kDecodeAhead ? "decoded ahead" : "decoded while mixing",
+						 channel.mixCount,
+						 channel.mixSamples);
 		if (channel.fadeStartTick) {
 			con->debugPrintf("                fade: vol %d -> %d, started at %d, pos %d/%d%s\n",
 							 channel.fadeStartVolume,
@@ -1441,6 +1781,11 @@ void Audio32::printAudioList(Console *con) const {
 		}
 	}
 
+	con->debugPrintf("\nMixing: %u calls, %u ms\n", _mixCount, _mixTime);
+	con->debugPrintf("PCM cache: %u resources in %u of %u bytes, %u hits, %u misses, %u evictions\n",
+					 _pcmCache.size(), _pcmCacheSize, _pcmCacheBudget,
+					 _pcmCacheStats.hits, _pcmCacheStats.misses, _pcmCacheStats.evictions);
+
 	if (g_sci->_features->hasSci3Audio()) {
 		con->debugPrintf("\nLocks: ");
 		if (_lockedResourceIds.size()) {
@@ -1456,4 +1801,15 @@ void Audio32::printAudioList(Console *con) const {
 	}
 }
 
+void Audio32::resetMixStats() {
+	Common::StackLock lock(_mutex);
+	for (int i = 0; i < _numActiveChannels; ++i) {
+		_channels[i].mixSamples = 0;
+		_channels[i].mixCount = 0;
+	}
+	_mixTime = 0;
+	_mixCount = 0;
+	memset(&_pcmCacheStats, 0, sizeof(_pcmCacheStats));
+}
+
 } // End of namespace Sci
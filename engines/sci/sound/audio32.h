@@ -26,7 +26,9 @@
 #include "audio/mixer.h"           // for Mixer, SoundHandle
 #include "audio/rate.h"            // for Audio::st_volume_t, RateConverter
 #include "common/array.h"          // for Array
+#include "common/hashmap.h"        // for HashMap
 #include "common/mutex.h"          // for StackLock, Mutex
+#include "common/ptr.h"            // for SharedPtr
 #include "common/scummsys.h"       // for int16, uint8, uint32, uint16
 #include "sci/resource/resource.h" // for ResourceId
 #include "sci/engine/state.h"      // for EngineState
@@ -35,12 +37,23 @@
 
 namespace Sci {
 class Console;
+class ReadAheadAudioStream;
+struct DecodedAudio;
 
 bool detectSolAudio(Common::SeekableReadStream &stream);
 bool detectWaveAudio(Common::SeekableReadStream &stream);
 
 #pragma mark AudioChannel
 
+/**
+ * How the audio of a channel gets decoded.
+ */
+enum AudioChannelDecoding {
+	kDecodeWhileMixing, ///< By its stream, from the mixer callback
+	kDecodeCached,      ///< All at once, into the PCM cache
+	kDecodeAhead        ///< By a timer, ahead of the mixer callback
+};
+
 /**
  * An audio channel used by the software SCI mixer.
  */
@@ -133,6 +146,23 @@ struct AudioChannel {
 	 */
 	int pan;
 
+	/**
+	 * How the audio of this channel gets decoded.
+	 */
+	AudioChannelDecoding decoding;
+
+	/**
+	 * The number of samples this channel wrote to the mixer. Single mixes
+	 * are too short for the millisecond clock, so only the whole mixer
+	 * callback is timed.
+	 */
+	uint32 mixSamples;
+
+	/**
+	 * The number of times this channel was mixed.
+	 */
+	uint32 mixCount;
+
 	AudioChannel &operator=(AudioChannel &other) {
 		id = other.id;
 		resource = other.resource;
@@ -150,6 +180,9 @@ struct AudioChannel {
 		soundNode = other.soundNode;
 		volume = other.volume;
 		pan = other.pan;
+		decoding = other.decoding;
+		mixSamples = other.mixSamples;
+		mixCount = other.mixCount;
 		return *this;
 	}
 };
@@ -649,10 +682,88 @@ public:
 	void kernelPan(EngineState *s, const int argc, const reg_t *const argv);
 	void kernelPanOff(EngineState *s, const int argc, const reg_t *const argv);
 
+#pragma mark -
+#pragma mark Decoding
+public:
+	struct PCMCacheStats {
+		uint32 hits;      ///< Channels played from the cache
+		uint32 misses;    ///< Resources decoded into the cache
+		uint32 evictions; ///< Resources dropped to stay within the budget
+	};
+
+private:
+	friend class ReadAheadAudioStream;
+
+	struct PCMCacheEntry {
+		Common::SharedPtr<DecodedAudio> audio;
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<ResourceId, PCMCacheEntry, ResourceIdHash> PCMCache;
+	typedef Common::Array<ReadAheadAudioStream *> ReadAheadList;
+
+	/**
+	 * Makes the stream for a SOL resource. Short resources are decoded once
+	 * into the PCM cache and played from there, longer ones are decoded ahead
+	 * of the mixer callback by a timer. Takes ownership of `stream`.
+	 */
+	Audio::SeekableAudioStream *makeDecodedStream(const ResourceId resourceId, Audio::SeekableAudioStream *stream, AudioChannelDecoding &decoding);
+
+	/**
+	 * Drops the least recently used resources from the PCM cache until
+	 * `size` more bytes fit into its budget.
+	 */
+	void evictPCM(const uint32 size);
+
+	void addReadAheadStream(ReadAheadAudioStream *stream);
+	void removeReadAheadStream(ReadAheadAudioStream *stream);
+	static void readAheadCallback(void *refCon);
+
+	/**
+	 * Decoded SOL resources. Channels share the decoded audio with the cache,
+	 * so it stays alive until they are done with it even if it is evicted.
+	 */
+	PCMCache _pcmCache;
+
+	/**
+	 * The size of the decoded audio in the PCM cache, in bytes.
+	 */
+	uint32 _pcmCacheSize;
+
+	/**
+	 * The maximum size of the PCM cache, in bytes. Resources which would take
+	 * up more than a quarter of this are decoded ahead instead.
+	 */
+	uint32 _pcmCacheBudget;
+
+	/**
+	 * Counter used to find the least recently used entry of the PCM cache.
+	 */
+	uint32 _pcmCacheUses;
+
+	PCMCacheStats _pcmCacheStats;
+
+	/**
+	 * Guards the list of streams decoded by the read-ahead timer. Streams
+	 * cannot be destroyed while the timer is filling them.
+	 */
+	Common::Mutex _readAheadMutex;
+	ReadAheadList _readAheadStreams;
+
+	/**
+	 * The time spent in the mixer callback, in ms, and the number of calls.
+	 * Every call is timed as a whole. Calls start at any point within a
+	 * millisecond, so the rounded durations add up to the real time over
+	 * many calls.
+	 */
+	uint32 _mixTime;
+	uint32 _mixCount;
+
 #pragma mark -
 #pragma mark Debugging
 public:
 	void printAudioList(Console *con) const;
+	void resetMixStats();
 };
 
 } // End of namespace Sci
@@ -25,6 +25,7 @@
 #include "scumm/actor.h"
 #include "scumm/actor_he.h"
 #include "scumm/akos.h"
+#include "scumm/box-cache.h"
 #include "scumm/boxes.h"
 #include "scumm/charset.h"
 #include "scumm/costume.h"
@@ -2401,6 +2402,7 @@ void ScummEngine::processActors() {
 	}
 
 	// Finally draw the now sorted actors
+	const uint32 drawStart = _system->getMillis(true);
 	Actor **end = _sortedActors + numactors;
 	for (Actor **ac = _sortedActors; ac != end; ++ac) {
 		Actor *a = *ac;
@@ -2466,6 +2468,9 @@ void ScummEngine::processActors() {
 			}
 		}
 	}
+
+	if (_costumeCelCache)
+		_costumeCelCache->addDrawTime(_system->getMillis(true) - drawStart);
 }
 
 void ScummEngine_v6::processActors() {
@@ -4410,9 +4415,12 @@ byte Actor_v0::updateWalkbox() {
 	if (_vm->checkXYInBoxBounds(_walkbox, _pos.x, _pos.y))
 		return 0;
 
+	const BoxCache *cache = _vm->getBoxCache();
+	const uint64 candidates = cache->getCandidates(_pos.x, _pos.y);
+
 	int numBoxes = _vm->getNumBoxes() - 1;
 	for (int i = 0; i <= numBoxes; i++) {
-		if (_vm->checkXYInBoxBounds(i, _pos.x, _pos.y) == true) {
+		if (cache->isCandidate(candidates, i) && _vm->checkXYInBoxBounds(i, _pos.x, _pos.y) == true) {
 			if (_walkdata.curbox == i) {
 				setBox(i);
 				directionUpdate();
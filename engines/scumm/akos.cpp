@@ -281,6 +281,7 @@ void AkosRenderer::setCostume(int costume, int shadow) {
 	const byte *akos = _vm->getResourceAddress(rtCostume, costume);
 	assert(akos);
 
+	_costumeId = costume;
 	_akhd = (const AkosHeader *)_vm->findResourceData(MKTAG('A','K','H','D'), akos);
 	_akof = (const AkosOffset *)_vm->findResourceData(MKTAG('A','K','O','F'), akos);
 	_akci = _vm->findResourceData(MKTAG('A','K','C','I'), akos);
@@ -716,6 +717,10 @@ byte AkosRenderer::paintCelByleRLE(int xMoveCur, int yMoveCur) {
 
 	const int scaletableSize = (_vm->_game.heversion >= 61) ? 128 : 384;
 
+	// skipCelLines() advances _srcPtr, remember where the cel starts
+	const byte *celPtr = _srcPtr;
+	int firstColumn = 0;
+
 	/* implement custom scale table */
 
 	compData.scaleTable = (_vm->_game.heversion >= 61) ? smallCostumeScaleTable : bigCostumeScaleTable;
@@ -903,6 +908,7 @@ byte AkosRenderer::paintCelByleRLE(int xMoveCur, int yMoveCur) {
 		if (linesToSkip > 0) {
 			compData.skipWidth -= linesToSkip;
 			skipCelLines(compData, linesToSkip);
+			firstColumn = linesToSkip;
 			compData.x = compData.boundsRect.left;
 		} else {
 			linesToSkip = rect.right - compData.boundsRect.right;
@@ -918,6 +924,7 @@ byte AkosRenderer::paintCelByleRLE(int xMoveCur, int yMoveCur) {
 		if (linesToSkip > 0) {
 			compData.skipWidth -= linesToSkip;
 			skipCelLines(compData, linesToSkip)	;
+			firstColumn = linesToSkip;
 			compData.x = compData.boundsRect.right - 1;
 		} else {
 			linesToSkip = (compData.boundsRect.left -1) - rect.left;
@@ -953,11 +960,79 @@ byte AkosRenderer::paintCelByleRLE(int xMoveCur, int yMoveCur) {
 	compData.height = _out.h;
 	compData.destPtr = (byte *)_out.getBasePtr(compData.x, compData.y);
 
-	byleRLEDecode(compData);
+	const CostumeCelCache::Cel *cel = nullptr;
+	if (!actorIsScaled && !_actorHitMode && _shadowMode != 2 && _vm->_costumeCelCache)
+		cel = _vm->_costumeCelCache->getCel(_costumeId, celPtr - _akcd, celPtr, _width, _height, compData.shr, compData.mask);
+
+	if (cel)
+		drawCachedCel(compData, cel, firstColumn);
+	else
+		byleRLEDecode(compData);
 
 	return drawFlag;
 }
 
+void AkosRenderer::drawCachedCel(ByleRLEData &compData, const CostumeCelCache::Cel *cel, int firstColumn) {
+	// This produces the same output as byleRLEDecode() for unscaled cels,
+	// only the opaque runs of each column are visited. Since every column
+	// advances x, shadow modes never skip a column here.
+	const int lastColumn = firstColumn + compData.skipWidth;
+
+	for (int column = firstColumn; column < lastColumn; column++) {
+		if (column != firstColumn) {
+			compData.x += compData.scaleXStep;
+			if (compData.x < 0 || compData.x >= compData.boundsRect.right)
+				return;
+			compData.destPtr += compData.scaleXStep * _vm->_bytesPerPixel;
+		}
+
+		if (compData.x < 0 || compData.x >= compData.boundsRect.right)
+			continue;
+
+		const byte maskbit = revBitMask(compData.x & 7);
+		const byte *columnMask = _vm->getMaskBuffer(compData.x - (_vm->_virtscr[kMainVirtScreen].xstart & 7), compData.y, _zbuf);
+		const byte *pixels = cel->pixels + column * _height;
+
+		for (uint16 run = cel->firstRun[column]; run < cel->firstRun[column + 1]; run++) {
+			// Clip the run against the bounds
+			int top = MAX<int>(cel->runs[run].start, compData.boundsRect.top - compData.y);
+			int bottom = MIN<int>(cel->runs[run].start + cel->runs[run].len, compData.boundsRect.bottom - compData.y);
+
+			byte *dst = compData.destPtr + top * _out.pitch;
+			const byte *mask = columnMask + top * _numStrips;
+
+			for (int i = top; i < bottom; i++, dst += _out.pitch, mask += _numStrips) {
+				if (*mask & maskbit)
+					continue;
+
+				uint16 pcolor = _palette[pixels[i]];
+				if (_shadowMode == 1) {
+					if (pcolor == 13)
+						pcolor = _shadowTable[*dst];
+				} else if (_shadowMode == 3) {
+					if (_vm->_game.features & GF_16BIT_COLOR) {
+						uint16 srcColor = (pcolor >> 1) & 0x7DEF;
+						uint16 dstColor = (READ_UINT16(dst) >> 1) & 0x7DEF;
+						pcolor = srcColor + dstColor;
+					} else if (_vm->_game.heversion >= 90) {
+						pcolor = (pcolor << 8) + *dst;
+						pcolor = _xmap[pcolor];
+					} else if (pcolor < 8) {
+						pcolor = (pcolor << 8) + *dst;
+						pcolor = _shadowTable[pcolor];
+					}
+				}
+
+				if (_vm->_bytesPerPixel == 2) {
+					WRITE_UINT16(dst, pcolor);
+				} else {
+					*dst = pcolor;
+				}
+			}
+		}
+	}
+}
+
 void AkosRenderer::markRectAsDirty(Common::Rect rect) {
 	rect.left -= _vm->_virtscr[kMainVirtScreen].xstart & 7;
 	rect.right -= _vm->_virtscr[kMainVirtScreen].xstart & 7;
@@ -23,6 +23,7 @@
 #define SCUMM_AKOS_H
 
 #include "scumm/base-costume.h"
+#include "scumm/costume-cache.h"
 #include "scumm/he/wiz_he.h"
 
 namespace Scumm {
@@ -65,6 +66,7 @@ protected:
 class AkosRenderer : public BaseCostumeRenderer {
 protected:
 	uint16 _codec;
+	int _costumeId;
 
 	// actor _palette
 	uint16 _palette[256];
@@ -98,6 +100,7 @@ protected:
 
 public:
 	AkosRenderer(ScummEngine *scumm) : BaseCostumeRenderer(scumm) {
+		_costumeId = 0;
 		_useBompPalette = false;
 		_akhd = nullptr;
 		_akpl = nullptr;
@@ -124,6 +127,7 @@ protected:
 
 	byte paintCelByleRLE(int xMoveCur, int yMoveCur);
 	void byleRLEDecode(ByleRLEData &v1);
+	void drawCachedCel(ByleRLEData &compData, const CostumeCelCache::Cel *cel, int firstColumn);
 	byte paintCelCDATRLE(int xMoveCur, int yMoveCur);
 	byte paintCelMajMin(int xMoveCur, int yMoveCur);
 	byte paintCelTRLE(int actor, int drawToBack, int celX, int celY, int celWidth, int celHeight, byte tcolor, const byte *shadowTablePtr, int32 specialRenderFlags);
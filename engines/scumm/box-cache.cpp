@@ -0,0 +1,103 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/util.h"
+
+#include "scumm/box-cache.h"
+
+namespace Scumm {
+
+BoxCache::BoxCache() : _valid(false), _numBoxes(0), _cellWidth(1), _cellHeight(1), _framePathQueries(0) {
+	memset(_grid, 0, sizeof(_grid));
+	resetStats();
+}
+
+void BoxCache::resetStats() {
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+void BoxCache::reset(int numBoxes) {
+	_numBoxes = numBoxes;
+	_coords.resize(numBoxes);
+	_bounds.resize(numBoxes);
+	_nextBox.clear();
+	_nextBox.resize(numBoxes * numBoxes, kUnknownNextBox);
+	_valid = false;
+	_stats.rebuilds++;
+}
+
+void BoxCache::setBox(int box, const BoxCoords &coords) {
+	_coords[box] = coords;
+
+	Common::Rect &r = _bounds[box];
+	r.left = MIN(MIN(coords.ul.x, coords.ur.x), MIN(coords.ll.x, coords.lr.x));
+	r.right = MAX(MAX(coords.ul.x, coords.ur.x), MAX(coords.ll.x, coords.lr.x));
+	r.top = MIN(MIN(coords.ul.y, coords.ur.y), MIN(coords.ll.y, coords.lr.y));
+	r.bottom = MAX(MAX(coords.ul.y, coords.ur.y), MAX(coords.ll.y, coords.lr.y));
+}
+
+void BoxCache::finalize() {
+	memset(_grid, 0, sizeof(_grid));
+
+	if (_numBoxes) {
+		_gridBounds = _bounds[0];
+		for (int i = 1; i < _numBoxes; i++) {
+			_gridBounds.left = MIN(_gridBounds.left, _bounds[i].left);
+			_gridBounds.right = MAX(_gridBounds.right, _bounds[i].right);
+			_gridBounds.top = MIN(_gridBounds.top, _bounds[i].top);
+			_gridBounds.bottom = MAX(_gridBounds.bottom, _bounds[i].bottom);
+		}
+
+		_cellWidth = (_gridBounds.right - _gridBounds.left) / kGridSize + 1;
+		_cellHeight = (_gridBounds.bottom - _gridBounds.top) / kGridSize + 1;
+
+		for (int i = 0; i < MIN(_numBoxes, 64); i++) {
+			const Common::Rect &r = _bounds[i];
+			const int x1 = (r.left - _gridBounds.left) / _cellWidth;
+			const int x2 = (r.right - _gridBounds.left) / _cellWidth;
+			const int y1 = (r.top - _gridBounds.top) / _cellHeight;
+			const int y2 = (r.bottom - _gridBounds.top) / _cellHeight;
+			for (int y = y1; y <= y2; y++) {
+				for (int x = x1; x <= x2; x++)
+					_grid[y * kGridSize + x] |= (uint64)1 << i;
+			}
+		}
+	}
+
+	_valid = true;
+}
+
+uint64 BoxCache::getCandidates(int x, int y) const {
+	if (!_numBoxes || x < _gridBounds.left || x > _gridBounds.right || y < _gridBounds.top || y > _gridBounds.bottom)
+		return 0;
+
+	const int cx = (x - _gridBounds.left) / _cellWidth;
+	const int cy = (y - _gridBounds.top) / _cellHeight;
+	return _grid[cy * kGridSize + cx];
+}
+
+void BoxCache::endFrame() {
+	_stats.frames++;
+	_stats.maxFramePathQueries = MAX(_stats.maxFramePathQueries, _framePathQueries);
+	_framePathQueries = 0;
+}
+
+} // End of namespace Scumm
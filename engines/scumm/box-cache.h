@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCUMM_BOX_CACHE_H
+#define SCUMM_BOX_CACHE_H
+
+#include "common/array.h"
+#include "common/rect.h"
+#include "common/scummsys.h"
+
+#include "scumm/boxes.h"
+
+namespace Scumm {
+
+/**
+ * Walkbox data of the current room, as derived from the rtMatrix resources.
+ *
+ * Box coordinates are decoded only once per room, together with their
+ * bounding rectangles and a coarse grid telling which boxes overlap each
+ * cell of the room, so point-in-box queries can skip most boxes. The results
+ * of getNextBox() are memoized per (from, to) pair.
+ *
+ * Everything is dropped whenever the box resources get replaced or a box
+ * flag or scale is changed; the cache is then rebuilt on the next query.
+ */
+class BoxCache {
+public:
+	static const int kGridSize = 16;
+	static const int16 kUnknownNextBox = 0x7FFF;
+
+	struct Stats {
+		uint32 frames;
+		uint32 pathQueries, pathHits, maxFramePathQueries;
+		uint32 pointQueries, pointRejects;
+		uint32 rebuilds;
+	};
+
+	BoxCache();
+
+	bool isValid() const { return _valid; }
+	void invalidate() { _valid = false; }
+
+	/** Start filling the cache for a room with the given number of boxes. */
+	void reset(int numBoxes);
+	void setBox(int box, const BoxCoords &coords);
+	/** Build the spatial index, after all boxes have been set. */
+	void finalize();
+
+	int getNumBoxes() const { return _numBoxes; }
+	const BoxCoords &getCoords(int box) const { return _coords[box]; }
+
+	/** Check if a point is outside the bounding rectangle of a box. */
+	bool isOutsideBounds(int box, int x, int y) {
+		_stats.pointQueries++;
+		const Common::Rect &r = _bounds[box];
+		if (x < r.left || x > r.right || y < r.top || y > r.bottom) {
+			_stats.pointRejects++;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * Get a mask of the boxes which may contain the given point. Only boxes
+	 * 0 to 63 are indexed; all higher ones are always reported as candidates
+	 * by isCandidate().
+	 */
+	uint64 getCandidates(int x, int y) const;
+	bool isCandidate(uint64 candidates, int box) const {
+		return box >= 64 || (candidates & ((uint64)1 << box)) != 0;
+	}
+
+	int16 getNextBox(int from, int to) {
+		_stats.pathQueries++;
+		_framePathQueries++;
+		int16 next = _nextBox[from * _numBoxes + to];
+		if (next != kUnknownNextBox)
+			_stats.pathHits++;
+		return next;
+	}
+	void setNextBox(int from, int to, int16 next) { _nextBox[from * _numBoxes + to] = next; }
+
+	/** Account the end of a frame for the per frame statistics. */
+	void endFrame();
+
+	const Stats &getStats() const { return _stats; }
+	uint32 getFramePathQueries() const { return _framePathQueries; }
+	void resetStats();
+
+private:
+	bool _valid;
+	int _numBoxes;
+
+	Common::Array<BoxCoords> _coords;
+	Common::Array<Common::Rect> _bounds;	// Inclusive bounding rectangles
+	Common::Array<int16> _nextBox;			// _numBoxes * _numBoxes entries
+
+	// Spatial index over the union of all bounding rectangles
+	Common::Rect _gridBounds;
+	int _cellWidth, _cellHeight;
+	uint64 _grid[kGridSize * kGridSize];
+
+	uint32 _framePathQueries;
+	Stats _stats;
+};
+
+} // End of namespace Scumm
+
+#endif
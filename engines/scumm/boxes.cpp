@@ -22,6 +22,7 @@
 #include "scumm/scumm.h"
 #include "scumm/actor.h"
 #include "scumm/boxes.h"
+#include "scumm/box-cache.h"
 #include "scumm/resource.h"
 #include "scumm/scumm_v0.h"
 #include "scumm/scumm_v6.h"
@@ -196,6 +197,8 @@ byte ScummEngine::getMaskFromBox(int box) {
 void ScummEngine::setBoxFlags(int box, int val) {
 	debug(2, "setBoxFlags(%d, 0x%02x)", box, val);
 
+	_boxCache->invalidate();
+
 	/* SCUMM7+ stuff */
 	if (val & 0xC000) {
 		assert(box >= 0 && box < 65);
@@ -230,6 +233,7 @@ byte ScummEngine::getBoxFlags(int box) {
 void ScummEngine::setBoxScale(int box, int scale) {
 	Box *ptr = getBoxBaseAddr(box);
 	assert(ptr);
+	_boxCache->invalidate();
 	if (_game.version == 8)
 		ptr->v8.scale = TO_LE_32(scale);
 	else if (_game.version <= 2)
@@ -241,6 +245,7 @@ void ScummEngine::setBoxScale(int box, int scale) {
 void ScummEngine::setBoxScaleSlot(int box, int slot) {
 	Box *ptr = getBoxBaseAddr(box);
 	assert(ptr);
+	_boxCache->invalidate();
 	ptr->v8.scaleSlot = TO_LE_32(slot);
 }
 
@@ -504,13 +509,16 @@ int ScummEngine_v6::getSpecialBox(int x, int y) {
 
 	numOfBoxes = getNumBoxes() - 1;
 
+	const BoxCache *cache = getBoxCache();
+	const uint64 candidates = cache->getCandidates(x, y);
+
 	for (i = numOfBoxes; i >= 0; i--) {
 		flag = getBoxFlags(i);
 
 		if (!(flag & kBoxInvisible) && (flag & kBoxPlayerOnly))
 			return (-1);
 
-		if (checkXYInBoxBounds(i, x, y))
+		if (cache->isCandidate(candidates, i) && checkXYInBoxBounds(i, x, y))
 			return (i);
 	}
 
@@ -525,24 +533,34 @@ bool ScummEngine::checkXYInBoxBounds(int boxnum, int x, int y) {
 	if (boxnum < 0 || boxnum == Actor::kInvalidBox)
 		return false;
 
-	BoxCoords box = getBoxCoordinates(boxnum);
+	BoxCache *cache = getBoxCache();
+	BoxCoords box;
 	const Common::Point p(x, y);
 
 	// Quick check: If the x (resp. y) coordinate of the point is
 	// strictly smaller (bigger) than the x (y) coordinates of all
 	// corners of the quadrangle, then it certainly is *not* contained
-	// inside the quadrangle.
-	if (x < box.ul.x && x < box.ur.x && x < box.lr.x && x < box.ll.x)
-		return false;
+	// inside the quadrangle. The cache keeps the bounding rectangle of
+	// every box for exactly this test.
+	if (boxnum < cache->getNumBoxes()) {
+		if (cache->isOutsideBounds(boxnum, x, y))
+			return false;
+		box = cache->getCoords(boxnum);
+	} else {
+		box = readBoxCoordinates(boxnum);
 
-	if (x > box.ul.x && x > box.ur.x && x > box.lr.x && x > box.ll.x)
-		return false;
+		if (x < box.ul.x && x < box.ur.x && x < box.lr.x && x < box.ll.x)
+			return false;
 
-	if (y < box.ul.y && y < box.ur.y && y < box.lr.y && y < box.ll.y)
-		return false;
+		if (x > box.ul.x && x > box.ur.x && x > box.lr.x && x > box.ll.x)
+			return false;
 
-	if (y > box.ul.y && y > box.ur.y && y > box.lr.y && y > box.ll.y)
-		return false;
+		if (y < box.ul.y && y < box.ur.y && y < box.lr.y && y < box.ll.y)
+			return false;
+
+		if (y > box.ul.y && y > box.ur.y && y > box.lr.y && y > box.ll.y)
+			return false;
+	}
 
 	// Corner case: If the box is a simple line segment, we consider the
 	// point to be contained "in" (or rather, lying on) the line if it
@@ -588,6 +606,25 @@ bool ScummEngine::checkXYInBoxBounds(int boxnum, int x, int y) {
 }
 
 BoxCoords ScummEngine::getBoxCoordinates(int boxnum) {
+	const BoxCache *cache = getBoxCache();
+	if (boxnum >= 0 && boxnum < cache->getNumBoxes())
+		return cache->getCoords(boxnum);
+	return readBoxCoordinates(boxnum);
+}
+
+BoxCache *ScummEngine::getBoxCache() {
+	if (!_boxCache->isValid()) {
+		const int numOfBoxes = getNumBoxes();
+		_boxCache->reset(numOfBoxes);
+		for (int i = 0; i < numOfBoxes; i++)
+			_boxCache->setBox(i, readBoxCoordinates(i));
+		_boxCache->finalize();
+		debugC(DEBUG_ACTORS, "BoxCache: Rebuilt for %d boxes in room %d", numOfBoxes, _roomResource);
+	}
+	return _boxCache;
+}
+
+BoxCoords ScummEngine::readBoxCoordinates(int boxnum) {
 	BoxCoords tmp, *box = &tmp;
 	Box *bp = getBoxBaseAddr(boxnum);
 	assert(bp);
@@ -731,6 +768,31 @@ byte *ScummEngine::getBoxConnectionBase(int box) {
  * If there is no connection -1 is return.
  */
 int ScummEngine::getNextBox(byte from, byte to) {
+	if (from == to)
+		return to;
+
+	if (to == Actor::kInvalidBox)
+		return -1;
+
+	if (from == Actor::kInvalidBox)
+		return to;
+
+	// The box matrix only changes together with the box resources or
+	// flags, which invalidates the cache, so results can be memoized
+	// per (from, to) pair.
+	BoxCache *cache = getBoxCache();
+	if (from >= cache->getNumBoxes() || to >= cache->getNumBoxes())
+		return getNextBoxUncached(from, to);
+
+	int next = cache->getNextBox(from, to);
+	if (next == BoxCache::kUnknownNextBox) {
+		next = getNextBoxUncached(from, to);
+		cache->setNextBox(from, to, next);
+	}
+	return next;
+}
+
+int ScummEngine::getNextBoxUncached(byte from, byte to) {
 	const byte *boxm;
 	byte i;
 	const int numOfBoxes = getNumBoxes();
@@ -0,0 +1,188 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/array.h"
+#include "common/debug.h"
+
+#include "scumm/costume-cache.h"
+#include "scumm/resource.h"
+#include "scumm/scumm.h"
+
+namespace Scumm {
+
+CostumeCelCache::CostumeCelCache(ResourceManager *res, uint32 budget) : _res(res), _budget(budget), _size(0) {
+	resetStats();
+}
+
+CostumeCelCache::~CostumeCelCache() {
+	clear();
+}
+
+void CostumeCelCache::resetStats() {
+	_stats.hits = _stats.misses = _stats.evictions = 0;
+	_stats.drawFrames = _stats.drawMillis = 0;
+}
+
+const CostumeCelCache::Cel *CostumeCelCache::getCel(int costume, uint32 offset, const byte *src, int width, int height, byte shr, byte mask) {
+	CelKey key;
+	key.costume = costume;
+	key.offset = offset;
+
+	CelMap::iterator it = _cels.find(key);
+	if (it != _cels.end()) {
+		_stats.hits++;
+		// Move to the front of the LRU list
+		Cel *cel = *it->_value;
+		_lru.erase(it->_value);
+		_lru.push_front(cel);
+		it->_value = _lru.begin();
+		return cel;
+	}
+
+	_stats.misses++;
+
+	if (width <= 0 || height <= 0 || height > 0xFFFF || (uint32)(width * height) > _budget / 2)
+		return nullptr;
+
+	Cel *cel = decodeCel(costume, offset, src, width, height, shr, mask);
+
+	while (!_lru.empty() && _size + cel->size > _budget) {
+		evict(--_lru.end());
+		_stats.evictions++;
+	}
+
+	_lru.push_front(cel);
+	_cels[key] = _lru.begin();
+	_size += cel->size;
+	if (_res)
+		_res->adjustHeapSize(cel->size);
+
+	::debugC(DEBUG_ACTORS, "CostumeCelCache: Decoded cel %d:0x%x (%dx%d), %d cels in %d bytes", costume, offset, width, height, _cels.size(), _size);
+	return cel;
+}
+
+CostumeCelCache::Cel *CostumeCelCache::decodeCel(int costume, uint32 offset, const byte *src, int width, int height, byte shr, byte mask) {
+	const uint32 numPixels = width * height;
+	Common::Array<byte> pixels(numPixels);
+	Common::Array<Run> runs;
+	Common::Array<uint16> firstRun(width + 1);
+
+	// Same stream layout as in ClassicCostumeRenderer::proc3 and
+	// AkosRenderer::byleRLEDecode: runs continue across columns and a
+	// zero length in the second byte stands for 256 pixels.
+	uint32 pos = 0;
+	while (pos < numPixels) {
+		byte len = *src++;
+		const byte color = len >> shr;
+		len &= mask;
+		if (!len)
+			len = *src++;
+
+		uint32 count = MIN<uint32>(len ? len : 256, numPixels - pos);
+		memset(&pixels[pos], color, count);
+		pos += count;
+	}
+
+	for (int x = 0; x < width; x++) {
+		firstRun[x] = runs.size();
+		const byte *column = &pixels[x * height];
+		int y = 0;
+		while (y < height) {
+			while (y < height && !column[y])
+				y++;
+			if (y == height)
+				break;
+			Run run;
+			run.start = y;
+			while (y < height && column[y])
+				y++;
+			run.len = y - run.start;
+			runs.push_back(run);
+		}
+	}
+	firstRun[width] = runs.size();
+
+	const uint32 runsSize = runs.size() * sizeof(Run);
+	const uint32 firstRunSize = (width + 1) * sizeof(uint16);
+	const uint32 size = sizeof(Cel) + runsSize + firstRunSize + numPixels;
+
+	byte *block = (byte *)malloc(size);
+	if (!block)
+		error("CostumeCelCache: Out of memory while allocating %d", size);
+
+	Cel *cel = (Cel *)block;
+	Run *celRuns = (Run *)(block + sizeof(Cel));
+	uint16 *celFirstRun = (uint16 *)(block + sizeof(Cel) + runsSize);
+	byte *celPixels = block + sizeof(Cel) + runsSize + firstRunSize;
+
+	if (runsSize)
+		memcpy(celRuns, &runs[0], runsSize);
+	memcpy(celFirstRun, &firstRun[0], firstRunSize);
+	memcpy(celPixels, &pixels[0], numPixels);
+
+	cel->costume = costume;
+	cel->offset = offset;
+	cel->width = width;
+	cel->height = height;
+	cel->runs = celRuns;
+	cel->firstRun = celFirstRun;
+	cel->pixels = celPixels;
+	cel->size = size;
+	return cel;
+}
+
+void CostumeCelCache::evict(CelList::iterator it) {
+	Cel *cel = *it;
+	CelKey key;
+	key.costume = cel->costume;
+	key.offset = cel->offset;
+
+	_cels.erase(key);
+	_lru.erase(it);
+	_size -= cel->size;
+	if (_res)
+		_res->adjustHeapSize(-(int32)cel->size);
+	free(cel);
+}
+
+void CostumeCelCache::purgeCostume(int costume) {
+	CelList::iterator it = _lru.begin();
+	while (it != _lru.end()) {
+		CelList::iterator cur = it++;
+		if ((*cur)->costume == costume)
+			evict(cur);
+	}
+}
+
+void CostumeCelCache::shrink(uint32 size) {
+	const uint32 target = size < _size ? _size - size : 0;
+	while (!_lru.empty() && _size > target) {
+		evict(--_lru.end());
+		_stats.evictions++;
+	}
+}
+
+void CostumeCelCache::clear() {
+	while (!_lru.empty())
+		evict(_lru.begin());
+}
+
+} // End of namespace Scumm
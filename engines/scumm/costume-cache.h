@@ -0,0 +1,140 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCUMM_COSTUME_CACHE_H
+#define SCUMM_COSTUME_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/scummsys.h"
+
+namespace Scumm {
+
+class ResourceManager;
+
+/**
+ * Cache of decoded ByleRLE costume cels, shared by ClassicCostumeRenderer
+ * and AkosRenderer for unscaled limbs.
+ *
+ * A cel is stored as color indices, column by column, together with the
+ * opaque runs of every column. Drawing a cached cel thus neither parses the
+ * RLE stream nor visits transparent pixels. Palette mapping and mirroring
+ * are applied while drawing, so a single entry serves all palettes and
+ * facings of a cel.
+ *
+ * The cache is bounded by a byte budget and evicts the least recently used
+ * cels. Its memory is accounted in the resource heap. When the heap runs
+ * full, the least recently used cels are dropped before any resource gets
+ * expired, since decoded cels are much cheaper to rebuild than resources
+ * are to reload.
+ */
+class CostumeCelCache {
+public:
+	struct Run {
+		uint16 start;
+		uint16 len;
+	};
+
+	struct Cel {
+		int costume;
+		uint32 offset;
+		int width, height;
+		const byte *pixels;      // width * height color indices, column by column
+		const Run *runs;         // Opaque runs of all columns
+		const uint16 *firstRun;  // Index of the first run of each column, width + 1 entries
+		uint32 size;
+	};
+
+	struct Stats {
+		uint32 hits, misses, evictions;
+		uint32 drawFrames, drawMillis;
+	};
+
+	/**
+	 * @param res     Resource manager whose heap the cels are accounted in,
+	 *                or nullptr.
+	 * @param budget  Maximum size of all cels in bytes.
+	 */
+	CostumeCelCache(ResourceManager *res, uint32 budget);
+	~CostumeCelCache();
+
+	/**
+	 * Look up the cel at the given offset of a costume resource, decoding
+	 * it from @p src on a miss.
+	 *
+	 * @return The cel, or nullptr if it does not fit into the cache.
+	 */
+	const Cel *getCel(int costume, uint32 offset, const byte *src, int width, int height, byte shr, byte mask);
+
+	/** Drop all cels of a costume, e.g. because the resource got nuked. */
+	void purgeCostume(int costume);
+
+	/**
+	 * Drop the least recently used cels until at least @p size bytes are
+	 * freed, or no cel is left.
+	 */
+	void shrink(uint32 size);
+
+	/** Drop all cels. */
+	void clear();
+
+	uint32 getSize() const { return _size; }
+	uint32 getBudget() const { return _budget; }
+	uint32 getNumCels() const { return _cels.size(); }
+
+	/** Account the time spent drawing actors in one frame. */
+	void addDrawTime(uint32 millis) { _stats.drawFrames++; _stats.drawMillis += millis; }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	struct CelKey {
+		int costume;
+		uint32 offset;
+
+		bool operator==(const CelKey &other) const { return costume == other.costume && offset == other.offset; }
+	};
+
+	struct CelKey_Hash {
+		uint operator()(const CelKey &key) const { return (uint)(key.costume * 0x9E3779B1u) ^ key.offset; }
+	};
+
+	typedef Common::List<Cel *> CelList;
+	typedef Common::HashMap<CelKey, CelList::iterator, CelKey_Hash> CelMap;
+
+	Cel *decodeCel(int costume, uint32 offset, const byte *src, int width, int height, byte shr, byte mask);
+	void evict(CelList::iterator it);
+
+	ResourceManager *_res;
+	uint32 _budget;
+	uint32 _size;
+
+	// Most recently used cels are kept at the front.
+	CelList _lru;
+	CelMap _cels;
+
+	Stats _stats;
+};
+
+} // End of namespace Scumm
+
+#endif
@@ -111,6 +111,10 @@ byte ClassicCostumeRenderer::mainRoutine(int xmoveCur, int ymoveCur) {
 		break;
 	}
 
+	// skipCelLines() advances _srcPtr, remember where the cel starts
+	const byte *celPtr = _srcPtr;
+	int firstColumn = 0;
+
 	use_scaling = (_scaleX != 0xFF) || (_scaleY != 0xFF);
 
 	compData.x = _actorX;
@@ -243,6 +247,7 @@ byte ClassicCostumeRenderer::mainRoutine(int xmoveCur, int ymoveCur) {
 			if (!newAmiCost && !pcEngCost && _loaded._format != 0x57) {
 				compData.skipWidth -= skip;
 				skipCelLines(compData, skip);
+				firstColumn = skip;
 				compData.x = 0;
 			}
 		} else {
@@ -260,6 +265,7 @@ byte ClassicCostumeRenderer::mainRoutine(int xmoveCur, int ymoveCur) {
 			if (!newAmiCost && !pcEngCost && _loaded._format != 0x57) {
 				compData.skipWidth -= skip;
 				skipCelLines(compData, skip);
+				firstColumn = skip;
 				compData.x = _out.w - 1;
 			}
 		} else {
@@ -313,12 +319,69 @@ byte ClassicCostumeRenderer::mainRoutine(int xmoveCur, int ymoveCur) {
 		proc3_ami(compData);
 	else if (pcEngCost)
 		procPCEngine(compData);
-	else
-		proc3(compData);
+	else {
+		const CostumeCelCache::Cel *cel = nullptr;
+		if (!use_scaling && _vm->_costumeCelCache)
+			cel = _vm->_costumeCelCache->getCel(_loaded._id, celPtr - _loaded._baseptr, celPtr, _width, _height, compData.shr, compData.mask);
+
+		if (cel)
+			drawCachedCel(compData, cel, firstColumn);
+		else
+			proc3(compData);
+	}
 
 	return drawFlag;
 }
 
+void ClassicCostumeRenderer::drawCachedCel(ByleRLEData &compData, const CostumeCelCache::Cel *cel, int firstColumn) {
+	// This produces the same output as proc3() for unscaled cels, only
+	// the opaque runs of each column are visited.
+	const int lastColumn = firstColumn + compData.skipWidth;
+
+	for (int column = firstColumn; column < lastColumn; column++) {
+		if (column != firstColumn) {
+			compData.x += compData.scaleXStep;
+			if (compData.x < 0 || compData.x >= _out.w)
+				return;
+			compData.destPtr += compData.scaleXStep;
+		}
+
+		if (compData.x < 0 || compData.x >= _out.w)
+			continue;
+
+		const byte maskbit = revBitMask(compData.x & 7);
+		const byte *pixels = cel->pixels + column * _height;
+
+		for (uint16 run = cel->firstRun[column]; run < cel->firstRun[column + 1]; run++) {
+			// Clip the run against the screen
+			int top = MAX<int>(cel->runs[run].start, -compData.y);
+			int bottom = MIN<int>(cel->runs[run].start + cel->runs[run].len, _out.h - compData.y);
+
+			byte *dst = compData.destPtr + top * _out.pitch;
+			const byte *mask = compData.maskPtr ? compData.maskPtr + top * _numStrips + compData.x / 8 : nullptr;
+
+			for (int i = top; i < bottom; i++, dst += _out.pitch) {
+				if (mask) {
+					const bool masked = (*mask & maskbit) != 0;
+					mask += _numStrips;
+					if (masked)
+						continue;
+				}
+
+				uint pcolor;
+				if (_shadowMode & 0x20) {
+					pcolor = _shadowTable[*dst];
+				} else {
+					pcolor = _palette[pixels[i]];
+					if (pcolor == 13 && _shadowTable)
+						pcolor = _shadowTable[*dst];
+				}
+				*dst = pcolor;
+			}
+		}
+	}
+}
+
 // Skin colors
 static const int v1MMActorPalatte1[25] = {
 	8, 8, 8, 8, 4, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
@@ -23,6 +23,7 @@
 #define SCUMM_COSTUME_H
 
 #include "scumm/base-costume.h"
+#include "scumm/costume-cache.h"
 
 namespace Scumm {
 class ClassicCostumeLoader : public BaseCostumeLoader {
@@ -100,6 +101,7 @@ protected:
 	byte drawLimb(const Actor *a, int limb) override;
 
 	void proc3(ByleRLEData &v1);
+	void drawCachedCel(ByleRLEData &compData, const CostumeCelCache::Cel *cel, int firstColumn);
 	void proc3_ami(ByleRLEData &v1);
 
 	void procC64(ByleRLEData &v1, int actor);
@@ -26,7 +26,9 @@
 #include "common/util.h"
 
 #include "scumm/actor.h"
+#include "scumm/box-cache.h"
 #include "scumm/boxes.h"
+#include "scumm/costume-cache.h"
 #include "scumm/debugger.h"
 #include "scumm/imuse/imuse.h"
 #include "scumm/imuse_digi/dimuse_engine.h"
@@ -78,6 +80,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("actors",    WRAP_METHOD(ScummDebugger, Cmd_PrintActor));
 	registerCmd("box",       WRAP_METHOD(ScummDebugger, Cmd_PrintBox));
 	registerCmd("matrix",    WRAP_METHOD(ScummDebugger, Cmd_PrintBoxMatrix));
+	registerCmd("boxcache",  WRAP_METHOD(ScummDebugger, Cmd_BoxCache));
 	registerCmd("camera",    WRAP_METHOD(ScummDebugger, Cmd_Camera));
 	registerCmd("room",      WRAP_METHOD(ScummDebugger, Cmd_Room));
 	registerCmd("objects",   WRAP_METHOD(ScummDebugger, Cmd_PrintObjects));
@@ -85,6 +88,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("script",    WRAP_METHOD(ScummDebugger, Cmd_Script));
 	registerCmd("scr",       WRAP_METHOD(ScummDebugger, Cmd_Script));
 	registerCmd("cosdump",   WRAP_METHOD(ScummDebugger, Cmd_Cosdump));
+	registerCmd("celcache",  WRAP_METHOD(ScummDebugger, Cmd_CelCache));
 	registerCmd("scripts",   WRAP_METHOD(ScummDebugger, Cmd_PrintScript));
 	registerCmd("importres", WRAP_METHOD(ScummDebugger, Cmd_ImportRes));
 
@@ -533,6 +537,32 @@ bool ScummDebugger::Cmd_PrintScript(int argc, const char **argv) {
 	return true;
 }
 
+bool ScummDebugger::Cmd_CelCache(int argc, const char **argv) {
+	CostumeCelCache *cache = _vm->_costumeCelCache;
+	if (!cache) {
+		debugPrintf("The costume cel cache is disabled\n");
+		return true;
+	}
+
+	if (argc > 1) {
+		if (!strcmp(argv[1], "reset")) {
+			cache->resetStats();
+		} else if (!strcmp(argv[1], "flush")) {
+			cache->clear();
+		} else {
+			debugPrintf("Syntax: celcache [reset|flush]\n");
+			return true;
+		}
+	}
+
+	const CostumeCelCache::Stats &stats = cache->getStats();
+	debugPrintf("Cels: %d, %d of %d bytes used\n", cache->getNumCels(), cache->getSize(), cache->getBudget());
+	debugPrintf("Hits: %d, misses: %d, evictions: %d\n", stats.hits, stats.misses, stats.evictions);
+	if (stats.drawFrames)
+		debugPrintf("Actor drawing: %d ms in %d frames, %.2f ms per frame\n", stats.drawMillis, stats.drawFrames, (double)stats.drawMillis / stats.drawFrames);
+	return true;
+}
+
 bool ScummDebugger::Cmd_Cosdump(int argc, const char **argv) {
 	const byte *akos;
 	const byte *aksq;
@@ -1087,6 +1117,29 @@ bool ScummDebugger::Cmd_PrintBox(int argc, const char **argv) {
 	return true;
 }
 
+bool ScummDebugger::Cmd_BoxCache(int argc, const char **argv) {
+	BoxCache *cache = _vm->_boxCache;
+
+	if (argc > 1) {
+		if (!strcmp(argv[1], "reset")) {
+			cache->resetStats();
+		} else if (!strcmp(argv[1], "flush")) {
+			cache->invalidate();
+		} else {
+			debugPrintf("Syntax: boxcache [reset|flush]\n");
+			return true;
+		}
+	}
+
+	const BoxCache::Stats &stats = cache->getStats();
+	debugPrintf("Boxes: %d (%s), rebuilds: %d\n", cache->getNumBoxes(), cache->isValid() ? "valid" : "invalid", stats.rebuilds);
+	debugPrintf("Path queries: %d, hits: %d\n", stats.pathQueries, stats.pathHits);
+	if (stats.frames)
+		debugPrintf("Path queries per frame: %.2f average, %d max\n", (double)stats.pathQueries / stats.frames, stats.maxFramePathQueries);
+	debugPrintf("Point queries: %d, rejected by bounds: %d\n", stats.pointQueries, stats.pointRejects);
+	return true;
+}
+
 bool ScummDebugger::Cmd_PrintBoxMatrix(int argc, const char **argv) {
 	byte *boxm = _vm->getBoxMatrixBaseAddr();
 	int num = _vm->getNumBoxes();
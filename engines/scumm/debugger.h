@@ -53,6 +53,7 @@ private:
 	bool Cmd_PrintActor(int argc, const char **argv);
 	bool Cmd_PrintBox(int argc, const char **argv);
 	bool Cmd_PrintBoxMatrix(int argc, const char **argv);
+	bool Cmd_BoxCache(int argc, const char **argv);
 	bool Cmd_PrintObjects(int argc, const char **argv);
 	bool Cmd_Actor(int argc, const char **argv);
 	bool Cmd_Camera(int argc, const char **argv);
@@ -71,6 +72,7 @@ private:
 	bool Cmd_Hide(int argc, const char **argv);
 
 	bool Cmd_Cosdump(int argc, const char **argv);
+	bool Cmd_CelCache(int argc, const char **argv);
 	bool Cmd_IMuse(int argc, const char **argv);
 	bool Cmd_DiMuse(int argc, const char **argv);
 
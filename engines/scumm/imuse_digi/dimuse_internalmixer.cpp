@@ -71,6 +71,76 @@ static const int8 _stereoVolumeTable[284] = {
 	14, 15, 15, 15, 0,  2,  3,  5,  6,  8,  9,  10, 11, 12, 13, 14, 15, 15, 16, 16, 16, 0,  0,  0
 };
 
+// Bulk mixing kernels for tracks which don't need resampling
+//
+// Samples are first unpacked into amplitude table indices, a block at a time,
+// and then accumulated into the mix buffer by a loop which only depends on
+// the channel layout. Both loops are free of per-sample format branches.
+// The results are the same as those of the original per-sample code: this
+// includes downmixing 8-bit stereo by taking the left channel only.
+
+static const int32 kMixBlockSamples = 256;
+
+template<int wordSize>
+static const uint8 *unpackSamples(const uint8 *src, int32 count, int32 *indices);
+
+template<>
+const uint8 *unpackSamples<8>(const uint8 *src, int32 count, int32 *indices) {
+	for (int32 i = 0; i < count; i++)
+		indices[i] = src[i];
+	return src + count;
+}
+
+template<>
+const uint8 *unpackSamples<12>(const uint8 *src, int32 count, int32 *indices) {
+	// Two samples packed in three bytes; count is always even
+	for (int32 i = 0; i < count; i += 2) {
+		indices[i]     = src[0] | ((src[1] & 0xF)  << 8);
+		indices[i + 1] = src[2] | ((src[1] & 0xF0) << 4);
+		src += 3;
+	}
+	return src;
+}
+
+template<>
+const uint8 *unpackSamples<16>(const uint8 *src, int32 count, int32 *indices) {
+	// The 12-bit amplitude table is indexed by the upper 12 bits, biased to unsigned
+	const int16 *samples = (const int16 *)src;
+	for (int32 i = 0; i < count; i++)
+		indices[i] = ((samples[i] & (int16)0xFFF7) >> 4) + 2048;
+	return (const uint8 *)(samples + count);
+}
+
+template<int wordSize, int inChannels, int outChannels>
+static void mixBulk(uint16 *dst, const uint8 *src, int32 frames, const int16 *leftAmpTable, const int16 *rightAmpTable) {
+	int32 indices[kMixBlockSamples];
+	int32 samples = frames * inChannels;
+
+	while (samples > 0) {
+		const int32 count = MIN(samples, kMixBlockSamples);
+		src = unpackSamples<wordSize>(src, count, indices);
+		samples -= count;
+
+		if (inChannels == outChannels) {
+			for (int32 i = 0; i < count; i++)
+				dst[i] += leftAmpTable[indices[i]];
+			dst += count;
+		} else if (outChannels == 2) {
+			for (int32 i = 0; i < count; i++) {
+				dst[0] += leftAmpTable[indices[i]];
+				dst[1] += rightAmpTable[indices[i]];
+				dst += 2;
+			}
+		} else if (wordSize == 8) {
+			for (int32 i = 0; i < count; i += 2)
+				*dst++ += leftAmpTable[indices[i]];
+		} else {
+			for (int32 i = 0; i < count; i += 2)
+				*dst++ += (leftAmpTable[indices[i]] + leftAmpTable[indices[i + 1]]) >> 1;
+		}
+	}
+}
+
 int IMuseDigiInternalMixer::init(int bytesPerSample, int numChannels, uint8 *mixBuf, int mixBufSize, int sizeSampleKB, int mixChannelsNum) {
 	int amplitudeValue;
 	int waveMixChannelsCount;
@@ -394,11 +464,7 @@ void IMuseDigiInternalMixer::mixBits8Mono(uint8 *srcBuf, int32 inFrameCount, int
 			mixBufCurCell[0] += *((uint16 *)ampTable + srcBuf_ptr[0]);
 			mixBufCurCell[1] += *((uint16 *)ampTable + srcBuf_ptr[0]);
 		} else {
-			if (inFrameCount) {
-				for (int i = 0; i < inFrameCount; i++) {
-					mixBufCurCell[i] += *((int16 *)ampTable + srcBuf_ptr[i]);
-				}
-			}
+			mixBulk<8, 1, 1>(mixBufCurCell, srcBuf, inFrameCount, (int16 *)ampTable, nullptr);
 		}
 	} else {
 		if (inFrameCount == feedSize) {
@@ -412,11 +478,7 @@ void IMuseDigiInternalMixer::mixBits8Mono(uint8 *srcBuf, int32 inFrameCount, int
 					}
 				}
 			} else {
-				if (feedSize) {
-					for (int i = 0; i < feedSize; i++) {
-						mixBufCurCell[i] += *((uint16 *)ampTable + srcBuf_ptr[i]);
-					}
-				}
+				mixBulk<8, 1, 1>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 			}
 		} else if (2 * inFrameCount == feedSize) {
 			if (inFrameCount - 1 != 0) {
@@ -464,15 +526,7 @@ void IMuseDigiInternalMixer::mixBits12Mono(uint8 *srcBuf, int32 inFrameCount, in
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[2 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (inFrameCount / 2) {
-			srcBuf_ptr = srcBuf;
-			for (int i = 0; i < inFrameCount / 2; i++) {
-				mixBufCurCell[0] += *((uint16 *)ampTable + (srcBuf_ptr[0] | ((srcBuf_ptr[1] & 0xF)  << 8)));
-				mixBufCurCell[1] += *((uint16 *)ampTable + (srcBuf_ptr[2] | ((srcBuf_ptr[1] & 0xF0) << 4)));
-				srcBuf_ptr += 3;
-				mixBufCurCell += 2;
-			}
-		}
+		mixBulk<12, 1, 1>(mixBufCurCell, srcBuf, inFrameCount, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = srcBuf;
 		if ((inFrameCount / 2) - 1) {
@@ -539,12 +593,7 @@ void IMuseDigiInternalMixer::mixBits16Mono(uint8 *srcBuf, int32 inFrameCount, in
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[2 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_ptr = (uint16 *)srcBuf;
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[i] += *(uint16 *)((uint8 *)ampTable + (((int16)srcBuf_ptr[i] & (int16)0xFFF7) >> 3) + 4096);
-			}
-		}
+		mixBulk<16, 1, 1>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = (uint16 *)srcBuf;
 		int i = 0;
@@ -591,11 +640,7 @@ void IMuseDigiInternalMixer::mixBits8ConvertToMono(uint8 *srcBuf, int32 inFrameC
 	mixBufCurCell = (uint16 *)(&_mixBuf[2 * mixBufStartIndex]);
 	srcBuf_ptr = srcBuf;
 	if (inFrameCount == feedSize) {
-		if (feedSize) {
-			for (int i = 0, j = 0; i < feedSize; i++, j += 2) {
-				mixBufCurCell[i] += (2 * *((int16 *)ampTable + srcBuf_ptr[j])) >> 1;
-			}
-		}
+		mixBulk<8, 2, 1>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		if (inFrameCount != 1) {
 			for (int i = 0; i < inFrameCount - 1; i++) {
@@ -638,15 +683,7 @@ void IMuseDigiInternalMixer::mixBits12ConvertToMono(uint8 *srcBuf, int32 inFrame
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[2 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_ptr = srcBuf;
-
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[i] += (*((int16 *)ampTable + (srcBuf_ptr[0] | ((srcBuf_ptr[1] & 0xF)  << 8))) +
-									 *((int16 *)ampTable + (srcBuf_ptr[2] | ((srcBuf_ptr[1] & 0xF0) << 4)))) >> 1;
-				srcBuf_ptr += 3;
-			}
-		}
+		mixBulk<12, 2, 1>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = srcBuf;
 		if (inFrameCount - 1 != 0) {
@@ -703,14 +740,7 @@ void IMuseDigiInternalMixer::mixBits16ConvertToMono(uint8 *srcBuf, int32 inFrame
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[2 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_ptr = (uint16 *)srcBuf;
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[i] += (*(int16 *)((uint8 *)ampTable + (((int16)srcBuf_ptr[0] & (int16)0xFFF7) >> 3) + 4096)
-								   + *(int16 *)((uint8 *)ampTable + (((int16)srcBuf_ptr[1] & (int16)0xFFF7) >> 3) + 4096)) >> 1;
-				srcBuf_ptr += 2;
-			}
-		}
+		mixBulk<16, 2, 1>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = (uint16 *)srcBuf;
 		if (inFrameCount - 1 != 0) {
@@ -782,14 +812,7 @@ void IMuseDigiInternalMixer::mixBits8ConvertToStereo(uint8 *srcBuf, int32 inFram
 			mixBufCurCell[2] += *((uint16 *)leftAmpTable  + srcBuf_ptr[i]);
 			mixBufCurCell[3] += *((uint16 *)rightAmpTable + srcBuf_ptr[i]);
 		} else {
-			srcBuf_ptr = srcBuf;
-			if (inFrameCount) {
-				for (int i = 0; i < inFrameCount; i++) {
-					mixBufCurCell[0] += *((int16 *)leftAmpTable  + srcBuf_ptr[i]);
-					mixBufCurCell[1] += *((int16 *)rightAmpTable + srcBuf_ptr[i]);
-					mixBufCurCell += 2;
-				}
-			}
+			mixBulk<8, 1, 2>(mixBufCurCell, srcBuf, inFrameCount, (int16 *)leftAmpTable, (int16 *)rightAmpTable);
 		}
 	} else {
 		if (feedSize == inFrameCount) {
@@ -806,14 +829,7 @@ void IMuseDigiInternalMixer::mixBits8ConvertToStereo(uint8 *srcBuf, int32 inFram
 					}
 				}
 			} else {
-				if (feedSize) {
-					srcBuf_ptr = srcBuf;
-					for (int i = 0; i < feedSize; i++) {
-						mixBufCurCell[0] += *((uint16 *)leftAmpTable  + srcBuf_ptr[i]);
-						mixBufCurCell[1] += *((uint16 *)rightAmpTable + srcBuf_ptr[i]);
-						mixBufCurCell += 2;
-					}
-				}
+				mixBulk<8, 1, 2>(mixBufCurCell, srcBuf, feedSize, (int16 *)leftAmpTable, (int16 *)rightAmpTable);
 			}
 		} else if (2 * inFrameCount == feedSize) {
 			srcBuf_ptr = srcBuf;
@@ -893,17 +909,8 @@ void IMuseDigiInternalMixer::mixBits12ConvertToStereo(uint8 *srcBuf, int32 inFra
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[4 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (inFrameCount / 2) {
-			srcBuf_ptr = srcBuf;
-			for (int i = 0; i < (inFrameCount / 2); i++) {
-				mixBufCurCell[0] += *((uint16 *)leftAmpTable  + (srcBuf_ptr[0] | ((srcBuf_ptr[1] & 0xF)  << 8)));
-				mixBufCurCell[1] += *((uint16 *)rightAmpTable + (srcBuf_ptr[0] | ((srcBuf_ptr[1] & 0xF)  << 8)));
-				mixBufCurCell[2] += *((uint16 *)leftAmpTable  + (srcBuf_ptr[2] | ((srcBuf_ptr[1] & 0xF0) << 4)));
-				mixBufCurCell[3] += *((uint16 *)rightAmpTable + (srcBuf_ptr[2] | ((srcBuf_ptr[1] & 0xF0) << 4)));
-				srcBuf_ptr += 3;
-				mixBufCurCell += 4;
-			}
-		}
+		// Samples come in pairs, an odd one out is dropped
+		mixBulk<12, 1, 2>(mixBufCurCell, srcBuf, inFrameCount & ~1, (int16 *)leftAmpTable, (int16 *)rightAmpTable);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = srcBuf;
 		if ((inFrameCount / 2) - 1 != 0) {
@@ -1040,14 +1047,7 @@ void IMuseDigiInternalMixer::mixBits16ConvertToStereo(uint8 *srcBuf, int32 inFra
 	mixBufCurCell = (uint16 *)(&_mixBuf[2 * mixBufStartIndex]);
 
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_tmp = (uint16 *)srcBuf;
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[0] += *(uint16 *)((uint8 *)leftAmpTable  + (((int16)srcBuf_tmp[i] & (int16)0xFFF7) >> 3) + 4096);
-				mixBufCurCell[1] += *(uint16 *)((uint8 *)rightAmpTable + (((int16)srcBuf_tmp[i] & (int16)0xFFF7) >> 3) + 4096);
-				mixBufCurCell += 2;
-			}
-		}
+		mixBulk<16, 1, 2>(mixBufCurCell, srcBuf, feedSize, (int16 *)leftAmpTable, (int16 *)rightAmpTable);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_tmp = (uint16 *)srcBuf;
 		int i = 0;
@@ -1128,15 +1128,7 @@ void IMuseDigiInternalMixer::mixBits8Stereo(uint8 *srcBuf, int32 inFrameCount, i
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[4 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_ptr = srcBuf;
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[0] += *((uint16 *)ampTable + srcBuf_ptr[0]);
-				mixBufCurCell[1] += *((uint16 *)ampTable + srcBuf_ptr[1]);
-				srcBuf_ptr += 2;
-				mixBufCurCell += 2;
-			}
-		}
+		mixBulk<8, 2, 2>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = srcBuf;
 		if (inFrameCount - 1 != 0) {
@@ -1212,17 +1204,7 @@ void IMuseDigiInternalMixer::mixBits12Stereo(uint8 *srcBuf, int32 inFrameCount,
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[4 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_ptr = srcBuf;
-
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[0] += *((uint16 *)ampTable + (srcBuf_ptr[0] | ((srcBuf_ptr[1] & 0xF)  << 8)));
-				mixBufCurCell[1] += *((uint16 *)ampTable + (srcBuf_ptr[2] | ((srcBuf_ptr[1] & 0xF0) << 4)));
-
-				srcBuf_ptr += 3;
-				mixBufCurCell += 2;
-			}
-		}
+		mixBulk<12, 2, 2>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = srcBuf;
 		if (inFrameCount - 1 != 0) {
@@ -1305,16 +1287,7 @@ void IMuseDigiInternalMixer::mixBits16Stereo(uint8 *srcBuf, int32 inFrameCount,
 
 	mixBufCurCell = (uint16 *)(&_mixBuf[4 * mixBufStartIndex]);
 	if (feedSize == inFrameCount) {
-		if (feedSize) {
-			srcBuf_ptr = (uint16 *)srcBuf;
-
-			for (int i = 0; i < feedSize; i++) {
-				mixBufCurCell[0] += *(uint16 *)((int8 *)ampTable + (((int16)srcBuf_ptr[0] & (int16)0xFFF7) >> 3) + 4096);
-				mixBufCurCell[1] += *(uint16 *)((int8 *)ampTable + (((int16)srcBuf_ptr[1] & (int16)0xFFF7) >> 3) + 4096);
-				srcBuf_ptr += 2;
-				mixBufCurCell += 2;
-			}
-		}
+		mixBulk<16, 2, 2>(mixBufCurCell, srcBuf, feedSize, (int16 *)ampTable, nullptr);
 	} else if (2 * inFrameCount == feedSize) {
 		srcBuf_ptr = (uint16 *)srcBuf;
 
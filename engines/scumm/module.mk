@@ -5,12 +5,14 @@ MODULE_OBJS := \
 	akos.o \
 	base-costume.o \
 	bomp.o \
+	box-cache.o \
 	boxes.o \
 	camera.o \
 	cdda.o \
 	charset.o \
 	charset-fontdata.o \
 	costume.o \
+	costume-cache.o \
 	cursor.o \
 	debugger.o \
 	dialogs.o \
@@ -23,11 +23,14 @@
 #include "common/str.h"
 #include "common/memstream.h"
 #include "common/macresman.h"
+#include "common/trace.h"
 #ifndef MACOSX
 #include "common/config-manager.h"
 #endif
 
 #include "scumm/charset.h"
+#include "scumm/box-cache.h"
+#include "scumm/costume-cache.h"
 #include "scumm/dialogs.h"
 #include "scumm/file.h"
 #include "scumm/imuse_digi/dimuse_engine.h"
@@ -644,6 +647,7 @@ int ScummEngine::loadResource(ResType type, ResId idx) {
 	uint32 fileOffs;
 	uint32 size, tag;
 
+	TRACE_ZONE("ScummEngine::loadResource");
 	debugC(DEBUG_RESOURCE, "loadResource(%s,%d)", nameOfResType(type), idx);
 
 	if (type == rtCharset && (_game.features & GF_SMALL_HEADER)) {
@@ -871,6 +875,9 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 	_types[type][idx]._size = size;
 	setResourceCounter(type, idx, 1);
 
+	if (type == rtMatrix && _vm->_boxCache)
+		_vm->_boxCache->invalidate();
+
 	_vm->_insideCreateResource--;
 
 	return ptr;
@@ -938,6 +945,11 @@ void ResourceManager::nukeResource(ResType type, ResId idx) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
 		_allocatedSize -= _types[type][idx]._size;
 		_types[type][idx].nuke();
+
+		if (type == rtCostume && _vm->_costumeCelCache)
+			_vm->_costumeCelCache->purgeCostume(idx);
+		else if (type == rtMatrix && _vm->_boxCache)
+			_vm->_boxCache->invalidate();
 	}
 }
 
@@ -1093,6 +1105,17 @@ void ResourceManager::expireResources(uint32 size) {
 
 	oldAllocatedSize = _allocatedSize;
 
+	// Decoded costume cels are cheaper to rebuild than any resource. When
+	// dropping the least recently used ones is enough, keep the resources.
+	// Otherwise, the cels of the costumes which get expired go with them.
+	CostumeCelCache *celCache = _vm->_costumeCelCache;
+	if (celCache && size + _allocatedSize - _minHeapThreshold <= celCache->getSize()) {
+		celCache->shrink(size + _allocatedSize - _minHeapThreshold);
+		increaseResourceCounters();
+		debugC(DEBUG_RESOURCE, "Shrunk costume cel cache, mem %d -> %d", oldAllocatedSize, _allocatedSize);
+		return;
+	}
+
 	do {
 		best_type = rtInvalid;
 		best_counter = 2;
@@ -182,6 +182,12 @@ public:
 	void setHeapThreshold(int min, int max);
 	uint32 getHeapSize() { return _allocatedSize; }
 
+	/**
+	 * Account memory which does not belong to any resource, like decoded
+	 * costume cels, against the heap thresholds.
+	 */
+	void adjustHeapSize(int32 delta) { _allocatedSize += delta; }
+
 	void allocResTypeData(ResType type, uint32 tag, int num, ResTypeMode mode);
 	void freeResources();
 
@@ -26,6 +26,7 @@
 #include "common/md5.h"
 #include "common/events.h"
 #include "common/system.h"
+#include "common/trace.h"
 #include "common/translation.h"
 
 #include "backends/keymapper/keymap.h"
@@ -41,6 +42,8 @@
 #include "scumm/akos.h"
 #include "scumm/charset.h"
 #include "scumm/costume.h"
+#include "scumm/box-cache.h"
+#include "scumm/costume-cache.h"
 #include "scumm/debugger.h"
 #include "scumm/detection_tables.h"
 #include "scumm/dialogs.h"
@@ -152,6 +155,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 		_gdi = new Gdi(this);
 	}
 	_res = new ResourceManager(this);
+	_boxCache = new BoxCache();
 
 	// Convert MD5 checksum back into a digest
 	for (int i = 0; i < 16; ++i) {
@@ -521,8 +525,21 @@ ScummEngine::~ScummEngine() {
 #endif
 #endif
 
+	if (_costumeCelCache) {
+		const CostumeCelCache::Stats &stats = _costumeCelCache->getStats();
+		debugC(DEBUG_ACTORS, "CostumeCelCache: %d hits, %d misses, %d evictions", stats.hits, stats.misses, stats.evictions);
+		delete _costumeCelCache;
+		_costumeCelCache = nullptr;
+	}
+
 	delete _res;
 	delete _gdi;
+
+	if (_boxCache) {
+		const BoxCache::Stats &stats = _boxCache->getStats();
+		debugC(DEBUG_ACTORS, "BoxCache: %d path queries, %d hits, %d rebuilds", stats.pathQueries, stats.pathHits, stats.rebuilds);
+		delete _boxCache;
+	}
 }
 
 
@@ -1771,6 +1788,14 @@ void ScummEngine::setupCostumeRenderer() {
 		_costumeRenderer = new ClassicCostumeRenderer(this);
 		_costumeLoader = new ClassicCostumeLoader(this);
 	}
+
+	// Decoded cels are only used by the ByleRLE code paths of the classic
+	// and AKOS renderers. A budget of 0 disables the cache.
+	if ((_game.features & GF_NEW_COSTUMES) || (_game.version > 0 && _game.platform != Common::kPlatformNES)) {
+		int budget = ConfMan.hasKey("costume_cache_kb") ? ConfMan.getInt("costume_cache_kb") : 256;
+		if (budget > 0)
+			_costumeCelCache = new CostumeCelCache(_res, budget * 1024);
+	}
 }
 
 void ScummEngine::resetScumm() {
@@ -2765,6 +2790,8 @@ void ScummEngine_v0::scummLoop(int delta) {
 }
 
 void ScummEngine::scummLoop(int delta) {
+	TRACE_ZONE("ScummEngine::scummLoop");
+
 	// Notify the script about how much time has passed, in jiffies
 	if (VAR_TIMER != 0xFF)
 		VAR(VAR_TIMER) = delta;
@@ -2940,6 +2967,7 @@ load_game:
 		scummLoop_handleDrawing();
 
 		scummLoop_handleActors();
+		_boxCache->endFrame();
 
 		_fullRedraw = false;
 
@@ -87,7 +87,9 @@ class Actor;
 class BaseCostumeLoader;
 class BaseCostumeRenderer;
 class BaseScummFile;
+class BoxCache;
 class CharsetRenderer;
+class CostumeCelCache;
 class IMuse;
 class IMuseDigital;
 class MacGui;
@@ -889,6 +891,7 @@ public:
 
 	BaseCostumeLoader *_costumeLoader = nullptr;
 	BaseCostumeRenderer *_costumeRenderer = nullptr;
+	CostumeCelCache *_costumeCelCache = nullptr;
 
 	int _NESCostumeSet = 0;
 	void NES_loadCostumeSet(int n);
@@ -1578,6 +1581,7 @@ protected:
 
 public:
 	uint16 _extraBoxFlags[65];
+	BoxCache *_boxCache = nullptr;
 
 	byte getNumBoxes();
 	byte *getBoxMatrixBaseAddr();
@@ -1591,6 +1595,7 @@ public:
 	bool checkXYInBoxBounds(int box, int x, int y);
 
 	BoxCoords getBoxCoordinates(int boxnum);
+	BoxCache *getBoxCache();
 
 	byte getMaskFromBox(int box);
 	Box *getBoxBaseAddr(int box);
@@ -1612,6 +1617,9 @@ protected:
 	void setBoxScaleSlot(int box, int slot);
 	void convertScaleTableToScaleSlot(int slot);
 
+	BoxCoords readBoxCoordinates(int boxnum);
+	int getNextBoxUncached(byte from, byte to);
+
 	void calcItineraryMatrix(byte *itineraryMatrix, int num);
 	void createBoxMatrix();
 	virtual bool areBoxesNeighbors(int i, int j);
@@ -55,6 +55,7 @@ public:
 	SmushDeltaGlyphsDecoder(int width, int height);
 	~SmushDeltaGlyphsDecoder();
 	bool decode(byte *dst, const byte *src);
+	int32 getFrameSize() const { return _frameSize; }
 };
 
 } // End of namespace Scumm
@@ -21,7 +21,9 @@
 
 #include "common/config-manager.h"
 #include "common/file.h"
+#include "common/memstream.h"
 #include "common/system.h"
+#include "common/timer.h"
 #include "common/util.h"
 #include "common/rect.h"
 
@@ -266,6 +268,16 @@ SmushPlayer::SmushPlayer(ScummEngine_v7 *scumm, IMuseDigital *imuseDigital, Insa
 	_smushAudioInitialized = false;
 	_smushAudioCallbackEnabled = false;
 
+	_decodeQueueHead = 0;
+	_decodeQueueCount = 0;
+	_decodeQueueEnded = false;
+	_curQueuedFrame = nullptr;
+	_curQueuedObject = 0;
+	_inflateBuffer = nullptr;
+	_inflateCapacity = 0;
+
+	resetFrameStats();
+
 	initAudio(_imuseDigital->getSampleRate(), 200000);
 }
 
@@ -307,6 +319,8 @@ void SmushPlayer::init(int32 speed) {
 void SmushPlayer::release() {
 	_vm->_smushVideoShouldFinish = true;
 
+	stopDecodeAhead();
+
 	for (int i = 0; i < 5; i++) {
 		delete _sf[i];
 		_sf[i] = nullptr;
@@ -749,19 +763,27 @@ byte *SmushPlayer::getVideoPalette() {
 void smushDecodeRLE(byte *dst, const byte *src, int left, int top, int width, int height, int pitch);
 void smushDecodeUncompressed(byte *dst, const byte *src, int left, int top, int width, int height, int pitch);
 
-void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height) {
-	if ((height == 242) && (width == 384)) {
-		if (_specialBuffer == 0)
-			_specialBuffer = (byte *)malloc(242 * 384);
-		_dst = _specialBuffer;
-	} else if ((height > _vm->_screenHeight) || (width > _vm->_screenWidth))
-		return;
+bool SmushPlayer::isFrameObjectVisible(int width, int height) const {
+	if ((height == 242) && (width == 384))
+		return true;
+	if ((height > _vm->_screenHeight) || (width > _vm->_screenWidth))
+		return false;
 	// FT Insane uses smaller frames to draw overlays with moving objects
 	// Other .san files do have them as well but their purpose in unknown
 	// and often it causes memory overdraw. So just skip those frames
-	else if (!_insanity && ((height != _vm->_screenHeight) || (width != _vm->_screenWidth)))
+	return _insanity || ((height == _vm->_screenHeight) && (width == _vm->_screenWidth));
+}
+
+void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height, const byte *decoded, uint32 decodedSize) {
+	if (!isFrameObjectVisible(width, height))
 		return;
 
+	if ((height == 242) && (width == 384)) {
+		if (_specialBuffer == 0)
+			_specialBuffer = (byte *)malloc(242 * 384);
+		_dst = _specialBuffer;
+	}
+
 	if ((height == 242) && (width == 384)) {
 		_width = width;
 		_height = height;
@@ -776,12 +798,21 @@ void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int t
 		smushDecodeRLE(_dst, src, left, top, width, height, _vm->_screenWidth);
 		break;
 	case SMUSH_CODEC_DELTA_BLOCKS:
+		// Delta coded objects may have been decoded ahead, see decodeAhead()
+		if (decoded) {
+			memcpy(_dst, decoded, decodedSize);
+			break;
+		}
 		if (!_deltaBlocksCodec)
 			_deltaBlocksCodec = new SmushDeltaBlocksDecoder(width, height);
 		if (_deltaBlocksCodec)
 			_deltaBlocksCodec->decode(_dst, src);
 		break;
 	case SMUSH_CODEC_DELTA_GLYPHS:
+		if (decoded) {
+			memcpy(_dst, decoded, decodedSize);
+			break;
+		}
 		if (!_deltaGlyphsCodec)
 			_deltaGlyphsCodec = new SmushDeltaGlyphsDecoder(width, height);
 		if (_deltaGlyphsCodec)
@@ -805,6 +836,14 @@ void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int t
 }
 
 void SmushPlayer::handleZlibFrameObject(int32 subSize, Common::SeekableReadStream &b) {
+	if (_curQueuedFrame && _curQueuedObject < _curQueuedFrame->objects.size()) {
+		const SmushQueuedObject &object = _curQueuedFrame->objects[_curQueuedObject++];
+		if (object.decoded) {
+			decodeFrameObject(object.codec, nullptr, object.left, object.top, object.width, object.height, _curQueuedFrame->images + object.imageOffset, object.imageSize);
+			return;
+		}
+	}
+
 	if (_skipNext) {
 		_skipNext = false;
 		return;
@@ -835,6 +874,14 @@ void SmushPlayer::handleZlibFrameObject(int32 subSize, Common::SeekableReadStrea
 
 void SmushPlayer::handleFrameObject(int32 subSize, Common::SeekableReadStream &b) {
 	assert(subSize >= 14);
+	if (_curQueuedFrame && _curQueuedObject < _curQueuedFrame->objects.size()) {
+		const SmushQueuedObject &object = _curQueuedFrame->objects[_curQueuedObject++];
+		if (object.decoded) {
+			decodeFrameObject(object.codec, nullptr, object.left, object.top, object.width, object.height, _curQueuedFrame->images + object.imageOffset, object.imageSize);
+			return;
+		}
+	}
+
 	if (_skipNext) {
 		_skipNext = false;
 		return;
@@ -1020,6 +1067,8 @@ SmushFont *SmushPlayer::getFont(int font) {
 void SmushPlayer::parseNextFrame() {
 
 	if (_seekPos >= 0) {
+		Common::StackLock lock(_decodeMutex);
+
 		if (_seekFile.size() > 0) {
 			delete _base;
 
@@ -1062,6 +1111,11 @@ void SmushPlayer::parseNextFrame() {
 
 	assert(_base);
 
+	if (!_decodeQueue.empty()) {
+		parseQueuedFrame();
+		return;
+	}
+
 	const uint32 subType = _base->readUint32BE();
 	const int32 subSize = _base->readUint32BE();
 	const int32 subOffset = _base->pos();
@@ -1072,27 +1126,271 @@ void SmushPlayer::parseNextFrame() {
 		return;
 	}
 
+	handleChunk(subType, subSize, subOffset, *_base);
+
+	_base->seek(subOffset + subSize, SEEK_SET);
+
+	if (_insanity)
+		_vm->_sound->processSound();
+
+	_vm->_imuseDigital->flushTracks();
+}
+
+void SmushPlayer::handleChunk(uint32 subType, int32 subSize, int32 subOffset, Common::SeekableReadStream &b) {
 	debug(3, "Chunk: %s at %x", tag2str(subType), subOffset);
 
 	switch (subType) {
 	case MKTAG('A','H','D','R'): // FT INSANE may seek file to the beginning
-		handleAnimHeader(subSize, *_base);
+		handleAnimHeader(subSize, b);
 		break;
 	case MKTAG('F','R','M','E'):
-		handleFrame(subSize, *_base);
+		handleFrame(subSize, b);
 		break;
 	default:
 		error("Unknown Chunk found at %x: %s, %d", subOffset, tag2str(subType), subSize);
 	}
+}
 
-	_base->seek(subOffset + subSize, SEEK_SET);
+void SmushPlayer::decodeAheadTimerProc(void *refCon) {
+	SmushPlayer *player = (SmushPlayer *)refCon;
 
-	if (_insanity)
-		_vm->_sound->processSound();
+	// The timer thread also runs the iMUSE Digital callbacks, so only one
+	// frame is decoded per tick, to keep the audio from stuttering. At 10 ms
+	// a tick this still fills the queue well ahead of the video frame rate.
+	player->decodeAhead();
+}
+
+void SmushPlayer::startDecodeAhead(int numFrames) {
+	_decodeQueue.resize(numFrames);
+	for (uint i = 0; i < _decodeQueue.size(); i++) {
+		SmushQueuedFrame &frame = _decodeQueue[i];
+		frame.type = 0;
+		frame.size = 0;
+		frame.offset = 0;
+		frame.data = nullptr;
+		frame.dataCapacity = 0;
+		frame.images = nullptr;
+		frame.imagesCapacity = 0;
+		frame.decodeTime = 0;
+		frame.endOfFile = false;
+	}
+
+	_decodeQueueHead = 0;
+	_decodeQueueCount = 0;
+	_decodeQueueEnded = false;
+
+	_vm->getTimerManager()->installTimerProc(&decodeAheadTimerProc, 10000, this, "smushDecodeAhead");
+}
+
+void SmushPlayer::stopDecodeAhead() {
+	if (_decodeQueue.empty())
+		return;
+
+	// This waits for the timer proc to return, if it is running
+	_vm->getTimerManager()->removeTimerProc(&decodeAheadTimerProc);
+
+	for (uint i = 0; i < _decodeQueue.size(); i++) {
+		free(_decodeQueue[i].data);
+		free(_decodeQueue[i].images);
+	}
+	_decodeQueue.clear();
+
+	free(_inflateBuffer);
+	_inflateBuffer = nullptr;
+	_inflateCapacity = 0;
+}
+
+bool SmushPlayer::decodeAhead() {
+	Common::StackLock decodeLock(_decodeMutex);
+
+	// Nothing to read before the video has been opened by parseNextFrame()
+	if (!_base || _seekPos >= 0)
+		return false;
+
+	SmushQueuedFrame *frame;
+	{
+		Common::StackLock lock(_decodeQueueMutex);
+		if (_decodeQueueEnded || _decodeQueueCount == _decodeQueue.size())
+			return false;
+		frame = &_decodeQueue[(_decodeQueueHead + _decodeQueueCount) % _decodeQueue.size()];
+	}
+
+	// The slot is not visible to the engine thread before it gets queued
+	// below, so it can be filled without holding the queue lock.
+	const uint32 startTime = _vm->_system->getMillis(true);
+	readAheadFrame(*frame);
+	frame->decodeTime = _vm->_system->getMillis(true) - startTime;
+
+	Common::StackLock lock(_decodeQueueMutex);
+	_decodeQueueCount++;
+	_decodeQueueEnded = frame->endOfFile;
+	return !_decodeQueueEnded;
+}
+
+void SmushPlayer::readAheadFrame(SmushQueuedFrame &frame) {
+	frame.type = _base->readUint32BE();
+	frame.size = _base->readUint32BE();
+	frame.offset = _base->pos();
+	frame.objects.resize(0);
+
+	frame.endOfFile = (_base->pos() >= (int32)_baseSize);
+	if (frame.endOfFile)
+		return;
+
+	if ((uint32)frame.size > frame.dataCapacity) {
+		free(frame.data);
+		frame.data = (byte *)malloc(frame.size);
+		assert(frame.data);
+		frame.dataCapacity = frame.size;
+	}
+	_base->read(frame.data, frame.size);
+
+	if (frame.type != MKTAG('F','R','M','E'))
+		return;
+
+	// Walk the subchunks the same way handleFrame() does, and decode the
+	// frame objects. Everything else is handled on the engine thread.
+	const byte *ptr = frame.data;
+	int32 frameSize = frame.size;
+	while (frameSize >= 8) {
+		const uint32 subType = READ_BE_UINT32(ptr);
+		const int32 subSize = READ_BE_UINT32(ptr + 4);
+		ptr += 8;
+		frameSize -= 8;
+		if (subSize < 0 || subSize > frameSize)
+			break;
+
+		if (subType == MKTAG('F','O','B','J') || subType == MKTAG('Z','F','O','B'))
+			decodeAheadObject(frame, ptr, subSize, subType == MKTAG('Z','F','O','B'));
+
+		ptr += subSize;
+		frameSize -= subSize;
+		if (subSize & 1) {
+			ptr++;
+			frameSize--;
+		}
+	}
+}
+
+void SmushPlayer::decodeAheadObject(SmushQueuedFrame &frame, const uint8 *src, int32 size, bool compressed) {
+	SmushQueuedObject object;
+	object.decoded = false;
+	object.imageOffset = frame.objects.empty() ? 0 : frame.objects.back().imageOffset + frame.objects.back().imageSize;
+	object.imageSize = 0;
+
+	if (compressed) {
+		unsigned long decompressedSize = READ_BE_UINT32(src);
+		if (decompressedSize > _inflateCapacity) {
+			free(_inflateBuffer);
+			_inflateBuffer = (byte *)malloc(decompressedSize);
+			assert(_inflateBuffer);
+			_inflateCapacity = decompressedSize;
+		}
+		if (!Common::inflateZlib(_inflateBuffer, &decompressedSize, src + 4, size - 4))
+			error("SmushPlayer::decodeAheadObject() Zlib uncompress error");
+		src = _inflateBuffer;
+		size = decompressedSize;
+	}
+
+	if (size < 14) {
+		frame.objects.push_back(object);
+		return;
+	}
+
+	object.codec = READ_LE_UINT16(src);
+	object.left = READ_LE_UINT16(src + 2);
+	object.top = READ_LE_UINT16(src + 4);
+	object.width = READ_LE_UINT16(src + 6);
+	object.height = READ_LE_UINT16(src + 8);
+
+	// Only the delta codecs are worth decoding ahead, the others draw
+	// straight into the frame buffer.
+	if ((object.codec == SMUSH_CODEC_DELTA_BLOCKS || object.codec == SMUSH_CODEC_DELTA_GLYPHS) &&
+		isFrameObjectVisible(object.width, object.height)) {
+		int32 imageSize;
+		if (object.codec == SMUSH_CODEC_DELTA_BLOCKS) {
+			if (!_deltaBlocksCodec)
+				_deltaBlocksCodec = new SmushDeltaBlocksDecoder(object.width, object.height);
+			imageSize = _deltaBlocksCodec->getFrameSize();
+		} else {
+			if (!_deltaGlyphsCodec)
+				_deltaGlyphsCodec = new SmushDeltaGlyphsDecoder(object.width, object.height);
+			imageSize = _deltaGlyphsCodec->getFrameSize();
+		}
+
+		if (object.imageOffset + imageSize > frame.imagesCapacity) {
+			frame.imagesCapacity = object.imageOffset + imageSize;
+			frame.images = (byte *)realloc(frame.images, frame.imagesCapacity);
+			assert(frame.images);
+		}
+
+		byte *image = frame.images + object.imageOffset;
+		if (object.codec == SMUSH_CODEC_DELTA_BLOCKS) {
+			_deltaBlocksCodec->decode(image, src + 14);
+			object.imageSize = imageSize;
+		} else if (_deltaGlyphsCodec->decode(image, src + 14)) {
+			object.imageSize = imageSize;
+		}
+		object.decoded = true;
+	}
+
+	frame.objects.push_back(object);
+}
+
+void SmushPlayer::parseQueuedFrame() {
+	bool stalled;
+	{
+		Common::StackLock lock(_decodeQueueMutex);
+		stalled = (_decodeQueueCount == 0);
+	}
+
+	// The timer did not keep up, so decode the frame right away
+	if (stalled) {
+		_frameStats.stalls++;
+		decodeAhead();
+	}
+
+	SmushQueuedFrame &frame = _decodeQueue[_decodeQueueHead];
+
+	if (frame.endOfFile) {
+		_vm->_smushVideoShouldFinish = true;
+		_endOfFile = true;
+		return;
+	}
+
+	_frameStats.decodeTime += frame.decodeTime;
+	_frameStats.maxDecodeTime = MAX(_frameStats.maxDecodeTime, frame.decodeTime);
+
+	Common::MemoryReadStream stream(frame.data, frame.size);
+	_curQueuedFrame = &frame;
+	_curQueuedObject = 0;
+	handleChunk(frame.type, frame.size, frame.offset, stream);
+	_curQueuedFrame = nullptr;
+
+	{
+		Common::StackLock lock(_decodeQueueMutex);
+		_decodeQueueHead = (_decodeQueueHead + 1) % _decodeQueue.size();
+		_decodeQueueCount--;
+	}
 
 	_vm->_imuseDigital->flushTracks();
 }
 
+void SmushPlayer::resetFrameStats() {
+	memset(&_frameStats, 0, sizeof(_frameStats));
+}
+
+void SmushPlayer::printFrameStats() {
+	if (!_frameStats.frames)
+		return;
+
+	debugC(DEBUG_SMUSH, "Smush stats: %d frames, %d presented, %d decoder stalls", _frameStats.frames, _frameStats.presented, _frameStats.stalls);
+	debugC(DEBUG_SMUSH, "Smush stats: decode %d ms (max %d), compose %d ms (max %d), present %d ms (max %d) per frame",
+		_frameStats.decodeTime / _frameStats.frames, _frameStats.maxDecodeTime,
+		_frameStats.composeTime / _frameStats.frames, _frameStats.maxComposeTime,
+		_frameStats.presentTime / MAX<uint32>(_frameStats.presented, 1), _frameStats.maxPresentTime);
+}
+
 void SmushPlayer::setPalette(const byte *palette) {
 	memcpy(_pal, palette, 0x300);
 	setDirtyColors(0, 255);
@@ -1215,6 +1513,15 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 	setupAnim(filename);
 	init(speed);
 
+	// Read and decode frames ahead on the timer thread. INSANE seeks within
+	// the video and skips frame objects itself, so it is left alone.
+	if (!_insanity) {
+		int lookahead = ConfMan.hasKey("smush_lookahead") ? ConfMan.getInt("smush_lookahead") : 2;
+		if (lookahead > 0)
+			startDecodeAhead(lookahead);
+	}
+	resetFrameStats();
+
 	_startTime = _vm->_system->getMillis();
 	_startFrame = startFrame;
 	_frame = startFrame;
@@ -1260,7 +1567,13 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 				skipFrame = true;
 			else
 				skipFrame = false;
+
+			const uint32 composeStart = _vm->_system->getMillis(true);
 			timerCallback();
+			const uint32 composeTime = _vm->_system->getMillis(true) - composeStart;
+			_frameStats.frames++;
+			_frameStats.composeTime += composeTime;
+			_frameStats.maxComposeTime = MAX(_frameStats.maxComposeTime, composeTime);
 		}
 
 		_vm->scummLoop_handleSound();
@@ -1302,6 +1615,7 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 				// when playing movie". Some frames there are 384 x 224
 				int frameWidth = MIN(_width, _vm->_screenWidth);
 				int frameHeight = MIN(_height, _vm->_screenHeight);
+				const uint32 presentStart = _vm->_system->getMillis(true);
 
 				if (_vm->_macScreen) {
 					_vm->mac_drawBufferToScreen(_dst, frameWidth, 0, 0, frameWidth, frameHeight);
@@ -1311,6 +1625,11 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 
 				_vm->_system->updateScreen();
 				_updateNeeded = false;
+
+				const uint32 presentTime = _vm->_system->getMillis(true) - presentStart;
+				_frameStats.presented++;
+				_frameStats.presentTime += presentTime;
+				_frameStats.maxPresentTime = MAX(_frameStats.maxPresentTime, presentTime);
 			}
 		}
 		if (_endOfFile)
@@ -1327,6 +1646,7 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 		_vm->_system->delayMillis(10);
 	}
 
+	printFrameStats();
 	release();
 
 	// Reset mouse state
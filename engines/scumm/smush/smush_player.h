@@ -22,6 +22,8 @@
 #if !defined(SCUMM_SMUSH_PLAYER_H) && defined(ENABLE_SCUMM_7_8)
 #define SCUMM_SMUSH_PLAYER_H
 
+#include "common/array.h"
+#include "common/mutex.h"
 #include "common/util.h"
 
 namespace Audio {
@@ -125,6 +127,35 @@ private:
 		int32 sdatSize;
 	};
 
+	struct SmushQueuedObject {
+		int codec, left, top, width, height;
+		bool decoded;
+		uint32 imageOffset;
+		uint32 imageSize;
+	};
+
+	struct SmushQueuedFrame {
+		uint32 type;
+		int32 size;
+		int32 offset;
+		byte *data;
+		uint32 dataCapacity;
+		byte *images;
+		uint32 imagesCapacity;
+		Common::Array<SmushQueuedObject> objects;
+		uint32 decodeTime;
+		bool endOfFile;
+	};
+
+	struct SmushFrameStats {
+		uint32 frames;
+		uint32 presented;
+		uint32 stalls;
+		uint32 decodeTime, maxDecodeTime;
+		uint32 composeTime, maxComposeTime;
+		uint32 presentTime, maxPresentTime;
+	};
+
 	ScummEngine_v7 *_vm;
 	IMuseDigital *_imuseDigital;
 	Insane *_insane;
@@ -192,6 +223,20 @@ private:
 	bool _smushAudioInitialized;
 	bool _smushAudioCallbackEnabled;
 
+	// Frames read and decoded ahead of time, see decodeAhead()
+	Common::Array<SmushQueuedFrame> _decodeQueue;
+	uint _decodeQueueHead;
+	uint _decodeQueueCount;
+	bool _decodeQueueEnded;
+	Common::Mutex _decodeMutex;
+	Common::Mutex _decodeQueueMutex;
+	SmushQueuedFrame *_curQueuedFrame;
+	uint _curQueuedObject;
+	byte *_inflateBuffer;
+	uint32 _inflateCapacity;
+
+	SmushFrameStats _frameStats;
+
 public:
 	SmushPlayer(ScummEngine_v7 *scumm, IMuseDigital *_imuseDigital, Insane *insane);
 	~SmushPlayer();
@@ -235,7 +280,9 @@ private:
 	void tryCmpFile(const char *filename);
 
 	bool readString(const char *file);
-	void decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height);
+	bool isFrameObjectVisible(int width, int height) const;
+	void decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height, const byte *decoded = nullptr, uint32 decodedSize = 0);
+	void handleChunk(uint32 subType, int32 subSize, int32 subOffset, Common::SeekableReadStream &b);
 	void handleAnimHeader(int32 subSize, Common::SeekableReadStream &);
 	void handleFrame(int32 frameSize, Common::SeekableReadStream &);
 	void handleNewPalette(int32 subSize, Common::SeekableReadStream &);
@@ -261,6 +308,17 @@ private:
 	void sendAudioToDiMUSE(uint8 *mixBuf, int32 mixStartingPoint, int32 mixFeedSize, int32 mixInFrameCount, int volume, int pan);
 
 	void timerCallback();
+
+	void startDecodeAhead(int numFrames);
+	void stopDecodeAhead();
+	bool decodeAhead();
+	void readAheadFrame(SmushQueuedFrame &frame);
+	void decodeAheadObject(SmushQueuedFrame &frame, const uint8 *src, int32 size, bool compressed);
+	void parseQueuedFrame();
+	static void decodeAheadTimerProc(void *refCon);
+
+	void resetFrameStats();
+	void printFrameStats();
 };
 
 } // End of namespace Scumm
@@ -932,7 +932,8 @@ Font *loadTTFFontFromArchive(const Common::String &filename, int size, TTFSizeMo
 		return nullptr;
 	}
 
-	// HACK: We currently assume that ZipArchive always loads the whole file into memory, so we can delete the archive here.
+	// The members of a ZipArchive are either loaded whole or share the
+	// stream of the archive, so they outlive it
 	delete archive;
 	return font;
 }
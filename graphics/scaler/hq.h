@@ -34,6 +34,7 @@ public:
 	uint increaseFactor() override;
 	uint decreaseFactor() override;
 protected:
+	bool canScaleInParallel() const override { return true; }
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) override;
 
@@ -20,6 +20,7 @@
  */
 
 #include "common/endian.h"
+#include "common/jobs.h"
 #include "common/scummsys.h"
 #include "common/system.h"
 
@@ -29,6 +30,9 @@
 #include "graphics/paletteman.h"
 #include "graphics/managed_surface.h"
 
+/** The number of thumbnail rows interpolated by a job */
+static const uint kThumbnailParallelRows = 8;
+
 template<typename ColorMask>
 uint16 quadBlockInterpolate(const uint8 *src, uint32 srcPitch) {
 	uint16 colorx1y1 = *(((const uint16 *)src));
@@ -117,46 +121,47 @@ static void scaleThumbnail(Graphics::Surface &in, Graphics::Surface &out) {
 		assert(targetHeight <= out.h);
 
 		// Center the image on the output surface
-		byte *dst = (byte *)out.getBasePtr((out.w - targetWidth) / 2, (out.h - targetHeight) / 2);
-		const uint dstLineIncrease = out.pitch - targetWidth * out.format.bytesPerPixel;
+		byte *dstOrigin = (byte *)out.getBasePtr((out.w - targetWidth) / 2, (out.h - targetHeight) / 2);
 
 		const float scaleFactorX = (float)targetWidth / in.w;
 		const float scaleFactorY = (float)targetHeight / in.h;
 
-		for (int y = 0; y < targetHeight; ++y) {
-			const float yFrac = (y / scaleFactorY);
-			const int y1 = (int)yFrac;
-			const int y2 = (y1 + 1 < in.h) ? (y1 + 1) : (in.h - 1);
-
-			for (int x = 0; x < targetWidth; ++x) {
-				const float xFrac = (x / scaleFactorX);
-				const int x1 = (int)xFrac;
-				const int x2 = (x1 + 1 < in.w) ? (x1 + 1) : (in.w - 1);
-
-				// Look up colors at the points
-				uint8 p1R, p1G, p1B;
-				in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x1, y1)), p1R, p1G, p1B);
-				uint8 p2R, p2G, p2B;
-				in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x2, y1)), p2R, p2G, p2B);
-				uint8 p3R, p3G, p3B;
-				in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x1, y2)), p3R, p3G, p3B);
-				uint8 p4R, p4G, p4B;
-				in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x2, y2)), p4R, p4G, p4B);
-
-				const float xDiff = xFrac - x1;
-				const float yDiff = yFrac - y1;
-
-				uint8 pR = (uint8)((1 - yDiff) * ((1 - xDiff) * p1R + xDiff * p2R) + yDiff * ((1 - xDiff) * p3R + xDiff * p4R));
-				uint8 pG = (uint8)((1 - yDiff) * ((1 - xDiff) * p1G + xDiff * p2G) + yDiff * ((1 - xDiff) * p3G + xDiff * p4G));
-				uint8 pB = (uint8)((1 - yDiff) * ((1 - xDiff) * p1B + xDiff * p2B) + yDiff * ((1 - xDiff) * p3B + xDiff * p4B));
-
-				WRITE_UINT16(dst, out.format.RGBToColorT<ColorMask>(pR, pG, pB));
-				dst += 2;
+		// The rows of the output only read the input, so bands of them are
+		// interpolated in parallel
+		g_system->getJobSystem()->parallelFor(0, targetHeight, kThumbnailParallelRows, [&](uint first, uint last) {
+			for (int y = first; y < (int)last; ++y) {
+				const float yFrac = (y / scaleFactorY);
+				const int y1 = (int)yFrac;
+				const int y2 = (y1 + 1 < in.h) ? (y1 + 1) : (in.h - 1);
+				byte *dst = dstOrigin + y * out.pitch;
+
+				for (int x = 0; x < targetWidth; ++x) {
+					const float xFrac = (x / scaleFactorX);
+					const int x1 = (int)xFrac;
+					const int x2 = (x1 + 1 < in.w) ? (x1 + 1) : (in.w - 1);
+
+					// Look up colors at the points
+					uint8 p1R, p1G, p1B;
+					in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x1, y1)), p1R, p1G, p1B);
+					uint8 p2R, p2G, p2B;
+					in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x2, y1)), p2R, p2G, p2B);
+					uint8 p3R, p3G, p3B;
+					in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x1, y2)), p3R, p3G, p3B);
+					uint8 p4R, p4G, p4B;
+					in.format.colorToRGBT<ColorMask>(READ_UINT16(in.getBasePtr(x2, y2)), p4R, p4G, p4B);
+
+					const float xDiff = xFrac - x1;
+					const float yDiff = yFrac - y1;
+
+					uint8 pR = (uint8)((1 - yDiff) * ((1 - xDiff) * p1R + xDiff * p2R) + yDiff * ((1 - xDiff) * p3R + xDiff * p4R));
+					uint8 pG = (uint8)((1 - yDiff) * ((1 - xDiff) * p1G + xDiff * p2G) + yDiff * ((1 - xDiff) * p3G + xDiff * p4G));
+					uint8 pB = (uint8)((1 - yDiff) * ((1 - xDiff) * p1B + xDiff * p2B) + yDiff * ((1 - xDiff) * p3B + xDiff * p4B));
+
+					WRITE_UINT16(dst, out.format.RGBToColorT<ColorMask>(pR, pG, pB));
+					dst += 2;
+				}
 			}
-
-			// Move to the next line
-			dst = (byte *)dst + dstLineIncrease;
-		}
+		});
 	}
 }
 
@@ -20,7 +20,17 @@
 
 #include "graphics/scalerplugin.h"
 
+#include "common/jobs.h"
+#include "common/system.h"
+
 namespace {
+
+/** Rects with fewer source pixels are scaled on the calling thread */
+const int kParallelScaleMinPixels = 32000;
+
+/** The number of source rows scaled by a job */
+const uint kParallelScaleRows = 16;
+
 /**
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
  * source to the destination.
@@ -52,6 +62,12 @@ void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 		} else {
 			Normal1x<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 		}
+	} else if (canScaleInParallel() && width * height >= kParallelScaleMinPixels) {
+		// Each band of rows is scaled as a rect of its own
+		g_system->getJobSystem()->parallelFor(0, height, kParallelScaleRows, [=](uint first, uint last) {
+			scaleIntern(srcPtr + first * srcPitch, srcPitch, dstPtr + first * _factor * dstPitch, dstPitch,
+			            width, last - first, x, y + first);
+		});
 	} else {
 		scaleIntern(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
 	}
@@ -95,6 +95,14 @@ public:
 	}
 
 protected:
+	/**
+	 * Return true if bands of rows of a rect can be scaled on several
+	 * threads at once. The scaler must then only read the source rows around
+	 * each band and write the destination rows of the band, and scaleIntern
+	 * must not change the state of the scaler.
+	 */
+	virtual bool canScaleInParallel() const { return false; }
+
 	/**
 	 * @see scale
 	 */
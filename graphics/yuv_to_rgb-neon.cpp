@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Graphics {
+
+namespace {
+
+template<bool itu>
+FORCEINLINE uint16x8_t neonChannel(int16x8_t y, const int16 *terms) {
+	const int16x8_t value = vaddq_s16(y, vld1q_s16(terms));
+	if (!itu)
+		return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(255)));
+
+	// vqdmulhq_s16 doubles the product before taking its high half
+	const int16x8_t scaled = vsubq_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(16)), vdupq_n_s16(235)), vdupq_n_s16(16));
+	return vreinterpretq_u16_s16(vaddq_s16(scaled, vqdmulhq_s16(scaled, vdupq_n_s16(kYUVKernelITUFactor / 2))));
+}
+
+template<YUVToRGBKernelFormat format, bool itu>
+void convertRow(const YUVToRGBRowArgs &args) {
+	const int count = args.width & ~7;
+	const uint16x8_t alpha = vdupq_n_u16(args.aMask >> 16);
+
+	for (int i = 0; i < count; i += 8) {
+		const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(args.ySrc + i)));
+		const uint16x8_t r = neonChannel<itu>(y, args.rTerms + i);
+		const uint16x8_t g = neonChannel<itu>(y, args.gTerms + i);
+		const uint16x8_t b = neonChannel<itu>(y, args.bTerms + i);
+
+		if (format == kYUVKernelRGB565) {
+			uint16x8_t pixels = vshlq_n_u16(vandq_u16(r, vdupq_n_u16(0xF8)), 8);
+			pixels = vorrq_u16(pixels, vshlq_n_u16(vandq_u16(g, vdupq_n_u16(0xFC)), 3));
+			pixels = vorrq_u16(pixels, vshrq_n_u16(b, 3));
+			vst1q_u16((uint16 *)(args.dst + i * 2), pixels);
+		} else {
+			const uint16x8x2_t pixels = vzipq_u16(vorrq_u16(vshlq_n_u16(g, 8), b), vorrq_u16(alpha, r));
+			vst1q_u16((uint16 *)(args.dst + i * 4), pixels.val[0]);
+			vst1q_u16((uint16 *)(args.dst + i * 4 + 16), pixels.val[1]);
+		}
+	}
+
+	if (count < args.width) {
+		YUVToRGBRowArgs tail = args;
+		tail.dst += count * (format == kYUVKernelRGB565 ? 2 : 4);
+		tail.ySrc += count;
+		tail.width -= count;
+		tail.rTerms += count;
+		tail.gTerms += count;
+		tail.bTerms += count;
+		convertYUVToRGBRowGeneric(tail);
+	}
+}
+
+} // End of anonymous namespace
+
+void convertYUVToRGBRowNEON(const YUVToRGBRowArgs &args) {
+	switch (args.format) {
+	case kYUVKernelRGB565:
+		if (args.itu)
+			convertRow<kYUVKernelRGB565, true>(args);
+		else
+			convertRow<kYUVKernelRGB565, false>(args);
+		break;
+	case kYUVKernelXRGB8888:
+		if (args.itu)
+			convertRow<kYUVKernelXRGB8888, true>(args);
+		else
+			convertRow<kYUVKernelXRGB8888, false>(args);
+		break;
+	default:
+		// Dithering looks up every pixel in a table
+		convertYUVToRGBRowGeneric(args);
+		break;
+	}
+}
+
+} // End of namespace Graphics
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
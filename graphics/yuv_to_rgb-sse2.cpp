@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Graphics {
+
+namespace {
+
+template<bool itu>
+FORCEINLINE __m128i sse2Channel(__m128i y, const int16 *terms) {
+	const __m128i value = _mm_add_epi16(y, _mm_loadu_si128((const __m128i *)terms));
+	if (!itu)
+		return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+
+	const __m128i scaled = _mm_sub_epi16(_mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(235)), _mm_set1_epi16(16));
+	return _mm_add_epi16(scaled, _mm_mulhi_epu16(scaled, _mm_set1_epi16(kYUVKernelITUFactor)));
+}
+
+template<YUVToRGBKernelFormat format, bool itu>
+void convertRow(const YUVToRGBRowArgs &args) {
+	const int count = args.width & ~7;
+	const __m128i alpha = _mm_set1_epi16((int16)(args.aMask >> 16));
+
+	for (int i = 0; i < count; i += 8) {
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(args.ySrc + i)), _mm_setzero_si128());
+		const __m128i r = sse2Channel<itu>(y, args.rTerms + i);
+		const __m128i g = sse2Channel<itu>(y, args.gTerms + i);
+		const __m128i b = sse2Channel<itu>(y, args.bTerms + i);
+
+		if (format == kYUVKernelRGB565) {
+			__m128i pixels = _mm_slli_epi16(_mm_and_si128(r, _mm_set1_epi16(0xF8)), 8);
+			pixels = _mm_or_si128(pixels, _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xFC)), 3));
+			pixels = _mm_or_si128(pixels, _mm_srli_epi16(b, 3));
+			_mm_storeu_si128((__m128i *)(args.dst + i * 2), pixels);
+		} else {
+			const __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+			const __m128i ar = _mm_or_si128(alpha, r);
+			_mm_storeu_si128((__m128i *)(args.dst + i * 4), _mm_unpacklo_epi16(gb, ar));
+			_mm_storeu_si128((__m128i *)(args.dst + i * 4 + 16), _mm_unpackhi_epi16(gb, ar));
+		}
+	}
+
+	if (count < args.width) {
+		YUVToRGBRowArgs tail = args;
+		tail.dst += count * (format == kYUVKernelRGB565 ? 2 : 4);
+		tail.ySrc += count;
+		tail.width -= count;
+		tail.rTerms += count;
+		tail.gTerms += count;
+		tail.bTerms += count;
+		convertYUVToRGBRowGeneric(tail);
+	}
+}
+
+} // End of anonymous namespace
+
+void convertYUVToRGBRowSSE2(const YUVToRGBRowArgs &args) {
+	switch (args.format) {
+	case kYUVKernelRGB565:
+		if (args.itu)
+			convertRow<kYUVKernelRGB565, true>(args);
+		else
+			convertRow<kYUVKernelRGB565, false>(args);
+		break;
+	case kYUVKernelXRGB8888:
+		if (args.itu)
+			convertRow<kYUVKernelXRGB8888, true>(args);
+		else
+			convertRow<kYUVKernelXRGB8888, false>(args);
+		break;
+	default:
+		// Dithering looks up every pixel in a table
+		convertYUVToRGBRowGeneric(args);
+		break;
+	}
+}
+
+} // End of namespace Graphics
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
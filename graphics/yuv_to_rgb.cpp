@@ -82,8 +82,11 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/jobs.h"
+#include "common/system.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -183,6 +186,7 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+	_convertRow = nullptr;
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
@@ -198,6 +202,194 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+namespace {
+
+// The factors of the chroma terms of the lookup tables, in 16.16 fixed point
+enum {
+	kCrRFactor = 91838,  // 0.419 / 0.299
+	kCrGFactor = 46766,  // 0.299 / 0.419
+	kCbGFactor = 22571,  // 0.114 / 0.331
+	kCbBFactor = 116222  // 0.587 / 0.331
+};
+
+// Truncates towards zero, like the conversion of the lookup tables
+inline int16 chromaTerm(int c, int factor) {
+	const int term = (ABS(c) * factor) >> 16;
+	return c < 0 ? -term : term;
+}
+
+template<int shiftX>
+void expandChroma(int16 *rTerms, int16 *gTerms, int16 *bTerms, const byte *uSrc, const byte *vSrc, int width) {
+	for (int i = 0; i < (width >> shiftX); i++) {
+		const int u = uSrc[i] - 128;
+		const int v = vSrc[i] - 128;
+		const int16 r = chromaTerm(v, kCrRFactor);
+		const int16 g = -chromaTerm(v, kCrGFactor) - chromaTerm(u, kCbGFactor);
+		const int16 b = chromaTerm(u, kCbBFactor);
+
+		for (int j = 0; j < (1 << shiftX); j++) {
+			rTerms[(i << shiftX) + j] = r;
+			gTerms[(i << shiftX) + j] = g;
+			bTerms[(i << shiftX) + j] = b;
+		}
+	}
+}
+
+// The row kernels are written for the compiler to vectorize, in 16 bits,
+// which GCC only tries at -O2 if asked to
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("tree-vectorize")
+#endif
+
+template<bool itu>
+inline uint16 yuvChannel(int16 value) {
+	if (!itu)
+		return CLIP<int16>(value, 0, 255);
+
+	const uint16 scaled = CLIP<int16>(value, 16, 235) - 16;
+	return scaled + (uint16)(((uint32)scaled * kYUVKernelITUFactor) >> 16);
+}
+
+template<YUVToRGBKernelFormat format, bool itu>
+void convertRow(const YUVToRGBRowArgs &args) {
+	const byte *ySrc = args.ySrc;
+	const int16 *rTerms = args.rTerms;
+	const int16 *gTerms = args.gTerms;
+	const int16 *bTerms = args.bTerms;
+	const uint32 aMask = args.aMask;
+	const int width = args.width;
+	byte *dst8 = args.dst;
+	uint16 *dst16 = (uint16 *)args.dst;
+	uint32 *dst32 = (uint32 *)args.dst;
+	const byte *ditherTable = args.ditherTable;
+	const uint16 ditherOffset = args.ditherOffset;
+
+	for (int i = 0; i < width; i++) {
+		const int16 y = ySrc[i];
+		const uint16 r = yuvChannel<itu>(y + rTerms[i]);
+		const uint16 g = yuvChannel<itu>(y + gTerms[i]);
+		const uint16 b = yuvChannel<itu>(y + bTerms[i]);
+
+		if (format == kYUVKernelRGB565) {
+			dst16[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+		} else if (format == kYUVKernelXRGB8888) {
+			dst32[i] = aMask | (r << 16) | (g << 8) | b;
+		} else {
+			// The four dither tables alternate along the row
+			const uint16 offset = ditherOffset + (i << 14);
+			dst8[i] = ditherTable[offset + (((r & 0xF8) << 6) | ((g & 0xF8) << 1) | (b >> 4))];
+		}
+	}
+}
+
+YUVToRGBKernelFormat getKernelFormat(const Graphics::PixelFormat &format) {
+	if (format == Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0))
+		return kYUVKernelRGB565;
+	if (format == Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0) || format == Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24))
+		return kYUVKernelXRGB8888;
+	return kYUVKernelNone;
+}
+
+YUVToRGBRowArgs makeRowArgs(YUVToRGBKernelFormat format, const Graphics::PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale scale, const byte *ditherTable = nullptr) {
+	YUVToRGBRowArgs args;
+	memset(&args, 0, sizeof(args));
+	args.format = format;
+	args.itu = (scale == YUVToRGBManager::kScaleITU);
+	args.aMask = (0xFF >> dstFormat.aLoss) << dstFormat.aShift;
+	args.ditherTable = ditherTable;
+	return args;
+}
+
+} // End of anonymous namespace
+
+void convertYUVToRGBRowGeneric(const YUVToRGBRowArgs &args) {
+	switch (args.format) {
+	case kYUVKernelRGB565:
+		if (args.itu)
+			convertRow<kYUVKernelRGB565, true>(args);
+		else
+			convertRow<kYUVKernelRGB565, false>(args);
+		break;
+	case kYUVKernelXRGB8888:
+		if (args.itu)
+			convertRow<kYUVKernelXRGB8888, true>(args);
+		else
+			convertRow<kYUVKernelXRGB8888, false>(args);
+		break;
+	case kYUVKernelCLUT8:
+		if (args.itu)
+			convertRow<kYUVKernelCLUT8, true>(args);
+		else
+			convertRow<kYUVKernelCLUT8, false>(args);
+		break;
+	default:
+		break;
+	}
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+void YUVToRGBManager::convertBlocks(YUVToRGBRowArgs &args, Graphics::Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, int chromaShiftX, int chromaShiftY) {
+	// If no function has been selected yet, detect and select
+	if (!_convertRow) {
+		_convertRow = convertYUVToRGBRowGeneric;
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) _convertRow = convertYUVToRGBRowNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) _convertRow = convertYUVToRGBRowSSE2;
+#endif
+	}
+
+	static const uint16 ditherOffsets[] = { 0x0000, 0xC000, 0x4000, 0x8000 };
+
+	const int bytesPerPixel = dst->format.bytesPerPixel;
+	const int rowsPerChroma = 1 << chromaShiftY;
+	const RowFunc convertRow = _convertRow;
+
+	// Converts the rows sharing the chroma rows [first, last)
+	auto convertChromaRows = [&](uint first, uint last) {
+		YUVToRGBRowArgs rowArgs = args;
+		int16 terms[3][kYUVKernelBlockSize];
+		rowArgs.rTerms = terms[0];
+		rowArgs.gTerms = terms[1];
+		rowArgs.bTerms = terms[2];
+
+		for (int h = first << chromaShiftY; h < MIN<int>(last << chromaShiftY, yHeight); h += rowsPerChroma) {
+			const byte *uRow = uSrc + (h >> chromaShiftY) * uvPitch;
+			const byte *vRow = vSrc + (h >> chromaShiftY) * uvPitch;
+
+			for (int x = 0; x < yWidth; x += kYUVKernelBlockSize) {
+				const int width = MIN<int>(kYUVKernelBlockSize, yWidth - x);
+				if (chromaShiftX)
+					expandChroma<1>(terms[0], terms[1], terms[2], uRow + (x >> 1), vRow + (x >> 1), width);
+				else
+					expandChroma<0>(terms[0], terms[1], terms[2], uRow + x, vRow + x, width);
+
+				// The chroma terms are shared by the rows of the block
+				for (int row = h; row < h + rowsPerChroma; row++) {
+					rowArgs.dst = (byte *)dst->getBasePtr(0, row) + x * bytesPerPixel;
+					rowArgs.ySrc = ySrc + row * yPitch + x;
+					rowArgs.width = width;
+					rowArgs.ditherOffset = ditherOffsets[row & 3];
+					convertRow(rowArgs);
+				}
+			}
+		}
+	};
+
+	// Bands of rows of video frames are converted in parallel, while smaller
+	// images are not worth the jobs
+	const uint chromaRows = (yHeight + rowsPerChroma - 1) >> chromaShiftY;
+	uint grain = chromaRows;
+	if (yWidth * yHeight >= kYUVParallelMinPixels)
+		grain = MAX<uint>(kYUVParallelRows >> chromaShiftY, 1);
+	g_system->getJobSystem()->parallelFor(0, chromaRows, grain, convertChromaRows);
+}
+
 #define PUT_PIXEL(s, d) \
 	L = &clipTable[(s)]; \
 	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | a_mask)
@@ -244,6 +436,13 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 
+	const YUVToRGBKernelFormat kernel = getKernelFormat(dst->format);
+	if (kernel != kYUVKernelNone) {
+		YUVToRGBRowArgs args = makeRowArgs(kernel, dst->format, scale);
+		convertBlocks(args, dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 0, 0);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -253,6 +452,17 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
+void YUVToRGBManager::convert444Dither(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ditherTable, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 1);
+	assert(ditherTable);
+	assert(ySrc && uSrc && vSrc);
+
+	YUVToRGBRowArgs args = makeRowArgs(kYUVKernelCLUT8, dst->format, scale, ditherTable);
+	convertBlocks(args, dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 0, 0);
+}
+
 template<typename PixelInt>
 void convertYUV422ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	int halfWidth = yWidth >> 1;
@@ -301,6 +511,13 @@ void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 1) == 0);
 
+	const YUVToRGBKernelFormat kernel = getKernelFormat(dst->format);
+	if (kernel != kYUVKernelNone) {
+		YUVToRGBRowArgs args = makeRowArgs(kernel, dst->format, scale);
+		convertBlocks(args, dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 1, 0);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -362,6 +579,13 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
+	const YUVToRGBKernelFormat kernel = getKernelFormat(dst->format);
+	if (kernel != kYUVKernelNone) {
+		YUVToRGBRowArgs args = makeRowArgs(kernel, dst->format, scale);
+		convertBlocks(args, dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 1, 1);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -371,6 +595,19 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
+void YUVToRGBManager::convert420Dither(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ditherTable, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 1);
+	assert(ditherTable);
+	assert(ySrc && uSrc && vSrc);
+	assert((yWidth & 1) == 0);
+	assert((yHeight & 1) == 0);
+
+	YUVToRGBRowArgs args = makeRowArgs(kYUVKernelCLUT8, dst->format, scale, ditherTable);
+	convertBlocks(args, dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch, 1, 1);
+}
+
 #define PUT_PIXELA(s, a, d) \
 	L = &clipTable[(s)]; \
 	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | ((a >> a_loss) << a_shift))
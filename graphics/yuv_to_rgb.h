@@ -41,9 +41,12 @@
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
+class YUVToRGBTestSuite;
+
 namespace Graphics {
 
 class YUVToRGBLookup;
+struct YUVToRGBRowArgs;
 
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
@@ -68,6 +71,23 @@ public:
 	 */
 	void convert444(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV444 image to a CLUT8 surface, dithered to a palette
+	 *
+	 * @param dst         the destination surface
+	 * @param scale       the scale of the luminance values
+	 * @param ditherTable the dither table of the palette, as created by
+	 *                    Image::Codec::createQuickTimeDitherTable()
+	 * @param ySrc        the source of the y component
+	 * @param uSrc        the source of the u component
+	 * @param vSrc        the source of the v component
+	 * @param yWidth      the width of the y surface
+	 * @param yHeight     the height of the y surface
+	 * @param yPitch      the pitch of the y surface
+	 * @param uvPitch     the pitch of the u and v surfaces
+	 */
+	void convert444Dither(Graphics::Surface *dst, LuminanceScale scale, const byte *ditherTable, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV422 image to an RGB surface
 	 *
@@ -98,6 +118,23 @@ public:
 	 */
 	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV420 image to a CLUT8 surface, dithered to a palette
+	 *
+	 * @param dst         the destination surface
+	 * @param scale       the scale of the luminance values
+	 * @param ditherTable the dither table of the palette, as created by
+	 *                    Image::Codec::createQuickTimeDitherTable()
+	 * @param ySrc        the source of the y component
+	 * @param uSrc        the source of the u component
+	 * @param vSrc        the source of the v component
+	 * @param yWidth      the width of the y surface (must be divisible by 2)
+	 * @param yHeight     the height of the y surface (must be divisible by 2)
+	 * @param yPitch      the pitch of the y surface
+	 * @param uvPitch     the pitch of the u and v surfaces
+	 */
+	void convert420Dither(Graphics::Surface *dst, LuminanceScale scale, const byte *ditherTable, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV420 image with Alpha component to an ARGB surface
 	 *
@@ -142,7 +179,20 @@ private:
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
 
+	/**
+	 * Convert an image with the kernels of yuv_to_rgb_intern.h
+	 *
+	 * @param args         the destination format and dither table
+	 * @param chromaShiftX log2 of the horizontal chroma subsampling
+	 * @param chromaShiftY log2 of the vertical chroma subsampling
+	 */
+	void convertBlocks(YUVToRGBRowArgs &args, Graphics::Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch, int chromaShiftX, int chromaShiftY);
+
 	YUVToRGBLookup *_lookup;
+
+	typedef void (*RowFunc)(const YUVToRGBRowArgs &args);
+	RowFunc _convertRow;
+	friend class ::YUVToRGBTestSuite;
 };
  /** @} */
 } // End of namespace Graphics
@@ -0,0 +1,96 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/**
+ * Internal interfaces to the YUV to RGB conversion kernels.
+ *
+ * The kernels convert YUV images to the most common destination formats
+ * without lookup tables. The chroma terms of a block of pixels are first
+ * computed in fixed point, then each row of the block is converted by a row
+ * kernel, which has SSE2 and NEON versions. They produce the same pixels as
+ * the lookup tables used for the other formats.
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_INTERN_H
+#define GRAPHICS_YUV_TO_RGB_INTERN_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/** The destination formats with their own kernels */
+enum YUVToRGBKernelFormat {
+	kYUVKernelNone,
+	kYUVKernelRGB565,
+	kYUVKernelXRGB8888, /** With or without alpha in the top byte */
+	kYUVKernelCLUT8     /** Dithered with a QuickTime dither table */
+};
+
+enum {
+	/** The number of pixels of a row converted at once */
+	kYUVKernelBlockSize = 128,
+
+	/** Images with fewer pixels are converted on the calling thread */
+	kYUVParallelMinPixels = 64000,
+
+	/** The number of rows converted by a job */
+	kYUVParallelRows = 16,
+
+	/**
+	 * Scales luminance values from [0, 219] to [0, 255] like the lookup
+	 * tables: x + ((x * kYUVKernelITUFactor) >> 16) == x * 255 / 219
+	 */
+	kYUVKernelITUFactor = 10774
+};
+
+/** A block of a row to convert */
+struct YUVToRGBRowArgs {
+	YUVToRGBKernelFormat format;
+	bool itu;          /** Luminance values range from [16, 235] */
+	uint32 aMask;      /** Alpha bits of XRGB8888 pixels */
+
+	byte *dst;
+	const byte *ySrc;
+	int width;
+
+	// Chroma terms added to the luminance of each pixel
+	const int16 *rTerms;
+	const int16 *gTerms;
+	const int16 *bTerms;
+
+	const byte *ditherTable;
+	uint16 ditherOffset; /** Offset in the dither table of the first pixel */
+};
+
+typedef void (*YUVToRGBRowFunc)(const YUVToRGBRowArgs &args);
+
+void convertYUVToRGBRowGeneric(const YUVToRGBRowArgs &args);
+#ifdef SCUMMVM_SSE2
+void convertYUVToRGBRowSSE2(const YUVToRGBRowArgs &args);
+#endif
+#ifdef SCUMMVM_NEON
+void convertYUVToRGBRowNEON(const YUVToRGBRowArgs &args);
+#endif
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,538 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gui/ThemeCache.h"
+#include "gui/ThemeEval.h"
+#include "gui/ThemeParser.h"
+
+#include "common/archive.h"
+#include "common/debug.h"
+#include "common/ptr.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/thumbnail.h"
+#include "graphics/VectorRenderer.h"
+
+namespace GUI {
+
+/** Tag and version of the header of theme cache files. */
+static const uint32 THEMECACHE_TAG = MKTAG('S', 'T', 'X', 'C');
+static const byte THEMECACHE_VERSION = 1;
+
+static void writeString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeString(str);
+	stream.writeByte(0);
+}
+
+static void writeColor(Common::WriteStream &stream, const Graphics::DrawStep::Color &color) {
+	stream.writeByte(color.r);
+	stream.writeByte(color.g);
+	stream.writeByte(color.b);
+	stream.writeByte(color.set);
+}
+
+static void readColor(Common::ReadStream &stream, Graphics::DrawStep::Color &color) {
+	color.r = stream.readByte();
+	color.g = stream.readByte();
+	color.b = stream.readByte();
+	color.set = stream.readByte() != 0;
+}
+
+static void writeRect(Common::WriteStream &stream, const Common::Rect &rect) {
+	stream.writeSint16LE(rect.left);
+	stream.writeSint16LE(rect.top);
+	stream.writeSint16LE(rect.right);
+	stream.writeSint16LE(rect.bottom);
+}
+
+static void readRect(Common::ReadStream &stream, Common::Rect &rect) {
+	rect.left = stream.readSint16LE();
+	rect.top = stream.readSint16LE();
+	rect.right = stream.readSint16LE();
+	rect.bottom = stream.readSint16LE();
+}
+
+ThemeCache::ThemeCache(ThemeEngine *engine) : _engine(engine), _ops(DisposeAfterUse::YES) {
+}
+
+bool ThemeCache::checksum(Common::SeekableReadStream *stream, uint32 &crc) const {
+	if (!stream)
+		return false;
+
+	const uint32 size = stream->size();
+	byte *data = (byte *)malloc(size);
+	if (size && !data) {
+		delete stream;
+		return false;
+	}
+
+	const bool ok = stream->read(data, size) == size;
+	crc = _crc.crcFast(data, size);
+	free(data);
+	delete stream;
+
+	return ok;
+}
+
+bool ThemeCache::checksum(const Common::String &name, uint32 &crc) const {
+	// The same lookup as the ThemeEngine uses to load bitmaps
+	Common::ArchiveMemberList members;
+	_engine->_themeFiles.listMatchingMembers(members, Common::Path(name, '/'));
+	for (Common::ArchiveMemberList::const_iterator i = members.begin(), end = members.end(); i != end; ++i) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (stream)
+			return checksum(stream, crc);
+	}
+
+	return false;
+}
+
+bool ThemeCache::addSource(const Common::ArchiveMember &member) {
+	Source source;
+	source.name = member.getName();
+	if (!checksum(member.createReadStream(), source.checksum))
+		return false;
+
+	_sources.push_back(source);
+	return true;
+}
+
+void ThemeCache::writeHeader(Common::WriteStream &stream) const {
+	const Graphics::PixelFormat &format = _engine->_overlayFormat;
+
+	stream.writeUint32BE(THEMECACHE_TAG);
+	stream.writeByte(THEMECACHE_VERSION);
+	writeString(stream, SCUMMVM_THEME_VERSION_STR);
+	stream.writeSint16LE(_engine->_baseWidth);
+	stream.writeSint16LE(_engine->_baseHeight);
+	stream.writeFloatLE(_engine->_scaleFactor);
+	stream.writeByte(format.bytesPerPixel);
+	stream.writeByte(format.rLoss);
+	stream.writeByte(format.gLoss);
+	stream.writeByte(format.bLoss);
+	stream.writeByte(format.aLoss);
+	stream.writeByte(format.rShift);
+	stream.writeByte(format.gShift);
+	stream.writeByte(format.bShift);
+	stream.writeByte(format.aShift);
+
+	stream.writeUint32LE(_sources.size());
+	for (uint i = 0; i < _sources.size(); ++i) {
+		writeString(stream, _sources[i].name);
+		stream.writeUint32LE(_sources[i].checksum);
+	}
+}
+
+bool ThemeCache::readHeader(Common::SeekableReadStream &stream) const {
+	if (stream.readUint32BE() != THEMECACHE_TAG || stream.readByte() != THEMECACHE_VERSION)
+		return false;
+
+	if (stream.readString() != SCUMMVM_THEME_VERSION_STR)
+		return false;
+
+	const int16 baseWidth = stream.readSint16LE();
+	const int16 baseHeight = stream.readSint16LE();
+	const float scaleFactor = stream.readFloatLE();
+	if (baseWidth != _engine->_baseWidth || baseHeight != _engine->_baseHeight || scaleFactor != _engine->_scaleFactor)
+		return false;
+
+	Graphics::PixelFormat format;
+	format.bytesPerPixel = stream.readByte();
+	format.rLoss = stream.readByte();
+	format.gLoss = stream.readByte();
+	format.bLoss = stream.readByte();
+	format.aLoss = stream.readByte();
+	format.rShift = stream.readByte();
+	format.gShift = stream.readByte();
+	format.bShift = stream.readByte();
+	format.aShift = stream.readByte();
+	if (format != _engine->_overlayFormat)
+		return false;
+
+	if (stream.readUint32LE() != _sources.size())
+		return false;
+
+	for (uint i = 0; i < _sources.size(); ++i) {
+		if (stream.readString() != _sources[i].name || stream.readUint32LE() != _sources[i].checksum)
+			return false;
+	}
+
+	return !stream.eos() && !stream.err();
+}
+
+bool ThemeCache::load(const Common::String &name) {
+	Common::SaveFileManager *saveMan = _engine->_system->getSavefileManager();
+	if (!saveMan || !saveMan->exists(name))
+		return false;
+
+	Common::ScopedPtr<Common::SeekableReadStream> in(saveMan->openForLoading(name));
+	if (!in)
+		return false;
+
+	if (!readHeader(*in)) {
+		debug(3, "ThemeCache: '%s' does not match the theme", name.c_str());
+		return false;
+	}
+
+	// Bitmaps are checked against their sources before anything is loaded,
+	// so the theme is left untouched when they changed
+	const uint32 numBitmaps = in->readUint32LE();
+	if (in->eos() || numBitmaps > (uint32)in->size())
+		return false;
+
+	Common::Array<Bitmap> bitmaps(numBitmaps);
+	for (uint i = 0; i < bitmaps.size(); ++i) {
+		bitmaps[i].filename = in->readString();
+		bitmaps[i].source.name = in->readString();
+		bitmaps[i].source.checksum = in->readUint32LE();
+
+		uint32 crc;
+		if (!checksum(bitmaps[i].source.name, crc) || crc != bitmaps[i].source.checksum) {
+			debug(3, "ThemeCache: '%s' changed since '%s' was written", bitmaps[i].source.name.c_str(), name.c_str());
+			return false;
+		}
+	}
+
+	const uint32 size = in->readUint32LE();
+	const uint32 crc = in->readUint32LE();
+	byte *data = (byte *)malloc(size);
+	if (!data || in->eos() || in->err() || in->read(data, size) != size || _crc.crcFast(data, size) != crc) {
+		free(data);
+		warning("ThemeCache: '%s' is corrupted, ignoring it", name.c_str());
+		return false;
+	}
+
+	Common::MemoryReadStream stream(data, size, DisposeAfterUse::YES);
+
+	for (uint i = 0; i < bitmaps.size(); ++i) {
+		Graphics::Surface *surface = nullptr;
+		if (!Graphics::loadThumbnail(stream, surface, false))
+			return false;
+
+		Graphics::ManagedSurface *surf = new Graphics::ManagedSurface();
+		surf->copyFrom(*surface);
+		surface->free();
+		delete surface;
+
+		const bool hasTransparentColor = stream.readByte() != 0;
+		const uint32 transparentColor = stream.readUint32LE();
+		if (hasTransparentColor)
+			surf->setTransparentColor(transparentColor);
+
+		// Bitmaps stay loaded when the theme is reloaded at the same scale
+		Graphics::ManagedSurface *&loaded = _engine->_bitmaps[bitmaps[i].filename];
+		if (loaded) {
+			surf->free();
+			delete surf;
+		} else {
+			loaded = surf;
+		}
+	}
+
+	return replay(stream) && _engine->_themeEval->loadState(stream);
+}
+
+bool ThemeCache::save(const Common::String &name) {
+	Common::SaveFileManager *saveMan = _engine->_system->getSavefileManager();
+	if (!saveMan)
+		return false;
+
+	Common::MemoryWriteStreamDynamic payload(DisposeAfterUse::YES);
+
+	for (uint i = 0; i < _bitmaps.size(); ++i) {
+		const Graphics::ManagedSurface *surf = _engine->getImageSurface(_bitmaps[i].filename);
+		if (!surf || !Graphics::saveThumbnail(payload, surf->rawSurface()))
+			return false;
+
+		payload.writeByte(surf->hasTransparentColor());
+		payload.writeUint32LE(surf->getTransparentColor());
+
+		if (!checksum(_bitmaps[i].source.name, _bitmaps[i].source.checksum))
+			return false;
+	}
+
+	payload.write(_ops.getData(), _ops.size());
+	payload.writeByte(kOpEnd);
+	_engine->_themeEval->saveState(payload);
+
+	Common::ScopedPtr<Common::OutSaveFile> out(saveMan->openForSaving(name, false));
+	if (!out) {
+		warning("ThemeCache: Can't write '%s'", name.c_str());
+		return false;
+	}
+
+	writeHeader(*out);
+
+	out->writeUint32LE(_bitmaps.size());
+	for (uint i = 0; i < _bitmaps.size(); ++i) {
+		writeString(*out, _bitmaps[i].filename);
+		writeString(*out, _bitmaps[i].source.name);
+		out->writeUint32LE(_bitmaps[i].source.checksum);
+	}
+
+	out->writeUint32LE(payload.size());
+	out->writeUint32LE(_crc.crcFast(payload.getData(), payload.size()));
+	out->write(payload.getData(), payload.size());
+
+	out->finalize();
+	if (out->err()) {
+		warning("ThemeCache: Can't write '%s'", name.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool ThemeCache::replay(Common::SeekableReadStream &stream) {
+	for (;;) {
+		const Op op = (Op)stream.readByte();
+		if (stream.eos() || stream.err())
+			return false;
+
+		switch (op) {
+		case kOpEnd:
+			return true;
+
+		case kOpFontNames:
+		case kOpFont: {
+			const TextData textId = (TextData)stream.readSByte();
+			const Common::String language = stream.readString();
+			const Common::String file = stream.readString();
+			const Common::String scalableFile = stream.readString();
+			const int pointsize = stream.readSint32LE();
+
+			if (op == kOpFontNames)
+				_engine->storeFontNames(textId, language, file, scalableFile, pointsize);
+			else if (!_engine->addFont(textId, language, file, scalableFile, pointsize))
+				return false;
+			break;
+		}
+
+		case kOpTextColor: {
+			const TextColor colorId = (TextColor)stream.readByte();
+			const byte r = stream.readByte();
+			const byte g = stream.readByte();
+			const byte b = stream.readByte();
+			if (!_engine->addTextColor(colorId, r, g, b))
+				return false;
+			break;
+		}
+
+		case kOpCursor: {
+			const Common::String filename = stream.readString();
+			const int hotspotX = stream.readSint16LE();
+			const int hotspotY = stream.readSint16LE();
+			if (!_engine->createCursor(filename, hotspotX, hotspotY))
+				return false;
+			break;
+		}
+
+		case kOpDrawData: {
+			const Common::String data = stream.readString();
+			if (!_engine->addDrawData(data, stream.readByte() != 0))
+				return false;
+			break;
+		}
+
+		case kOpDrawStep: {
+			const Common::String drawDataId = stream.readString();
+			Graphics::DrawStep step;
+			if (!readStep(stream, step))
+				return false;
+			_engine->addDrawStep(drawDataId, step);
+			break;
+		}
+
+		case kOpTextData: {
+			const Common::String drawDataId = stream.readString();
+			const TextData textId = (TextData)stream.readSByte();
+			const TextColor colorId = (TextColor)stream.readByte();
+			const Graphics::TextAlign alignH = (Graphics::TextAlign)stream.readByte();
+			const ThemeEngine::TextAlignVertical alignV = (ThemeEngine::TextAlignVertical)stream.readByte();
+			if (!_engine->addTextData(drawDataId, textId, colorId, alignH, alignV))
+				return false;
+			break;
+		}
+
+		default:
+			return false;
+		}
+	}
+}
+
+void ThemeCache::writeFont(Op op, TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	_ops.writeByte(op);
+	_ops.writeSByte(textId);
+	writeString(_ops, language);
+	writeString(_ops, file);
+	writeString(_ops, scalableFile);
+	_ops.writeSint32LE(pointsize);
+}
+
+void ThemeCache::recordFontNames(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	writeFont(kOpFontNames, textId, language, file, scalableFile, pointsize);
+}
+
+void ThemeCache::recordFont(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	writeFont(kOpFont, textId, language, file, scalableFile, pointsize);
+}
+
+void ThemeCache::recordTextColor(TextColor colorId, int r, int g, int b) {
+	_ops.writeByte(kOpTextColor);
+	_ops.writeByte(colorId);
+	_ops.writeByte(r);
+	_ops.writeByte(g);
+	_ops.writeByte(b);
+}
+
+void ThemeCache::recordBitmap(const Common::String &filename, const Common::String &scalablefile) {
+	// The bitmap itself is only written with the cache, once it is loaded
+	for (uint i = 0; i < _bitmaps.size(); ++i) {
+		if (_bitmaps[i].filename == filename)
+			return;
+	}
+
+	Bitmap bitmap;
+	bitmap.filename = filename;
+	bitmap.source.name = scalablefile.empty() ? filename : scalablefile;
+	bitmap.source.checksum = 0;
+	_bitmaps.push_back(bitmap);
+}
+
+void ThemeCache::recordCursor(const Common::String &filename, int hotspotX, int hotspotY) {
+	_ops.writeByte(kOpCursor);
+	writeString(_ops, filename);
+	_ops.writeSint16LE(hotspotX);
+	_ops.writeSint16LE(hotspotY);
+}
+
+void ThemeCache::recordDrawData(const Common::String &data, bool cached) {
+	_ops.writeByte(kOpDrawData);
+	writeString(_ops, data);
+	_ops.writeByte(cached);
+}
+
+void ThemeCache::recordDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step) {
+	_ops.writeByte(kOpDrawStep);
+	writeString(_ops, drawDataId);
+	writeStep(step);
+}
+
+void ThemeCache::recordTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV) {
+	_ops.writeByte(kOpTextData);
+	writeString(_ops, drawDataId);
+	_ops.writeSByte(textId);
+	_ops.writeByte(colorId);
+	_ops.writeByte(alignH);
+	_ops.writeByte(alignV);
+}
+
+void ThemeCache::writeStep(const Graphics::DrawStep &step) {
+	// Drawing functions and bitmaps are written by name
+	const char *function = ThemeParser::getDrawingFunctionName(step);
+	writeString(_ops, function ? function : "");
+
+	Common::String blitSrc;
+	if (step.blitSrc) {
+		for (ThemeEngine::ImagesMap::const_iterator i = _engine->_bitmaps.begin(); i != _engine->_bitmaps.end(); ++i) {
+			if (i->_value == step.blitSrc) {
+				blitSrc = i->_key;
+				break;
+			}
+		}
+	}
+	writeString(_ops, blitSrc);
+
+	_ops.writeByte(step.alphaType);
+	writeColor(_ops, step.fgColor);
+	writeColor(_ops, step.bgColor);
+	writeColor(_ops, step.gradColor1);
+	writeColor(_ops, step.gradColor2);
+	writeColor(_ops, step.bevelColor);
+	_ops.writeByte(step.autoWidth);
+	_ops.writeByte(step.autoHeight);
+	_ops.writeSint16LE(step.x);
+	_ops.writeSint16LE(step.y);
+	_ops.writeSint16LE(step.w);
+	_ops.writeSint16LE(step.h);
+	writeRect(_ops, step.padding);
+	writeRect(_ops, step.clip);
+	_ops.writeByte(step.xAlign);
+	_ops.writeByte(step.yAlign);
+	_ops.writeByte(step.shadow);
+	_ops.writeByte(step.stroke);
+	_ops.writeByte(step.factor);
+	_ops.writeByte(step.radius);
+	_ops.writeByte(step.bevel);
+	_ops.writeByte(step.fillMode);
+	_ops.writeByte(step.shadowFillMode);
+	_ops.writeUint32LE(step.extraData);
+	_ops.writeUint32LE(step.scale);
+	_ops.writeUint32LE(step.shadowIntensity);
+	_ops.writeByte(step.autoscale);
+}
+
+bool ThemeCache::readStep(Common::SeekableReadStream &stream, Graphics::DrawStep &step) const {
+	const Common::String function = stream.readString();
+	if (!function.empty() && !ThemeParser::setDrawingFunction(step, function))
+		return false;
+
+	const Common::String blitSrc = stream.readString();
+	if (!blitSrc.empty()) {
+		step.blitSrc = _engine->getImageSurface(blitSrc);
+		if (!step.blitSrc)
+			return false;
+	}
+
+	step.alphaType = (Graphics::AlphaType)stream.readByte();
+	readColor(stream, step.fgColor);
+	readColor(stream, step.bgColor);
+	readColor(stream, step.gradColor1);
+	readColor(stream, step.gradColor2);
+	readColor(stream, step.bevelColor);
+	step.autoWidth = stream.readByte() != 0;
+	step.autoHeight = stream.readByte() != 0;
+	step.x = stream.readSint16LE();
+	step.y = stream.readSint16LE();
+	step.w = stream.readSint16LE();
+	step.h = stream.readSint16LE();
+	readRect(stream, step.padding);
+	readRect(stream, step.clip);
+	step.xAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+	step.yAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+	step.shadow = stream.readByte();
+	step.stroke = stream.readByte();
+	step.factor = stream.readByte();
+	step.radius = stream.readByte();
+	step.bevel = stream.readByte();
+	step.fillMode = stream.readByte();
+	step.shadowFillMode = stream.readByte();
+	step.extraData = stream.readUint32LE();
+	step.scale = stream.readUint32LE();
+	step.shadowIntensity = stream.readUint32LE();
+	step.autoscale = (ThemeEngine::AutoScaleMode)stream.readByte();
+
+	return !stream.eos() && !stream.err();
+}
+
+} // End of namespace GUI
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GUI_THEME_CACHE_H
+#define GUI_THEME_CACHE_H
+
+#include "common/array.h"
+#include "common/crc.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "gui/ThemeEngine.h"
+
+namespace Common {
+class ArchiveMember;
+}
+
+namespace GUI {
+
+/**
+ * Compiled form of a theme, which lets the ThemeEngine skip parsing the STX
+ * files of a theme and decoding its bitmaps.
+ *
+ * While a theme is parsed, the ThemeEngine records in a ThemeCache the calls
+ * the ThemeParser makes to define fonts, colors, draw steps and bitmaps.
+ * Once the theme is parsed, the recorded calls are written to a cache file
+ * along with the decoded bitmaps and the variables and layouts built in the
+ * ThemeEval. Loading the cache replays the calls and restores the rest.
+ *
+ * The parsed theme depends on the base resolution, the scale factor and the
+ * overlay pixel format, so each cache file is only valid for those. It is
+ * also keyed by the theme format version and the checksums of the THEMERC
+ * file, the STX files and the bitmap sources.
+ */
+class ThemeCache {
+public:
+	explicit ThemeCache(ThemeEngine *engine);
+
+	/**
+	 * Adds a file the theme is parsed from to the key of the cache. All files
+	 * must be added, in the order they are parsed, before the cache is loaded
+	 * or recorded.
+	 */
+	bool addSource(const Common::ArchiveMember &member);
+
+	/**
+	 * Replays the theme from a cache file of the save file manager.
+	 *
+	 * @return False if the cache file is missing, does not match the theme
+	 *         and the current resolution, or cannot be replayed. The theme
+	 *         may have been replayed in part when the replay fails.
+	 */
+	bool load(const Common::String &name);
+
+	/** Writes the recorded theme to a cache file of the save file manager. */
+	bool save(const Common::String &name);
+
+	/**
+	 * @name Recording of the calls of the ThemeParser
+	 * @{
+	 */
+	void recordFontNames(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void recordFont(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void recordTextColor(TextColor colorId, int r, int g, int b);
+	void recordBitmap(const Common::String &filename, const Common::String &scalablefile);
+	void recordCursor(const Common::String &filename, int hotspotX, int hotspotY);
+	void recordDrawData(const Common::String &data, bool cached);
+	void recordDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step);
+	void recordTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV);
+	/** @} */
+
+private:
+	enum Op {
+		kOpEnd,
+		kOpFontNames,
+		kOpFont,
+		kOpTextColor,
+		kOpCursor,
+		kOpDrawData,
+		kOpDrawStep,
+		kOpTextData
+	};
+
+	struct Source {
+		Common::String name;
+		uint32 checksum;
+	};
+
+	struct Bitmap {
+		Common::String filename;
+		Source source;
+	};
+
+	bool checksum(Common::SeekableReadStream *stream, uint32 &crc) const;
+	bool checksum(const Common::String &name, uint32 &crc) const;
+
+	void writeHeader(Common::WriteStream &stream) const;
+	bool readHeader(Common::SeekableReadStream &stream) const;
+
+	bool replay(Common::SeekableReadStream &stream);
+
+	void writeFont(Op op, TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void writeStep(const Graphics::DrawStep &step);
+	bool readStep(Common::SeekableReadStream &stream, Graphics::DrawStep &step) const;
+
+	ThemeEngine *_engine;
+	Common::CRC32 _crc;
+
+	Common::Array<Source> _sources;
+	Common::Array<Bitmap> _bitmaps;
+	Common::MemoryWriteStreamDynamic _ops;
+};
+
+} // End of namespace GUI
+
+#endif
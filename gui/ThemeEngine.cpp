@@ -41,6 +41,7 @@
 #include "image/png.h"
 
 #include "gui/widget.h"
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -188,7 +189,7 @@ static const DrawDataInfo kDrawDataDefaults[] = {
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system(nullptr), _vectorRenderer(nullptr),
 	_layerToDraw(kDrawLayerBackground), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
-	_font(nullptr), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
+	_font(nullptr), _initOk(false), _themeOk(false), _themeFromCache(false), _enabled(false), _themeFiles(),
 	_cursor(nullptr), _scaleFactor(1.0f) {
 
 	_baseWidth = 640;	// Default sane values
@@ -197,6 +198,7 @@ ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system = g_system;
 	_parser = new ThemeParser(this);
 	_themeEval = new GUI::ThemeEval();
+	_themeCache = nullptr;
 	_themeEval->setScaleFactor(_scaleFactor);
 
 	_useCursor = false;
@@ -507,6 +509,8 @@ void ThemeEngine::addDrawStep(const Common::String &drawDataId, const Graphics::
 	DrawData id = parseDrawDataId(drawDataId);
 
 	assert(id != kDDNone && _widgets[id] != nullptr);
+	if (_themeCache)
+		_themeCache->recordDrawStep(drawDataId, step);
 	_widgets[id]->_steps.push_back(step);
 }
 
@@ -516,6 +520,9 @@ bool ThemeEngine::addTextData(const Common::String &drawDataId, TextData textId,
 	if (id == -1 || textId == -1 || colorId == kTextColorMAX || !_widgets[id])
 		return false;
 
+	if (_themeCache)
+		_themeCache->recordTextData(drawDataId, textId, colorId, alignH, alignV);
+
 	_widgets[id]->_textDataId = textId;
 	_widgets[id]->_textColorId = colorId;
 	_widgets[id]->_textAlignH = alignH;
@@ -528,6 +535,9 @@ bool ThemeEngine::addFont(TextData textId, const Common::String &language, const
 	if (textId == -1)
 		return false;
 
+	if (_themeCache)
+		_themeCache->recordFont(textId, language, file, scalableFile, pointsize);
+
 	if (!language.empty()) {
 #ifdef USE_TRANSLATION
 		Common::String cl = TransMan.getCurrentLanguage();
@@ -607,6 +617,9 @@ void ThemeEngine::storeFontNames(TextData textId, const Common::String &language
 	if (language.empty())
 		return;
 
+	if (_themeCache)
+		_themeCache->recordFontNames(textId, language, file, scalableFile, pointsize);
+
 	Common::Array<Common::Language> langs = getLangIdentifiers(language);
 	if (langs.empty())
 		return;
@@ -633,6 +646,9 @@ bool ThemeEngine::addTextColor(TextColor colorId, int r, int g, int b) {
 	if (colorId >= kTextColorMAX)
 		return false;
 
+	if (_themeCache)
+		_themeCache->recordTextColor(colorId, r, g, b);
+
 	if (_textColors[colorId] != nullptr)
 		delete _textColors[colorId];
 
@@ -646,6 +662,9 @@ bool ThemeEngine::addTextColor(TextColor colorId, int r, int g, int b) {
 }
 
 bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String &scalablefile, int width, int height) {
+	if (_themeCache)
+		_themeCache->recordBitmap(filename, scalablefile);
+
 	// Nothing has to be done if the bitmap already has been loaded.
 	Graphics::ManagedSurface *surf = _bitmaps[filename];
 	if (surf) {
@@ -743,6 +762,9 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 	if (id == -1)
 		return false;
 
+	if (_themeCache)
+		_themeCache->recordDrawData(data, cached);
+
 	if (_widgets[id] != nullptr)
 		delete _widgets[id];
 
@@ -759,8 +781,10 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
  *********************************************************/
 void ThemeEngine::loadTheme(const Common::String &themeId) {
 	unloadTheme();
+	_themeFromCache = false;
 
 	debug(6, "Loading theme %s", themeId.c_str());
+	const uint32 startTime = _system->getMillis();
 
 	if (themeId == "builtin") {
 		_themeOk = loadDefaultXML();
@@ -782,13 +806,18 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 		}
 	}
 
-	debug(6, "Finished loading theme %s", themeId.c_str());
+	debug(6, "Finished loading theme %s in %u ms%s", themeId.c_str(), _system->getMillis() - startTime, _themeFromCache ? " from its cache" : "");
 }
 
 void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	clearTheme();
+	_themeOk = false;
+}
+
+void ThemeEngine::clearTheme() {
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = nullptr;
@@ -808,7 +837,7 @@ void ThemeEngine::unloadTheme() {
 	}
 
 	_themeEval->reset();
-	_themeOk = false;
+	_themeFromCache = false;
 }
 
 void ThemeEngine::unloadExtraFont() {
@@ -886,6 +915,29 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 		return false;
 	}
 
+	// The compiled cache of the theme is only used when all files the theme
+	// is parsed from are unchanged
+	const bool useCache = ConfMan.getBool("gui_theme_cache");
+	ThemeCache cache(this);
+	if (useCache) {
+		Common::ArchiveMemberPtr themerc = _themeArchive->getMember("THEMERC");
+		bool sourcesOk = themerc && cache.addSource(*themerc);
+		for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end() && sourcesOk; ++i)
+			sourcesOk = cache.addSource(**i);
+
+		if (sourcesOk && cache.load(getThemeCacheName())) {
+			_themeFromCache = true;
+			return true;
+		}
+
+		// The cache may have been replayed in part before it failed
+		clearTheme();
+
+		// Record the theme while it is parsed
+		if (sourcesOk)
+			_themeCache = &cache;
+	}
+
 	//
 	// Loop over all STX files, load and parse them
 	//
@@ -895,18 +947,25 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 		if (_parser->loadStream((*i)->createReadStream()) == false) {
 			warning("Failed to load STX file '%s'", (*i)->getName().c_str());
 			_parser->close();
+			_themeCache = nullptr;
 			return false;
 		}
 
 		if (_parser->parse() == false) {
 			warning("Failed to parse STX file '%s'", (*i)->getName().c_str());
 			_parser->close();
+			_themeCache = nullptr;
 			return false;
 		}
 
 		_parser->close();
 	}
 
+	if (_themeCache) {
+		_themeCache = nullptr;
+		cache.save(getThemeCacheName());
+	}
+
 	assert(!_themeName.empty());
 	return true;
 }
@@ -1585,6 +1644,9 @@ bool ThemeEngine::createCursor(const Common::String &filename, int hotspotX, int
 	if (!cursor)
 		return false;
 
+	if (_themeCache)
+		_themeCache->recordCursor(filename, hotspotX, hotspotY);
+
 	// Set up the cursor parameters
 	_cursorHotspotX = hotspotX;
 	_cursorHotspotY = hotspotY;
@@ -1714,6 +1776,10 @@ TextColor ThemeEngine::getTextColor(DrawData ddId) const {
 	return _widgets[ddId] ? _widgets[ddId]->_textColorId : kTextColorMAX;
 }
 
+const Common::List<Graphics::DrawStep> *ThemeEngine::getDrawSteps(DrawData ddId) const {
+	return _widgets[ddId] ? &_widgets[ddId]->_steps : nullptr;
+}
+
 TextColorData *ThemeEngine::getTextColorData(TextColor color) const {
 	if (color >= kTextColorMAX)
 		color = kTextColorNormal;
@@ -1834,6 +1900,10 @@ const Graphics::Font *ThemeEngine::loadFont(const Common::String &filename, cons
 	return font;
 }
 
+Common::String ThemeEngine::getThemeCacheName() const {
+	return Common::String::format("%s-%dx%d-%d.tcc", _themeId.c_str(), _baseWidth, _baseHeight, (int)(_scaleFactor * 100 + 0.5f));
+}
+
 Common::String ThemeEngine::genCacheFilename(const Common::String &filename) const {
 	Common::String cacheName(filename);
 	for (int i = cacheName.size() - 1; i >= 0; --i) {
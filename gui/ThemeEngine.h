@@ -51,6 +51,7 @@ struct WidgetDrawData;
 struct TextDrawData;
 class Dialog;
 class GuiObject;
+class ThemeCache;
 class ThemeEval;
 class ThemeParser;
 
@@ -212,6 +213,7 @@ protected:
 
 	friend class GUI::Dialog;
 	friend class GUI::GuiObject;
+	friend class GUI::ThemeCache;
 
 public:
 	/// Vertical alignment of the text.
@@ -532,6 +534,9 @@ public:
 	TextData getTextData(DrawData ddId) const;
 	TextColor getTextColor(DrawData ddId) const;
 
+	/** Returns the draw steps of a DrawData set, or nullptr if the theme does not define it. */
+	const Common::List<Graphics::DrawStep> *getDrawSteps(DrawData ddId) const;
+
 	TextColorData *getTextColorData(TextColor color) const;
 
 	/**
@@ -665,6 +670,9 @@ public:
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
 
+	/** Whether the theme was replayed from its compiled cache instead of being parsed. */
+	bool isThemeFromCache() const { return _themeFromCache; }
+
 protected:
 
 	/**
@@ -688,6 +696,12 @@ protected:
 	 */
 	void unloadTheme();
 
+	/**
+	 * Frees the draw data, fonts, text colors and layouts of the theme,
+	 * including those of a theme which failed to load halfway.
+	 */
+	void clearTheme();
+
 	/**
 	 * Unload the language specific font loaded via loadExtraFont()
 	*/
@@ -696,6 +710,13 @@ protected:
 	const Graphics::Font *loadScalableFont(const Common::String &filename, const int pointsize, Common::String &name);
 	const Graphics::Font *loadFont(const Common::String &filename, Common::String &name);
 	Common::String genCacheFilename(const Common::String &filename) const;
+
+	/**
+	 * Returns the name of the compiled cache file of the theme for the
+	 * current base resolution and scale factor. The cache files are kept
+	 * with the save files, as themes may be installed in read-only places.
+	 */
+	Common::String getThemeCacheName() const;
 	const Graphics::Font *loadFont(const Common::String &filename, const Common::String &scalableFilename, const int pointsize, const bool makeLocalizedFont);
 
 	/**
@@ -756,6 +777,9 @@ protected:
 	/** Theme getEvaluator (changed from GUI::Eval to add functionality) */
 	GUI::ThemeEval *_themeEval;
 
+	/** Records the calls of the parser while a theme is parsed, nullptr otherwise */
+	GUI::ThemeCache *_themeCache;
+
 	/** Main screen surface. This is blitted straight into the overlay. */
 	Graphics::ManagedSurface _screen;
 
@@ -809,6 +833,7 @@ protected:
 
 	bool _initOk;  ///< Class and renderer properly initialized
 	bool _themeOk; ///< Theme data successfully loaded.
+	bool _themeFromCache; ///< Theme data replayed from the compiled cache.
 	bool _enabled; ///< Whether the Theme is currently shown on the overlay
 
 	Common::String _themeName; ///< Name of the currently loaded theme
@@ -23,6 +23,8 @@
 
 #include "graphics/scaler.h"
 
+#include "common/debug.h"
+#include "common/stream.h"
 #include "common/system.h"
 #include "common/tokenizer.h"
 
@@ -44,9 +46,59 @@ void ThemeEval::reset() {
 	_curLayout.clear();
 
 	for (LayoutsMap::iterator i = _layouts.begin(); i != _layouts.end(); ++i)
-		delete i->_value;
+		ThemeLayout::destroyLayout(i->_value);
 
 	_layouts.clear();
+
+	const Common::FrameArena::Stats &stats = _layoutArena.getStats();
+	debug(3, "ThemeEval: %u layout allocations, %u bytes at peak, %u heap chunks",
+	      stats.allocations, (uint)stats.peakBytes, stats.heapAllocations);
+	_layoutArena.reset();
+}
+
+void ThemeEval::saveState(Common::WriteStream &stream) const {
+	assert(_curLayout.empty());
+
+	stream.writeUint32LE(_vars.size());
+	for (VariablesMap::const_iterator i = _vars.begin(); i != _vars.end(); ++i) {
+		stream.writeString(i->_key);
+		stream.writeByte(0);
+		stream.writeSint32LE(i->_value);
+	}
+
+	stream.writeUint32LE(_layouts.size());
+	for (LayoutsMap::const_iterator i = _layouts.begin(); i != _layouts.end(); ++i) {
+		stream.writeString(i->_key);
+		stream.writeByte(0);
+		i->_value->saveLayout(stream);
+	}
+}
+
+bool ThemeEval::loadState(Common::ReadStream &stream) {
+	reset();
+
+	const uint32 numVars = stream.readUint32LE();
+	for (uint32 i = 0; i < numVars && !stream.eos() && !stream.err(); ++i) {
+		const Common::String name = stream.readString();
+		_vars[name] = stream.readSint32LE();
+	}
+
+	const uint32 numLayouts = stream.readUint32LE();
+	for (uint32 i = 0; i < numLayouts && !stream.eos() && !stream.err(); ++i) {
+		const Common::String name = stream.readString();
+		ThemeLayout *layout = ThemeLayout::loadLayout(stream, nullptr, &_layoutArena);
+		if (!layout)
+			break;
+
+		_layouts[name] = layout;
+	}
+
+	if (_vars.size() != numVars || _layouts.size() != numLayouts || stream.eos() || stream.err()) {
+		reset();
+		return false;
+	}
+
+	return true;
 }
 
 bool ThemeEval::getWidgetData(const Common::String &widget, int16 &x, int16 &y, int16 &w, int16 &h) {
@@ -98,19 +150,19 @@ ThemeEval &ThemeEval::addWidget(const Common::String &name, const Common::String
 
 	ThemeLayoutWidget *widget;
 	if (type == "TabWidget")
-		widget = new ThemeLayoutTabWidget(_curLayout.top(), name,
+		widget = new (&_layoutArena) ThemeLayoutTabWidget(_curLayout.top(), name,
 									typeW == -1 ? w : typeW,
 									typeH == -1 ? h : typeH,
 									typeAlign == Graphics::kTextAlignInvalid ? align : typeAlign,
 									getVar("Globals.TabWidget.Tab.Height", 0));
 	else if (type == "ScrollContainerWidget")
-		widget = new ThemeLayoutScrollContainerWidget(_curLayout.top(), name,
+		widget = new (&_layoutArena) ThemeLayoutScrollContainerWidget(_curLayout.top(), name,
 									typeW == -1 ? w : typeW,
 									typeH == -1 ? h : typeH,
 									typeAlign == Graphics::kTextAlignInvalid ? align : typeAlign,
 									getVar("Globals.Scrollbar.Width", 0));
 	else
-		widget = new ThemeLayoutWidget(_curLayout.top(), name,
+		widget = new (&_layoutArena) ThemeLayoutWidget(_curLayout.top(), name,
 									typeW == -1 ? w : typeW,
 									typeH == -1 ? h : typeH,
 									typeAlign == Graphics::kTextAlignInvalid ? align : typeAlign,
@@ -124,10 +176,10 @@ ThemeEval &ThemeEval::addWidget(const Common::String &name, const Common::String
 ThemeEval &ThemeEval::addDialog(const Common::String &name, const Common::String &overlays, int16 width, int16 height, int inset) {
 	Common::String var = "Dialog." + name;
 
-	ThemeLayout *layout = new ThemeLayoutMain(name, overlays, width, height, inset);
+	ThemeLayout *layout = new (&_layoutArena) ThemeLayoutMain(name, overlays, width, height, inset, &_layoutArena);
 
 	if (_layouts.contains(var))
-		delete _layouts[var];
+		ThemeLayout::destroyLayout(_layouts[var]);
 
 	_layouts[var] = layout;
 
@@ -150,7 +202,7 @@ ThemeEval &ThemeEval::addLayout(ThemeLayout::LayoutType type, int spacing, Theme
 	if (spacing == -1)
 		spacing = getVar("Globals.Layout.Spacing");
 
-	layout = new ThemeLayoutStacked(_curLayout.top(), type, spacing, itemAlign);
+	layout = new (&_layoutArena) ThemeLayoutStacked(_curLayout.top(), type, spacing, itemAlign);
 
 	assert(layout);
 
@@ -168,7 +220,7 @@ ThemeEval &ThemeEval::addLayout(ThemeLayout::LayoutType type, int spacing, Theme
 }
 
 ThemeEval &ThemeEval::addSpace(int size) {
-	ThemeLayout *space = new ThemeLayoutSpacing(_curLayout.top(), size);
+	ThemeLayout *space = new (&_layoutArena) ThemeLayoutSpacing(_curLayout.top(), size);
 	_curLayout.top()->addChild(space);
 
 	return *this;
@@ -23,6 +23,7 @@
 #define GUI_THEME_EVAL_H
 
 #include "common/scummsys.h"
+#include "common/framearena.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
 #include "common/stack.h"
@@ -111,10 +112,30 @@ public:
 
 	void reset();
 
+	/**
+	 * Writes the variables and the layouts defined by the theme to a stream.
+	 * Must not be called while a dialog is being defined.
+	 */
+	void saveState(Common::WriteStream &stream) const;
+
+	/**
+	 * Replaces the variables and the layouts with those written by
+	 * saveState().
+	 *
+	 * @return False if the data is invalid, in which case the evaluator is
+	 *         left empty.
+	 */
+	bool loadState(Common::ReadStream &stream);
+
 private:
 	VariablesMap _vars;
 	VariablesMap _builtin;
 
+	/**
+	 * The arena of the layouts, which live as long as the theme. The memory
+	 * of a redefined dialog is only reclaimed by reset().
+	 */
+	Common::FrameArena _layoutArena;
 	LayoutsMap _layouts;
 	Common::Stack<ThemeLayout *> _curLayout;
 	Common::String _curDialog;
@@ -20,6 +20,7 @@
  */
 
 #include "common/util.h"
+#include "common/stream.h"
 #include "common/system.h"
 
 #include "gui/gui-manager.h"
@@ -60,6 +61,141 @@ void ThemeLayout::importLayout(ThemeLayout *layout) {
 	}
 }
 
+void ThemeLayout::saveLayout(Common::WriteStream &stream) const {
+	stream.writeByte(getLayoutType());
+	saveParameters(stream);
+
+	stream.writeSint16LE(_x);
+	stream.writeSint16LE(_y);
+	stream.writeSint16LE(_w);
+	stream.writeSint16LE(_h);
+	stream.writeSint16LE(_defaultW);
+	stream.writeSint16LE(_defaultH);
+	stream.writeByte(_useRTL);
+	stream.writeSint16LE(_padding.left);
+	stream.writeSint16LE(_padding.right);
+	stream.writeSint16LE(_padding.top);
+	stream.writeSint16LE(_padding.bottom);
+	stream.writeByte(_textHAlign);
+
+	stream.writeUint16LE(_children.size());
+	for (uint i = 0; i < _children.size(); ++i)
+		_children[i]->saveLayout(stream);
+}
+
+ThemeLayout *ThemeLayout::loadLayout(Common::ReadStream &stream, ThemeLayout *parent, Common::FrameArena *arena) {
+	const LayoutType type = (LayoutType)stream.readByte();
+	ThemeLayout *layout = nullptr;
+
+	// Everything but the constructor parameters is read below, so sizes and
+	// alignments are left to their defaults here
+	switch (type) {
+	case kLayoutMain:
+		if (!parent) {
+			const Common::String name = stream.readString();
+			const Common::String overlays = stream.readString();
+			const int inset = stream.readSint32LE();
+			layout = new (arena) ThemeLayoutMain(name, overlays, -1, -1, inset, arena);
+		}
+		break;
+
+	case kLayoutVertical:
+	case kLayoutHorizontal:
+		if (parent) {
+			const int8 spacing = stream.readSByte();
+			const ItemAlign itemAlign = (ItemAlign)stream.readByte();
+			layout = new (arena) ThemeLayoutStacked(parent, type, spacing, itemAlign);
+		}
+		break;
+
+	case kLayoutWidget:
+		if (parent)
+			layout = new (arena) ThemeLayoutWidget(parent, stream.readString(), -1, -1, Graphics::kTextAlignInvalid, true);
+		break;
+
+	case kLayoutTabWidget:
+		if (parent) {
+			const Common::String name = stream.readString();
+			layout = new (arena) ThemeLayoutTabWidget(parent, name, -1, -1, Graphics::kTextAlignInvalid, stream.readSint32LE());
+		}
+		break;
+
+	case kLayoutScrollContainerWidget:
+		if (parent) {
+			const Common::String name = stream.readString();
+			layout = new (arena) ThemeLayoutScrollContainerWidget(parent, name, -1, -1, Graphics::kTextAlignInvalid, stream.readSint32LE());
+		}
+		break;
+
+	case kLayoutSpace:
+		if (parent)
+			layout = new (arena) ThemeLayoutSpacing(parent, -1);
+		break;
+
+	default:
+		break;
+	}
+
+	if (!layout)
+		return nullptr;
+
+	layout->_x = stream.readSint16LE();
+	layout->_y = stream.readSint16LE();
+	layout->_w = stream.readSint16LE();
+	layout->_h = stream.readSint16LE();
+	layout->_defaultW = stream.readSint16LE();
+	layout->_defaultH = stream.readSint16LE();
+	layout->_useRTL = stream.readByte() != 0;
+	layout->_padding.left = stream.readSint16LE();
+	layout->_padding.right = stream.readSint16LE();
+	layout->_padding.top = stream.readSint16LE();
+	layout->_padding.bottom = stream.readSint16LE();
+	layout->_textHAlign = (Graphics::TextAlign)stream.readByte();
+
+	const uint16 count = stream.readUint16LE();
+	for (uint16 i = 0; i < count && !stream.eos() && !stream.err(); ++i) {
+		ThemeLayout *child = loadLayout(stream, layout, arena);
+		if (!child)
+			break;
+		layout->addChild(child);
+	}
+
+	if (layout->_children.size() != count || stream.eos() || stream.err()) {
+		destroyLayout(layout);
+		return nullptr;
+	}
+
+	return layout;
+}
+
+void ThemeLayoutMain::saveParameters(Common::WriteStream &stream) const {
+	stream.writeString(_name);
+	stream.writeByte(0);
+	stream.writeString(_overlays);
+	stream.writeByte(0);
+	stream.writeSint32LE(_inset);
+}
+
+void ThemeLayoutStacked::saveParameters(Common::WriteStream &stream) const {
+	stream.writeSByte(_spacing);
+	stream.writeByte(_itemAlign);
+}
+
+void ThemeLayoutWidget::saveParameters(Common::WriteStream &stream) const {
+	stream.writeString(_name);
+	stream.writeByte(0);
+}
+
+void ThemeLayoutTabWidget::saveParameters(Common::WriteStream &stream) const {
+	ThemeLayoutWidget::saveParameters(stream);
+	stream.writeSint32LE(_tabHeight);
+}
+
+void ThemeLayoutScrollContainerWidget::saveParameters(Common::WriteStream &stream) const {
+	ThemeLayoutWidget::saveParameters(stream);
+	stream.writeSint32LE(_scrollWidth);
+}
+
 void ThemeLayout::resetLayout() {
 	_x = 0;
 	_y = 0;
@@ -23,6 +23,7 @@
 #define THEME_LAYOUT_H
 
 #include "common/array.h"
+#include "common/framearena.h"
 #include "common/rect.h"
 #include "graphics/font.h"
 
@@ -34,6 +35,11 @@ struct Surface;
 }
 #endif
 
+namespace Common {
+class ReadStream;
+class WriteStream;
+}
+
 namespace GUI {
 
 class Widget;
@@ -62,16 +68,48 @@ public:
 		kItemAlignStretch  ///< Items are resized to match the size of the layout in the cross-direction
 	};
 
-	ThemeLayout(ThemeLayout *p) :
+	/**
+	 * Constructs a layout element, which allocates its children from the
+	 * arena of its parent, or from the given arena if it has no parent.
+	 */
+	ThemeLayout(ThemeLayout *p, Common::FrameArena *arena = nullptr) :
 		_parent(p), _x(0), _y(0), _w(-1), _h(-1),
+		_children(ChildAllocator(p ? p->getArena() : arena)),
 		_defaultW(-1), _defaultH(-1),
 		_textHAlign(Graphics::kTextAlignInvalid), _useRTL(true) {}
 
 	virtual ~ThemeLayout() {
 		for (uint i = 0; i < _children.size(); ++i)
-			delete _children[i];
+			destroyLayout(_children[i]);
+	}
+
+	/**
+	 * Allocates a layout element from an arena, or from the heap if it is
+	 * null. The element must use the same arena for its children.
+	 */
+	static void *operator new(size_t size, Common::FrameArena *arena) {
+		return arena ? arena->allocate(size) : ::operator new(size);
+	}
+
+	static void operator delete(void *p, Common::FrameArena *arena) {
+		if (!arena)
+			::operator delete(p);
+	}
+
+	static void operator delete(void *p) {
+		::operator delete(p);
+	}
+
+	/** Destroys a layout element and its children, wherever they were allocated. */
+	static void destroyLayout(ThemeLayout *layout) {
+		if (layout && layout->getArena())
+			layout->~ThemeLayout();
+		else
+			delete layout;
 	}
 
+	Common::FrameArena *getArena() const { return _children.get_allocator().getArena(); }
+
 	virtual void reflowLayout(Widget *widgetChain) = 0;
 	virtual void resetLayout();
 
@@ -115,6 +153,9 @@ protected:
 
 	virtual ThemeLayout *makeClone(ThemeLayout *newParent) = 0;
 
+	/** Writes what the constructor of the layout element needs to create it again. */
+	virtual void saveParameters(Common::WriteStream &stream) const {}
+
 public:
 	virtual bool getWidgetData(const Common::String &name, int16 &x, int16 &y, int16 &w, int16 &h, bool &useRTL);
 	bool getUseRTL() { return _useRTL; }
@@ -123,6 +164,20 @@ public:
 
 	void importLayout(ThemeLayout *layout);
 
+	/**
+	 * Writes the layout element and all its children to a stream, as they
+	 * are before they are reflowed.
+	 */
+	void saveLayout(Common::WriteStream &stream) const;
+
+	/**
+	 * Creates a layout element and its children from the data written by
+	 * saveLayout().
+	 *
+	 * @return The layout element, or nullptr if the data is invalid.
+	 */
+	static ThemeLayout *loadLayout(Common::ReadStream &stream, ThemeLayout *parent, Common::FrameArena *arena);
+
 	Graphics::TextAlign getTextHAlign() { return _textHAlign; }
 
 #ifdef LAYOUT_DEBUG_DIALOG
@@ -131,19 +186,21 @@ public:
 	virtual const char *getName() const { return "<override-me>"; }
 
 protected:
+	typedef Common::FrameArenaAllocator<ThemeLayout *> ChildAllocator;
+
 	ThemeLayout *_parent;
 	int16 _x, _y, _w, _h;
 	bool _useRTL;
 	Common::Rect _padding;
-	Common::Array<ThemeLayout *> _children;
+	Common::Array<ThemeLayout *, ChildAllocator> _children;
 	int16 _defaultW, _defaultH;
 	Graphics::TextAlign _textHAlign;
 };
 
 class ThemeLayoutMain : public ThemeLayout {
 public:
-	ThemeLayoutMain(const Common::String &name, const Common::String &overlays, int16 width, int16 height, int inset) :
-			ThemeLayout(nullptr),
+	ThemeLayoutMain(const Common::String &name, const Common::String &overlays, int16 width, int16 height, int inset, Common::FrameArena *arena) :
+			ThemeLayout(nullptr, arena),
 			_name(name),
 			_overlays(overlays),
 			_inset(inset) {
@@ -165,6 +222,7 @@ public:
 protected:
 	LayoutType getLayoutType() const override { return kLayoutMain; }
 	ThemeLayout *makeClone(ThemeLayout *newParent) override { assert(!"Do not copy Main Layouts!"); return nullptr; }
+	void saveParameters(Common::WriteStream &stream) const override;
 
 	int16 _defaultX;
 	int16 _defaultY;
@@ -206,7 +264,7 @@ protected:
 	LayoutType getLayoutType() const override { return _type; }
 
 	ThemeLayout *makeClone(ThemeLayout *newParent) override {
-		ThemeLayoutStacked *n = new ThemeLayoutStacked(*this);
+		ThemeLayoutStacked *n = new (getArena()) ThemeLayoutStacked(*this);
 		n->_parent = newParent;
 
 		for (uint i = 0; i < n->_children.size(); ++i)
@@ -215,6 +273,8 @@ protected:
 		return n;
 	}
 
+	void saveParameters(Common::WriteStream &stream) const override;
+
 	const LayoutType _type;
 	ItemAlign _itemAlign;
 	int8 _spacing;
@@ -244,11 +304,13 @@ protected:
 	Widget *getWidget(Widget *widgetChain) const;
 
 	ThemeLayout *makeClone(ThemeLayout *newParent) override {
-		ThemeLayout *n = new ThemeLayoutWidget(*this);
+		ThemeLayout *n = new (getArena()) ThemeLayoutWidget(*this);
 		n->_parent = newParent;
 		return n;
 	}
 
+	void saveParameters(Common::WriteStream &stream) const override;
+
 	Common::String _name;
 };
 
@@ -280,10 +342,12 @@ protected:
 	LayoutType getLayoutType() const override { return kLayoutTabWidget; }
 
 	ThemeLayout *makeClone(ThemeLayout *newParent) override {
-		ThemeLayoutTabWidget *n = new ThemeLayoutTabWidget(*this);
+		ThemeLayoutTabWidget *n = new (getArena()) ThemeLayoutTabWidget(*this);
 		n->_parent = newParent;
 		return n;
 	}
+
+	void saveParameters(Common::WriteStream &stream) const override;
 };
 
 class ThemeLayoutScrollContainerWidget : public ThemeLayoutWidget {
@@ -314,10 +378,12 @@ protected:
 	LayoutType getLayoutType() const override { return kLayoutScrollContainerWidget; }
 
 	ThemeLayout *makeClone(ThemeLayout *newParent) override {
-		ThemeLayoutScrollContainerWidget *n = new ThemeLayoutScrollContainerWidget(*this);
+		ThemeLayoutScrollContainerWidget *n = new (getArena()) ThemeLayoutScrollContainerWidget(*this);
 		n->_parent = newParent;
 		return n;
 	}
+
+	void saveParameters(Common::WriteStream &stream) const override;
 };
 
 class ThemeLayoutSpacing : public ThemeLayout {
@@ -342,7 +408,7 @@ protected:
 	LayoutType getLayoutType() const override { return kLayoutSpace; }
 
 	ThemeLayout *makeClone(ThemeLayout *newParent) override {
-		ThemeLayout *n = new ThemeLayoutSpacing(*this);
+		ThemeLayout *n = new (getArena()) ThemeLayoutSpacing(*this);
 		n->_parent = newParent;
 		return n;
 	}
@@ -25,6 +25,10 @@
 #include "common/scummsys.h"
 #include "common/formats/xmlparser.h"
 
+namespace Graphics {
+struct DrawStep;
+}
+
 namespace GUI {
 
 class ThemeEngine;
@@ -52,6 +56,12 @@ public:
 		return true;
 	}
 
+	/** Returns the name of the drawing function of a draw step, or nullptr if it has none. */
+	static const char *getDrawingFunctionName(const Graphics::DrawStep &step);
+
+	/** Sets the drawing function of a draw step from its name in STX files. */
+	static bool setDrawingFunction(Graphics::DrawStep &step, const Common::String &name);
+
 protected:
 	ThemeEngine *_theme;
 
@@ -26,6 +26,7 @@
 #include "common/debug.h"
 #include "common/debug-channels.h"
 #include "common/system.h"
+#include "common/trace.h"
 
 #ifndef DISABLE_MD5
 #include "common/md5.h"
@@ -81,6 +82,9 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+#ifdef ENABLE_TRACING
+	registerCmd("trace",			WRAP_METHOD(Debugger, cmdTrace));
+#endif
 }
 
 Debugger::~Debugger() {
@@ -857,6 +861,28 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+#ifdef ENABLE_TRACING
+bool Debugger::cmdTrace(int argc, const char **argv) {
+	if (argc == 3 && !scumm_stricmp(argv[1], "dump")) {
+		Common::DumpFile file;
+		if (!file.open(Common::Path(argv[2], Common::Path::kNativeSeparator))) {
+			debugPrintf("Can't open file %s\n", argv[2]);
+		} else if (!Common::writeTrace(file) || !file.flush()) {
+			debugPrintf("Can't write the trace to %s\n", argv[2]);
+		} else {
+			debugPrintf("Wrote the trace to %s\n", argv[2]);
+		}
+	} else if (argc == 2 && !scumm_stricmp(argv[1], "clear")) {
+		Common::clearTrace();
+		debugPrintf("Cleared the trace\n");
+	} else {
+		debugPrintf("trace dump <filename> | trace clear\n");
+		debugPrintf("The trace can be opened in chrome://tracing or ui.perfetto.dev\n");
+	}
+	return true;
+}
+#endif
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
@@ -0,0 +1,204 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/framearena.h"
+#include "common/list.h"
+#include "common/rect.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+class FrameArenaTestSuite : public CxxTest::TestSuite {
+#ifdef SLOW_TESTS
+	static const int kBenchmarkFrames = 10000;
+#else
+	static const int kBenchmarkFrames = 500;
+#endif
+
+	typedef Common::Array<Common::Rect, Common::FrameArenaAllocator<Common::Rect> > RectArray;
+
+	// What a frame of a renderer does: a few lists of rects, some of which are
+	// merged into a temporary list
+	template<class List>
+	static uint buildFrame(const List &prototype) {
+		uint total = 0;
+		for (int list = 0; list < 8; ++list) {
+			List rects(prototype);
+			for (int i = 0; i < 50; ++i) {
+				List merge(prototype);
+				merge.push_back(Common::Rect(i, list, i + 10, list + 10));
+				merge.push_back(Common::Rect(list, i, list + 10, i + 10));
+				for (uint j = 0; j < merge.size(); ++j)
+					rects.push_back(merge[j]);
+			}
+			total += rects.size();
+		}
+		return total;
+	}
+
+public:
+	void test_alignment() {
+		Common::FrameArena arena(256);
+		byte *previous = nullptr;
+		for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+			byte *p = (byte *)arena.allocate(3, alignment);
+			TS_ASSERT(p);
+			TS_ASSERT_EQUALS((size_t)p & (alignment - 1), 0u);
+			memset(p, 0xff, 3);
+			if (previous)
+				TS_ASSERT(p >= previous + 3 || p + 3 <= previous);
+			previous = p;
+		}
+		TS_ASSERT_EQUALS(arena.getStats().allocations, 7u);
+	}
+
+	void test_release() {
+		Common::FrameArena arena(1024);
+		void *first = arena.allocate(16);
+
+		const Common::FrameArena::Mark mark = arena.getMark();
+		void *second = arena.allocate(100);
+		// Larger than a chunk
+		void *large = arena.allocate(5000);
+		TS_ASSERT(second);
+		TS_ASSERT(large);
+		TS_ASSERT_LESS_THAN(5000u, arena.getUsedBytes());
+		TS_ASSERT_EQUALS(arena.getStats().heapAllocations, 2u);
+
+		arena.release(mark);
+		TS_ASSERT_EQUALS(arena.allocate(100), second);
+		TS_ASSERT(arena.allocate(5000));
+		// The chunks are reused
+		TS_ASSERT_EQUALS(arena.getStats().heapAllocations, 2u);
+		TS_ASSERT_LESS_THAN_EQUALS(arena.getStats().peakBytes, arena.getUsedBytes());
+
+		arena.reset();
+		TS_ASSERT_EQUALS(arena.getUsedBytes(), 0u);
+		TS_ASSERT_EQUALS(arena.allocate(16), first);
+
+		arena.freeUnusedChunks();
+		TS_ASSERT(arena.allocate(5000));
+		TS_ASSERT_EQUALS(arena.getStats().heapAllocations, 3u);
+	}
+
+	void test_deallocate_last() {
+		Common::FrameArena arena;
+		void *a = arena.allocate(32);
+		void *b = arena.allocate(32);
+
+		// Only the latest allocation is given back
+		arena.deallocate(a, 32);
+		TS_ASSERT_DIFFERS(arena.allocate(32), a);
+		arena.deallocate(b, 32);
+		TS_ASSERT_DIFFERS(arena.allocate(32), b);
+
+		void *c = arena.allocate(32);
+		arena.deallocate(c, 32);
+		TS_ASSERT_EQUALS(arena.allocate(32), c);
+	}
+
+	void test_scope() {
+		Common::FrameArena arena;
+		arena.allocate(8);
+		const size_t used = arena.getUsedBytes();
+		{
+			Common::FrameArena::Scope scope(arena);
+			arena.allocate(1000);
+			TS_ASSERT_LESS_THAN(used, arena.getUsedBytes());
+		}
+		TS_ASSERT_EQUALS(arena.getUsedBytes(), used);
+	}
+
+	void test_array() {
+		Common::FrameArena arena;
+		{
+			Common::Array<int, Common::FrameArenaAllocator<int> > array((Common::FrameArenaAllocator<int>(&arena)));
+			for (int i = 0; i < 1000; ++i)
+				array.push_back(i);
+			TS_ASSERT_EQUALS(array.size(), 1000u);
+			for (int i = 0; i < 1000; ++i)
+				TS_ASSERT_EQUALS(array[i], i);
+			TS_ASSERT_EQUALS(array.get_allocator().getArena(), &arena);
+			TS_ASSERT_LESS_THAN_EQUALS(1000 * sizeof(int), arena.getUsedBytes());
+
+			// Copies use the arena of the original
+			Common::Array<int, Common::FrameArenaAllocator<int> > copy(array);
+			TS_ASSERT_EQUALS(copy.get_allocator().getArena(), &arena);
+			TS_ASSERT_EQUALS(copy[999], 999);
+
+			// Moving to an array of the heap copies the elements
+			Common::Array<int, Common::FrameArenaAllocator<int> > heap;
+			heap = Common::move(copy);
+			TS_ASSERT_EQUALS(heap.get_allocator().getArena(), (Common::FrameArena *)nullptr);
+			TS_ASSERT_EQUALS(heap.size(), 1000u);
+			TS_ASSERT_EQUALS(heap[500], 500);
+		}
+		arena.reset();
+	}
+
+	void test_list() {
+		Common::FrameArena arena;
+		const uint32 allocations = arena.getStats().allocations;
+		{
+			Common::List<Common::String, Common::FrameArenaAllocator<Common::String> > list((Common::FrameArenaAllocator<Common::String>(&arena)));
+			for (int i = 0; i < 10; ++i)
+				list.push_back(Common::String::format("%d", i));
+			list.pop_front();
+			list.remove("5");
+
+			TS_ASSERT_EQUALS(list.size(), 8u);
+			TS_ASSERT_EQUALS(list.front(), "1");
+			TS_ASSERT_EQUALS(list.back(), "9");
+			TS_ASSERT_EQUALS(arena.getStats().allocations, allocations + 10);
+		}
+		arena.reset();
+	}
+
+	void test_heap_fallback() {
+		Common::Array<int, Common::FrameArenaAllocator<int> > array;
+		Common::List<int, Common::FrameArenaAllocator<int> > list;
+		for (int i = 0; i < 100; ++i) {
+			array.push_back(i);
+			list.push_back(i);
+		}
+		TS_ASSERT_EQUALS(array[99], 99);
+		TS_ASSERT_EQUALS(list.back(), 99);
+	}
+
+	void test_placement_new() {
+		Common::FrameArena arena;
+		Common::String *str = new (arena) Common::String("arena");
+		TS_ASSERT_EQUALS(*str, "arena");
+		str->~String();
+	}
+
+	void test_frame_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		uint32 start = g_system->getMillis();
+		uint heapTotal = 0;
+		for (int frame = 0; frame < kBenchmarkFrames; ++frame)
+			heapTotal += buildFrame(RectArray());
+		const uint32 heapTime = g_system->getMillis() - start;
+
+		Common::FrameArena arena;
+		start = g_system->getMillis();
+		uint arenaTotal = 0;
+		for (int frame = 0; frame < kBenchmarkFrames; ++frame) {
+			Common::FrameArena::Scope scope(arena);
+			arenaTotal += buildFrame(RectArray(Common::FrameArenaAllocator<Common::Rect>(&arena)));
+		}
+		const uint32 arenaTime = g_system->getMillis() - start;
+
+		TS_ASSERT_EQUALS(heapTotal, arenaTotal);
+		// All the frames fit in the chunks allocated for the first one
+		TS_ASSERT_LESS_THAN_EQUALS(arena.getStats().heapAllocations, 2u);
+
+		debug("Building %d frames of rect lists: heap %u ms, arena %u ms (%u allocations, %u from the heap, %u bytes at peak)",
+		      kBenchmarkFrames, heapTime, arenaTime, arena.getStats().allocations, arena.getStats().heapAllocations,
+		      (uint)arena.getStats().peakBytes);
+#endif
+	}
+};
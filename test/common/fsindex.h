@@ -0,0 +1,188 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/algorithm.h"
+#include "common/archive.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/fsindex.h"
+#include "common/ptr.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+/**
+ * Scans a synthetic tree through FSDirectory with and without the persistent
+ * directory index, which must list the same members, and must list them from
+ * the index when the tree did not change.
+ *
+ * The directories are made older than the resolution of their modification
+ * times, which the signatures of the POSIX backend are built from.
+ */
+class FSIndexTestSuite : public CxxTest::TestSuite {
+	static const int kNumDirs = 10;
+#ifdef SLOW_TESTS
+	static const int kNumFiles = 100;
+#else
+	static const int kNumFiles = 10;
+#endif
+
+	// kNumDirs * kNumDirs directories of kNumFiles files each, two levels
+	// below the root
+	static bool createTree(const Common::Path &root) {
+		if (!Common::FSNode(root).createDirectory())
+			return false;
+
+		for (int i = 0; i < kNumDirs; ++i) {
+			const Common::Path dir = root.join(Common::String::format("d%d", i));
+			if (!Common::FSNode(dir).createDirectory())
+				return false;
+
+			for (int j = 0; j < kNumDirs; ++j) {
+				const Common::Path subDir = dir.join(Common::String::format("d%d", j));
+				if (!Common::FSNode(subDir).createDirectory())
+					return false;
+
+				for (int k = 0; k < kNumFiles; ++k) {
+					Common::ScopedPtr<Common::SeekableWriteStream> out(Common::FSNode(subDir.join(Common::String::format("f%04d.dat", k))).createWriteStream(false));
+					if (!out)
+						return false;
+					out->writeUint32LE(k);
+					out->finalize();
+				}
+			}
+		}
+
+		return true;
+	}
+
+	static void addFile(const Common::Path &path) {
+		Common::ScopedPtr<Common::SeekableWriteStream> out(Common::FSNode(path).createWriteStream());
+		TS_ASSERT(out);
+		if (out)
+			out->finalize();
+	}
+
+	static Common::StringArray scan(const Common::Path &root, uint32 &time) {
+		const uint32 start = g_system->getMillis();
+		Common::FSDirectory dir(root, 3, false, false, true);
+		Common::ArchiveMemberList members;
+		dir.listMembers(members);
+		time = g_system->getMillis() - start;
+
+		TS_ASSERT(dir.hasFile(Common::Path("d3/d4/f0005.dat")));
+		TS_ASSERT(!dir.hasFile(Common::Path("d3/d4/missing.dat")));
+
+		Common::StringArray names;
+		for (Common::ArchiveMemberList::const_iterator it = members.begin(); it != members.end(); ++it)
+			names.push_back((*it)->getPathInArchive().toString() + ((*it)->isDirectory() ? "/" : ""));
+		Common::sort(names.begin(), names.end());
+		return names;
+	}
+
+public:
+	void test_fsindex() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		Common::install_null_g_system();
+
+		const Common::Path testDir = Common::create_test_directory("fsindex");
+		TS_ASSERT(!testDir.empty());
+		if (testDir.empty())
+			return;
+		const Common::Path root = testDir.join("tree");
+		const Common::FSNode indexFile(testDir.join("fsindex.dat"));
+		const uint numDirs = 1 + kNumDirs + kNumDirs * kNumDirs;
+		TS_ASSERT(createTree(root));
+		TS_ASSERT(Common::age_test_files(root, 120));
+
+		uint32 plainTime, recordTime, indexTime;
+		Common::StringArray expected = scan(root, plainTime);
+		TS_ASSERT_EQUALS(expected.size(), numDirs - 1 + kNumDirs * kNumDirs * kNumFiles);
+
+		{
+			// The first start records the listings
+			Common::FSIndex index(indexFile);
+			Common::FSDirectory::setIndex(&index);
+			TS_ASSERT(scan(root, recordTime) == expected);
+			TS_ASSERT_EQUALS(index.getStats().hits, 0u);
+			TS_ASSERT_EQUALS(index.getStats().misses, numDirs);
+			TS_ASSERT_EQUALS(index.getStats().merges, 1u);
+			Common::FSDirectory::setIndex(nullptr);
+		}
+		const int64 indexSize = Common::FSNode(indexFile.getPath()).getFileSize();
+		TS_ASSERT(indexSize > 0);
+
+		{
+			// The next one lists everything from the index, with the sizes of the files
+			Common::FSIndex index(indexFile);
+			Common::FSDirectory::setIndex(&index);
+			TS_ASSERT(scan(root, indexTime) == expected);
+			TS_ASSERT_EQUALS(index.getStats().hits, numDirs);
+			TS_ASSERT_EQUALS(index.getStats().misses, 0u);
+
+			debug("Scanning %d files in %u directories: %u ms, recording the index %u ms, through the index %u ms",
+			      kNumDirs * kNumDirs * kNumFiles, numDirs, plainTime, recordTime, indexTime);
+
+			Common::FSList list;
+			TS_ASSERT(index.getChildren(Common::FSNode(root.join("d3/d4")), list));
+			TS_ASSERT_EQUALS(list.size(), (uint)kNumFiles);
+			for (Common::FSList::const_iterator it = list.begin(); it != list.end(); ++it)
+				TS_ASSERT_EQUALS(it->getFileSize(), 4);
+
+			// Adding a file lists its directory again, and only that one. A
+			// directory modified a moment ago is always listed again.
+			addFile(root.join("d0/d0/added.dat"));
+			Common::FSDirectory recent(root, 3);
+			TS_ASSERT(recent.hasFile(Common::Path("d0/d0/added.dat")));
+			TS_ASSERT_EQUALS(index.getStats().misses, 1u);
+
+			addFile(root.join("d0/d1/added.dat"));
+			TS_ASSERT(Common::age_test_files(root.join("d0/d1"), 60));
+			Common::FSDirectory dir(root, 3);
+			TS_ASSERT(dir.hasFile(Common::Path("d0/d1/added.dat")));
+			TS_ASSERT_EQUALS(index.getStats().misses, 3u);
+
+			// The new listings are appended to the journal of the index
+			TS_ASSERT_EQUALS(index.getStats().merges, 0u);
+			TS_ASSERT_EQUALS(Common::FSNode(indexFile.getPath()).getFileSize(), indexSize);
+			Common::FSDirectory::setIndex(nullptr);
+		}
+		expected.push_back("d0/d0/added.dat");
+		expected.push_back("d0/d1/added.dat");
+		Common::sort(expected.begin(), expected.end());
+		TS_ASSERT(Common::age_test_files(root.join("d0/d0"), 60));
+
+		{
+			// The listings of the journal are read back, and only the directory
+			// recorded while it was changing is listed again
+			Common::FSIndex index(indexFile);
+			Common::FSDirectory::setIndex(&index);
+			TS_ASSERT(scan(root, indexTime) == expected);
+			TS_ASSERT_EQUALS(index.getStats().hits, numDirs - 1);
+			TS_ASSERT_EQUALS(index.getStats().misses, 1u);
+			Common::FSDirectory::setIndex(nullptr);
+		}
+
+		{
+			// Without signatures, the listings are trusted until a lookup fails
+			// in them, which lists the directory again once
+			Common::FSIndex index(indexFile, false);
+			Common::FSDirectory::setIndex(&index);
+			addFile(root.join("d5/d5/trusted.dat"));
+			Common::FSDirectory dir(root, 3);
+			TS_ASSERT(dir.hasFile(Common::Path("d5/d5/trusted.dat")));
+			TS_ASSERT(!dir.hasFile(Common::Path("d5/d5/missing.dat")));
+			TS_ASSERT_EQUALS(index.getStats().invalidated, 1u);
+			TS_ASSERT_EQUALS(index.getStats().misses, 1u);
+
+			// Other trees get the new listing from the index
+			Common::FSDirectory subDir(root.join("d5"), 2);
+			TS_ASSERT(subDir.hasFile(Common::Path("d5/trusted.dat")));
+			TS_ASSERT_EQUALS(index.getStats().invalidated, 1u);
+			TS_ASSERT_EQUALS(index.getStats().misses, 1u);
+			Common::FSDirectory::setIndex(nullptr);
+		}
+
+		Common::remove_test_directory(testDir);
+#endif
+	}
+};
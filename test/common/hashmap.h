@@ -1,10 +1,78 @@
 #include <cxxtest/TestSuite.h>
 
+#include "common/debug.h"
+#include "common/flathashmap.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/str-array.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+// Sends every key to the same entry, so that all of them collide
+struct CollidingHash {
+	uint operator()(int) const { return 7; }
+};
 
 class HashMapTestSuite : public CxxTest::TestSuite
 {
+#ifdef SLOW_TESTS
+	static const int kBenchmarkSize = 100000;
+#else
+	static const int kBenchmarkSize = 10000;
+#endif
+
+	template<class Map>
+	static void benchmarkInts(const char *name) {
+		Map map;
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < kBenchmarkSize; ++i)
+			map[i * 7] = i;
+		const uint32 insertTime = g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		int hits = 0;
+		for (int pass = 0; pass < 10; ++pass) {
+			for (int i = 0; i < kBenchmarkSize * 7; i += 3)
+				hits += map.contains(i);
+		}
+		const uint32 lookupTime = g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		uint64 sum = 0;
+		for (int pass = 0; pass < 10; ++pass) {
+			for (typename Map::const_iterator it = map.begin(); it != map.end(); ++it)
+				sum += it->_value;
+		}
+		const uint32 iterationTime = g_system->getMillis() - start;
+
+		TS_ASSERT_EQUALS(hits, 10 * ((kBenchmarkSize * 7 + 20) / 21));
+		TS_ASSERT_EQUALS(sum, (uint64)10 * (kBenchmarkSize - 1) * kBenchmarkSize / 2);
+		debug("%s<int, int>: %d inserts %u ms, lookups %u ms, iterations %u ms",
+		      name, kBenchmarkSize, insertTime, lookupTime, iterationTime);
+	}
+
+	template<class Map>
+	static void benchmarkStrings(const char *name, const Common::StringArray &keys) {
+		Map map;
+		uint32 start = g_system->getMillis();
+		for (uint i = 0; i < keys.size(); ++i)
+			map[keys[i]] = i;
+		const uint32 insertTime = g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		uint hits = 0;
+		for (int pass = 0; pass < 10; ++pass) {
+			for (uint i = 0; i < keys.size(); ++i)
+				hits += map.contains(keys[i]);
+		}
+		const uint32 lookupTime = g_system->getMillis() - start;
+
+		TS_ASSERT_EQUALS(hits, 10 * keys.size());
+		debug("%s<String, uint>: %u inserts %u ms, lookups %u ms",
+		      name, keys.size(), insertTime, lookupTime);
+	}
+
 	public:
 	void test_empty_clear() {
 		Common::HashMap<int, int> container;
@@ -230,5 +298,134 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
-	// TODO: Add test cases for iterators, find, ...
+	void test_flat_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		TS_ASSERT(!container.contains(0));
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+
+		for (int i = 0; i < 1000; ++i)
+			container[i] = i * 2;
+		TS_ASSERT_EQUALS(container.size(), 1000u);
+
+		for (int i = 1; i < 1000; i += 2)
+			container.erase(i);
+		TS_ASSERT_EQUALS(container.size(), 500u);
+		for (int i = 0; i < 1000; ++i) {
+			TS_ASSERT_EQUALS(container.contains(i), !(i & 1));
+			TS_ASSERT_EQUALS(container.getValOrDefault(i, -1), (i & 1) ? -1 : i * 2);
+		}
+
+		container.setVal(1, 42);
+		TS_ASSERT_EQUALS(container.getVal(1), 42);
+		int value = 0;
+		TS_ASSERT(container.tryGetVal(998, value));
+		TS_ASSERT_EQUALS(value, 1996);
+		TS_ASSERT(!container.tryGetVal(999, value));
+
+		container.clear();
+		TS_ASSERT(container.empty());
+		TS_ASSERT(!container.contains(0));
+		container[3] = 4;
+		TS_ASSERT_EQUALS(container[3], 4);
+	}
+
+	void test_flat_strings() {
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container;
+		container["foo"] = "bar";
+		container["quux"] = "blub";
+		TS_ASSERT(container.contains("FOO"));
+		TS_ASSERT(container.contains("Quux"));
+		TS_ASSERT(!container.contains("bar"));
+		TS_ASSERT_EQUALS(container["fOo"], "bar");
+
+		// The values survive the growth of the table
+		for (int i = 0; i < 100; ++i)
+			container[Common::String::format("key%d", i)] = Common::String::format("value%d", i);
+		TS_ASSERT_EQUALS(container.size(), 102u);
+		TS_ASSERT_EQUALS(container["KEY57"], "value57");
+		TS_ASSERT_EQUALS(container["quux"], "blub");
+	}
+
+	void test_flat_collision() {
+		Common::FlatHashMap<int, int, CollidingHash> h;
+		for (int i = 0; i < 10; ++i)
+			h[i] = i;
+		h.erase(3);
+		h.erase(0);
+		for (int i = 0; i < 10; ++i)
+			TS_ASSERT_EQUALS(h.contains(i), i != 0 && i != 3);
+		h[3] = 33;
+		TS_ASSERT_EQUALS(h[3], 33);
+		TS_ASSERT_EQUALS(h.size(), 9u);
+
+		// Many insertions and erasures must not fill the table with erased
+		// entries
+		for (int i = 10; i < 2000; ++i) {
+			h[i] = i;
+			h.erase(i - 5);
+		}
+		TS_ASSERT_EQUALS(h.size(), 9u);
+		for (int i = 1; i < 2000; ++i)
+			TS_ASSERT_EQUALS(h.contains(i), i < 5 || i >= 1995);
+	}
+
+	void test_flat_iterator() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 100; ++i)
+			container[i] = i;
+
+		// Erasing does not invalidate the iterators
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ++i) {
+			if (i->_key % 3)
+				container.erase(i);
+			else
+				i->_value = -i->_key;
+		}
+		TS_ASSERT_EQUALS(container.size(), 34u);
+
+		int found = 0;
+		const Common::FlatHashMap<int, int> &constContainer = container;
+		for (Common::FlatHashMap<int, int>::const_iterator i = constContainer.begin(); i != constContainer.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_key % 3, 0);
+			TS_ASSERT_EQUALS(i->_value, -i->_key);
+			++found;
+		}
+		TS_ASSERT_EQUALS(found, 34);
+
+		TS_ASSERT_EQUALS(container.find(5), container.end());
+		TS_ASSERT_EQUALS(container.find(6)->_value, -6);
+	}
+
+	void test_flat_copy() {
+		Common::FlatHashMap<int, Common::String> map1, map2;
+		for (int i = 0; i < 50; ++i)
+			map1[i] = Common::String::format("%d", i);
+		map1.erase(10);
+
+		map2 = map1;
+		TS_ASSERT_EQUALS(map2.size(), 49u);
+		TS_ASSERT_EQUALS(map2[42], "42");
+		TS_ASSERT(!map2.contains(10));
+
+		Common::FlatHashMap<int, Common::String> map3(Common::move(map2));
+		TS_ASSERT(map2.empty());
+		TS_ASSERT_EQUALS(map3[49], "49");
+		map2[1] = "one";
+		TS_ASSERT_EQUALS(map2[1], "one");
+	}
+
+	void test_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		benchmarkInts<Common::HashMap<int, int> >("HashMap");
+		benchmarkInts<Common::FlatHashMap<int, int> >("FlatHashMap");
+
+		Common::StringArray keys;
+		for (int i = 0; i < kBenchmarkSize; ++i)
+			keys.push_back(Common::String::format("dir%d/File%d.dat", i % 37, i));
+		benchmarkStrings<Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("HashMap", keys);
+		benchmarkStrings<Common::FlatHashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("FlatHashMap", keys);
+#endif
+	}
 };
@@ -0,0 +1,207 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/jobs.h"
+#include "common/system.h"
+
+#ifdef POSIX
+#include "backends/jobs/pthread/pthread-jobs.h"
+#endif
+
+#include "../null_osystem.h"
+
+class JobSystemTestSuite : public CxxTest::TestSuite {
+#ifdef SLOW_TESTS
+	static const uint kBenchmarkJobs = 200000;
+#else
+	static const uint kBenchmarkJobs = 10000;
+#endif
+
+	struct Slot {
+		Common::Array<uint> *values;
+		uint index;
+	};
+
+	static void writeIndex(void *data) {
+		Slot *slot = (Slot *)data;
+		(*slot->values)[slot->index] = slot->index + 1;
+	}
+
+	struct Nested {
+		Common::JobSystem *jobs;
+		Common::Array<uint> *values;
+		Slot slots[8];
+	};
+
+	// Each job queues and waits for jobs of its own
+	static void runNested(void *data) {
+		Nested *nested = (Nested *)data;
+		Common::JobSystem::Group group;
+		for (uint i = 0; i < ARRAYSIZE(nested->slots); ++i)
+			nested->jobs->run(group, writeIndex, &nested->slots[i]);
+		nested->jobs->wait(group);
+	}
+
+	static void emptyJob(void *data) {
+	}
+
+	// Create a job system with workers, which the machine running the tests
+	// may not have enough cores for
+	static Common::JobSystem *createJobSystem(uint threadCount) {
+#ifdef POSIX
+		return createPthreadJobSystem(threadCount, false);
+#else
+		return new Common::JobSystem();
+#endif
+	}
+
+	static void checkRunWait(Common::JobSystem &jobs) {
+		Common::Array<uint> values(300, 0u);
+		Common::Array<Slot> slots(values.size());
+		Common::JobSystem::Group group;
+		for (uint i = 0; i < slots.size(); ++i) {
+			slots[i].values = &values;
+			slots[i].index = i;
+			// More jobs than a queue can hold
+			jobs.run(group, writeIndex, &slots[i]);
+		}
+		jobs.wait(group);
+
+		TS_ASSERT(group.isDone());
+		for (uint i = 0; i < values.size(); ++i)
+			TS_ASSERT_EQUALS(values[i], i + 1);
+	}
+
+	static void checkNested(Common::JobSystem &jobs) {
+		Common::Array<uint> values(16 * ARRAYSIZE(Nested().slots), 0u);
+		Nested nested[16];
+		Common::JobSystem::Group group;
+		for (uint i = 0; i < ARRAYSIZE(nested); ++i) {
+			nested[i].jobs = &jobs;
+			nested[i].values = &values;
+			for (uint j = 0; j < ARRAYSIZE(nested[i].slots); ++j) {
+				nested[i].slots[j].values = &values;
+				nested[i].slots[j].index = i * ARRAYSIZE(nested[i].slots) + j;
+			}
+			jobs.run(group, runNested, &nested[i]);
+		}
+		jobs.wait(group);
+
+		for (uint i = 0; i < values.size(); ++i)
+			TS_ASSERT_EQUALS(values[i], i + 1);
+	}
+
+	static void checkParallelFor(Common::JobSystem &jobs, uint begin, uint end, uint grain) {
+		Common::Array<uint> counts(end, 0u);
+		bool inRange = true;
+		jobs.parallelFor(begin, end, grain, [&](uint first, uint last) {
+			if (first < begin || last > end || first >= last)
+				inRange = false;
+			// Without workers, the whole range is handled at once
+			if (jobs.getWorkerCount() && last - first > MAX(grain, 1u))
+				inRange = false;
+			for (uint i = first; i < last; ++i)
+				++counts[i];
+		});
+
+		TS_ASSERT(inRange);
+		for (uint i = 0; i < end; ++i)
+			TS_ASSERT_EQUALS(counts[i], i >= begin ? 1u : 0u);
+	}
+
+public:
+	void test_serial() {
+		Common::JobSystem jobs;
+		TS_ASSERT_EQUALS(jobs.getWorkerCount(), 0u);
+
+		checkRunWait(jobs);
+		checkNested(jobs);
+		checkParallelFor(jobs, 0, 1000, 7);
+
+		// Without workers, the jobs run at once
+		TS_ASSERT_EQUALS(jobs.getStats().inlined, jobs.getStats().jobs);
+		TS_ASSERT_EQUALS(jobs.getStats().stolen, 0u);
+	}
+
+	void test_run_wait() {
+		Common::JobSystem *jobs = createJobSystem(4);
+		checkRunWait(*jobs);
+		TS_ASSERT_EQUALS(jobs->getStats().jobs, 300u);
+		delete jobs;
+	}
+
+	void test_nested() {
+		Common::JobSystem *jobs = createJobSystem(4);
+		checkNested(*jobs);
+		TS_ASSERT_EQUALS(jobs->getStats().jobs, 16u + 16u * ARRAYSIZE(Nested().slots));
+		delete jobs;
+	}
+
+	void test_parallel_for() {
+		Common::JobSystem *jobs = createJobSystem(4);
+		checkParallelFor(*jobs, 0, 1000, 7);
+		checkParallelFor(*jobs, 3, 1000, 1000);
+		checkParallelFor(*jobs, 10, 11, 4);
+		checkParallelFor(*jobs, 0, 64, 0);
+		checkParallelFor(*jobs, 5, 5, 1);
+		delete jobs;
+	}
+
+	void test_thread_count() {
+#ifdef POSIX
+		// Counts of 0 or less give one thread per core
+		Common::JobSystem *automatic = createPthreadJobSystem(0, false);
+		Common::JobSystem *negative = createPthreadJobSystem(-1, false);
+		TS_ASSERT_EQUALS(negative->getWorkerCount(), automatic->getWorkerCount());
+		delete negative;
+		delete automatic;
+
+		Common::JobSystem *serial = createPthreadJobSystem(1, false);
+		TS_ASSERT_EQUALS(serial->getWorkerCount(), 0u);
+		delete serial;
+#endif
+	}
+
+	void test_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Common::JobSystem *jobs = createJobSystem(4);
+
+		// The cost of scheduling jobs which do nothing
+		uint32 start = g_system->getMillis();
+		Common::JobSystem::Group group;
+		for (uint i = 0; i < kBenchmarkJobs; ++i) {
+			jobs->run(group, emptyJob, nullptr);
+			if (!(i & 63))
+				jobs->wait(group);
+		}
+		jobs->wait(group);
+		const uint32 emptyTime = g_system->getMillis() - start;
+
+		// A loop over an image, in bands of rows or at once
+		Common::Array<uint32> pixels(640 * 480, 1u);
+		auto shade = [&](uint first, uint last) {
+			for (uint i = first * 640; i < last * 640; ++i)
+				pixels[i] = pixels[i] * 1664525u + 1013904223u;
+		};
+
+		start = g_system->getMillis();
+		for (uint frame = 0; frame < kBenchmarkJobs / 1000; ++frame)
+			shade(0, 480);
+		const uint32 serialTime = g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		for (uint frame = 0; frame < kBenchmarkJobs / 1000; ++frame)
+			jobs->parallelFor(0, 480, 16, shade);
+		const uint32 parallelTime = g_system->getMillis() - start;
+
+		const Common::JobSystem::Stats stats = jobs->getStats();
+		debug("%u empty jobs on %u workers: %u ms (%u stolen, %u inlined, %u sleeps)",
+		      kBenchmarkJobs, jobs->getWorkerCount(), emptyTime, stats.stolen, stats.inlined, stats.sleeps);
+		debug("%u frames of 640x480 pixels: serial %u ms, parallel %u ms",
+		      kBenchmarkJobs / 1000, serialTime, parallelTime);
+		delete jobs;
+#endif
+	}
+};
@@ -0,0 +1,221 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/debug.h"
+#include "common/file.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+/**
+ * Reads a data file through the regular streams of the file system and
+ * through memory mapped streams, which must give the same data, and times
+ * the usual read patterns of engines with both.
+ */
+class MappedStreamTestSuite : public CxxTest::TestSuite {
+#ifdef SLOW_TESTS
+	static const uint32 kFileSize = 64 * 1024 * 1024;
+	static const int kRandomReads = 200000;
+#else
+	static const uint32 kFileSize = 4 * 1024 * 1024;
+	static const int kRandomReads = 20000;
+#endif
+
+	static byte contentAt(uint32 offset) {
+		return (byte)((offset * 2654435761u) >> 24);
+	}
+
+	Common::Path _testDir;
+
+	Common::Path getDataPath() const {
+		return _testDir.appendComponent("mapped.dat");
+	}
+
+	bool createDataFile() const {
+		if (_testDir.empty())
+			return false;
+
+		const Common::FSNode node(getDataPath());
+		Common::ScopedPtr<Common::SeekableWriteStream> out(node.createWriteStream(false));
+		if (!out)
+			return false;
+
+		byte buffer[4096];
+		for (uint32 offset = 0; offset < kFileSize; offset += sizeof(buffer)) {
+			for (uint32 i = 0; i < sizeof(buffer); ++i)
+				buffer[i] = contentAt(offset + i);
+			out->write(buffer, sizeof(buffer));
+		}
+		out->finalize();
+		return !out->err();
+	}
+
+	// Whole file in blocks, like an engine loading a resource
+	static uint32 readSequential(Common::SeekableReadStream &stream) {
+		byte buffer[4096];
+		uint32 sum = 0;
+		stream.seek(0);
+		while (!stream.eos()) {
+			const uint32 size = stream.read(buffer, sizeof(buffer));
+			for (uint32 i = 0; i < size; i += 64)
+				sum += buffer[i];
+		}
+		return sum;
+	}
+
+	// Small records at scattered offsets, like resources of a bundle
+	static uint32 readRandom(Common::SeekableReadStream &stream) {
+		byte buffer[256];
+		uint32 sum = 0;
+		uint32 seed = 1;
+		for (int i = 0; i < kRandomReads; ++i) {
+			seed = seed * 1103515245 + 12345;
+			stream.seek((seed >> 8) % (kFileSize - sizeof(buffer)));
+			stream.read(buffer, sizeof(buffer));
+			sum += buffer[0] + buffer[sizeof(buffer) - 1];
+		}
+		return sum;
+	}
+
+	// Integers one at a time, like a parser of a header or an index
+	static uint32 readIntegers(Common::SeekableReadStream &stream) {
+		uint32 sum = 0;
+		stream.seek(0);
+		for (uint32 i = 0; i < kFileSize / 16; i += 4)
+			sum += stream.readUint32LE();
+		return sum;
+	}
+
+	// The same blocks, used in place
+	static uint32 readInPlace(Common::SeekableReadStream &stream) {
+		uint32 sum = 0;
+		stream.seek(0);
+		for (uint32 offset = 0; offset < kFileSize; offset += 4096) {
+			const byte *data = stream.getPointer(4096);
+			if (!data)
+				return 0;
+			for (uint32 i = 0; i < 4096; i += 64)
+				sum += data[i];
+			stream.skip(4096);
+		}
+		return sum;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		Common::install_null_g_system();
+		_testDir = Common::create_test_directory("mappedstream");
+#endif
+	}
+
+	void tearDown() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		if (!_testDir.empty())
+			Common::remove_test_directory(_testDir);
+		_testDir.clear();
+#endif
+	}
+
+	void test_mapped_read() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		TS_ASSERT(createDataFile());
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::FSNode(getDataPath()).createReadStreamMapped());
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int64)kFileSize);
+
+		stream->seek(12345);
+		byte buffer[16];
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+		for (uint32 i = 0; i < sizeof(buffer); ++i)
+			TS_ASSERT_EQUALS(buffer[i], contentAt(12345 + i));
+
+		stream->seek(-4, SEEK_END);
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 4u);
+		TS_ASSERT(stream->eos());
+
+#ifdef HAS_MMAP
+		stream->seek(kFileSize - 8);
+		const byte *data = stream->getPointer(8);
+		TS_ASSERT(data);
+		if (data)
+			TS_ASSERT_EQUALS(data[7], contentAt(kFileSize - 1));
+		TS_ASSERT(!stream->getPointer(9));
+		TS_ASSERT_EQUALS(stream->pos(), (int64)kFileSize - 8);
+#endif
+
+		// The regular streams do not have the data in memory
+		Common::ScopedPtr<Common::SeekableReadStream> plain(Common::FSNode(getDataPath()).createReadStream());
+		TS_ASSERT(plain);
+		TS_ASSERT(!plain->getPointer(1));
+#endif
+	}
+
+	void test_file_open_mapped() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		TS_ASSERT(createDataFile());
+
+		SearchMan.addDirectory("mappedstream-test", Common::FSNode(_testDir));
+
+		Common::File file;
+		TS_ASSERT(file.openMapped(getDataPath().getLastComponent()));
+		TS_ASSERT_EQUALS(file.size(), (int64)kFileSize);
+		file.seek(100);
+		TS_ASSERT_EQUALS(file.readByte(), contentAt(100));
+#ifdef HAS_MMAP
+		TS_ASSERT(file.getPointer(16));
+#endif
+		file.close();
+
+		TS_ASSERT(!file.openMapped("mappedstream-missing.dat"));
+		SearchMan.remove("mappedstream-test");
+#endif
+	}
+
+	void test_read_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		TS_ASSERT(createDataFile());
+
+		const Common::FSNode node(getDataPath());
+		Common::ScopedPtr<Common::SeekableReadStream> plain(node.createReadStream());
+		Common::ScopedPtr<Common::SeekableReadStream> mapped(node.createReadStreamMapped());
+		TS_ASSERT(plain && mapped);
+		if (!plain || !mapped)
+			return;
+
+		typedef uint32 (*Pattern)(Common::SeekableReadStream &stream);
+		static const struct {
+			const char *name;
+			Pattern pattern;
+		} patterns[] = {
+			{ "sequential 4 KB blocks", readSequential },
+			{ "random 256 byte records", readRandom },
+			{ "32-bit integers", readIntegers }
+		};
+
+		for (int i = 0; i < ARRAYSIZE(patterns); ++i) {
+			uint32 start = g_system->getMillis();
+			const uint32 plainSum = patterns[i].pattern(*plain);
+			const uint32 plainTime = g_system->getMillis() - start;
+
+			start = g_system->getMillis();
+			const uint32 mappedSum = patterns[i].pattern(*mapped);
+			const uint32 mappedTime = g_system->getMillis() - start;
+
+			TS_ASSERT_EQUALS(plainSum, mappedSum);
+			debug("Reading %u KB as %s: stdio %u ms, mapped %u ms", kFileSize / 1024, patterns[i].name, plainTime, mappedTime);
+		}
+
+#ifdef HAS_MMAP
+		const uint32 start = g_system->getMillis();
+		const uint32 inPlaceSum = readInPlace(*mapped);
+		const uint32 inPlaceTime = g_system->getMillis() - start;
+		TS_ASSERT_EQUALS(inPlaceSum, readSequential(*plain));
+		debug("Reading %u KB as sequential 4 KB blocks in place: mapped %u ms", kFileSize / 1024, inPlaceTime);
+#endif
+#endif
+	}
+};
@@ -104,4 +104,17 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_get_pointer() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		TS_ASSERT_EQUALS(ms.getPointer(7), contents);
+		ms.seek(3, SEEK_SET);
+		TS_ASSERT_EQUALS(ms.getPointer(4), contents + 3);
+		TS_ASSERT_EQUALS(ms.getPointer(5), (const byte *)nullptr);
+		// The position does not move
+		TS_ASSERT_EQUALS(ms.pos(), 3);
+		TS_ASSERT_EQUALS(ms.readByte(), 4);
+	}
 };
@@ -0,0 +1,244 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/saves/default/default-saves.h"
+#include "engines/savestate.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/system.h"
+#include "graphics/scaler.h"
+#include "graphics/surface.h"
+#include "graphics/thumbnail.h"
+
+#include "../null_osystem.h"
+
+/**
+ * Serializes save descriptors into metadata index entries, and queries
+ * saves through the metadata index of DefaultSaveFileManager. Reading the
+ * entries of 100 saves must give the same descriptors as opening and
+ * inflating the saves themselves.
+ */
+class SaveMetaIndexTestSuite : public CxxTest::TestSuite {
+	static const int kNumSaves = 100;
+	static const uint32 kPayloadSize = 64 * 1024;
+
+	static Common::String saveName(int slot) {
+		return Common::String::format("savemetaindex.%03d", slot);
+	}
+
+	static Graphics::Surface *createThumbnail(int w, int h, int seed) {
+		Graphics::Surface *thumbnail = new Graphics::Surface();
+		thumbnail->create(w, h, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x)
+				*(uint16 *)thumbnail->getBasePtr(x, y) = (uint16)(x * 31 + y * 17 + seed);
+		}
+		return thumbnail;
+	}
+
+	// The game state, followed by a header with a full size thumbnail
+	static void writeSave(Common::SaveFileManager &saveMan, int slot, const Common::String &desc) {
+		Common::ScopedPtr<Common::OutSaveFile> out(saveMan.openForSaving(saveName(slot)));
+		TS_ASSERT(out);
+		if (!out)
+			return;
+
+		for (uint32 i = 0; i < kPayloadSize; ++i)
+			out->writeByte((byte)((i * 7 + slot) ^ (i >> 9)));
+
+		const uint32 headerPos = out->pos();
+		out->writeUint32LE(slot * 60000);
+		out->writeByte(desc.size());
+		out->writeString(desc);
+
+		Graphics::Surface *thumbnail = createThumbnail(320, 200, slot);
+		Graphics::saveThumbnail(*out, *thumbnail);
+		thumbnail->free();
+		delete thumbnail;
+
+		out->writeUint32LE(headerPos);
+		out->finalize();
+	}
+
+	// What querySaveMetaInfos() does with the header of a save
+	static SaveStateDescriptor readSave(Common::SaveFileManager &saveMan, int slot) {
+		SaveStateDescriptor desc;
+		Common::ScopedPtr<Common::InSaveFile> in(saveMan.openForLoading(saveName(slot)));
+		if (!in)
+			return desc;
+
+		in->seek(-4, SEEK_END);
+		in->seek(in->readUint32LE());
+		const uint32 playTime = in->readUint32LE();
+		const Common::String description = in->readString(0, in->readByte());
+
+		Graphics::Surface *thumbnail = nullptr;
+		if (!Graphics::loadThumbnail(*in, thumbnail))
+			return desc;
+
+		desc.setSaveSlot(slot);
+		desc.setDescription(description);
+		desc.setSaveDate(2024, 5, 12);
+		desc.setSaveTime(13, 37);
+		desc.setPlayTime(playTime);
+		desc.setThumbnail(thumbnail);
+		return desc;
+	}
+
+	// What MetaEngine::querySaveMetaInfosCached() does around it
+	static SaveStateDescriptor queryCached(Common::SaveFileManager &saveMan, int slot, int &saveReads) {
+		SaveStateDescriptor desc;
+		desc.setSaveSlot(slot);
+		if (desc.loadMetaInfoCache(saveMan, saveName(slot)))
+			return desc;
+
+		++saveReads;
+		desc = readSave(saveMan, slot);
+		if (desc.isValid())
+			TS_ASSERT(desc.saveMetaInfoCache(saveMan, saveName(slot)));
+		return desc;
+	}
+
+	static void checkDescriptor(const SaveStateDescriptor &desc, int slot, const Common::String &description, bool fromIndex) {
+		TS_ASSERT(desc.isValid());
+		TS_ASSERT_EQUALS(desc.getSaveSlot(), slot);
+		TS_ASSERT_EQUALS(desc.getDescription().encode(), description);
+		TS_ASSERT_EQUALS(desc.getSaveDate(), "2024-05-12");
+		TS_ASSERT_EQUALS(desc.getSaveTime(), "13:37");
+		TS_ASSERT_EQUALS(desc.getPlayTimeMSecs(), (uint32)slot * 60000);
+
+		// The index holds thumbnails of the size of the dialogs
+		const Graphics::Surface *thumbnail = desc.getThumbnail();
+		TS_ASSERT(thumbnail);
+		if (thumbnail) {
+			TS_ASSERT_EQUALS(thumbnail->w, fromIndex ? kThumbnailWidth : 320);
+			TS_ASSERT_EQUALS(thumbnail->h, fromIndex ? 200 * kThumbnailWidth / 320 : 200);
+		}
+	}
+
+	static bool sameThumbnail(const Graphics::Surface *a, const Graphics::Surface *b) {
+		if (!a || !b || a->w != b->w || a->h != b->h || a->format != b->format)
+			return false;
+		for (int y = 0; y < a->h; ++y) {
+			if (memcmp(a->getBasePtr(0, y), b->getBasePtr(0, y), a->w * a->format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void test_descriptor_round_trip() {
+		SaveStateDescriptor desc;
+		desc.setSaveSlot(3);
+		desc.setDescription(Common::U32String("Caf\xc3\xa9 du Monde"));
+		desc.setSaveDate(2024, 5, 12);
+		desc.setSaveTime(13, 37);
+		desc.setPlayTime(3723000);
+		desc.setDeletableFlag(false);
+		desc.setWriteProtectedFlag(true);
+		desc.setThumbnail(createThumbnail(320, 200, 3));
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		desc.saveMetaInfoCache(out);
+
+		Common::MemoryReadStream in(out.getData(), out.size());
+		SaveStateDescriptor loaded;
+		loaded.setSaveSlot(3);
+		TS_ASSERT(loaded.loadMetaInfoCache(in));
+		TS_ASSERT_EQUALS(in.pos(), in.size());
+
+		TS_ASSERT_EQUALS(loaded.getSaveSlot(), 3);
+		TS_ASSERT(loaded.getDescription() == desc.getDescription());
+		TS_ASSERT_EQUALS(loaded.getSaveDate(), desc.getSaveDate());
+		TS_ASSERT_EQUALS(loaded.getSaveTime(), desc.getSaveTime());
+		TS_ASSERT_EQUALS(loaded.getPlayTime(), desc.getPlayTime());
+		TS_ASSERT_EQUALS(loaded.getPlayTimeMSecs(), desc.getPlayTimeMSecs());
+		TS_ASSERT(!loaded.getDeletableFlag());
+		TS_ASSERT(loaded.getWriteProtectedFlag());
+
+		// Thumbnails are scaled down to the size of the dialogs
+		const Graphics::Surface *thumbnail = loaded.getThumbnail();
+		TS_ASSERT(thumbnail);
+		if (thumbnail) {
+			TS_ASSERT_EQUALS(thumbnail->w, kThumbnailWidth);
+			TS_ASSERT_EQUALS(thumbnail->h, 200 * kThumbnailWidth / 320);
+		}
+
+		// Small thumbnails are kept as they are
+		desc.setThumbnail(createThumbnail(80, 50, 4));
+		Common::MemoryWriteStreamDynamic smallOut(DisposeAfterUse::YES);
+		desc.saveMetaInfoCache(smallOut);
+		Common::MemoryReadStream smallIn(smallOut.getData(), smallOut.size());
+		TS_ASSERT(loaded.loadMetaInfoCache(smallIn));
+		TS_ASSERT(sameThumbnail(loaded.getThumbnail(), desc.getThumbnail()));
+
+		// Truncated entries are rejected
+		Common::MemoryReadStream truncated(out.getData(), out.size() / 2);
+		TS_ASSERT(!loaded.loadMetaInfoCache(truncated));
+	}
+
+	void test_query_cached() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		Common::install_null_g_system();
+
+		const Common::Path savePath = Common::create_test_directory("savemetaindex");
+		TS_ASSERT(!savePath.empty());
+		if (savePath.empty())
+			return;
+		ConfMan.setPath("savepath", savePath, Common::ConfigManager::kApplicationDomain);
+		DefaultSaveFileManager saveMan;
+
+		for (int slot = 0; slot < kNumSaves; ++slot)
+			writeSave(saveMan, slot, Common::String::format("Save %d", slot));
+
+		// No entry until the first query
+		Common::ScopedPtr<Common::InSaveFile> in(saveMan.openMetaInfoCache(saveName(0)));
+		TS_ASSERT(!in);
+
+		// This is what the dialogs had to do without the index
+		uint32 start = g_system->getMillis();
+		for (int slot = 0; slot < kNumSaves; ++slot)
+			checkDescriptor(readSave(saveMan, slot), slot, Common::String::format("Save %d", slot), false);
+		const uint32 inflateTime = g_system->getMillis() - start;
+
+		// The first query reads the saves, and writes their entries
+		int saveReads = 0;
+		start = g_system->getMillis();
+		for (int slot = 0; slot < kNumSaves; ++slot)
+			checkDescriptor(queryCached(saveMan, slot, saveReads), slot, Common::String::format("Save %d", slot), false);
+		const uint32 recordTime = g_system->getMillis() - start;
+		TS_ASSERT_EQUALS(saveReads, kNumSaves);
+
+		// Later queries only read the entries
+		saveReads = 0;
+		start = g_system->getMillis();
+		for (int slot = 0; slot < kNumSaves; ++slot)
+			checkDescriptor(queryCached(saveMan, slot, saveReads), slot, Common::String::format("Save %d", slot), true);
+		const uint32 indexTime = g_system->getMillis() - start;
+		TS_ASSERT_EQUALS(saveReads, 0);
+
+		debug("Querying %d saves by inflating them took %u ms, recording the metadata index %u ms, through the index %u ms",
+		      kNumSaves, inflateTime, recordTime, indexTime);
+
+		// Rewriting a save drops its entry
+		writeSave(saveMan, 1, "Rewritten");
+		in.reset(saveMan.openMetaInfoCache(saveName(1)));
+		TS_ASSERT(!in);
+		checkDescriptor(queryCached(saveMan, 1, saveReads), 1, "Rewritten", false);
+		checkDescriptor(queryCached(saveMan, 2, saveReads), 2, "Save 2", true);
+		TS_ASSERT_EQUALS(saveReads, 1);
+
+		// Removing a save drops its entry too
+		for (int slot = 0; slot < kNumSaves; ++slot)
+			TS_ASSERT(saveMan.removeSavefile(saveName(slot)));
+		in.reset(saveMan.openMetaInfoCache(saveName(2)));
+		TS_ASSERT(!in);
+		TS_ASSERT(!queryCached(saveMan, 2, saveReads).isValid());
+
+		ConfMan.removeKey("savepath", Common::ConfigManager::kApplicationDomain);
+		Common::remove_test_directory(savePath);
+#endif
+	}
+};
@@ -0,0 +1,91 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/formats/json.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/trace.h"
+
+/**
+ * Records events in the trace of the test thread and reads them back from
+ * the Chrome trace JSON. Tracing is only built with --enable-tracing.
+ */
+class TraceTestSuite : public CxxTest::TestSuite {
+#ifdef ENABLE_TRACING
+	// The events of the test thread, as parsed from the trace
+	static Common::JSONValue *dump() {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		if (!Common::writeTrace(out))
+			return nullptr;
+		out.writeByte(0);
+		return Common::JSON::parse((const char *)out.getData());
+	}
+
+	static int countEvents(const Common::JSONArray &events, const char *phase, const char *name) {
+		int count = 0;
+		for (uint i = 0; i < events.size(); ++i) {
+			const Common::JSONObject &event = events[i]->asObject();
+			if (event["ph"]->asString() == phase && event["name"]->asString() == name)
+				++count;
+		}
+		return count;
+	}
+#endif
+
+public:
+	void test_events() {
+#ifdef ENABLE_TRACING
+		Common::clearTrace();
+		TRACE_THREAD_NAME("Test");
+		for (int i = 0; i < 3; ++i) {
+			TRACE_ZONE("zone");
+			TRACE_COUNTER("counter", i);
+		}
+		TRACE_FRAME("frame");
+
+		Common::ScopedPtr<Common::JSONValue> trace(dump());
+		TS_ASSERT(trace);
+		if (!trace)
+			return;
+		const Common::JSONArray &events = trace->asObject()["traceEvents"]->asArray();
+		TS_ASSERT_EQUALS(countEvents(events, "X", "zone"), 3);
+		TS_ASSERT_EQUALS(countEvents(events, "C", "counter"), 3);
+		TS_ASSERT_EQUALS(countEvents(events, "i", "frame"), 1);
+		TS_ASSERT_EQUALS(countEvents(events, "M", "thread_name"), 1);
+
+		Common::clearTrace();
+		trace.reset(dump());
+		TS_ASSERT_EQUALS(countEvents(trace->asObject()["traceEvents"]->asArray(), "X", "zone"), 0);
+#endif
+	}
+
+	void test_overwrite_oldest() {
+#ifdef ENABLE_TRACING
+		static const int kCount = 100000;
+		Common::clearTrace();
+		for (int i = 0; i < kCount; ++i)
+			TRACE_COUNTER("overwritten", i);
+
+		Common::ScopedPtr<Common::JSONValue> trace(dump());
+		TS_ASSERT(trace);
+		if (!trace)
+			return;
+		const Common::JSONArray &events = trace->asObject()["traceEvents"]->asArray();
+		const int count = countEvents(events, "C", "overwritten");
+		TS_ASSERT_LESS_THAN(0, count);
+		TS_ASSERT_LESS_THAN(count, kCount);
+
+		// The newest events are kept, in order
+		long long int last = -1;
+		for (uint i = 0; i < events.size(); ++i) {
+			const Common::JSONObject &event = events[i]->asObject();
+			if (event["name"]->asString() != "overwritten")
+				continue;
+			const long long int value = event["args"]->asObject()["value"]->asIntegerNumber();
+			TS_ASSERT_LESS_THAN(last, value);
+			last = value;
+		}
+		TS_ASSERT_EQUALS(last, kCount - 1);
+		Common::clearTrace();
+#endif
+	}
+};
@@ -0,0 +1,312 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/system.h"
+#include "common/compression/deflate.h"
+#include "common/compression/unzip.h"
+
+#include "../null_osystem.h"
+
+/**
+ * A memory stream which counts how many bytes were read from it, to tell how
+ * much of a ZIP archive reading a member pulls in.
+ */
+class CountingReadStream : public Common::MemoryReadStream {
+public:
+	CountingReadStream(const byte *data, uint32 size) : Common::MemoryReadStream(data, size), _bytesRead(0) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		const uint32 count = Common::MemoryReadStream::read(dataPtr, dataSize);
+		_bytesRead += count;
+		return count;
+	}
+
+	uint32 _bytesRead;
+};
+
+/**
+ * Checks that members of ZIP archives read the same whether they are held in
+ * memory or streamed, that streamed members only pull in what is read, and
+ * compares streaming and seeking in deflated members to inflating them whole.
+ */
+class UnzipTestSuite : public CxxTest::TestSuite {
+#ifdef SLOW_TESTS
+	static const uint32 kLargeSize = 16 * 1024 * 1024;
+#else
+	static const uint32 kLargeSize = 2 * 1024 * 1024;
+#endif
+	static const uint32 kStoredSize = 256 * 1024;
+	static const uint32 kSmallSize = 1000;
+
+	struct Member {
+		const char *name;
+		const byte *data;
+		uint32 size;
+		bool deflate;
+	};
+
+	Common::Array<byte> _zip;
+	Common::Array<byte> _large, _stored, _small;
+	Common::Array<byte> _largeDeflated;
+
+	// Text-like data, which compresses to many deflate blocks
+	static void fill(Common::Array<byte> &data, uint32 size, uint32 seed) {
+		static const char *const words[] = { "the ", "room ", "ego ", "script ", "view ", "palette ", "sound ", "\n" };
+		data.resize(size);
+		for (uint32 i = 0; i < size; ) {
+			seed = seed * 1103515245 + 12345;
+			for (const char *word = words[(seed >> 16) % ARRAYSIZE(words)]; *word && i < size; ++word)
+				data[i++] = *word;
+		}
+	}
+
+	// Raw deflate data and its CRC32, taken from a gzip stream
+	static void deflate(const byte *data, uint32 dataSize, Common::Array<byte> &deflated, uint32 &crc) {
+		Common::MemoryWriteStreamDynamic *out = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::ScopedPtr<Common::WriteStream> gzip(Common::wrapCompressedWriteStream(out));
+		gzip->write(data, dataSize);
+		gzip->finalize();
+
+		const byte *gz = out->getData();
+		const uint32 size = out->size();
+		deflated.resize(size - 18);
+		memcpy(deflated.data(), gz + 10, size - 18);
+		crc = READ_LE_UINT32(gz + size - 8);
+	}
+
+	static void writeUint16(Common::Array<byte> &out, uint16 value) {
+		out.push_back(value & 0xFF);
+		out.push_back(value >> 8);
+	}
+
+	static void writeUint32(Common::Array<byte> &out, uint32 value) {
+		writeUint16(out, value & 0xFFFF);
+		writeUint16(out, value >> 16);
+	}
+
+	void buildZip() {
+		fill(_large, kLargeSize, 1);
+		fill(_stored, kStoredSize, 2);
+		fill(_small, kSmallSize, 3);
+
+		const Member members[] = {
+			{ "large.txt", _large.data(), kLargeSize, true },
+			{ "stored.txt", _stored.data(), kStoredSize, false },
+			{ "small.txt", _small.data(), kSmallSize, true }
+		};
+
+		Common::Array<byte> central;
+		_zip.clear();
+		for (uint i = 0; i < ARRAYSIZE(members); ++i) {
+			const Member &member = members[i];
+			Common::Array<byte> deflated;
+			uint32 crc;
+			deflate(member.data, member.size, deflated, crc);
+			if (i == 0)
+				_largeDeflated = deflated;
+
+			const byte *data = member.deflate ? deflated.data() : member.data;
+			const uint32 size = member.deflate ? deflated.size() : member.size;
+			const uint16 nameLength = strlen(member.name);
+			const uint32 offset = _zip.size();
+
+			writeUint32(_zip, 0x04034b50);
+			writeUint16(_zip, 20);
+			writeUint16(_zip, 0);
+			writeUint16(_zip, member.deflate ? 8 : 0);
+			writeUint32(_zip, 0);
+			writeUint32(_zip, crc);
+			writeUint32(_zip, size);
+			writeUint32(_zip, member.size);
+			writeUint16(_zip, nameLength);
+			writeUint16(_zip, 0);
+			for (uint16 j = 0; j < nameLength; ++j)
+				_zip.push_back(member.name[j]);
+			for (uint32 j = 0; j < size; ++j)
+				_zip.push_back(data[j]);
+
+			writeUint32(central, 0x02014b50);
+			writeUint16(central, 20);
+			writeUint16(central, 20);
+			writeUint16(central, 0);
+			writeUint16(central, member.deflate ? 8 : 0);
+			writeUint32(central, 0);
+			writeUint32(central, crc);
+			writeUint32(central, size);
+			writeUint32(central, member.size);
+			writeUint16(central, nameLength);
+			writeUint16(central, 0);
+			writeUint16(central, 0);
+			writeUint16(central, 0);
+			writeUint16(central, 0);
+			writeUint32(central, 0);
+			writeUint32(central, offset);
+			for (uint16 j = 0; j < nameLength; ++j)
+				central.push_back(member.name[j]);
+		}
+
+		const uint32 centralOffset = _zip.size();
+		_zip.push_back(central);
+		writeUint32(_zip, 0x06054b50);
+		writeUint16(_zip, 0);
+		writeUint16(_zip, 0);
+		writeUint16(_zip, ARRAYSIZE(members));
+		writeUint16(_zip, ARRAYSIZE(members));
+		writeUint32(_zip, central.size());
+		writeUint32(_zip, centralOffset);
+		writeUint16(_zip, 0);
+	}
+
+	bool readsLike(Common::SeekableReadStream &stream, const Common::Array<byte> &expected, uint32 offset, uint32 size) {
+		Common::Array<byte> buffer(size);
+		if (!stream.seek(offset) || stream.read(buffer.data(), size) != size)
+			return false;
+		return !memcmp(buffer.data(), expected.data() + offset, size);
+	}
+
+public:
+	void test_members_match() {
+#ifdef USE_ZLIB
+		buildZip();
+		Common::ScopedPtr<Common::Archive> zip(Common::makeZipArchive(new Common::MemoryReadStream(_zip.data(), _zip.size())));
+		TS_ASSERT(zip);
+
+		const Common::Array<byte> *expected[] = { &_large, &_stored, &_small };
+		const char *const names[] = { "large.txt", "stored.txt", "small.txt" };
+		for (uint i = 0; i < ARRAYSIZE(names); ++i) {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(zip->createReadStreamForMember(names[i]));
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+			TS_ASSERT_EQUALS(stream->size(), (int64)expected[i]->size());
+			TS_ASSERT(readsLike(*stream, *expected[i], 0, expected[i]->size()));
+
+			// Reading past the end
+			byte b;
+			TS_ASSERT_EQUALS(stream->read(&b, 1), 0u);
+			TS_ASSERT(stream->eos());
+			TS_ASSERT(!stream->err());
+		}
+#endif
+	}
+
+	void test_streamed_member_seeking() {
+#ifdef USE_ZLIB
+		buildZip();
+		Common::ScopedPtr<Common::Archive> zip(Common::makeZipArchive(new Common::MemoryReadStream(_zip.data(), _zip.size())));
+		Common::ScopedPtr<Common::SeekableReadStream> large(zip->createReadStreamForMember("large.txt"));
+		Common::ScopedPtr<Common::SeekableReadStream> stored(zip->createReadStreamForMember("stored.txt"));
+		TS_ASSERT(large && stored);
+		if (!large || !stored)
+			return;
+
+		uint32 seed = 4;
+		for (int i = 0; i < 200; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 offset = (seed >> 8) % (kLargeSize - 100);
+			TS_ASSERT(readsLike(*large, _large, offset, 100));
+			TS_ASSERT(readsLike(*stored, _stored, offset % (kStoredSize - 100), 100));
+
+			// Short seeks backwards, like those of most parsers
+			TS_ASSERT(readsLike(*large, _large, offset + 50, 50));
+			TS_ASSERT(readsLike(*large, _large, offset, 10));
+		}
+
+		// Interleaved reads of the same member
+		Common::ScopedPtr<Common::SeekableReadStream> again(zip->createReadStreamForMember("large.txt"));
+		TS_ASSERT(readsLike(*again, _large, kLargeSize - 5000, 5000));
+		TS_ASSERT(readsLike(*large, _large, 0, 5000));
+		TS_ASSERT(readsLike(*again, _large, 1000, 5000));
+#endif
+	}
+
+	void test_streamed_member_outlives_archive() {
+#ifdef USE_ZLIB
+		buildZip();
+		Common::Archive *zip = Common::makeZipArchive(new Common::MemoryReadStream(_zip.data(), _zip.size()));
+		TS_ASSERT(zip);
+		if (!zip)
+			return;
+		Common::ScopedPtr<Common::SeekableReadStream> large(zip->createReadStreamForMember("large.txt"));
+		Common::ScopedPtr<Common::SeekableReadStream> stored(zip->createReadStreamForMember("stored.txt"));
+		delete zip;
+
+		// Like the fonts, which FreeType reads after the archive is gone
+		TS_ASSERT(large && stored);
+		if (!large || !stored)
+			return;
+		TS_ASSERT(readsLike(*large, _large, kLargeSize - 5000, 5000));
+		TS_ASSERT(readsLike(*large, _large, 0, 5000));
+		TS_ASSERT(readsLike(*stored, _stored, 1000, 5000));
+#endif
+	}
+
+	void test_streamed_member_reads_lazily() {
+#ifdef USE_ZLIB
+		buildZip();
+		CountingReadStream *archive = new CountingReadStream(_zip.data(), _zip.size());
+		Common::ScopedPtr<Common::Archive> zip(Common::makeZipArchive(archive));
+
+		const char *const names[] = { "large.txt", "stored.txt" };
+		for (uint i = 0; i < ARRAYSIZE(names); ++i) {
+			archive->_bytesRead = 0;
+			Common::ScopedPtr<Common::SeekableReadStream> stream(zip->createReadStreamForMember(names[i]));
+			byte buffer[4096];
+			TS_ASSERT(stream && stream->read(buffer, sizeof(buffer)) == sizeof(buffer));
+
+			// Members used to be read whole, along with their inflated copy
+			TS_ASSERT_LESS_THAN(archive->_bytesRead, 64 * 1024u);
+		}
+#endif
+	}
+
+	void test_unzip_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_ZLIB)
+		Common::install_null_g_system();
+		buildZip();
+		Common::ScopedPtr<Common::Archive> zip(Common::makeZipArchive(new Common::MemoryReadStream(_zip.data(), _zip.size())));
+
+		// What opening a member used to do
+		uint32 start = g_system->getMillis();
+		byte *whole = new byte[kLargeSize];
+		TS_ASSERT(Common::inflateZlibHeaderless(whole, kLargeSize, _largeDeflated.data(), _largeDeflated.size()));
+		const uint32 wholeTime = g_system->getMillis() - start;
+		delete[] whole;
+
+		start = g_system->getMillis();
+		Common::ScopedPtr<Common::SeekableReadStream> stream(zip->createReadStreamForMember("large.txt"));
+		byte buffer[4096];
+		uint32 total = 0;
+		while (stream && !stream->eos())
+			total += stream->read(buffer, sizeof(buffer));
+		const uint32 streamTime = g_system->getMillis() - start;
+		TS_ASSERT_EQUALS(total, kLargeSize);
+
+		// Random seeks, through restart points and by restarting from the
+		// start of the member
+		uint32 seekTime[2];
+		for (int pass = 0; pass < 2; ++pass) {
+			Common::ScopedPtr<Common::SeekableReadStream> seekable(pass ?
+				Common::wrapDeflateReadStream(new Common::MemoryReadStream(_largeDeflated.data(), _largeDeflated.size()), DisposeAfterUse::YES, kLargeSize) :
+				zip->createReadStreamForMember("large.txt"));
+
+			// Decompress everything once, like a first pass through the data
+			seekable->seek(kLargeSize - 1);
+			start = g_system->getMillis();
+			uint32 seed = 5;
+			for (int i = 0; i < 50; ++i) {
+				seed = seed * 1103515245 + 12345;
+				TS_ASSERT(readsLike(*seekable, _large, (seed >> 8) % (kLargeSize - 100), 100));
+			}
+			seekTime[pass] = g_system->getMillis() - start;
+		}
+
+		debug("Inflating a %u KB member whole: %u ms, streaming it: %u ms, 50 random seeks with restart points: %u ms, without: %u ms",
+		      kLargeSize / 1024, wholeTime, streamTime, seekTime[0], seekTime[1]);
+#endif
+	}
+};
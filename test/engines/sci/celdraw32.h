@@ -0,0 +1,341 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/system.h"
+
+#include "engines/sci/graphics/celdraw32.h"
+#ifdef ENABLE_SCI32
+#include "engines/sci/graphics/celobj32.h"
+#endif
+
+#include "../../null_osystem.h"
+
+#ifdef ENABLE_SCI32
+/**
+ * A cel drawn from pixels in memory, stored like the cels of views. Cels from
+ * Mac games are still drawn a pixel at a time, so a cel without the colors 0
+ * and 255 gives the same pixels either way.
+ */
+class SciTestCel : public Sci::CelObj {
+	Common::Array<byte> _data;
+
+	static void writeRun(Common::Array<byte> &control, Common::Array<byte> &literals, const byte *row, int16 length) {
+		control.push_back(length);
+		for (int16 i = 0; i < length; ++i)
+			literals.push_back(row[i]);
+	}
+
+	// Rows are stored as runs of the skip color, runs of one color, and
+	// literal pixels
+	void compressRow(Common::Array<byte> &control, Common::Array<byte> &literals, const byte *row) const {
+		int16 x = 0, literalStart = 0;
+		while (x < _width) {
+			int16 run = 1;
+			while (x + run < _width && run < 0x3F && row[x + run] == row[x])
+				++run;
+
+			if (row[x] != _skipColor && run < 3) {
+				if (++x - literalStart == 0x7F) {
+					writeRun(control, literals, row + literalStart, x - literalStart);
+					literalStart = x;
+				}
+				continue;
+			}
+
+			if (x > literalStart)
+				writeRun(control, literals, row + literalStart, x - literalStart);
+			if (row[x] == _skipColor) {
+				control.push_back(0xC0 | run);
+			} else {
+				control.push_back(0x80 | run);
+				literals.push_back(row[x]);
+			}
+			x += run;
+			literalStart = x;
+		}
+		if (x > literalStart)
+			writeRun(control, literals, row + literalStart, x - literalStart);
+	}
+
+public:
+	SciTestCel(const byte *pixels, int16 width, int16 height, uint8 skipColor, bool transparent, bool compressed) {
+		_celHeaderOffset = 0;
+		_hunkPaletteOffset = 0;
+		_width = width;
+		_height = height;
+		_xResolution = Sci::kLowResX;
+		_yResolution = Sci::kLowResY;
+		_skipColor = skipColor;
+		_transparent = transparent;
+		_compressionType = compressed ? Sci::kCelCompressionRLE : Sci::kCelCompressionNone;
+		_remap = false;
+		_mirrorX = false;
+		_isMacSource = false;
+		_drawMirrored = false;
+
+		const uint32 kHeaderSize = 36;
+		_data.resize(kHeaderSize, 0);
+		if (!compressed) {
+			WRITE_LE_UINT32(&_data[24], kHeaderSize);
+			_data.resize(kHeaderSize + width * height);
+			memcpy(&_data[kHeaderSize], pixels, width * height);
+			return;
+		}
+
+		// The offsets of the rows of control bytes and literals, followed by
+		// all control bytes and all literals
+		Common::Array<byte> control, literals;
+		Common::Array<uint32> controlOffsets, literalOffsets;
+		for (int16 y = 0; y < height; ++y) {
+			controlOffsets.push_back(control.size());
+			literalOffsets.push_back(literals.size());
+			compressRow(control, literals, pixels + y * width);
+		}
+
+		const uint32 controlOffset = kHeaderSize;
+		const uint32 dataOffset = controlOffset + height * 8;
+		const uint32 literalsOffset = dataOffset + control.size();
+		WRITE_LE_UINT32(&_data[24], dataOffset);
+		WRITE_LE_UINT32(&_data[28], literalsOffset);
+		WRITE_LE_UINT32(&_data[32], controlOffset);
+		_data.resize(literalsOffset);
+		for (int16 y = 0; y < height; ++y) {
+			WRITE_LE_UINT32(&_data[controlOffset + y * 4], controlOffsets[y]);
+			WRITE_LE_UINT32(&_data[controlOffset + (height + y) * 4], literalOffsets[y]);
+		}
+		memcpy(&_data[dataOffset], control.begin(), control.size());
+		_data.push_back(literals);
+	}
+
+	void setDrawMirrored(bool mirrored) {
+		_drawMirrored = mirrored;
+	}
+
+	Sci::CelObj *duplicate() const override {
+		return new SciTestCel(*this);
+	}
+
+	const Sci::SciSpan<const byte> getResPointer() const override {
+		return Sci::SciSpan<const byte>(_data.begin(), _data.size());
+	}
+};
+#endif
+
+/**
+ * Checks the row kernels used to draw SCI32 cels without remapping against
+ * drawing them one pixel at a time, like the cel renderer does for all other
+ * cels, both on their own and when drawing cels through CelObj.
+ */
+class SciCelDraw32TestSuite : public CxxTest::TestSuite {
+	static const int kMaxWidth = 640;
+
+	uint32 _seed;
+
+	uint32 nextRandom(uint32 max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) % max;
+	}
+
+	static void referenceDraw(byte *target, const byte *source, int16 width, uint8 skipColor, bool flip, bool skip) {
+		for (int16 x = 0; x < width; ++x) {
+			const byte pixel = flip ? *source-- : *source++;
+			if (!skip || pixel != skipColor)
+				target[x] = pixel;
+		}
+	}
+
+	static void referenceScale(byte *target, const byte *row, const int16 *valuesX, int16 width) {
+		for (int16 x = 0; x < width; ++x)
+			target[x] = row[valuesX[x]];
+	}
+
+	// Source indexes for scaling a row of the given width up or down, like
+	// the tables of CelScaler
+	static void buildScaleTable(int16 *valuesX, int16 width, int16 sourceWidth, int numerator, int denominator, bool flip) {
+		for (int16 x = 0; x < width; ++x) {
+			int16 index = MIN<int>(x * denominator / numerator, sourceWidth - 1);
+			valuesX[x] = flip ? sourceWidth - 1 - index : index;
+		}
+	}
+
+	void fillRow(byte *row, uint32 width, uint8 skipColor) {
+		for (uint32 x = 0; x < width; ++x)
+			row[x] = nextRandom(4) == 0 ? skipColor : nextRandom(256);
+	}
+
+public:
+	void test_draw_span_matches_reference() {
+		byte source[kMaxWidth], expected[kMaxWidth], actual[kMaxWidth];
+
+		_seed = 1;
+		for (int i = 0; i < 500; ++i) {
+			const int16 width = 1 + nextRandom(kMaxWidth);
+			const uint8 skipColor = nextRandom(256);
+			fillRow(source, width, skipColor);
+			for (int16 x = 0; x < kMaxWidth; ++x)
+				expected[x] = actual[x] = nextRandom(256);
+
+			switch (i % 4) {
+			case 0:
+				referenceDraw(expected, source, width, skipColor, false, false);
+				Sci::drawCelSpan<false, false>(actual, source, width, skipColor);
+				break;
+			case 1:
+				referenceDraw(expected, source, width, skipColor, false, true);
+				Sci::drawCelSpan<false, true>(actual, source, width, skipColor);
+				break;
+			case 2:
+				referenceDraw(expected, source + width - 1, width, skipColor, true, false);
+				Sci::drawCelSpan<true, false>(actual, source + width - 1, width, skipColor);
+				break;
+			default:
+				referenceDraw(expected, source + width - 1, width, skipColor, true, true);
+				Sci::drawCelSpan<true, true>(actual, source + width - 1, width, skipColor);
+				break;
+			}
+
+			TSM_ASSERT(Common::String::format("row %d", i).c_str(), !memcmp(expected, actual, sizeof(expected)));
+		}
+	}
+
+	void test_scale_span_matches_reference() {
+		static const int ratios[][2] = { { 2, 1 }, { 3, 1 }, { 3, 2 }, { 1, 2 }, { 2, 3 }, { 1, 1 } };
+		byte row[kMaxWidth], expected[kMaxWidth], actual[kMaxWidth];
+		int16 valuesX[kMaxWidth];
+
+		_seed = 2;
+		for (int i = 0; i < 600; ++i) {
+			const int numerator = ratios[i % ARRAYSIZE(ratios)][0];
+			const int denominator = ratios[i % ARRAYSIZE(ratios)][1];
+			const int16 sourceWidth = 1 + nextRandom(kMaxWidth);
+			const int16 width = 1 + nextRandom(MIN<int>(kMaxWidth, sourceWidth * numerator / denominator + 1));
+			fillRow(row, sourceWidth, 0);
+			buildScaleTable(valuesX, width, sourceWidth, numerator, denominator, (i / ARRAYSIZE(ratios)) & 1);
+
+			memset(expected, 0, sizeof(expected));
+			memset(actual, 0, sizeof(actual));
+			referenceScale(expected, row, valuesX, width);
+			Sci::scaleCelSpan(actual, row, valuesX, width);
+
+			TSM_ASSERT(Common::String::format("row %d, %d/%d", i, numerator, denominator).c_str(), !memcmp(expected, actual, sizeof(expected)));
+		}
+	}
+
+	void test_celobj_matches_per_pixel_renderer() {
+#ifdef ENABLE_SCI32
+		static const int ratios[][2] = { { 1, 1 }, { 2, 1 }, { 3, 2 }, { 2, 3 } };
+		static const Common::Point positions[] = { Common::Point(17, 9), Common::Point(-13, -7), Common::Point(290, 180) };
+		const int16 width = 57, height = 41;
+		const uint8 skipColor = 250;
+
+		Sci::CelObj::init(false);
+		Sci::Buffer expected, actual;
+		expected.create(320, 200, Graphics::PixelFormat::createFormatCLUT8());
+		actual.create(320, 200, Graphics::PixelFormat::createFormatCLUT8());
+
+		_seed = 4;
+		byte pixels[width * height];
+		for (int transparent = 0; transparent < 2; ++transparent) {
+			// Colors that Mac cels do not swap, with runs of the skip color and
+			// of other colors
+			for (int i = 0; i < width * height; ++i) {
+				if (i && nextRandom(3) == 0)
+					pixels[i] = pixels[i - 1];
+				else if (transparent && nextRandom(4) == 0)
+					pixels[i] = skipColor;
+				else
+					pixels[i] = 1 + nextRandom(249);
+			}
+
+			for (int compressed = 0; compressed < 2; ++compressed) {
+				SciTestCel cel(pixels, width, height, skipColor, transparent, compressed);
+				bool sameCel = true;
+				for (int16 y = 0; y < height; ++y) {
+					for (int16 x = 0; x < width; ++x)
+						sameCel &= cel.readPixel(x, y, false) == pixels[y * width + x];
+				}
+				TS_ASSERT(sameCel);
+
+				for (int mirrored = 0; mirrored < 2; ++mirrored) {
+					cel.setDrawMirrored(mirrored);
+					for (int r = 0; r < ARRAYSIZE(ratios); ++r) {
+						const Sci::Ratio scale(ratios[r][0], ratios[r][1]);
+						for (int p = 0; p < ARRAYSIZE(positions); ++p) {
+							const Common::Point &position = positions[p];
+							Common::Rect targetRect(position.x, position.y, position.x + (scale * width).toInt(), position.y + (scale * height).toInt());
+							targetRect.clip(Common::Rect(actual.w, actual.h));
+
+							for (int i = 0; i < actual.w * actual.h; ++i)
+								((byte *)expected.getPixels())[i] = ((byte *)actual.getPixels())[i] = nextRandom(256);
+
+							// Mac cels are drawn by the per-pixel renderer
+							cel._isMacSource = true;
+							cel.drawScaled(expected, targetRect, position, scale, scale, false);
+							cel._isMacSource = false;
+							cel.drawScaled(actual, targetRect, position, scale, scale, false);
+
+							TSM_ASSERT(Common::String::format("%s%s%s cel at %d,%d scaled %d/%d", transparent ? "transparent " : "", compressed ? "compressed " : "", mirrored ? "mirrored " : "", position.x, position.y, ratios[r][0], ratios[r][1]).c_str(),
+							           !memcmp(expected.getPixels(), actual.getPixels(), actual.w * actual.h));
+						}
+					}
+				}
+			}
+		}
+
+		expected.free();
+		actual.free();
+		Sci::CelObj::deinit();
+#endif
+	}
+
+	void test_span_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+#ifdef SLOW_TESTS
+		const int frames = 2000;
+#else
+		const int frames = 20;
+#endif
+		// A 640x480 frame drawn from a 320x240 cel scaled up 2x, one row at
+		// a time
+		const int16 width = 640, height = 480;
+		byte *source = new byte[width / 2 * height / 2];
+		byte *screen = new byte[width * height];
+		int16 valuesX[width];
+		byte line[width];
+
+		_seed = 3;
+		fillRow(source, width / 2 * height / 2, 0);
+		buildScaleTable(valuesX, width, width / 2, 2, 1, false);
+
+		for (int pass = 0; pass < 2; ++pass) {
+			const uint32 start = g_system->getMillis();
+			for (int frame = 0; frame < frames; ++frame) {
+				int16 lastSourceY = -1;
+				for (int16 y = 0; y < height; ++y) {
+					byte *target = screen + y * width;
+					const byte *sourceRow = source + (y / 2) * (width / 2);
+					if (pass) {
+						if (y / 2 != lastSourceY) {
+							lastSourceY = y / 2;
+							Sci::scaleCelSpan(line, sourceRow, valuesX, width);
+						}
+						Sci::drawCelSpan<false, true>(target, line, width, 0);
+					} else {
+						for (int16 x = 0; x < width; ++x) {
+							const byte pixel = sourceRow[valuesX[x]];
+							if (pixel != 0)
+								target[x] = pixel;
+						}
+					}
+				}
+			}
+			debug("SCI32 2x cel drawing: %s: %d frames in %u ms", pass ? "row kernels" : "per pixel", frames, g_system->getMillis() - start);
+		}
+
+		delete[] screen;
+		delete[] source;
+#endif
+	}
+};
@@ -0,0 +1,609 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "engines/sci/resource/decompressor.h"
+
+#include "../../null_osystem.h"
+
+/**
+ * Decompresses synthetic resources, as well as broken ones, with the SCI
+ * Huffman and LZW decompressors and checks that they give the same results
+ * as the bit by bit decompressors they replaced.
+ */
+class SciDecompressorTestSuite : public CxxTest::TestSuite {
+	enum {
+		kDecompressionError = 7 // SCI_ERROR_DECOMPRESSION_ERROR
+	};
+
+	// The decompressors which were used before, down to how they read the
+	// stream and count read bytes. Two safety checks were added: they stop
+	// once past the end of dest, where they could only fail, and when LZW1
+	// token links form a loop.
+	class ReferenceDecompressor {
+	public:
+		ReferenceDecompressor(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) :
+			_src(src), _dest(dest), _szPacked(nPacked), _szUnpacked(nUnpacked),
+			_dwBits(0), _nBits(0), _dwRead(0), _dwWrote(0), _numbits(9), _curtoken(0x102), _endtoken(0x1ff), _loop(false) {}
+
+		int unpackHuffman() {
+			byte numnodes = _src->readByte();
+			uint16 terminator = _src->readByte() | 0x100;
+			_nodes = new byte[numnodes << 1];
+			_src->read(_nodes, numnodes << 1);
+
+			int16 c;
+			while ((c = getc2()) != terminator && (c >= 0) && !isFinished() && _dwWrote <= _szUnpacked)
+				putByte(c);
+
+			delete[] _nodes;
+			return _dwWrote == _szUnpacked ? 0 : 1;
+		}
+
+		int unpackLZW() {
+			uint16 tokenlastlength = 0;
+			Common::Array<uint16> tokenlist(4096), tokenlengthlist(4096);
+
+			while (!isFinished()) {
+				uint16 token = getBitsLSB(_numbits);
+				if (token == 0x101)
+					return 0;
+
+				if (token == 0x100) {
+					_numbits = 9;
+					_endtoken = 0x1FF;
+					_curtoken = 0x0102;
+				} else {
+					if (token > 0xff) {
+						if (token >= _curtoken)
+							return kDecompressionError;
+						tokenlastlength = tokenlengthlist[token] + 1;
+						if (_dwWrote + tokenlastlength > _szUnpacked) {
+							for (int i = 0; _dwWrote < _szUnpacked; i++)
+								putByte(_dest[tokenlist[token] + i]);
+						} else
+							for (int i = 0; i < tokenlastlength; i++)
+								putByte(_dest[tokenlist[token] + i]);
+					} else {
+						tokenlastlength = 1;
+						if (_dwWrote < _szUnpacked)
+							putByte(token);
+					}
+					if (_curtoken > _endtoken && _numbits < 12) {
+						_numbits++;
+						_endtoken = (_endtoken << 1) + 1;
+					}
+					if (_curtoken <= _endtoken) {
+						tokenlist[_curtoken] = _dwWrote - tokenlastlength;
+						tokenlengthlist[_curtoken] = tokenlastlength;
+						_curtoken++;
+					}
+				}
+			}
+
+			return _dwWrote == _szUnpacked ? 0 : kDecompressionError;
+		}
+
+		int unpackLZW1() {
+			struct Tokenlist {
+				byte data;
+				uint16 next;
+			};
+			Common::Array<byte> stak(0x1014);
+			Common::Array<Tokenlist> tokens(0x1004);
+			for (uint i = 0; i < tokens.size(); i++) {
+				tokens[i].data = 0;
+				tokens[i].next = 0;
+			}
+
+			byte lastchar = 0;
+			uint16 stakptr = 0, lastbits = 0;
+			byte decryptstart = 0;
+			uint16 bitstring, token;
+			bool bExit = false;
+
+			while (!isFinished() && !bExit && _dwWrote <= _szUnpacked) {
+				switch (decryptstart) {
+				case 0:
+					bitstring = getBitsMSB(_numbits);
+					if (bitstring == 0x101) {
+						bExit = true;
+						continue;
+					}
+					putByte(bitstring);
+					lastbits = bitstring;
+					lastchar = (bitstring & 0xff);
+					decryptstart = 1;
+					break;
+
+				case 1:
+					bitstring = getBitsMSB(_numbits);
+					if (bitstring == 0x101) {
+						bExit = true;
+						continue;
+					}
+					if (bitstring == 0x100) {
+						_numbits = 9;
+						_curtoken = 0x102;
+						_endtoken = 0x1ff;
+						decryptstart = 0;
+						continue;
+					}
+
+					token = bitstring;
+					if (token >= _curtoken) {
+						token = lastbits;
+						stak[stakptr++] = lastchar;
+					}
+					while ((token > 0xff) && (token < 0x1004)) {
+						if (stakptr == 0x1013) {
+							_loop = true;
+							return kDecompressionError;
+						}
+						stak[stakptr++] = tokens[token].data;
+						token = tokens[token].next;
+					}
+					lastchar = stak[stakptr++] = token & 0xff;
+					while (stakptr > 0) {
+						putByte(stak[--stakptr]);
+						if (_dwWrote == _szUnpacked) {
+							bExit = true;
+							continue;
+						}
+					}
+					if (_curtoken <= _endtoken) {
+						tokens[_curtoken].data = lastchar;
+						tokens[_curtoken].next = lastbits;
+						_curtoken++;
+						if (_curtoken == _endtoken && _numbits < 12) {
+							_numbits++;
+							_endtoken = (_endtoken << 1) + 1;
+						}
+					}
+					lastbits = bitstring;
+					break;
+
+				default:
+					break;
+				}
+			}
+
+			return _dwWrote == _szUnpacked ? 0 : kDecompressionError;
+		}
+
+		bool hitLoop() const { return _loop; }
+
+	private:
+		bool isFinished() {
+			return (_dwWrote == _szUnpacked) && (_dwRead >= _szPacked);
+		}
+
+		uint32 getBitsMSB(int n) {
+			if (_nBits < n) {
+				while (_nBits <= 24) {
+					_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
+					_nBits += 8;
+					_dwRead++;
+				}
+			}
+			uint32 ret = _dwBits >> (32 - n);
+			_dwBits <<= n;
+			_nBits -= n;
+			return ret;
+		}
+
+		uint32 getBitsLSB(int n) {
+			if (_nBits < n) {
+				while (_nBits <= 24) {
+					_dwBits |= ((uint32)_src->readByte()) << _nBits;
+					_nBits += 8;
+					_dwRead++;
+				}
+			}
+			uint32 ret = (_dwBits & ~(0xFFFFFFFFU << n));
+			_dwBits >>= n;
+			_nBits -= n;
+			return ret;
+		}
+
+		int16 getc2() {
+			byte *node = _nodes;
+			int16 next;
+			while (node[1]) {
+				if (getBitsMSB(1)) {
+					next = node[1] & 0x0F;
+					if (next == 0)
+						return getBitsMSB(8) | 0x100;
+				} else
+					next = node[1] >> 4;
+				node += next << 1;
+			}
+			return (int16)(*node | (node[1] << 8));
+		}
+
+		void putByte(byte b) {
+			_dest[_dwWrote++] = b;
+		}
+
+		Common::ReadStream *_src;
+		byte *_dest;
+		uint32 _szPacked, _szUnpacked;
+		uint32 _dwBits;
+		byte _nBits;
+		uint32 _dwRead, _dwWrote;
+		uint16 _numbits, _curtoken, _endtoken;
+		byte *_nodes;
+		bool _loop;
+	};
+
+	class BitWriter {
+	public:
+		BitWriter(bool msb) : _msb(msb), _bits(0), _count(0) {}
+
+		void put(uint32 value, int n) {
+			for (int i = 0; i < n; i++) {
+				const uint32 bit = _msb ? (value >> (n - 1 - i)) & 1 : (value >> i) & 1;
+				if (_msb)
+					_bits |= bit << (7 - _count);
+				else
+					_bits |= bit << _count;
+				if (++_count == 8)
+					flush();
+			}
+		}
+
+		Common::Array<byte> finish() {
+			if (_count)
+				flush();
+			return _data;
+		}
+
+	private:
+		void flush() {
+			_data.push_back(_bits);
+			_bits = 0;
+			_count = 0;
+		}
+
+		bool _msb;
+		byte _bits;
+		int _count;
+		Common::Array<byte> _data;
+	};
+
+	// The dictionary of an LZW encoder, keyed by the code of a string and the
+	// byte appended to it
+	typedef Common::HashMap<uint32, uint16> Dictionary;
+
+	static Common::Array<byte> encodeLZW(const Common::Array<byte> &data) {
+		BitWriter writer(false);
+		Dictionary dictionary;
+		uint16 numbits = 9, curtoken = 0x102, endtoken = 0x1ff;
+
+		uint i = 0;
+		while (i < data.size()) {
+			uint16 code = data[i++];
+			while (i < data.size()) {
+				Dictionary::const_iterator next = dictionary.find(code << 8 | data[i]);
+				if (next == dictionary.end())
+					break;
+				code = next->_value;
+				i++;
+			}
+			writer.put(code, numbits);
+
+			// Follows the decompressor, which adds the string plus the byte
+			// after it
+			if (curtoken > endtoken && numbits < 12) {
+				numbits++;
+				endtoken = (endtoken << 1) + 1;
+			}
+			if (curtoken <= endtoken) {
+				if (i < data.size())
+					dictionary[code << 8 | data[i]] = curtoken;
+				curtoken++;
+			}
+		}
+		writer.put(0x101, numbits);
+		return writer.finish();
+	}
+
+	static Common::Array<byte> encodeLZW1(const Common::Array<byte> &data) {
+		BitWriter writer(true);
+		Dictionary dictionary;
+		uint16 numbits = 9, curtoken = 0x102, endtoken = 0x1ff;
+
+		uint i = 0;
+		bool first = true;
+		while (i < data.size()) {
+			uint16 code = data[i++];
+			while (i < data.size()) {
+				Dictionary::const_iterator next = dictionary.find(code << 8 | data[i]);
+				if (next == dictionary.end())
+					break;
+				code = next->_value;
+				i++;
+			}
+			writer.put(code, numbits);
+
+			// The decompressor adds the string of the previous code plus the
+			// first byte of this one after reading this code
+			if (!first && curtoken <= endtoken) {
+				curtoken++;
+				if (curtoken == endtoken && numbits < 12) {
+					numbits++;
+					endtoken = (endtoken << 1) + 1;
+				}
+			}
+			first = false;
+			if (curtoken <= endtoken && i < data.size())
+				dictionary[code << 8 | data[i]] = curtoken;
+		}
+		writer.put(0x101, numbits);
+		return writer.finish();
+	}
+
+	// A comb shaped tree: the most common bytes get codes of 1 to count + 1
+	// bits, all others are stored as literals
+	static Common::Array<byte> encodeHuffman(const Common::Array<byte> &data, const byte *common, int count, byte terminator) {
+		Common::Array<byte> packed;
+		packed.push_back(count * 2);
+		packed.push_back(terminator);
+		for (int i = 0; i < count; i++) {
+			packed.push_back(0);
+			packed.push_back(i == count - 1 ? 0x10 : 0x12);
+			packed.push_back(common[i]);
+			packed.push_back(0);
+		}
+
+		BitWriter writer(true);
+		for (uint i = 0; i <= data.size(); i++) {
+			int leaf = -1;
+			if (i < data.size()) {
+				for (int j = 0; j < count; j++) {
+					if (common[j] == data[i]) {
+						leaf = j;
+						break;
+					}
+				}
+			}
+			if (leaf >= 0) {
+				writer.put((1 << leaf) - 1, leaf);
+				writer.put(0, 1);
+			} else {
+				writer.put((1 << count) - 1, count);
+				writer.put(i < data.size() ? data[i] : terminator, 8);
+			}
+		}
+
+		Common::Array<byte> bits = writer.finish();
+		for (uint i = 0; i < bits.size(); i++)
+			packed.push_back(bits[i]);
+		return packed;
+	}
+
+	uint32 _seed;
+
+	uint32 nextRandom(uint32 max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) % max;
+	}
+
+	// Runs, repeated phrases and noise, like the data of views and pics
+	Common::Array<byte> makeData(uint size) {
+		Common::Array<byte> data;
+		while (data.size() < size) {
+			switch (nextRandom(3)) {
+			case 0: {
+				const byte value = nextRandom(16);
+				for (uint i = nextRandom(40); i > 0; i--)
+					data.push_back(value);
+				break;
+			}
+			case 1:
+				if (data.size() > 20) {
+					const uint start = nextRandom(data.size() - 10);
+					const uint length = 3 + nextRandom(MIN<uint>(60, data.size() - start - 3));
+					for (uint i = 0; i < length; i++)
+						data.push_back(data[start + i]);
+				}
+				break;
+			default:
+				for (uint i = nextRandom(10); i > 0; i--)
+					data.push_back(nextRandom(256));
+				break;
+			}
+		}
+		data.resize(size);
+		return data;
+	}
+
+	Common::Array<byte> makeNoise(uint size) {
+		Common::Array<byte> data(size);
+		for (uint i = 0; i < size; i++)
+			data[i] = nextRandom(256);
+		return data;
+	}
+
+	// Decompresses packed data, followed by a few more bytes like in a
+	// resource volume, with both decompressors and compares the results.
+	// Returns false if the reference decompressor could not handle the data.
+	bool compare(int compression, const Common::Array<byte> &packed, uint32 nUnpacked, const char *what, uint32 *hash) {
+		Common::Array<byte> stream(packed);
+		for (int i = 0; i < 16; i++)
+			stream.push_back(0x5A ^ i);
+
+		Common::Array<byte> expected(nUnpacked + 0x2000, 0), actual(nUnpacked + 1, 0);
+
+		Common::MemoryReadStream referenceStream(stream.begin(), stream.size());
+		ReferenceDecompressor reference(&referenceStream, expected.begin(), packed.size(), nUnpacked);
+		int expectedResult;
+		if (compression == Sci::kCompHuffman)
+			expectedResult = reference.unpackHuffman();
+		else if (compression == Sci::kCompLZW)
+			expectedResult = reference.unpackLZW();
+		else
+			expectedResult = reference.unpackLZW1();
+		if (reference.hitLoop())
+			return false;
+
+		Common::MemoryReadStream stream2(stream.begin(), stream.size());
+		Sci::Decompressor *decompressor;
+		if (compression == Sci::kCompHuffman)
+			decompressor = new Sci::DecompressorHuffman();
+		else
+			decompressor = new Sci::DecompressorLZW(compression);
+		const int actualResult = decompressor->unpack(&stream2, actual.begin(), packed.size(), nUnpacked);
+		delete decompressor;
+
+		TSM_ASSERT_EQUALS(what, actualResult, expectedResult);
+		TSM_ASSERT(what, !memcmp(expected.begin(), actual.begin(), nUnpacked));
+		TSM_ASSERT_EQUALS(what, actual[nUnpacked], 0);
+
+		*hash = (*hash ^ actualResult) * 16777619;
+		for (uint32 i = 0; i < nUnpacked; i++)
+			*hash = (*hash ^ actual[i]) * 16777619;
+		return true;
+	}
+
+	Common::Array<byte> encode(int compression, const Common::Array<byte> &data) {
+		if (compression == Sci::kCompLZW)
+			return encodeLZW(data);
+		if (compression == Sci::kCompLZW1)
+			return encodeLZW1(data);
+
+		// The terminator gets a code of its own, so that it does not show up
+		// as a literal
+		byte common[24];
+		const int count = 1 + nextRandom(ARRAYSIZE(common));
+		for (int i = 0; i < count; i++)
+			common[i] = i < 16 ? i : nextRandom(256);
+		return encodeHuffman(data, common, count, common[count - 1]);
+	}
+
+public:
+	void test_round_trip() {
+		static const int compressions[] = { Sci::kCompLZW, Sci::kCompLZW1, Sci::kCompHuffman };
+
+		_seed = 1;
+		uint32 hash = 2166136261u;
+		for (int i = 0; i < 150; i++) {
+			const int compression = compressions[i % ARRAYSIZE(compressions)];
+			const Common::Array<byte> data = makeData(1 + nextRandom(i < 140 ? 4000 : 40000));
+			const Common::Array<byte> packed = encode(compression, data);
+			const Common::String what = Common::String::format("resource %d, compression %d", i, compression);
+
+			compare(compression, packed, data.size(), what.c_str(), &hash);
+
+			// The data should also come out as it went in
+			Common::MemoryReadStream stream(packed.begin(), packed.size());
+			Common::Array<byte> unpacked(data.size());
+			Sci::Decompressor *decompressor;
+			if (compression == Sci::kCompHuffman)
+				decompressor = new Sci::DecompressorHuffman();
+			else
+				decompressor = new Sci::DecompressorLZW(compression);
+			TSM_ASSERT_EQUALS(what.c_str(), decompressor->unpack(&stream, unpacked.begin(), packed.size(), data.size()), 0);
+			TSM_ASSERT(what.c_str(), !memcmp(unpacked.begin(), data.begin(), data.size()));
+			delete decompressor;
+		}
+
+		// Decompressed before the table driven decompressors were introduced
+		TS_ASSERT_EQUALS(hash, 1667870554u);
+	}
+
+	void test_broken_data() {
+		static const int compressions[] = { Sci::kCompLZW, Sci::kCompLZW1, Sci::kCompHuffman };
+
+		_seed = 2;
+		uint32 hash = 2166136261u;
+		int compared = 0;
+		for (int i = 0; i < 600; i++) {
+			const int compression = compressions[i % ARRAYSIZE(compressions)];
+			const Common::String what = Common::String::format("broken resource %d, compression %d", i, compression);
+			const Common::Array<byte> data = makeData(1 + nextRandom(3000));
+			Common::Array<byte> packed = encode(compression, data);
+			uint32 nUnpacked = data.size();
+
+			// Huffman trees stay intact, the decompressors go wherever they lead
+			const uint treeSize = compression == Sci::kCompHuffman ? 2 + packed[0] * 2 : 0;
+			switch ((i / ARRAYSIZE(compressions)) % 4) {
+			case 0: // wrong size
+				nUnpacked = MAX<int>(1, nUnpacked + (int)nextRandom(64) - 32);
+				break;
+			case 1: // truncated
+				packed.resize(MAX<uint>(treeSize + 1, packed.size() - nextRandom(packed.size() / 2 + 1)));
+				break;
+			case 2: // corrupted
+				for (int j = 1 + nextRandom(4); j > 0; j--)
+					packed[treeSize + nextRandom(packed.size() - treeSize)] ^= 1 << nextRandom(8);
+				break;
+			default: { // noise
+				const Common::Array<byte> noise = makeNoise(packed.size());
+				for (uint j = treeSize; j < packed.size(); j++)
+					packed[j] = noise[j];
+				break;
+			}
+			}
+
+			if (compare(compression, packed, nUnpacked, what.c_str(), &hash))
+				compared++;
+		}
+
+		TS_ASSERT_LESS_THAN(500, compared);
+		// Decompressed before the table driven decompressors were introduced
+		TS_ASSERT_EQUALS(hash, 2958964337u);
+	}
+
+	void test_decompressor_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+#ifdef SLOW_TESTS
+		const int resources = 2000;
+#else
+		const int resources = 50;
+#endif
+		static const int compressions[] = { Sci::kCompLZW, Sci::kCompLZW1, Sci::kCompHuffman };
+
+		for (int c = 0; c < ARRAYSIZE(compressions); c++) {
+			_seed = 3;
+			const Common::Array<byte> data = makeData(30000);
+			const Common::Array<byte> packed = encode(compressions[c], data);
+			Common::Array<byte> unpacked(data.size() + 0x2000);
+
+			uint32 referenceMillis = 0, millis = 0;
+			for (int pass = 0; pass < 2; pass++) {
+				const uint32 start = g_system->getMillis();
+				for (int i = 0; i < resources; i++) {
+					Common::MemoryReadStream stream(packed.begin(), packed.size());
+					if (pass) {
+						Sci::Decompressor *decompressor;
+						if (compressions[c] == Sci::kCompHuffman)
+							decompressor = new Sci::DecompressorHuffman();
+						else
+							decompressor = new Sci::DecompressorLZW(compressions[c]);
+						decompressor->unpack(&stream, unpacked.begin(), packed.size(), data.size());
+						delete decompressor;
+					} else {
+						ReferenceDecompressor reference(&stream, unpacked.begin(), packed.size(), data.size());
+						if (compressions[c] == Sci::kCompHuffman)
+							reference.unpackHuffman();
+						else if (compressions[c] == Sci::kCompLZW)
+							reference.unpackLZW();
+						else
+							reference.unpackLZW1();
+					}
+				}
+				(pass ? millis : referenceMillis) = g_system->getMillis() - start;
+			}
+			debug("SCI decompression %d: %d resources of %d bytes: %u ms bit by bit, %u ms table driven",
+				  compressions[c], resources, data.size(), referenceMillis, millis);
+		}
+#endif
+	}
+};
@@ -0,0 +1,314 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/stack.h"
+#include "common/system.h"
+
+#include "engines/sci/graphics/floodfill.h"
+
+#include "../../null_osystem.h"
+
+/**
+ * Draws synthetic vector pictures and fills areas of them with both the
+ * scanline flood fill and the pixel based flood fill it replaced, and checks
+ * that all planes come out the same.
+ */
+class SciFloodFillTestSuite : public CxxTest::TestSuite {
+	static const int kWidth = 320;
+	static const int kHeight = 190;
+	static const int kPixels = kWidth * kHeight;
+
+	enum {
+		kMaskVisual = 1,
+		kMaskPriority = 2,
+		kMaskControl = 4
+	};
+
+	struct Screen {
+		byte visual[kPixels];
+		byte priority[kPixels];
+		byte control[kPixels];
+		byte display[kPixels * 4];
+		byte paletteMap[kPixels];
+
+		Sci::FloodFillPlanes planes(bool upscaled) {
+			Sci::FloodFillPlanes p;
+			p.visual = visual;
+			p.priority = priority;
+			p.control = control;
+			p.width = kWidth;
+			p.display = display;
+			p.displayWidth = upscaled ? kWidth * 2 : kWidth;
+			p.displayUpscaled = upscaled;
+			p.paletteMap = paletteMap;
+			p.paletteMapValue = 7;
+			return p;
+		}
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom(uint32 max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) % max;
+	}
+
+	static byte visibleColor(byte color, int16 x, int16 y) {
+		if ((x ^ y) & 1)
+			return (color ^ (color >> 4)) & 0x0F;
+		return color & 0x0F;
+	}
+
+	// The pixel based flood fill which was used before, down to the order
+	// in which it visits pixels
+	static byte referenceMatch(const Sci::FloodFillPlanes &planes, const Sci::FloodFillParams &params, int16 x, int16 y) {
+		const int offset = y * planes.width + x;
+		if (params.matchMask & kMaskVisual) {
+			byte color = planes.visual[offset];
+			if (params.isEGA)
+				color = visibleColor(color, x, y);
+			return color == params.searchColor;
+		}
+		if (params.matchMask & kMaskPriority)
+			return planes.priority[offset] == params.searchPriority;
+		return planes.control[offset] == params.searchControl;
+	}
+
+	static void referencePutPixel(const Sci::FloodFillPlanes &planes, const Sci::FloodFillParams &params, int16 x, int16 y) {
+		const int offset = y * planes.width + x;
+		if (params.drawMask & kMaskVisual) {
+			planes.visual[offset] = params.color;
+			planes.paletteMap[offset] = planes.paletteMapValue;
+			if (planes.displayUpscaled) {
+				const int displayOffset = (y * 2) * planes.displayWidth + x * 2;
+				planes.display[displayOffset] = params.color;
+				planes.display[displayOffset + 1] = params.color;
+				planes.display[displayOffset + planes.displayWidth] = params.color;
+				planes.display[displayOffset + planes.displayWidth + 1] = params.color;
+			} else {
+				planes.display[offset] = params.color;
+			}
+		}
+		if (params.drawMask & kMaskPriority)
+			planes.priority[offset] = params.priority;
+		if (params.drawMask & kMaskControl)
+			planes.control[offset] = params.control;
+	}
+
+	static void referenceFloodFill(const Sci::FloodFillPlanes &planes, const Sci::FloodFillParams &params, int16 x, int16 y, const Common::Rect &border) {
+		Common::Stack<Common::Point> stack;
+		Common::Point p(x, y), p1;
+		const int16 borderLeft = border.left, borderTop = border.top;
+		const int16 borderRight = border.right - 1, borderBottom = border.bottom - 1;
+
+		stack.push(p);
+		while (stack.size()) {
+			p = stack.pop();
+			if (!referenceMatch(planes, params, p.x, p.y))
+				continue;
+			referencePutPixel(planes, params, p.x, p.y);
+			int16 curToLeft = p.x;
+			int16 curToRight = p.x;
+			while (curToLeft > borderLeft && referenceMatch(planes, params, curToLeft - 1, p.y))
+				referencePutPixel(planes, params, --curToLeft, p.y);
+			while (curToRight < borderRight && referenceMatch(planes, params, curToRight + 1, p.y))
+				referencePutPixel(planes, params, ++curToRight, p.y);
+
+			int a_set = 0, b_set = 0;
+			while (curToLeft <= curToRight) {
+				if (p.y > borderTop && referenceMatch(planes, params, curToLeft, p.y - 1)) {
+					if (a_set == 0) {
+						p1.x = curToLeft;
+						p1.y = p.y - 1;
+						stack.push(p1);
+						a_set = 1;
+					}
+				} else
+					a_set = 0;
+
+				if (p.y < borderBottom && referenceMatch(planes, params, curToLeft, p.y + 1)) {
+					if (b_set == 0) {
+						p1.x = curToLeft;
+						p1.y = p.y + 1;
+						stack.push(p1);
+						b_set = 1;
+					}
+				} else
+					b_set = 0;
+				curToLeft++;
+			}
+		}
+	}
+
+	// Outlines of boxes, lines and dots, like the line work of a picture
+	void drawScene(Screen &screen, bool isEGA) {
+		memset(screen.visual, isEGA ? 0x0F : 0xFF, kPixels);
+		memset(screen.priority, 0, kPixels);
+		memset(screen.control, 0, kPixels);
+		memset(screen.display, 0, sizeof(screen.display));
+		memset(screen.paletteMap, 0, kPixels);
+
+		const int shapes = 20 + nextRandom(40);
+		for (int i = 0; i < shapes; i++) {
+			const byte mask = 1 + nextRandom(7);
+			const byte color = isEGA ? (byte)nextRandom(0x100) : (byte)nextRandom(0xFF);
+			const byte priority = 1 + nextRandom(15);
+			const byte control = 1 + nextRandom(15);
+			int16 x1 = nextRandom(kWidth), y1 = nextRandom(kHeight);
+			int16 x2 = nextRandom(kWidth), y2 = nextRandom(kHeight);
+
+			switch (nextRandom(3)) {
+			case 0: // box outline
+				for (int16 x = MIN(x1, x2); x <= MAX(x1, x2); x++) {
+					putPixel(screen, mask, x, y1, color, priority, control);
+					putPixel(screen, mask, x, y2, color, priority, control);
+				}
+				for (int16 y = MIN(y1, y2); y <= MAX(y1, y2); y++) {
+					putPixel(screen, mask, x1, y, color, priority, control);
+					putPixel(screen, mask, x2, y, color, priority, control);
+				}
+				break;
+			case 1: { // line
+				const int steps = MAX(ABS(x2 - x1), ABS(y2 - y1));
+				for (int s = 0; s <= steps; s++) {
+					int16 x = x1 + (steps ? (x2 - x1) * s / steps : 0);
+					int16 y = y1 + (steps ? (y2 - y1) * s / steps : 0);
+					putPixel(screen, mask, x, y, color, priority, control);
+				}
+				break;
+			}
+			default: // dots
+				for (int d = 0; d < 50; d++)
+					putPixel(screen, mask, nextRandom(kWidth), nextRandom(kHeight), color, priority, control);
+				break;
+			}
+		}
+	}
+
+	static void putPixel(Screen &screen, byte mask, int16 x, int16 y, byte color, byte priority, byte control) {
+		const int offset = y * kWidth + x;
+		if (mask & kMaskVisual)
+			screen.visual[offset] = color;
+		if (mask & kMaskPriority)
+			screen.priority[offset] = priority;
+		if (mask & kMaskControl)
+			screen.control[offset] = control;
+	}
+
+	// Picks a fill which does not match the pixels it fills, like the abort
+	// rules of GfxPicture::vectorFloodFill() ensure
+	bool pickFill(Screen &screen, bool isEGA, int16 x, int16 y, Sci::FloodFillParams &params) {
+		const int offset = y * kWidth + x;
+		params.isEGA = isEGA;
+		params.drawMask = 1 + nextRandom(7);
+		params.color = nextRandom(0x100);
+		params.priority = nextRandom(16);
+		params.control = nextRandom(16);
+		params.searchColor = isEGA ? visibleColor(screen.visual[offset], x, y) : screen.visual[offset];
+		params.searchPriority = screen.priority[offset];
+		params.searchControl = screen.control[offset];
+
+		if ((params.drawMask & kMaskVisual) && params.color != params.searchColor)
+			params.matchMask = kMaskVisual;
+		else if ((params.drawMask & kMaskPriority) && params.priority != params.searchPriority)
+			params.matchMask = kMaskPriority;
+		else if ((params.drawMask & kMaskControl) && params.control != params.searchControl)
+			params.matchMask = kMaskControl;
+		else
+			return false;
+
+		if (params.matchMask == kMaskVisual && isEGA &&
+			(visibleColor(params.color, 0, 0) == params.searchColor || visibleColor(params.color, 1, 0) == params.searchColor))
+			return false;
+		return true;
+	}
+
+	static uint32 hashScreen(const Screen &screen, uint32 hash) {
+		const byte *data = (const byte *)&screen;
+		for (uint32 i = 0; i < sizeof(Screen); i++)
+			hash = (hash ^ data[i]) * 16777619;
+		return hash;
+	}
+
+public:
+	void test_fill_matches_reference() {
+		Screen *reference = new Screen();
+		Screen *scanline = new Screen();
+		const Common::Rect borders[] = {
+			Common::Rect(0, 0, kWidth, kHeight), Common::Rect(0, 10, kWidth, kHeight), Common::Rect(17, 23, 301, 170)
+		};
+
+		_seed = 1;
+		uint32 hash = 2166136261u;
+		for (int scene = 0; scene < 60; scene++) {
+			const bool isEGA = (scene & 1) != 0;
+			const bool upscaled = (scene % 3) == 2;
+			const Common::Rect &border = borders[scene % ARRAYSIZE(borders)];
+
+			drawScene(*reference, isEGA);
+			memcpy(scanline, reference, sizeof(Screen));
+
+			for (int fill = 0; fill < 30; fill++) {
+				const int16 x = border.left + nextRandom(border.width());
+				const int16 y = border.top + nextRandom(border.height());
+				Sci::FloodFillParams params;
+				if (!pickFill(*reference, isEGA, x, y, params))
+					continue;
+
+				referenceFloodFill(reference->planes(upscaled), params, x, y, border);
+				Sci::floodFill(scanline->planes(upscaled), params, x, y, border);
+			}
+
+			TSM_ASSERT(Common::String::format("scene %d", scene).c_str(), !memcmp(reference, scanline, sizeof(Screen)));
+			hash = hashScreen(*scanline, hash);
+		}
+
+		// Rendered before the scanline flood fill was introduced
+		TS_ASSERT_EQUALS(hash, 1506897724u);
+
+		delete scanline;
+		delete reference;
+	}
+
+	void test_fill_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+#ifdef SLOW_TESTS
+		const int scenes = 2000;
+#else
+		const int scenes = 50;
+#endif
+		Screen *screen = new Screen();
+		Screen *original = new Screen();
+		const Common::Rect border(0, 10, kWidth, kHeight);
+
+		for (int pass = 0; pass < 2; pass++) {
+			_seed = 2;
+			uint32 millis = 0;
+			for (int scene = 0; scene < scenes; scene++) {
+				drawScene(*original, false);
+				memcpy(screen, original, sizeof(Screen));
+
+				const uint32 start = g_system->getMillis();
+				for (int fill = 0; fill < 30; fill++) {
+					const int16 x = nextRandom(kWidth);
+					const int16 y = border.top + nextRandom(border.height());
+					Sci::FloodFillParams params;
+					if (!pickFill(*screen, false, x, y, params))
+						continue;
+					if (pass)
+						Sci::floodFill(screen->planes(false), params, x, y, border);
+					else
+						referenceFloodFill(screen->planes(false), params, x, y, border);
+				}
+				millis += g_system->getMillis() - start;
+			}
+			debug("SCI flood fill: %s: %d scenes in %u ms", pass ? "scanline" : "pixel based", scenes, millis);
+		}
+
+		delete original;
+		delete screen;
+#endif
+	}
+};
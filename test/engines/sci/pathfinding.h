@@ -0,0 +1,409 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/list.h"
+#include "common/system.h"
+
+#include "engines/sci/engine/pathfinding.h"
+
+#include "../../null_osystem.h"
+
+/**
+ * Runs the A* pathfinder over stored and synthetic polygon sets, and checks
+ * that it finds the same paths as the list based pathfinder it replaced,
+ * whether the visibility graph is cached across calls or not.
+ */
+class SciPathfindingTestSuite : public CxxTest::TestSuite {
+	static const int kWidth = 320;
+	static const int kHeight = 190;
+
+	struct Scene {
+		Common::Array<Common::Point> points;
+		Common::Array<uint> sizes;
+	};
+
+	// The vertices of a scene as the pathfinder sees them: extra vertices
+	// first, then the vertices of the polygons
+	struct ReferenceGraph {
+		Common::Array<Common::Point> v;
+		Common::Array<int> prev, next;
+
+		ReferenceGraph(const Scene &scene, const Common::Point *extra, uint extraCount) {
+			for (uint i = 0; i < extraCount; i++)
+				addVertex(extra[i], v.size(), v.size());
+			uint first = 0;
+			for (uint p = 0; p < scene.sizes.size(); p++) {
+				const uint size = scene.sizes[p];
+				const int base = v.size();
+				for (uint i = 0; i < size; i++)
+					addVertex(scene.points[first + i], base + (i + size - 1) % size, base + (i + 1) % size);
+				first += size;
+			}
+		}
+
+		void addVertex(const Common::Point &p, int prevVertex, int nextVertex) {
+			v.push_back(p);
+			prev.push_back(prevVertex);
+			next.push_back(nextVertex);
+		}
+
+		bool hasEdges(int vertex) const { return next[vertex] != vertex; }
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom(uint32 max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) % max;
+	}
+
+	// The pathfinder which was used before, a list based open set and
+	// visibility computed from scratch for every expanded vertex
+	static bool referenceInside(const ReferenceGraph &g, const Common::Point &p, int vertex) {
+		if (g.hasEdges(vertex)) {
+			const Common::Point &prev = g.v[g.prev[vertex]];
+			const Common::Point &next = g.v[g.next[vertex]];
+			const Common::Point &cur = g.v[vertex];
+
+			if (Sci::left(prev, cur, next)) {
+				if (Sci::left(cur, next, p) && Sci::left(prev, cur, p))
+					return true;
+			} else {
+				if (Sci::left(cur, next, p) || Sci::left(prev, cur, p))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	static Common::List<int> referenceVisibleVertices(const ReferenceGraph &g, int cur) {
+		Common::List<int> visVerts;
+		const int count = g.v.size();
+
+		for (int i = 0; i < count; i++) {
+			if (i == cur || referenceInside(g, g.v[i], cur) || referenceInside(g, g.v[cur], i))
+				continue;
+
+			int j;
+			for (j = 0; j < count; j++) {
+				if (g.hasEdges(j)) {
+					if (Sci::between(g.v[cur], g.v[i], g.v[j])) {
+						if (referenceInside(g, g.v[cur], j) || referenceInside(g, g.v[i], j))
+							break;
+						continue;
+					}
+
+					if (Sci::intersect_proper(g.v[cur], g.v[i], g.v[j], g.v[g.next[j]]))
+						break;
+				}
+			}
+
+			if (j == count)
+				visVerts.push_front(i);
+		}
+
+		return visVerts;
+	}
+
+	static bool contains(const Common::List<int> &list, int vertex) {
+		for (Common::List<int>::const_iterator it = list.begin(); it != list.end(); ++it) {
+			if (*it == vertex)
+				return true;
+		}
+		return false;
+	}
+
+	static void referenceAStar(const ReferenceGraph &g, int start, int end, const Common::Array<uint32> &penalties, Common::Array<int> &pathPrev) {
+		const int count = g.v.size();
+		Common::Array<uint32> costF, costG;
+		costF.resize(count);
+		costG.resize(count);
+		pathPrev.resize(count);
+		for (int i = 0; i < count; i++) {
+			costG[i] = 0xFFFFFFFF;
+			pathPrev[i] = -1;
+		}
+
+		Common::List<int> closedSet, openSet;
+		openSet.push_front(start);
+		costG[start] = 0;
+		costF[start] = (uint32)sqrt((float)g.v[start].sqrDist(g.v[end]));
+
+		while (!openSet.empty()) {
+			Common::List<int>::iterator minIt = openSet.end();
+			uint32 min = 0xFFFFFFFF;
+			for (Common::List<int>::iterator it = openSet.begin(); it != openSet.end(); ++it) {
+				if (costF[*it] < min) {
+					minIt = it;
+					min = costF[*it];
+				}
+			}
+
+			const int vertexMin = *minIt;
+			if (vertexMin == end)
+				break;
+
+			closedSet.push_front(vertexMin);
+			openSet.erase(minIt);
+
+			Common::List<int> visVerts = referenceVisibleVertices(g, vertexMin);
+			for (Common::List<int>::iterator it = visVerts.begin(); it != visVerts.end(); ++it) {
+				const int vertex = *it;
+				if (contains(closedSet, vertex))
+					continue;
+				if (!contains(openSet, vertex))
+					openSet.push_front(vertex);
+
+				uint32 newDist = costG[vertexMin] + (uint32)sqrt((float)g.v[vertexMin].sqrDist(g.v[vertex]));
+				newDist += penalties[vertex];
+
+				if (newDist < costG[vertex]) {
+					costG[vertex] = newDist;
+					costF[vertex] = costG[vertex] + (uint32)sqrt((float)g.v[vertex].sqrDist(g.v[end]));
+					pathPrev[vertex] = vertexMin;
+				}
+			}
+		}
+	}
+
+	static void computePenalties(const ReferenceGraph &g, Common::Array<uint32> &penalties) {
+		penalties.resize(g.v.size());
+		for (uint i = 0; i < g.v.size(); i++) {
+			const Common::Point &p = g.v[i];
+			const bool onBorder = p.x == 0 || p.x == kWidth - 1 || p.y == 0 || p.y == kHeight - 1;
+			penalties[i] = onBorder ? 10000 : 0;
+		}
+	}
+
+	// Orders the vertices anti-clockwise, or clockwise for contained access
+	// polygons, like the polygons given to the pathfinder
+	static void addPolygon(Scene &scene, const Common::Point *points, uint count, bool containedAccess) {
+		int size = 0;
+		for (uint i = 1; i + 1 < count; i++)
+			size += Sci::area(points[0], points[i], points[i + 1]);
+
+		const bool reverse = (size > 0 && containedAccess) || (size < 0 && !containedAccess);
+		for (uint i = 0; i < count; i++)
+			scene.points.push_back(points[reverse ? count - 1 - i : i]);
+		scene.sizes.push_back(count);
+	}
+
+	// Polygon sets like the ones of actual rooms
+	Scene storedScene(int index) {
+		Scene scene;
+		switch (index) {
+		case 0: {
+			// Walkable area of the room, with a table and a pillar
+			const Common::Point room[] = {
+				Common::Point(0, 189), Common::Point(0, 120), Common::Point(60, 95), Common::Point(140, 95),
+				Common::Point(150, 80), Common::Point(250, 80), Common::Point(319, 110), Common::Point(319, 189)
+			};
+			const Common::Point table[] = {
+				Common::Point(100, 130), Common::Point(180, 130), Common::Point(190, 150), Common::Point(90, 150)
+			};
+			const Common::Point pillar[] = {
+				Common::Point(230, 120), Common::Point(245, 120), Common::Point(245, 160), Common::Point(230, 160)
+			};
+			addPolygon(scene, room, ARRAYSIZE(room), true);
+			addPolygon(scene, table, ARRAYSIZE(table), false);
+			addPolygon(scene, pillar, ARRAYSIZE(pillar), false);
+			break;
+		}
+		case 1: {
+			// Corridor with a U-shaped obstacle
+			const Common::Point obstacle[] = {
+				Common::Point(80, 40), Common::Point(240, 40), Common::Point(240, 150), Common::Point(200, 150),
+				Common::Point(200, 80), Common::Point(120, 80), Common::Point(120, 150), Common::Point(80, 150)
+			};
+			const Common::Point wall[] = {
+				Common::Point(0, 0), Common::Point(319, 0), Common::Point(319, 20), Common::Point(0, 20)
+			};
+			addPolygon(scene, obstacle, ARRAYSIZE(obstacle), false);
+			addPolygon(scene, wall, ARRAYSIZE(wall), false);
+			break;
+		}
+		default: {
+			// Collinear edges and touching polygons
+			const Common::Point a[] = {
+				Common::Point(50, 50), Common::Point(100, 50), Common::Point(150, 50), Common::Point(150, 100), Common::Point(50, 100)
+			};
+			const Common::Point b[] = {
+				Common::Point(150, 100), Common::Point(200, 100), Common::Point(200, 150), Common::Point(150, 150)
+			};
+			const Common::Point c[] = {
+				Common::Point(20, 170), Common::Point(300, 170), Common::Point(300, 175)
+			};
+			const Common::Point dot(250, 60);
+			addPolygon(scene, a, ARRAYSIZE(a), false);
+			addPolygon(scene, b, ARRAYSIZE(b), false);
+			addPolygon(scene, c, ARRAYSIZE(c), false);
+			addPolygon(scene, &dot, 1, false);
+			break;
+		}
+		}
+		return scene;
+	}
+
+	// Random star shaped obstacles, which may overlap
+	Scene randomScene() {
+		Scene scene;
+		const int polygons = 1 + nextRandom(8);
+		for (int p = 0; p < polygons; p++) {
+			const int cx = 20 + nextRandom(kWidth - 40), cy = 20 + nextRandom(kHeight - 40);
+			const int count = 3 + nextRandom(7);
+			Common::Point points[10];
+			for (int i = 0; i < count; i++) {
+				const float angle = (float)(i * 2 * M_PI / count);
+				const int radius = 5 + nextRandom(40);
+				points[i].x = CLIP<int>(cx + (int)(cos(angle) * radius), 0, kWidth - 1);
+				points[i].y = CLIP<int>(cy + (int)(sin(angle) * radius), 0, kHeight - 1);
+			}
+			addPolygon(scene, points, count, false);
+		}
+		return scene;
+	}
+
+	Common::Point randomPoint() {
+		return Common::Point(nextRandom(kWidth), nextRandom(kHeight));
+	}
+
+	static uint32 hashPath(const Common::Array<int> &pathPrev, int end, uint32 hash) {
+		for (int vertex = end; vertex >= 0; vertex = pathPrev[vertex])
+			hash = (hash ^ (uint32)vertex) * 16777619;
+		return (hash ^ 0xFF) * 16777619;
+	}
+
+	// Finds paths between random points and vertices of the scene, with
+	// the pathfinder using both a fresh and a cached visibility graph
+	uint32 checkScene(const Scene &scene, Sci::VisibilityGraph &cached, uint32 hash) {
+		Sci::VisibilityGraph fresh;
+		for (uint i = 0, first = 0; i < scene.sizes.size(); first += scene.sizes[i], i++)
+			fresh.addPolygon(scene.points.begin() + first, scene.sizes[i]);
+
+		if (!cached.hasPolygons(scene.points, scene.sizes)) {
+			cached.clear();
+			for (uint i = 0, first = 0; i < scene.sizes.size(); first += scene.sizes[i], i++)
+				cached.addPolygon(scene.points.begin() + first, scene.sizes[i]);
+		}
+
+		for (int query = 0; query < 12; query++) {
+			Common::Point extra[2];
+			const uint extraCount = nextRandom(3);
+			for (uint i = 0; i < extraCount; i++)
+				extra[i] = randomPoint();
+
+			ReferenceGraph reference(scene, extra, extraCount);
+			const int count = reference.v.size();
+			if (count < 2)
+				continue;
+			const int start = nextRandom(count);
+			const int end = nextRandom(count);
+
+			Common::Array<uint32> penalties;
+			computePenalties(reference, penalties);
+
+			Common::Array<int> expected, pathFresh, pathCached;
+			referenceAStar(reference, start, end, penalties, expected);
+
+			fresh.setExtraVertices(extra, extraCount);
+			cached.setExtraVertices(extra, extraCount);
+			TS_ASSERT_EQUALS((int)fresh.size(), count);
+			Sci::findShortestPath(fresh, start, end, penalties, pathFresh);
+			Sci::findShortestPath(cached, start, end, penalties, pathCached);
+
+			for (int i = end; i >= 0; i = expected[i]) {
+				TS_ASSERT_EQUALS(pathFresh[i], expected[i]);
+				TS_ASSERT_EQUALS(pathCached[i], expected[i]);
+			}
+			hash = hashPath(expected, end, hash);
+		}
+		return hash;
+	}
+
+public:
+	void test_visibility_matches_reference() {
+		_seed = 3;
+		for (int s = 0; s < 20; s++) {
+			const Scene scene = s < 3 ? storedScene(s) : randomScene();
+			const Common::Point extra[] = { randomPoint(), randomPoint() };
+			ReferenceGraph reference(scene, extra, ARRAYSIZE(extra));
+
+			Sci::VisibilityGraph graph;
+			for (uint i = 0, first = 0; i < scene.sizes.size(); first += scene.sizes[i], i++)
+				graph.addPolygon(scene.points.begin() + first, scene.sizes[i]);
+			graph.setExtraVertices(extra, ARRAYSIZE(extra));
+
+			for (uint cur = 0; cur < reference.v.size(); cur++) {
+				Common::List<int> visible = referenceVisibleVertices(reference, cur);
+				for (uint i = 0; i < reference.v.size(); i++)
+					TS_ASSERT_EQUALS(graph.isVisible(cur, i), contains(visible, i));
+			}
+		}
+	}
+
+	void test_paths_match_reference() {
+		Sci::VisibilityGraph cached;
+		uint32 hash = 2166136261u;
+
+		_seed = 1;
+		for (int s = 0; s < 3; s++) {
+			const Scene scene = storedScene(s);
+			// Every scene twice, so that the cached graph gets reused
+			hash = checkScene(scene, cached, hash);
+			hash = checkScene(scene, cached, hash);
+		}
+		for (int s = 0; s < 40; s++) {
+			const Scene scene = randomScene();
+			hash = checkScene(scene, cached, hash);
+			hash = checkScene(scene, cached, hash);
+		}
+
+		// Paths found before the heap based open set was introduced
+		TS_ASSERT_EQUALS(hash, 3094076024u);
+	}
+
+	void test_pathfinding_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+#ifdef SLOW_TESTS
+		const int queries = 2000;
+#else
+		const int queries = 100;
+#endif
+		_seed = 2;
+		Scene scene;
+		for (int i = 0; i < 4; i++) {
+			const Scene part = randomScene();
+			for (uint j = 0, first = 0; j < part.sizes.size(); first += part.sizes[j], j++)
+				addPolygon(scene, part.points.begin() + first, part.sizes[j], false);
+		}
+
+		Common::Array<Common::Point> extras;
+		for (int i = 0; i < queries * 2; i++)
+			extras.push_back(randomPoint());
+
+		Sci::VisibilityGraph cached;
+		for (uint i = 0, first = 0; i < scene.sizes.size(); first += scene.sizes[i], i++)
+			cached.addPolygon(scene.points.begin() + first, scene.sizes[i]);
+
+		for (int pass = 0; pass < 2; pass++) {
+			const uint32 start = g_system->getMillis();
+			for (int q = 0; q < queries; q++) {
+				ReferenceGraph reference(scene, &extras[q * 2], 2);
+				Common::Array<uint32> penalties;
+				computePenalties(reference, penalties);
+				Common::Array<int> pathPrev;
+				if (pass) {
+					cached.setExtraVertices(&extras[q * 2], 2);
+					Sci::findShortestPath(cached, 0, 1, penalties, pathPrev);
+				} else {
+					referenceAStar(reference, 0, 1, penalties, pathPrev);
+				}
+			}
+			debug("SCI pathfinding: %s: %d paths over %d vertices in %u ms", pass ? "heap, cached graph" : "list, no cache",
+				queries, scene.points.size() + 2, g_system->getMillis() - start);
+		}
+#endif
+	}
+};
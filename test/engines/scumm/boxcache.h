@@ -0,0 +1,77 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/scumm/box-cache.h"
+
+class BoxCacheTestSuite : public CxxTest::TestSuite {
+	static Scumm::BoxCoords makeBox(int16 left, int16 top, int16 right, int16 bottom) {
+		Scumm::BoxCoords box;
+		box.ul = Common::Point(left, top);
+		box.ur = Common::Point(right, top);
+		box.ll = Common::Point(left, bottom);
+		box.lr = Common::Point(right, bottom);
+		return box;
+	}
+
+public:
+	void test_candidates() {
+		Scumm::BoxCache cache;
+		TS_ASSERT(!cache.isValid());
+
+		cache.reset(3);
+		cache.setBox(0, makeBox(0, 0, 99, 49));
+		cache.setBox(1, makeBox(100, 0, 319, 49));
+		cache.setBox(2, makeBox(50, 50, 150, 199));
+		cache.finalize();
+		TS_ASSERT(cache.isValid());
+
+		// Every box must be reported for each point inside its bounds
+		for (int box = 0; box < 3; box++) {
+			const Scumm::BoxCoords &c = cache.getCoords(box);
+			for (int y = c.ul.y; y <= c.ll.y; y += 7) {
+				for (int x = c.ul.x; x <= c.ur.x; x += 7) {
+					TS_ASSERT(cache.isCandidate(cache.getCandidates(x, y), box));
+					TS_ASSERT(!cache.isOutsideBounds(box, x, y));
+				}
+			}
+		}
+
+		// Far corners of the room only overlap the boxes next to them
+		const uint64 candidates = cache.getCandidates(319, 0);
+		TS_ASSERT(cache.isCandidate(candidates, 1));
+		TS_ASSERT(!cache.isCandidate(candidates, 0));
+		TS_ASSERT(!cache.isCandidate(candidates, 2));
+		TS_ASSERT_EQUALS(cache.getCandidates(320, 0), 0u);
+		TS_ASSERT_EQUALS(cache.getCandidates(10, 199) & 1, 0u);
+		TS_ASSERT(cache.isOutsideBounds(2, 151, 100));
+
+		cache.invalidate();
+		TS_ASSERT(!cache.isValid());
+	}
+
+	void test_next_box() {
+		Scumm::BoxCache cache;
+		cache.reset(4);
+		for (int box = 0; box < 4; box++)
+			cache.setBox(box, makeBox(box * 10, 0, box * 10 + 9, 9));
+		cache.finalize();
+
+		TS_ASSERT_EQUALS(cache.getNextBox(0, 3), Scumm::BoxCache::kUnknownNextBox);
+		cache.setNextBox(0, 3, 1);
+		cache.setNextBox(3, 0, -1);
+		TS_ASSERT_EQUALS(cache.getNextBox(0, 3), 1);
+		TS_ASSERT_EQUALS(cache.getNextBox(3, 0), -1);
+		TS_ASSERT_EQUALS(cache.getNextBox(1, 2), Scumm::BoxCache::kUnknownNextBox);
+
+		const Scumm::BoxCache::Stats &stats = cache.getStats();
+		TS_ASSERT_EQUALS(stats.pathQueries, 4u);
+		TS_ASSERT_EQUALS(stats.pathHits, 2u);
+		TS_ASSERT_EQUALS(cache.getFramePathQueries(), 4u);
+		cache.endFrame();
+		TS_ASSERT_EQUALS(cache.getFramePathQueries(), 0u);
+		TS_ASSERT_EQUALS(stats.maxFramePathQueries, 4u);
+
+		// Rebuilding forgets all paths
+		cache.reset(4);
+		TS_ASSERT_EQUALS(cache.getNextBox(0, 3), Scumm::BoxCache::kUnknownNextBox);
+	}
+};
@@ -0,0 +1,268 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/system.h"
+
+#include "engines/scumm/costume-cache.h"
+
+#include "../../null_osystem.h"
+
+/**
+ * Draws ByleRLE encoded cels straight from their RLE streams and through
+ * CostumeCelCache, which must give the same pixels. The benchmark replays
+ * the cel draws of a play session, with rooms changing and the resource
+ * heap running full from time to time.
+ */
+class CostumeCelCacheTestSuite : public CxxTest::TestSuite {
+	static const int kScreenWidth = 320;
+	static const int kScreenHeight = 200;
+	static const int kCelWidth = 40;
+	static const int kCelHeight = 64;
+	static const int kNumCostumes = 12;
+	static const int kCelsPerCostume = 24;
+	static const int kNumActors = 4;
+	static const int kWalkCycle = 8;
+	// Classic costumes have 16 colors
+	static const byte kShr = 4;
+	static const byte kMask = 0x0F;
+#ifdef SLOW_TESTS
+	static const int kReplayFrames = 20000;
+#else
+	static const int kReplayFrames = 2000;
+#endif
+
+	struct Costume {
+		Common::Array<byte> data;
+		uint32 celOffsets[kCelsPerCostume];
+	};
+
+	// A figure with transparent borders, which moves a little from one
+	// cel to the next
+	static byte celPixel(int costume, int cel, int x, int y) {
+		const int center = kCelWidth / 2 + (cel % 5) - 2;
+		const int halfWidth = 6 + (y * 7 + cel * 3) % 9;
+		if (y < 4 || x < center - halfWidth || x > center + halfWidth)
+			return 0;
+		return (byte)(1 + (costume + y / 6 + (x > center ? 1 : 0)) % 15);
+	}
+
+	static void encodeRun(Common::Array<byte> &out, byte color, uint32 len) {
+		while (len > 0) {
+			const uint32 count = MIN<uint32>(len, 256);
+			if (count <= kMask) {
+				out.push_back((color << kShr) | count);
+			} else {
+				out.push_back(color << kShr);
+				out.push_back((byte)count);
+			}
+			len -= count;
+		}
+	}
+
+	// Columns are stored one after the other, and runs continue from the
+	// end of a column into the next one
+	static void encodeCel(Common::Array<byte> &out, int costume, int cel) {
+		byte color = celPixel(costume, cel, 0, 0);
+		uint32 len = 0;
+		for (int x = 0; x < kCelWidth; x++) {
+			for (int y = 0; y < kCelHeight; y++) {
+				const byte pixel = celPixel(costume, cel, x, y);
+				if (pixel != color) {
+					encodeRun(out, color, len);
+					color = pixel;
+					len = 0;
+				}
+				len++;
+			}
+		}
+		encodeRun(out, color, len);
+	}
+
+	static void createCostumes(Costume *costumes) {
+		for (int costume = 0; costume < kNumCostumes; costume++) {
+			for (int cel = 0; cel < kCelsPerCostume; cel++) {
+				costumes[costume].celOffsets[cel] = costumes[costume].data.size();
+				encodeCel(costumes[costume].data, costume, cel);
+			}
+		}
+	}
+
+	// What the renderers do without the cache: parse the RLE stream on
+	// every draw
+	static void drawRLE(byte *dst, const byte *src, const byte *palette) {
+		int x = 0, y = 0;
+		while (x < kCelWidth) {
+			byte len = *src++;
+			const byte color = len >> kShr;
+			len &= kMask;
+			int count = len ? len : *src++;
+			if (!count)
+				count = 256;
+			for (; count > 0 && x < kCelWidth; count--) {
+				if (color)
+					dst[y * kScreenWidth + x] = palette[color];
+				if (++y == kCelHeight) {
+					y = 0;
+					x++;
+				}
+			}
+		}
+	}
+
+	static void drawCached(byte *dst, const Scumm::CostumeCelCache::Cel *cel, const byte *palette) {
+		for (int x = 0; x < cel->width; x++) {
+			const byte *pixels = cel->pixels + x * cel->height;
+			for (uint16 run = cel->firstRun[x]; run < cel->firstRun[x + 1]; run++) {
+				const int end = cel->runs[run].start + cel->runs[run].len;
+				for (int y = cel->runs[run].start; y < end; y++)
+					dst[y * kScreenWidth + x] = palette[pixels[y]];
+			}
+		}
+	}
+
+	enum DrawMode {
+		kDrawRLE,
+		kDrawCachedClear,
+		kDrawCachedShrink
+	};
+
+	// Actors walk through the cycles of their costumes, rooms change every
+	// 500 frames, and every 60 frames loading a resource needs 48 KB of the
+	// heap
+	static uint32 replay(const Costume *costumes, DrawMode mode, Scumm::CostumeCelCache *cache) {
+		Common::Array<byte> screen(kScreenWidth * kScreenHeight, 0);
+		byte palette[16];
+		for (int i = 0; i < 16; i++)
+			palette[i] = (byte)(0x40 + i * 3);
+
+		uint32 hash = 2166136261u;
+		for (int frame = 0; frame < kReplayFrames; frame++) {
+			const int room = frame / 500;
+			for (int actor = 0; actor < kNumActors; actor++) {
+				const int costume = (room * 3 + actor * 2) % kNumCostumes;
+				const int cel = ((actor & 1) ? kWalkCycle : 0) + (frame / 2 + actor) % kWalkCycle;
+				const byte *src = costumes[costume].data.begin() + costumes[costume].celOffsets[cel];
+				byte *dst = screen.begin() + (10 + actor * 30) * kScreenWidth + actor * 70 + frame % 7;
+
+				const Scumm::CostumeCelCache::Cel *cached = nullptr;
+				if (mode != kDrawRLE)
+					cached = cache->getCel(costume, costumes[costume].celOffsets[cel], src, kCelWidth, kCelHeight, kShr, kMask);
+				if (cached)
+					drawCached(dst, cached, palette);
+				else
+					drawRLE(dst, src, palette);
+			}
+
+			if (!(frame % 60) && mode != kDrawRLE) {
+				if (mode == kDrawCachedClear)
+					cache->clear();
+				else
+					cache->shrink(48 * 1024);
+			}
+
+			if (!(frame % 50)) {
+				for (uint i = 0; i < screen.size(); i += 3)
+					hash = (hash ^ screen[i]) * 16777619;
+			}
+		}
+		return hash;
+	}
+
+public:
+	void test_decode() {
+		Costume costumes[kNumCostumes];
+		createCostumes(costumes);
+
+		Scumm::CostumeCelCache cache(nullptr, 256 * 1024);
+		for (int cel = 0; cel < kCelsPerCostume; cel++) {
+			const Scumm::CostumeCelCache::Cel *cached = cache.getCel(3, costumes[3].celOffsets[cel], costumes[3].data.begin() + costumes[3].celOffsets[cel], kCelWidth, kCelHeight, kShr, kMask);
+			TS_ASSERT(cached);
+			if (!cached)
+				continue;
+
+			for (int x = 0; x < kCelWidth; x++) {
+				for (int y = 0; y < kCelHeight; y++)
+					TS_ASSERT_EQUALS(cached->pixels[x * kCelHeight + y], celPixel(3, cel, x, y));
+
+				// The runs cover exactly the opaque pixels of the column
+				int opaque = 0;
+				for (int y = 0; y < kCelHeight; y++)
+					opaque += celPixel(3, cel, x, y) ? 1 : 0;
+				for (uint16 run = cached->firstRun[x]; run < cached->firstRun[x + 1]; run++) {
+					for (int y = cached->runs[run].start; y < cached->runs[run].start + cached->runs[run].len; y++) {
+						TS_ASSERT(celPixel(3, cel, x, y));
+						opaque--;
+					}
+				}
+				TS_ASSERT_EQUALS(opaque, 0);
+			}
+		}
+
+		TS_ASSERT_EQUALS(cache.getStats().misses, (uint32)kCelsPerCostume);
+		TS_ASSERT(cache.getCel(3, costumes[3].celOffsets[5], nullptr, kCelWidth, kCelHeight, kShr, kMask));
+		TS_ASSERT_EQUALS(cache.getStats().hits, 1u);
+	}
+
+	void test_shrink() {
+		Costume costumes[kNumCostumes];
+		createCostumes(costumes);
+
+		Scumm::CostumeCelCache cache(nullptr, 256 * 1024);
+		for (int cel = 0; cel < kCelsPerCostume; cel++)
+			cache.getCel(0, costumes[0].celOffsets[cel], costumes[0].data.begin() + costumes[0].celOffsets[cel], kCelWidth, kCelHeight, kShr, kMask);
+		// The first cel is the most recently used one now
+		cache.getCel(0, costumes[0].celOffsets[0], nullptr, kCelWidth, kCelHeight, kShr, kMask);
+
+		const uint32 size = cache.getSize();
+		const uint32 numCels = cache.getNumCels();
+		TS_ASSERT_EQUALS(numCels, (uint32)kCelsPerCostume);
+
+		// Only the least recently used cels go, as many as needed
+		cache.shrink(size / 4);
+		TS_ASSERT_LESS_THAN_EQUALS(size - cache.getSize(), size / 4 + size / numCels * 2);
+		TS_ASSERT_LESS_THAN_EQUALS(size / 4, size - cache.getSize());
+		TS_ASSERT_LESS_THAN(0u, cache.getNumCels());
+		const uint32 hits = cache.getStats().hits;
+		cache.getCel(0, costumes[0].celOffsets[0], nullptr, kCelWidth, kCelHeight, kShr, kMask);
+		cache.getCel(0, costumes[0].celOffsets[kCelsPerCostume - 1], nullptr, kCelWidth, kCelHeight, kShr, kMask);
+		TS_ASSERT_EQUALS(cache.getStats().hits, hits + 2);
+
+		cache.shrink(size * 2);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+		TS_ASSERT_EQUALS(cache.getNumCels(), 0u);
+	}
+
+	void test_replay_benchmark() {
+		Costume costumes[kNumCostumes];
+		createCostumes(costumes);
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+
+		uint32 times[3] = { 0, 0, 0 };
+		uint32 hashes[3];
+		uint32 hits[3] = { 0, 0, 0 };
+		for (int mode = kDrawRLE; mode <= kDrawCachedShrink; mode++) {
+			Scumm::CostumeCelCache cache(nullptr, 256 * 1024);
+#if NULL_OSYSTEM_IS_AVAILABLE
+			const uint32 start = g_system->getMillis();
+#endif
+			hashes[mode] = replay(costumes, (DrawMode)mode, &cache);
+#if NULL_OSYSTEM_IS_AVAILABLE
+			times[mode] = g_system->getMillis() - start;
+#endif
+			hits[mode] = cache.getStats().hits;
+		}
+
+		TS_ASSERT_EQUALS(hashes[kDrawCachedClear], hashes[kDrawRLE]);
+		TS_ASSERT_EQUALS(hashes[kDrawCachedShrink], hashes[kDrawRLE]);
+		// Dropping only the least recently used cels keeps the ones in use
+		TS_ASSERT_LESS_THAN(hits[kDrawCachedClear], hits[kDrawCachedShrink]);
+
+		const uint32 draws = kReplayFrames * kNumActors;
+		debug("Replaying %u cel draws: RLE %u ms, cached and cleared %u ms (%u hits), cached and shrunk %u ms (%u hits)",
+		      draws, times[kDrawRLE], times[kDrawCachedClear], hits[kDrawCachedClear], times[kDrawCachedShrink], hits[kDrawCachedShrink]);
+	}
+};
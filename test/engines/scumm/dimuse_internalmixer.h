@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "common/debug.h"
+#include "common/system.h"
+
+#include "engines/scumm/imuse_digi/dimuse_engine.h"
+
+#include "../../null_osystem.h"
+
+/**
+ * Drives IMuseDigiInternalMixer with synthetic tracks in every supported
+ * format and compares the mix buffer against checksums taken before the
+ * bulk mixing kernels were introduced, then times the common case.
+ */
+class IMuseDigiInternalMixerTestSuite : public CxxTest::TestSuite {
+	static const int kMaxFrames = 2048;
+	static const int kMixChannels = 8;
+
+	struct RateCase {
+		int32 inFrameCount;
+		int feedSize;
+	};
+
+	static void fillSource(byte *buf, uint32 size, uint32 seed) {
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			buf[i] = (byte)(seed >> 16);
+		}
+	}
+
+	static uint32 hashBuffer(const byte *buf, uint32 size, uint32 hash) {
+		for (uint32 i = 0; i < size; i++)
+			hash = (hash ^ buf[i]) * 16777619;
+		return hash;
+	}
+
+	static uint32 mixAll(Audio::Mixer *mixer, bool isEarlyDiMUSE, int wordSize, int channelCount, int outChannelCount) {
+		static const RateCase rates[] = {
+			{ 1024, 1024 }, { 512, 1024 }, { 1024, 512 }, { 256, 1024 }, { 1000, 1024 }, { 1024, 1000 }
+		};
+		static const int volumes[][2] = {
+			{ 127, 64 }, { 60, 20 }, { 100, 110 }, { 0, 64 }
+		};
+
+		const uint32 mixBufSize = kMaxFrames * 2 * 2;
+		byte *mixBuf = new byte[mixBufSize * 2];
+		byte *srcBuf = new byte[kMaxFrames * 2 * 2 + 64];
+
+		Scumm::IMuseDigiInternalMixer internalMixer(mixer, 22050, isEarlyDiMUSE);
+		internalMixer.init(16, outChannelCount, mixBuf, mixBufSize * 2, 0, kMixChannels);
+
+		uint32 hash = 2166136261u;
+		for (int radio = 0; radio < 2; radio++) {
+			if (radio)
+				internalMixer.setRadioChatter();
+			else
+				internalMixer.clearRadioChatter();
+
+			for (int r = 0; r < ARRAYSIZE(rates); r++) {
+				// Upsampling 12-bit stereo to mono reads outside of the
+				// amplitude table, as the original did, so the result
+				// depends on whatever follows it in memory
+				if (wordSize == 12 && channelCount == 2 && outChannelCount == 1 && 2 * rates[r].inFrameCount == rates[r].feedSize)
+					continue;
+
+				for (int ft = 0; ft < 2; ft++) {
+					internalMixer.clearMixerBuffer();
+					for (int v = 0; v < ARRAYSIZE(volumes); v++) {
+						// The radio chatter filter of 8-bit mono tracks
+						// reads before the amplitude table at volume 0, as
+						// the original did
+						if (radio && wordSize == 8 && channelCount == 1 && !volumes[v][0])
+							continue;
+
+						fillSource(srcBuf, kMaxFrames * 2 * 2 + 64, r * 31 + v);
+						internalMixer.mix(srcBuf, rates[r].inFrameCount, wordSize, channelCount, rates[r].feedSize, 16 * v, volumes[v][0], volumes[v][1], ft != 0);
+					}
+					hash = hashBuffer(mixBuf, mixBufSize * 2, hash);
+				}
+			}
+		}
+
+		delete[] srcBuf;
+		delete[] mixBuf;
+		return hash;
+	}
+
+	struct Golden {
+		int isEarlyDiMUSE;
+		int wordSize;
+		int channelCount;
+		int outChannelCount;
+		uint32 hash;
+	};
+
+public:
+	void test_mix_bitexact() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+		static const Golden golden[] = {
+			{ 0,  8, 1, 1, 1184276349u }, { 0,  8, 1, 2, 2517539261u }, { 0,  8, 2, 1, 2661109029u }, { 0,  8, 2, 2, 2734316453u },
+			{ 0, 12, 1, 1, 1709268789u }, { 0, 12, 1, 2, 1684709309u }, { 0, 12, 2, 1, 3150704565u }, { 0, 12, 2, 2, 2398837253u },
+			{ 0, 16, 1, 1, 2155911909u }, { 0, 16, 1, 2, 1788475949u }, { 0, 16, 2, 1,  380842581u }, { 0, 16, 2, 2,  725332061u },
+			{ 1,  8, 1, 1, 1181114321u }, { 1,  8, 1, 2, 3126387697u }, { 1,  8, 2, 1, 2661109029u }, { 1,  8, 2, 2, 2734316453u },
+			{ 1, 12, 1, 1, 1709268789u }, { 1, 12, 1, 2, 1684709309u }, { 1, 12, 2, 1, 3150704565u }, { 1, 12, 2, 2, 2398837253u },
+			{ 1, 16, 1, 1, 2155911909u }, { 1, 16, 1, 2, 1788475949u }, { 1, 16, 2, 1,  380842581u }, { 1, 16, 2, 2,  725332061u }
+		};
+
+		for (int i = 0; i < ARRAYSIZE(golden); i++) {
+			const Golden &g = golden[i];
+			uint32 hash = mixAll(&mixer, g.isEarlyDiMUSE != 0, g.wordSize, g.channelCount, g.outChannelCount);
+			TSM_ASSERT_EQUALS(Common::String::format("early %d, %d-bit, %d -> %d channels", g.isEarlyDiMUSE, g.wordSize, g.channelCount, g.outChannelCount).c_str(), hash, g.hash);
+		}
+#endif
+	}
+
+	void test_mix_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Audio::MixerImpl mixer(22050);
+		mixer.setReady(true);
+
+#ifdef SLOW_TESTS
+		const int iterations = 20000;
+#else
+		const int iterations = 500;
+#endif
+		const int32 frames = 1024;
+		const uint32 mixBufSize = kMaxFrames * 2 * 2;
+		byte *mixBuf = new byte[mixBufSize];
+		byte *srcBuf = new byte[kMaxFrames * 2 * 2];
+		fillSource(srcBuf, kMaxFrames * 2 * 2, 1);
+
+		static const int wordSizes[] = { 8, 12, 16 };
+		for (int w = 0; w < ARRAYSIZE(wordSizes); w++) {
+			for (int channels = 1; channels <= 2; channels++) {
+				for (int outChannels = 1; outChannels <= 2; outChannels++) {
+					Scumm::IMuseDigiInternalMixer internalMixer(&mixer, 22050, false);
+					internalMixer.init(16, outChannels, mixBuf, mixBufSize, 0, kMixChannels);
+
+					const uint32 start = g_system->getMillis();
+					for (int i = 0; i < iterations; i++) {
+						internalMixer.clearMixerBuffer();
+						for (int track = 0; track < kMixChannels; track++)
+							internalMixer.mix(srcBuf, frames, wordSizes[w], channels, frames, 0, 127 - track * 8, 64, false);
+					}
+					debug("DiMUSE mixer: %d-bit, %d -> %d channels: %d mixes of %d tracks in %u ms",
+						wordSizes[w], channels, outChannels, iterations, kMixChannels, g_system->getMillis() - start);
+				}
+			}
+		}
+
+		delete[] srcBuf;
+		delete[] mixBuf;
+#endif
+	}
+};
@@ -0,0 +1,109 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/system.h"
+#include "graphics/managed_surface.h"
+#include "graphics/svg.h"
+#include "graphics/thumbnail.h"
+
+#include "../null_osystem.h"
+
+/**
+ * Compares rasterizing the SVG bitmaps of a theme, as the ThemeEngine does
+ * when it parses a theme, to reading them back pre-rasterized, as it does
+ * from its compiled theme cache.
+ */
+class SVGTestSuite : public CxxTest::TestSuite {
+	static const int kWidth = 64;
+	static const int kHeight = 48;
+#ifdef SLOW_TESTS
+	static const int kCount = 500;
+#else
+	static const int kCount = 50;
+#endif
+
+	// A button icon like those of the themes, with a gradient and curves
+	static const char *icon() {
+		return
+			"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"64\" height=\"48\" viewBox=\"0 0 64 48\">"
+			"<defs><linearGradient id=\"g\" x1=\"0\" y1=\"0\" x2=\"0\" y2=\"1\">"
+			"<stop offset=\"0\" stop-color=\"#fcb45c\"/><stop offset=\"1\" stop-color=\"#cc6600\"/>"
+			"</linearGradient></defs>"
+			"<rect x=\"2\" y=\"2\" width=\"60\" height=\"44\" rx=\"8\" fill=\"url(#g)\" stroke=\"#804000\" stroke-width=\"2\"/>"
+			"<circle cx=\"20\" cy=\"24\" r=\"10\" fill=\"#ffffff\" fill-opacity=\"0.7\"/>"
+			"<path d=\"M36 12 C 52 12, 52 36, 36 36 L 30 24 Z\" fill=\"#402000\"/>"
+			"<path d=\"M8 40 Q 32 28 56 40\" fill=\"none\" stroke=\"#ffffff\" stroke-width=\"3\"/>"
+			"</svg>";
+	}
+
+	static Graphics::ManagedSurface *rasterize(float scale) {
+		const char *svg = icon();
+		Common::MemoryReadStream stream((const byte *)svg, strlen(svg));
+		return new Graphics::SVGBitmap(&stream, kWidth * scale, kHeight * scale);
+	}
+
+	static bool equals(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h || a.format != b.format)
+			return false;
+		for (int y = 0; y < a.h; ++y) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void test_prerasterized_bitmap() {
+		const float scales[] = { 1.0f, 1.5f, 2.0f };
+		for (int i = 0; i < ARRAYSIZE(scales); ++i) {
+			Common::ScopedPtr<Graphics::ManagedSurface> bitmap(rasterize(scales[i]));
+			TS_ASSERT_EQUALS(bitmap->w, (int16)(kWidth * scales[i]));
+
+			Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+			TS_ASSERT(Graphics::saveThumbnail(out, bitmap->rawSurface()));
+
+			Common::MemoryReadStream in(out.getData(), out.size());
+			Graphics::Surface *loaded = nullptr;
+			TS_ASSERT(Graphics::loadThumbnail(in, loaded, false));
+			TS_ASSERT(loaded && equals(*loaded, bitmap->rawSurface()));
+			TS_ASSERT_EQUALS(in.pos(), in.size());
+
+			if (loaded) {
+				loaded->free();
+				delete loaded;
+			}
+		}
+	}
+
+	void test_svg_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < kCount; ++i)
+			delete rasterize(2.0f);
+		const uint32 rasterizeTime = g_system->getMillis() - start;
+
+		Common::ScopedPtr<Graphics::ManagedSurface> bitmap(rasterize(2.0f));
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		TS_ASSERT(Graphics::saveThumbnail(out, bitmap->rawSurface()));
+
+		start = g_system->getMillis();
+		for (int i = 0; i < kCount; ++i) {
+			Common::MemoryReadStream in(out.getData(), out.size());
+			Graphics::Surface *loaded = nullptr;
+			TS_ASSERT(Graphics::loadThumbnail(in, loaded, false));
+			Graphics::ManagedSurface surf;
+			surf.copyFrom(*loaded);
+			loaded->free();
+			delete loaded;
+		}
+		const uint32 loadTime = g_system->getMillis() - start;
+
+		debug("%d SVG bitmaps of %dx%d: rasterizing %u ms, loading pre-rasterized %u ms",
+		      kCount, bitmap->w, bitmap->h, rasterizeTime, loadTime);
+#endif
+	}
+};
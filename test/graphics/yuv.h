@@ -0,0 +1,229 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include "../null_osystem.h"
+
+/**
+ * Checks that the YUV to RGB kernels produce the same pixels as the lookup
+ * tables, with every row kernel the CPU supports, and compares their
+ * throughput to the lookup tables.
+ */
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+#ifdef SLOW_TESTS
+	static const int kFrames = 200;
+#else
+	static const int kFrames = 20;
+#endif
+
+	struct Planes {
+		int width, height;
+		int uvWidth, uvHeight;
+		Common::Array<byte> y, u, v;
+	};
+
+	// Every chroma pair appears in a 256x256 block of a YUV444 image
+	static void fill(Planes &planes, int width, int height, int chromaShift, uint32 seed) {
+		planes.width = width;
+		planes.height = height;
+		planes.uvWidth = width >> chromaShift;
+		planes.uvHeight = height >> chromaShift;
+		planes.y.resize(width * height);
+		planes.u.resize(planes.uvWidth * planes.uvHeight);
+		planes.v.resize(planes.uvWidth * planes.uvHeight);
+
+		for (int i = 0; i < width * height; i++) {
+			seed = seed * 1103515245 + 12345;
+			planes.y[i] = seed >> 24;
+		}
+		for (int y = 0; y < planes.uvHeight; y++) {
+			for (int x = 0; x < planes.uvWidth; x++) {
+				planes.u[y * planes.uvWidth + x] = x + (seed >> 8);
+				planes.v[y * planes.uvWidth + x] = y + (seed >> 16);
+			}
+		}
+	}
+
+	// The channels as computed by the lookup tables
+	static void referenceRGB(const Planes &planes, int chromaShift, bool itu, int x, int y, byte &r, byte &g, byte &b) {
+		const int uvIndex = (y >> chromaShift) * planes.uvWidth + (x >> chromaShift);
+		const int16 CR = planes.v[uvIndex] - 128;
+		const int16 CB = planes.u[uvIndex] - 128;
+		const int luma = planes.y[y * planes.width + x];
+
+		r = referenceChannel(luma + (int16)((0.419 / 0.299) * CR), itu);
+		g = referenceChannel(luma + (int16)(-(0.299 / 0.419) * CR) + (int16)(-(0.114 / 0.331) * CB), itu);
+		b = referenceChannel(luma + (int16)((0.587 / 0.331) * CB), itu);
+	}
+
+	static byte referenceChannel(int value, bool itu) {
+		if (!itu)
+			return CLIP(value, 0, 255);
+		return (CLIP(value, 16, 235) - 16) * 255 / 219;
+	}
+
+	static void convert(Graphics::Surface &dst, const Planes &planes, int chromaShift, Graphics::YUVToRGBManager::LuminanceScale scale, const byte *ditherTable = nullptr) {
+		if (chromaShift && ditherTable)
+			YUVToRGBMan.convert420Dither(&dst, scale, ditherTable, planes.y.data(), planes.u.data(), planes.v.data(), planes.width, planes.height, planes.width, planes.uvWidth);
+		else if (ditherTable)
+			YUVToRGBMan.convert444Dither(&dst, scale, ditherTable, planes.y.data(), planes.u.data(), planes.v.data(), planes.width, planes.height, planes.width, planes.uvWidth);
+		else if (chromaShift)
+			YUVToRGBMan.convert420(&dst, scale, planes.y.data(), planes.u.data(), planes.v.data(), planes.width, planes.height, planes.width, planes.uvWidth);
+		else
+			YUVToRGBMan.convert444(&dst, scale, planes.y.data(), planes.u.data(), planes.v.data(), planes.width, planes.height, planes.width, planes.uvWidth);
+	}
+
+	static bool matchesReference(const Graphics::Surface &dst, const Planes &planes, int chromaShift, bool itu) {
+		for (int y = 0; y < dst.h; y++) {
+			for (int x = 0; x < dst.w; x++) {
+				byte r, g, b;
+				referenceRGB(planes, chromaShift, itu, x, y, r, g, b);
+				if (dst.getPixel(x, y) != dst.format.RGBToColor(r, g, b))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	static Common::Array<Graphics::YUVToRGBManager::RowFunc> rowKernels() {
+		Common::Array<Graphics::YUVToRGBManager::RowFunc> kernels;
+		kernels.push_back(Graphics::convertYUVToRGBRowGeneric);
+#ifdef SCUMMVM_NEON
+		kernels.push_back(Graphics::convertYUVToRGBRowNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			kernels.push_back(Graphics::convertYUVToRGBRowSSE2);
+#endif
+		return kernels;
+	}
+
+public:
+	void test_kernels_match_lookup() {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),  // RGB565 kernel
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),  // XRGB8888 kernel
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), // XRGB8888 kernel, with alpha
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0),  // Lookup tables
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)  // Lookup tables
+		};
+		const Common::Array<Graphics::YUVToRGBManager::RowFunc> kernels = rowKernels();
+		Graphics::YUVToRGBManager::RowFunc oldKernel = YUVToRGBMan._convertRow;
+
+		for (int chromaShift = 0; chromaShift < 2; chromaShift++) {
+			// An odd number of blocks, which do not end on a vector of pixels
+			Planes planes;
+			fill(planes, chromaShift ? 518 : 262, 260, chromaShift, 1);
+
+			for (uint k = 0; k < kernels.size(); k++) {
+				YUVToRGBMan._convertRow = kernels[k];
+				for (int f = 0; f < ARRAYSIZE(formats); f++) {
+					for (int itu = 0; itu < 2; itu++) {
+						Graphics::Surface dst;
+						dst.create(planes.width, planes.height, formats[f]);
+						convert(dst, planes, chromaShift, itu ? Graphics::YUVToRGBManager::kScaleITU : Graphics::YUVToRGBManager::kScaleFull);
+						TSM_ASSERT(Common::String::format("kernel %u, format %d, chroma shift %d, ITU %d", k, f, chromaShift, itu).c_str(),
+						           matchesReference(dst, planes, chromaShift, itu));
+						dst.free();
+					}
+				}
+			}
+		}
+
+		YUVToRGBMan._convertRow = oldKernel;
+	}
+
+	void test_dither_matches_lookup() {
+		Common::Array<byte> ditherTable(0x10000);
+		uint32 seed = 2;
+		for (uint i = 0; i < ditherTable.size(); i++) {
+			seed = seed * 1103515245 + 12345;
+			ditherTable[i] = seed >> 24;
+		}
+
+		const Common::Array<Graphics::YUVToRGBManager::RowFunc> kernels = rowKernels();
+		Graphics::YUVToRGBManager::RowFunc oldKernel = YUVToRGBMan._convertRow;
+
+		for (int chromaShift = 0; chromaShift < 2; chromaShift++) {
+			Planes planes;
+			fill(planes, 262, 66, chromaShift, 3);
+
+			for (uint k = 0; k < kernels.size(); k++) {
+				YUVToRGBMan._convertRow = kernels[k];
+				for (int itu = 0; itu < 2; itu++) {
+					Graphics::Surface dst;
+					dst.create(planes.width, planes.height, Graphics::PixelFormat::createFormatCLUT8());
+					convert(dst, planes, chromaShift, itu ? Graphics::YUVToRGBManager::kScaleITU : Graphics::YUVToRGBManager::kScaleFull, ditherTable.data());
+
+					// As QuickTimeDecoder dithers frames
+					static const uint16 colorTableOffsets[] = { 0x0000, 0xC000, 0x4000, 0x8000 };
+					bool matches = true;
+					for (int y = 0; y < dst.h; y++) {
+						uint16 colorTableOffset = colorTableOffsets[y & 3];
+						for (int x = 0; x < dst.w; x++) {
+							byte r, g, b;
+							referenceRGB(planes, chromaShift, itu, x, y, r, g, b);
+							const uint16 color = ((r & 0xF8) << 6) | ((g & 0xF8) << 1) | (b >> 4);
+							matches &= (*(const byte *)dst.getBasePtr(x, y) == ditherTable[colorTableOffset + color]);
+							colorTableOffset += 0x4000;
+						}
+					}
+					TSM_ASSERT(Common::String::format("kernel %u, chroma shift %d, ITU %d", k, chromaShift, itu).c_str(), matches);
+					dst.free();
+				}
+			}
+		}
+
+		YUVToRGBMan._convertRow = oldKernel;
+	}
+
+	void test_yuv_benchmark() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Planes planes;
+		fill(planes, 640, 480, 1, 4);
+
+		// The lookup tables convert formats of the same size the kernels do not
+		// handle at the same speed
+		const Graphics::PixelFormat formats[][2] = {
+			{ Graphics::PixelFormat(2, 5, 6, 5, 0, 0, 5, 11, 0), Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+			{ Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) }
+		};
+		const Common::Array<Graphics::YUVToRGBManager::RowFunc> kernels = rowKernels();
+		Graphics::YUVToRGBManager::RowFunc oldKernel = YUVToRGBMan._convertRow;
+
+		for (int f = 0; f < ARRAYSIZE(formats); f++) {
+			Graphics::Surface dst;
+			dst.create(planes.width, planes.height, formats[f][0]);
+			uint32 start = g_system->getMillis();
+			for (int i = 0; i < kFrames; i++)
+				convert(dst, planes, 1, Graphics::YUVToRGBManager::kScaleITU);
+			const uint32 lookupTime = g_system->getMillis() - start;
+			dst.free();
+
+			dst.create(planes.width, planes.height, formats[f][1]);
+			Common::String kernelTimes;
+			for (uint k = 0; k < kernels.size(); k++) {
+				YUVToRGBMan._convertRow = kernels[k];
+				start = g_system->getMillis();
+				for (int i = 0; i < kFrames; i++)
+					convert(dst, planes, 1, Graphics::YUVToRGBManager::kScaleITU);
+				kernelTimes += Common::String::format(", kernel %u: %u ms", k, g_system->getMillis() - start);
+			}
+			dst.free();
+
+			debug("%d YUV420 frames of %dx%d to %d bpp: lookup tables %u ms%s",
+			      kFrames, planes.width, planes.height, formats[f][1].bytesPerPixel * 8, lookupTime, kernelTimes.c_str());
+		}
+
+		YUVToRGBMan._convertRow = oldKernel;
+#endif
+	}
+};
@@ -0,0 +1,251 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "graphics/font.h"
+#include "graphics/VectorRenderer.h"
+#include "gui/ThemeEngine.h"
+#include "gui/ThemeEval.h"
+
+#include "../null_osystem.h"
+
+/**
+ * Loads a theme by parsing it, which writes its compiled cache, then loads
+ * it again from the cache. Both must give the same theme.
+ */
+class ThemeCacheTestSuite : public CxxTest::TestSuite {
+	static const char *themerc() {
+		return "[" SCUMMVM_THEME_VERSION_STR ":Test Theme:No Author]\n";
+	}
+
+	static const char *stx() {
+		return
+			"<?xml version = '1.0'?>"
+			"<render_info>"
+			"<palette>"
+			"<color name='black' rgb='0, 0, 0'/>"
+			"<color name='green' rgb='32, 160, 32'/>"
+			"<color name='white' rgb='255, 255, 255'/>"
+			"</palette>"
+			"<fonts>"
+			"<font id='text_default'><language id='*' file='default'/></font>"
+			"<font id='text_button'><language id='*' file='default'/></font>"
+			"<font id='console'><language id='*' file='builtinConsole'/></font>"
+			"<text_color id='color_normal' color='green'/>"
+			"<text_color id='color_button' color='255, 128, 0'/>"
+			"</fonts>"
+			"<bitmaps>"
+			"<bitmap filename='icon.bmp' scalable_file='icon.svg' width='32' height='24'/>"
+			"</bitmaps>"
+			"<defaults fill='foreground' fg_color='white' bg_color='black' shadow='0'/>"
+			"<drawdata id='mainmenu_bg' cache='false'>"
+			"<drawstep func='fill' fill='gradient' gradient_start='black' gradient_end='green'/>"
+			"</drawdata>"
+			"<drawdata id='widget_default' cache='false'>"
+			"<drawstep func='roundedsq' radius='4' stroke='1' fill='background' shadow='2'/>"
+			"<drawstep func='bitmap' file='icon.bmp' xpos='center' ypos='center' width='auto' height='auto'/>"
+			"</drawdata>"
+			"<drawdata id='button_idle' cache='false'>"
+			"<text font='text_button' text_color='color_button' vertical_align='center' horizontal_align='center'/>"
+			"<drawstep func='bevelsq' bevel='2' fill='none' bevel_color='green'/>"
+			"<drawstep func='triangle' fg_color='green' fill='foreground' width='8' height='8' xpos='right' ypos='center' orientation='top'/>"
+			"</drawdata>"
+			"</render_info>"
+			"<layout_info>"
+			"<globals>"
+			"<def var='Line.Height' value='16'/>"
+			"<def var='Padding.Left' value='8' scalable='yes'/>"
+			"<widget name='Button' size='108, 24'/>"
+			"</globals>"
+			"<dialog name='TestDialog' overlays='screen' inset='16' shading='dim'>"
+			"<layout type='vertical' padding='8, 8, 8, 8' spacing='4'>"
+			"<widget name='Title' height='Globals.Line.Height'/>"
+			"<widget name='Ok' type='Button'/>"
+			"</layout>"
+			"</dialog>"
+			"</layout_info>";
+	}
+
+	static Common::String svg(const char *fill) {
+		return Common::String::format(
+			"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"32\" height=\"24\" viewBox=\"0 0 32 24\">"
+			"<rect x=\"1\" y=\"1\" width=\"30\" height=\"22\" rx=\"4\" fill=\"%s\" stroke=\"#804000\"/>"
+			"<circle cx=\"10\" cy=\"12\" r=\"5\" fill=\"#ffffff\" fill-opacity=\"0.7\"/>"
+			"</svg>", fill);
+	}
+
+	static bool writeFile(const Common::Path &path, const char *data) {
+		Common::ScopedPtr<Common::SeekableWriteStream> out(Common::FSNode(path).createWriteStream(false));
+		if (!out)
+			return false;
+		out->write(data, strlen(data));
+		out->finalize();
+		return !out->err();
+	}
+
+	static GUI::ThemeEngine *loadTheme(const Common::Path &themePath) {
+		GUI::ThemeEngine *theme = new GUI::ThemeEngine(themePath.toString(Common::Path::kNativeSeparator), GUI::ThemeEngine::kGfxStandard);
+		theme->setBaseResolution(640, 480, 1.0f);
+		TS_ASSERT(theme->init());
+		return theme;
+	}
+
+	static bool sameSurface(const Graphics::ManagedSurface *a, const Graphics::ManagedSurface *b) {
+		if (!a || !b)
+			return a == b;
+		const Graphics::Surface &sa = a->rawSurface();
+		const Graphics::Surface &sb = b->rawSurface();
+		if (sa.w != sb.w || sa.h != sb.h || sa.format != sb.format)
+			return false;
+		for (int y = 0; y < sa.h; ++y) {
+			if (memcmp(sa.getBasePtr(0, y), sb.getBasePtr(0, y), sa.w * sa.format.bytesPerPixel))
+				return false;
+		}
+		return a->hasTransparentColor() == b->hasTransparentColor() && a->getTransparentColor() == b->getTransparentColor();
+	}
+
+	static bool sameColor(const Graphics::DrawStep::Color &a, const Graphics::DrawStep::Color &b) {
+		return a.r == b.r && a.g == b.g && a.b == b.b && a.set == b.set;
+	}
+
+	static bool sameStep(const Graphics::DrawStep &a, const Graphics::DrawStep &b) {
+		return a.drawingCall == b.drawingCall && sameSurface(a.blitSrc, b.blitSrc) && a.alphaType == b.alphaType &&
+		       sameColor(a.fgColor, b.fgColor) && sameColor(a.bgColor, b.bgColor) &&
+		       sameColor(a.gradColor1, b.gradColor1) && sameColor(a.gradColor2, b.gradColor2) &&
+		       sameColor(a.bevelColor, b.bevelColor) &&
+		       a.autoWidth == b.autoWidth && a.autoHeight == b.autoHeight &&
+		       a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h &&
+		       a.padding == b.padding && a.clip == b.clip && a.xAlign == b.xAlign && a.yAlign == b.yAlign &&
+		       a.shadow == b.shadow && a.stroke == b.stroke && a.factor == b.factor &&
+		       a.radius == b.radius && a.bevel == b.bevel &&
+		       a.fillMode == b.fillMode && a.shadowFillMode == b.shadowFillMode &&
+		       a.extraData == b.extraData && a.scale == b.scale &&
+		       a.shadowIntensity == b.shadowIntensity && a.autoscale == b.autoscale;
+	}
+
+	static void checkSameTheme(GUI::ThemeEngine &parsed, GUI::ThemeEngine &cached) {
+		uint steps = 0;
+		for (int i = 0; i < GUI::kDrawDataMAX; ++i) {
+			const GUI::DrawData dd = (GUI::DrawData)i;
+			const Common::List<Graphics::DrawStep> *a = parsed.getDrawSteps(dd);
+			const Common::List<Graphics::DrawStep> *b = cached.getDrawSteps(dd);
+			TS_ASSERT_EQUALS(a == nullptr, b == nullptr);
+			if (!a || !b)
+				continue;
+
+			TS_ASSERT_EQUALS(a->size(), b->size());
+			Common::List<Graphics::DrawStep>::const_iterator j = a->begin(), k = b->begin();
+			for (; j != a->end() && k != b->end(); ++j, ++k, ++steps)
+				TS_ASSERT(sameStep(*j, *k));
+
+			// The text color is only set along with the text data
+			TS_ASSERT_EQUALS(parsed.getTextData(dd), cached.getTextData(dd));
+			if (parsed.getTextData(dd) != GUI::kTextDataNone)
+				TS_ASSERT_EQUALS(parsed.getTextColor(dd), cached.getTextColor(dd));
+		}
+		TS_ASSERT_EQUALS(steps, 5u);
+
+		for (int i = 0; i < GUI::kTextColorMAX; ++i) {
+			const GUI::TextColorData *a = parsed.getTextColorData((GUI::TextColor)i);
+			const GUI::TextColorData *b = cached.getTextColorData((GUI::TextColor)i);
+			TS_ASSERT_EQUALS(a == nullptr, b == nullptr);
+			if (a && b)
+				TS_ASSERT(a->r == b->r && a->g == b->g && a->b == b->b);
+		}
+
+		// The fonts the theme defines, which are loaded anew by each theme
+		TS_ASSERT_EQUALS(parsed.getFont(GUI::ThemeEngine::kFontStyleBold), cached.getFont(GUI::ThemeEngine::kFontStyleBold));
+		TS_ASSERT_EQUALS(parsed.getFont(GUI::ThemeEngine::kFontStyleConsole)->getFontHeight(), cached.getFont(GUI::ThemeEngine::kFontStyleConsole)->getFontHeight());
+		TS_ASSERT_EQUALS(parsed.getFont(GUI::ThemeEngine::kFontStyleConsole)->getMaxCharWidth(), cached.getFont(GUI::ThemeEngine::kFontStyleConsole)->getMaxCharWidth());
+
+		TS_ASSERT(sameSurface(parsed.getImageSurface("icon.bmp"), cached.getImageSurface("icon.bmp")));
+
+		GUI::ThemeEval &a = *parsed.getEvaluator();
+		GUI::ThemeEval &b = *cached.getEvaluator();
+		TS_ASSERT_EQUALS(a.getVar("Globals.Line.Height", -1), 16);
+		TS_ASSERT_EQUALS(a.getVar("Globals.Padding.Left", -1), b.getVar("Globals.Padding.Left", -2));
+		TS_ASSERT_EQUALS(a.getVar("Globals.Button.Width", -1), b.getVar("Globals.Button.Width", -2));
+		TS_ASSERT_EQUALS(a.getVar("Globals.Button.Height", -1), b.getVar("Globals.Button.Height", -2));
+		TS_ASSERT(b.hasDialog("TestDialog"));
+	}
+
+public:
+	void test_cache_round_trip() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		Common::install_null_g_system();
+		g_system->initSize(640, 480);
+
+		const Common::Path testDir = Common::create_test_directory("themecache");
+		TS_ASSERT(!testDir.empty());
+		if (testDir.empty())
+			return;
+
+		const Common::Path themePath = testDir.join("testtheme");
+		TS_ASSERT(Common::FSNode(themePath).createDirectory());
+		TS_ASSERT(writeFile(themePath.join("THEMERC"), themerc()));
+		TS_ASSERT(writeFile(themePath.join("test_gfx.stx"), stx()));
+		TS_ASSERT(writeFile(themePath.join("icon.svg"), svg("#fcb45c").c_str()));
+
+		// The cache files are kept with the save files, not in the theme
+		const Common::Path savePath = testDir.join("saves");
+		TS_ASSERT(Common::FSNode(savePath).createDirectory());
+		ConfMan.setPath("savepath", savePath, Common::ConfigManager::kApplicationDomain);
+		ConfMan.setBool("gui_theme_cache", true, Common::ConfigManager::kApplicationDomain);
+
+		Common::SaveFileManager *saveMan = g_system->getSavefileManager();
+		const Common::String cacheName = "testtheme-640x480-100.tcc";
+
+		// Parsing the theme writes its cache
+		Common::ScopedPtr<GUI::ThemeEngine> parsed(loadTheme(themePath));
+		TS_ASSERT(!parsed->isThemeFromCache());
+		TS_ASSERT(saveMan->exists(cacheName));
+		TS_ASSERT(!Common::FSNode(themePath.join(cacheName)).exists());
+
+		Common::ScopedPtr<GUI::ThemeEngine> cached(loadTheme(themePath));
+		TS_ASSERT(cached->isThemeFromCache());
+		checkSameTheme(*parsed, *cached);
+
+		// A corrupted cache is parsed again, and rewritten
+		Common::ScopedPtr<Common::InSaveFile> in(saveMan->openForLoading(cacheName));
+		TS_ASSERT(in);
+		Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+		data.writeStream(in.get());
+		in.reset();
+		data.getData()[data.size() - 1] ^= 0xFF;
+		Common::ScopedPtr<Common::OutSaveFile> out(saveMan->openForSaving(cacheName, false));
+		TS_ASSERT(out);
+		out->write(data.getData(), data.size());
+		out->finalize();
+		out.reset();
+
+		cached.reset(loadTheme(themePath));
+		TS_ASSERT(!cached->isThemeFromCache());
+		checkSameTheme(*parsed, *cached);
+
+		cached.reset(loadTheme(themePath));
+		TS_ASSERT(cached->isThemeFromCache());
+		checkSameTheme(*parsed, *cached);
+
+		// The cache is keyed by the contents of the theme files, not by their times
+		TS_ASSERT(writeFile(themePath.join("icon.svg"), svg("#fcb45c").c_str()));
+		cached.reset(loadTheme(themePath));
+		TS_ASSERT(cached->isThemeFromCache());
+
+		// A theme whose files changed is parsed again
+		TS_ASSERT(writeFile(themePath.join("icon.svg"), svg("#5cb4fc").c_str()));
+		cached.reset(loadTheme(themePath));
+		TS_ASSERT(!cached->isThemeFromCache());
+		TS_ASSERT(!sameSurface(parsed->getImageSurface("icon.bmp"), cached->getImageSurface("icon.bmp")));
+
+		parsed.reset();
+		cached.reset();
+		ConfMan.removeKey("gui_theme_cache", Common::ConfigManager::kApplicationDomain);
+		ConfMan.removeKey("savepath", Common::ConfigManager::kApplicationDomain);
+		Common::remove_test_directory(testDir);
+#endif
+	}
+};
@@ -0,0 +1,30 @@
+// The theme engine refers to the GUI manager and the widgets only to lay out
+// dialogs. The tests load themes without showing any dialog, so these stand in
+// for them, instead of pulling the whole GUI into the test runner.
+
+#include "common/textconsole.h"
+
+#include "gui/gui-manager.h"
+#include "gui/widget.h"
+
+namespace Common {
+DECLARE_SINGLETON(GUI::GuiManager);
+}
+
+namespace GUI {
+
+GuiManager::GuiManager() : CommandSender(nullptr) {
+	error("The tests have no GUI manager");
+}
+
+GuiManager::~GuiManager() {
+}
+
+void GuiManager::setDialogPaddings(int l, int r) {
+}
+
+Widget *Widget::findWidgetInChain(Widget *w, const char *name) {
+	return nullptr;
+}
+
+} // End of namespace GUI
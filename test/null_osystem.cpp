@@ -1,10 +1,18 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_abort
+#define FORBIDDEN_SYMBOL_EXCEPTION_getenv
+#define FORBIDDEN_SYMBOL_EXCEPTION_unlink
 
 #define USE_NULL_DRIVER 1
 #define NULL_DRIVER_USE_FOR_TEST 1
 #include "null_osystem.h"
 #include "../backends/platform/null/null.cpp"
 
+#include "common/fs.h"
+
+#ifdef POSIX
+#include <utime.h>
+#endif
+
 //#define DISPLAY_ERROR_MESSAGES
 
 void Common::install_null_g_system() {
@@ -17,6 +25,54 @@ void Common::install_null_g_system() {
 	g_system = OSystem_NULL_create(silenceLogs);
 }
 
+#ifdef POSIX
+Common::Path Common::create_test_directory(const char *name) {
+	const char *tmpDir = getenv("TMPDIR");
+	if (!tmpDir || !*tmpDir)
+		tmpDir = "/tmp";
+
+	const Common::String pattern = Common::String::format("%s/scummvm-%s-XXXXXX", tmpDir, name);
+	Common::Array<char> buffer(pattern.c_str(), pattern.size() + 1);
+	if (!mkdtemp(buffer.data()))
+		return Common::Path();
+
+	return Common::Path(buffer.data(), '/');
+}
+
+void Common::remove_test_directory(const Common::Path &path) {
+	if (path.empty())
+		return;
+
+	const Common::FSNode dir(path);
+	Common::FSList children;
+	if (dir.getChildren(children, Common::FSNode::kListAll, true)) {
+		for (Common::FSList::const_iterator it = children.begin(); it != children.end(); ++it) {
+			if (it->isDirectory())
+				remove_test_directory(it->getPath());
+			else
+				unlink(it->getPath().toString('/').c_str());
+		}
+	}
+
+	rmdir(path.toString('/').c_str());
+}
+
+bool Common::age_test_files(const Common::Path &path, int seconds) {
+	const Common::FSNode node(path);
+	Common::FSList children;
+	if (node.isDirectory() && node.getChildren(children, Common::FSNode::kListAll, true)) {
+		for (Common::FSList::const_iterator it = children.begin(); it != children.end(); ++it) {
+			if (!age_test_files(it->getPath(), seconds))
+				return false;
+		}
+	}
+
+	struct utimbuf times;
+	times.actime = times.modtime = time(nullptr) - seconds;
+	return utime(path.toString('/').c_str(), &times) == 0;
+}
+#endif
+
 void OSystem_NULL::quit() {
 	abort();
 }
@@ -1,11 +1,30 @@
 #ifndef TEST_NULL_OSYSTEM
 #define TEST_NULL_OSYSTEM 1
 namespace Common {
+class Path;
+
 #if defined(POSIX) || defined(WIN32)
 void install_null_g_system();
 #define NULL_OSYSTEM_IS_AVAILABLE 1
 #else
 #define NULL_OSYSTEM_IS_AVAILABLE 0
 #endif
+
+#ifdef POSIX
+/**
+ * Create a new, empty directory for the files of a test in the temporary
+ * directory of the system. Returns an empty path on failure.
+ */
+Path create_test_directory(const char *name);
+
+/** Remove a directory created by create_test_directory() and its contents. */
+void remove_test_directory(const Path &path);
+
+/**
+ * Set the modification time of a file or directory, and of its contents,
+ * the given number of seconds in the past.
+ */
+bool age_test_files(const Path &path, int seconds);
+#endif
 }
 #endif
@@ -0,0 +1,14 @@
+// The save file manager of the tests does not sync the saves to the cloud,
+// which would pull the whole cloud manager into the test runner
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+
+#include "common/scummsys.h"
+#undef USE_CLOUD
+
+#include "../backends/saves/savefile.cpp"
+#include "../backends/saves/default/default-saves.cpp"
+
+// The save descriptors only ask the running engine for its autosave slot
+class Engine;
+Engine *g_engine = nullptr;
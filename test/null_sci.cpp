@@ -0,0 +1,64 @@
+// The SCI32 cel renderer reads its cels through the running engine. The tests
+// draw cels of their own, so these stand in for the parts of the engine which
+// the cel objects refer to, instead of pulling the whole engine into the test
+// runner.
+
+#include "common/scummsys.h"
+
+#ifdef ENABLE_SCI32
+
+#include "sci/engine/seg_manager.h"
+#include "sci/engine/state.h"
+#include "sci/graphics/palette32.h"
+#include "sci/resource/resource.h"
+#include "sci/sci.h"
+#include "sci/util.h"
+
+namespace Sci {
+
+SciEngine *g_sci = nullptr;
+SciVersion g_sciVersion = SCI_VERSION_2_1_MIDDLE;
+const reg_t NULL_REG = {0, 0};
+
+SegmentId reg_t::getSegment() const {
+	return _segment;
+}
+
+// The cels of the tests are stored like the ones of PC games
+uint16 READ_SCI11ENDIAN_UINT16(const void *ptr) {
+	return READ_LE_UINT16(ptr);
+}
+
+uint32 READ_SCI11ENDIAN_UINT32(const void *ptr) {
+	return READ_LE_UINT32(ptr);
+}
+
+Common::Platform SciEngine::getPlatform() const {
+	return Common::kPlatformDOS;
+}
+
+// Views, pics, bitmaps and palettes come from the engine state, which the
+// tests do not have
+Resource *ResourceManager::findResource(ResourceId id, bool lock) {
+	error("ResourceManager::findResource() is not available in the tests");
+}
+
+SciBitmap *SegManager::lookupBitmap(reg_t addr) {
+	error("SegManager::lookupBitmap() is not available in the tests");
+}
+
+SciCallOrigin EngineState::getCurrentCallOrigin() const {
+	error("EngineState::getCurrentCallOrigin() is not available in the tests");
+}
+
+HunkPalette::HunkPalette(const SciSpan<const byte> &rawPalette) {
+	error("HunkPalette is not available in the tests");
+}
+
+void GfxPalette32::submit(const HunkPalette &palette) {
+	error("GfxPalette32::submit() is not available in the tests");
+}
+
+} // End of namespace Sci
+
+#endif
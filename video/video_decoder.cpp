@@ -27,6 +27,7 @@
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/trace.h"
 
 namespace Video {
 
@@ -208,6 +209,8 @@ Graphics::PixelFormat VideoDecoder::getPixelFormat() const {
 }
 
 const Graphics::Surface *VideoDecoder::decodeNextFrame() {
+	TRACE_ZONE("VideoDecoder::decodeNextFrame");
+
 	_needsUpdate = false;
 	_canSetDither = false;
 	_canSetDefaultFormat = false;